@@ -10,6 +10,8 @@ macro(configure_project)
     # Features:
     option(VMTRACE "Enable VM tracing" OFF)
     option(EVM_OPTIMIZE "Enable VM optimizations (can distort tracing)" ON)
+    option(EVM_NATIVE_UINT256 "Use native 4x64-bit 256-bit arithmetic in the VMs" ON)
+    option(EVM_BASIC_BLOCKS "Basic blocks and superinstructions in skale-interpreter" ON)
     option(FATDB "Enable fat state database" ON)
     option(PARANOID "Enable additional checks when validating transactions (deprecated)" OFF)
     option(MINIUPNPC "Build with UPnP support" OFF)
@@ -17,6 +19,7 @@ macro(configure_project)
     option(CONSENSUS "Use Skale consensus algorithm" ON)
     option(MICROPROFILE "Enable generation of profile.html through MICROPROFILE lib" OFF)
     option(HISTORIC_STATE "Use parallel Merkle Tree to maintain historic states" OFF)
+    option(ROCKSDB "Build with RocksDB database backend" OFF)
 
     if(MINIUPNPC)
         message(WARNING
@@ -99,8 +102,11 @@ macro(print_config)
     message("--------------------------------------------------------------- features")
     message("-- VMTRACE          VM execution tracing                     ${VMTRACE}")
     message("-- EVM_OPTIMIZE     Enable VM optimizations                  ${EVM_OPTIMIZE}")
+    message("-- EVM_NATIVE_UINT256 Native 256-bit VM arithmetic           ${EVM_NATIVE_UINT256}")
+    message("-- EVM_BASIC_BLOCKS Basic blocks and superinstructions       ${EVM_BASIC_BLOCKS}")
     message("-- FATDB            Full database exploring                  ${FATDB}")
     message("-- DB               Database implementation                  LEVELDB")
+    message("-- ROCKSDB          RocksDB database backend                 ${ROCKSDB}")
     message("-- PARANOID         -                                        ${PARANOID}")
     message("-- MINIUPNPC        -                                        ${MINIUPNPC}")
     message("-- CONSENSUS        -                                        ${CONSENSUS}")
@@ -7,6 +7,57 @@ using namespace dev::db;
 batched_db::~batched_db() {
     // all batches should be either commit()'ted or revert()'ed!
     assert( !m_batch );
+    std::lock_guard< std::mutex > write_lock( m_write_mutex );
+    if ( m_write.valid() )
+        m_write.wait();
+}
+
+void batched_db::commit_async( const std::string& test_crash_string ) {
+    if ( !m_async ) {
+        commit( test_crash_string );
+        return;
+    }
+
+    // one batch at a time keeps writes in order
+    wait_written();
+
+    std::lock_guard< std::mutex > batch_lock( m_batch_mutex );
+    ensure_batch();
+    test_crash_before_commit( test_crash_string );
+    {
+        std::unique_lock< std::shared_mutex > writing_lock( m_writing_mutex );
+        m_writing = std::move( m_batch_contents );
+    }
+    m_batch_contents.clear();
+
+    std::lock_guard< std::mutex > write_lock( m_write_mutex );
+    m_write = std::async(
+        std::launch::async, [this, batch = std::move( m_batch )]() mutable {
+            m_db->commit( std::move( batch ) );
+            // written data is read from m_db from now on; on error it stays here
+            std::unique_lock< std::shared_mutex > writing_lock( m_writing_mutex );
+            m_writing.clear();
+        } );
+}
+
+void batched_db::wait_written() const {
+    std::lock_guard< std::mutex > write_lock( m_write_mutex );
+    if ( !m_write.valid() )
+        return;
+    // get() rethrows write errors and makes the future invalid
+    m_write.get();
+}
+
+bool batched_db::lookup_writing(
+    dev::db::Slice _key, std::optional< std::string >& _value ) const {
+    std::shared_lock< std::shared_mutex > writing_lock( m_writing_mutex );
+    if ( m_writing.empty() )
+        return false;
+    auto it = m_writing.find( _key.toString() );
+    if ( it == m_writing.end() )
+        return false;
+    _value = it->second;
+    return true;
 }
 
 db_operations_face* db_splitter::new_interface() {
@@ -59,4 +110,16 @@ void db_splitter::prefixed_db::forEach(
     } );
 }
 
+void db_splitter::prefixed_db::forEachInRange( dev::db::Slice _begin, dev::db::Slice _end,
+    std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const {
+    std::string const begin = prefix + _begin.toString();
+    std::string const end = _end.empty() ?
+                                dev::db::prefixUpperBound( dev::db::Slice( &prefix, 1 ) ) :
+                                prefix + _end.toString();
+    backend->forEachInRange( begin, end, [&]( dev::db::Slice _key, dev::db::Slice _val ) -> bool {
+        dev::db::Slice key_short = dev::db::Slice( _key.data() + 1, _key.size() - 1 );
+        return f( key_short, _val );
+    } );
+}
+
 }  // namespace batched_io
@@ -5,6 +5,9 @@
 
 #include <libdevcore/LevelDB.h>
 
+#include <future>
+#include <map>
+#include <optional>
 #include <shared_mutex>
 
 namespace batched_io {
@@ -18,11 +21,27 @@ public:
     virtual std::string lookup( dev::db::Slice _key ) const = 0;
     virtual bool exists( dev::db::Slice _key ) const = 0;
     virtual void forEach( std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const = 0;
+    // see dev::db::DatabaseFace::forEachInRange()
+    virtual void forEachInRange( dev::db::Slice _begin, dev::db::Slice _end,
+        std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const = 0;
+    void forEachWithPrefix( dev::db::Slice _prefix,
+        std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const {
+        std::string const end = dev::db::prefixUpperBound( _prefix );
+        forEachInRange( _prefix, end, std::move( f ) );
+    }
 
     virtual ~db_operations_face() = default;
 };
 
-class db_face : public db_operations_face, public batched_face {};
+class db_face : public db_operations_face, public batched_face {
+public:
+    // like commit() but may write in background; committed data is readable at once
+    virtual void commit_async( const std::string& test_crash_string = std::string() ) {
+        commit( test_crash_string );
+    }
+    // waits until everything committed is written, rethrows write errors
+    virtual void wait_committed() {}
+};
 
 class batched_db : public db_face {
 private:
@@ -30,44 +49,89 @@ private:
     std::unique_ptr< dev::db::WriteBatchFace > m_batch;
     mutable std::mutex m_batch_mutex;
 
+    // commit_async() support: contents of m_batch and of the batch being written
+    // nullopt means killed
+    using contents = std::map< std::string, std::optional< std::string > >;
+    bool m_async = false;
+    contents m_batch_contents;
+    contents m_writing;
+    mutable std::shared_mutex m_writing_mutex;
+    mutable std::future< void > m_write;
+    mutable std::mutex m_write_mutex;
+
+    // @returns true and sets _value if _key is in the batch being written
+    bool lookup_writing( dev::db::Slice _key, std::optional< std::string >& _value ) const;
+    void wait_written() const;
+
     void ensure_batch() {
         if ( !m_batch )
             m_batch = m_db->createWriteBatch();
     }
 
 public:
-    void open( std::shared_ptr< dev::db::DatabaseFace > _db ) { m_db = _db; }
+    // _async enables background writes in commit_async()
+    void open( std::shared_ptr< dev::db::DatabaseFace > _db, bool _async = false ) {
+        m_db = _db;
+        m_async = _async;
+    }
     bool is_open() const { return !!m_db; }
     void insert( dev::db::Slice _key, dev::db::Slice _value ) {
         std::lock_guard< std::mutex > batch_lock( m_batch_mutex );
         ensure_batch();
         m_batch->insert( _key, _value );
+        if ( m_async )
+            m_batch_contents[_key.toString()] = _value.toString();
     }
     void kill( dev::db::Slice _key ) {
         std::lock_guard< std::mutex > batch_lock( m_batch_mutex );
         ensure_batch();
         m_batch->kill( _key );
+        if ( m_async )
+            m_batch_contents[_key.toString()] = std::nullopt;
     }
     virtual void revert() {
+        wait_written();
         std::lock_guard< std::mutex > batch_lock( m_batch_mutex );
         if ( m_batch )
             m_batch.reset();
+        m_batch_contents.clear();
         m_db->discardCreatedBatches();
     }
     virtual void commit( const std::string& test_crash_string = std::string() ) {
+        wait_written();
         std::lock_guard< std::mutex > batch_lock( m_batch_mutex );
         ensure_batch();
         test_crash_before_commit( test_crash_string );
         m_db->commit( std::move( m_batch ) );
+        m_batch_contents.clear();
     }
+    virtual void commit_async( const std::string& test_crash_string = std::string() );
+    virtual void wait_committed() { wait_written(); }
 
     // readonly
-    virtual std::string lookup( dev::db::Slice _key ) const { return m_db->lookup( _key ); }
-    virtual bool exists( dev::db::Slice _key ) const { return m_db->exists( _key ); }
+    virtual std::string lookup( dev::db::Slice _key ) const {
+        std::optional< std::string > value;
+        if ( lookup_writing( _key, value ) )
+            return value ? *value : std::string();
+        return m_db->lookup( _key );
+    }
+    virtual bool exists( dev::db::Slice _key ) const {
+        std::optional< std::string > value;
+        if ( lookup_writing( _key, value ) )
+            return value.has_value();
+        return m_db->exists( _key );
+    }
     virtual void forEach( std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const {
+        wait_written();
         std::lock_guard< std::mutex > foreach_lock( m_batch_mutex );
         m_db->forEach( f );
     }
+    virtual void forEachInRange( dev::db::Slice _begin, dev::db::Slice _end,
+        std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const {
+        wait_written();
+        std::lock_guard< std::mutex > foreach_lock( m_batch_mutex );
+        m_db->forEachInRange( _begin, _end, f );
+    }
 
     virtual ~batched_db();
 
@@ -100,11 +164,17 @@ private:
         virtual void commit( const std::string& test_crash_string = std::string() ) {
             backend->commit( test_crash_string );
         }
+        virtual void commit_async( const std::string& test_crash_string = std::string() ) {
+            backend->commit_async( test_crash_string );
+        }
+        virtual void wait_committed() { backend->wait_committed(); }
 
         // readonly
         virtual std::string lookup( dev::db::Slice _key ) const;
         virtual bool exists( dev::db::Slice _key ) const;
         virtual void forEach( std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const;
+        virtual void forEachInRange( dev::db::Slice _begin, dev::db::Slice _end,
+            std::function< bool( dev::db::Slice, dev::db::Slice ) > f ) const;
 
     protected:
         virtual void recover() { /* nothing */
@@ -1,5 +1,6 @@
 #include "batched_rotating_db_io.h"
 
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/LevelDB.h>
 
 namespace batched_io {
@@ -11,13 +12,17 @@ const std::string current_piece_mark_key =
     "ead48ec575aaa7127384dee432fc1c02d9f6a22950234e5ecf59f35ed9f6e78d";
 }
 
-rotating_db_io::rotating_db_io(
-    const boost::filesystem::path& _path, size_t _nPieces, bool _archiveMode )
-    : base_path( _path ), n_pieces( _nPieces ), archive_mode( _archiveMode ) {
+rotating_db_io::rotating_db_io( const boost::filesystem::path& _path, size_t _nPieces,
+    bool _archiveMode, IncrementalHash _incrementalHash )
+    : base_path( _path ),
+      n_pieces( _nPieces ),
+      archive_mode( _archiveMode ),
+      incremental_hash( _incrementalHash ) {
     // open all
     for ( size_t i = 0; i < n_pieces; ++i ) {
         boost::filesystem::path path = base_path / ( std::to_string( i ) + ".db" );
-        DatabaseFace* db = new LevelDB( path );
+        DatabaseFace* db =
+            DBFactory::create( path, LevelDBKind::Blocks, incremental_hash ).release();
         pieces.emplace_back( db );
     }  // for
 
@@ -60,7 +65,8 @@ rotating_db_io::rotating_db_io(
             if ( !boost::filesystem::exists( path ) )
                 break;
 
-            DatabaseFace* db = new LevelDB( path );
+            DatabaseFace* db =
+                DBFactory::create( path, LevelDBKind::Blocks, incremental_hash ).release();
             pieces.emplace_back( db );
         }  // for
     }      // archive_mode
@@ -84,7 +90,8 @@ void rotating_db_io::rotate() {
     if ( archive_mode ) {
         boost::filesystem::rename( oldest_path, new_archive_path );
         test_crash_before_commit( "after_rename_oldest" );
-        DatabaseFace* new_archive_db = new LevelDB( new_archive_path );
+        DatabaseFace* new_archive_db =
+            DBFactory::create( new_archive_path, LevelDBKind::Blocks, incremental_hash ).release();
         pieces.emplace_back( new_archive_db );
     } else {
         boost::filesystem::remove_all( oldest_path );  // delete oldest
@@ -92,7 +99,8 @@ void rotating_db_io::rotate() {
     }
 
     // 2 recreate it as new current
-    DatabaseFace* new_db = new LevelDB( oldest_path );
+    DatabaseFace* new_db =
+        DBFactory::create( oldest_path, LevelDBKind::Blocks, incremental_hash ).release();
     pieces.emplace_front( new_db );
 
     test_crash_before_commit( "after_open_leveldb" );
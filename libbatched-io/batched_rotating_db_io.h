@@ -19,12 +19,14 @@ private:
     size_t n_pieces;
 
     bool archive_mode;
+    const dev::db::IncrementalHash incremental_hash;
     std::deque< std::unique_ptr< dev::db::DatabaseFace > > archive_pieces;
 
 public:
     using const_iterator = std::deque< std::unique_ptr< dev::db::DatabaseFace > >::const_iterator;
 
-    rotating_db_io( const boost::filesystem::path& _path, size_t _nPieces, bool _archiveMode );
+    rotating_db_io( const boost::filesystem::path& _path, size_t _nPieces, bool _archiveMode,
+        dev::db::IncrementalHash _incrementalHash = dev::db::IncrementalHash::Untouched );
     const_iterator begin() const { return pieces.begin(); }
     const_iterator end() const { return pieces.end(); }
     size_t pieces_count() const { return n_pieces; }
@@ -21,8 +21,13 @@
 #include "FileSystem.h"
 #include "LevelDB.h"
 #include "MemoryDB.h"
+#if SKALED_ROCKSDB
+#include "RocksDB.h"
+#endif
 #include "libethcore/Exceptions.h"
 
+#include <fstream>
+
 namespace dev {
 namespace db {
 namespace fs = boost::filesystem;
@@ -44,7 +49,14 @@ struct DBKindTableEntry {
 ///
 /// We don't use a map to avoid complex dynamic initialization. This list will never be long,
 /// so linear search only to parse command line arguments is not a problem.
-DBKindTableEntry dbKindsTable[] = { { DatabaseKind::LevelDB, "leveldb" } };
+DBKindTableEntry dbKindsTable[] = {
+    { DatabaseKind::LevelDB, "leveldb" },
+#if SKALED_ROCKSDB
+    { DatabaseKind::RocksDB, "rocksdb" },
+#endif
+};
+
+char const* const c_databaseKindFileName = "db_backend";
 
 void setDatabaseKindByName( std::string const& _name ) {
     for ( auto& entry : dbKindsTable ) {
@@ -69,6 +81,7 @@ void setDatabasePath( std::string const& _path ) {
 bool isDiskDatabase() {
     switch ( g_kind ) {
     case DatabaseKind::LevelDB:
+    case DatabaseKind::RocksDB:
         return true;
     default:
         return false;
@@ -83,6 +96,43 @@ fs::path databasePath() {
     return g_dbPath.empty() ? getDataDir() : g_dbPath;
 }
 
+std::string databaseKindName( DatabaseKind _kind ) {
+    // LevelDB is always in the table, other kinds are there only if compiled in
+    for ( auto const& entry : dbKindsTable )
+        if ( entry.kind == _kind )
+            return entry.name;
+    return "rocksdb";
+}
+
+std::string writtenDatabaseKindName( fs::path const& _dir ) {
+    fs::path const marker = _dir / c_databaseKindFileName;
+    std::string written;
+    if ( fs::exists( marker ) ) {
+        std::ifstream in( marker.string() );
+        in >> written;
+    } else if ( fs::exists( _dir ) && !fs::is_empty( _dir ) )
+        written = databaseKindName( DatabaseKind::LevelDB );
+    return written;
+}
+
+void checkDatabaseKind( fs::path const& _dir ) {
+    std::string const selected = databaseKindName( g_kind );
+    std::string const written = writtenDatabaseKindName( _dir );
+
+    if ( !written.empty() && written != selected )
+        BOOST_THROW_EXCEPTION( eth::InvalidDatabaseKind()
+                               << errinfo_comment( "databases in " + _dir.string() +
+                                                   " were written by " + written +
+                                                   ", cannot open them with " + selected ) );
+
+    fs::path const marker = _dir / c_databaseKindFileName;
+    if ( !fs::exists( marker ) ) {
+        fs::create_directories( _dir );
+        std::ofstream out( marker.string() );
+        out << selected;
+    }
+}
+
 po::options_description databaseProgramOptions( unsigned _lineLength ) {
     // It must be a static object because boost expects const char*.
     static std::string const description = [] {
@@ -133,6 +183,37 @@ std::unique_ptr< DatabaseFace > DBFactory::create( DatabaseKind _kind, fs::path
     case DatabaseKind::LevelDB:
         return std::unique_ptr< DatabaseFace >( new LevelDB( _path ) );
         break;
+#if SKALED_ROCKSDB
+    case DatabaseKind::RocksDB:
+        return std::unique_ptr< DatabaseFace >( new RocksDB( _path ) );
+        break;
+#endif
+    default:
+        assert( false );
+        return {};
+    }
+}
+
+std::unique_ptr< DatabaseFace > DBFactory::create( fs::path const& _path, LevelDBKind _usage ) {
+    return create( _path, _usage, IncrementalHash::Untouched );
+}
+
+std::unique_ptr< DatabaseFace > DBFactory::create(
+    fs::path const& _path, LevelDBKind _usage, IncrementalHash _incrementalHash ) {
+    switch ( g_kind ) {
+    case DatabaseKind::LevelDB:
+        return std::unique_ptr< DatabaseFace >( new LevelDB( _path, _usage, _incrementalHash ) );
+        break;
+#if SKALED_ROCKSDB
+    case DatabaseKind::RocksDB:
+        if ( _incrementalHash == IncrementalHash::Owned && c_maintainIncrementalHash )
+            BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment(
+                                       "Incremental snapshot hash is supported by leveldb only" )
+                                                   << errinfo_path( _path.string() ) );
+        return std::unique_ptr< DatabaseFace >( new RocksDB( _path, _usage,
+            _usage == LevelDBKind::Blocks ? RocksDB::c_blocksPrefixFamilies : 0 ) );
+        break;
+#endif
     default:
         assert( false );
         return {};
@@ -27,7 +27,9 @@
 
 namespace dev {
 namespace db {
-enum class DatabaseKind { LevelDB };
+enum class DatabaseKind { LevelDB, RocksDB };
+enum class LevelDBKind;
+enum class IncrementalHash;
 
 /// Provide a set of program options related to databases
 ///
@@ -42,6 +44,18 @@ void setDatabaseKindByName( std::string const& _name );
 void setDatabaseKind( DatabaseKind _kind );
 boost::filesystem::path databasePath();
 
+/// Name of the file that records which backend wrote the databases in a directory
+extern char const* const c_databaseKindFileName;
+
+std::string databaseKindName( DatabaseKind _kind );
+/// Name of the backend that wrote the databases in _dir, empty if there are none. Directories
+/// that already hold data but have no marker were written by LevelDB.
+std::string writtenDatabaseKindName( boost::filesystem::path const& _dir );
+/// Throws InvalidDatabaseKind if the databases in _dir were written by another backend than
+/// the selected one, as they would be read as empty or corrupt. Marks _dir with the selected
+/// backend otherwise.
+void checkDatabaseKind( boost::filesystem::path const& _dir );
+
 class DBFactory {
 public:
     DBFactory() = delete;
@@ -52,6 +66,12 @@ public:
     static std::unique_ptr< DatabaseFace > create( DatabaseKind _kind );
     static std::unique_ptr< DatabaseFace > create(
         DatabaseKind _kind, boost::filesystem::path const& _path );
+    /// Database tuned for the given usage
+    static std::unique_ptr< DatabaseFace > create(
+        boost::filesystem::path const& _path, LevelDBKind _usage );
+    /// Database tuned for the given usage, with its incremental hash handled as requested
+    static std::unique_ptr< DatabaseFace > create( boost::filesystem::path const& _path,
+        LevelDBKind _usage, IncrementalHash _incrementalHash );
 
 private:
 };
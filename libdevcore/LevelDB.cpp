@@ -24,10 +24,28 @@
 #include <libdevcore/microprofile.h>
 #include <secp256k1_sha256.h>
 
+#include <leveldb/cache.h>
+#include <leveldb/filter_policy.h>
+
+#include <map>
+#include <set>
+
 namespace dev {
 namespace db {
 
 unsigned c_maxOpenLeveldbFiles = 25;
+bool c_maintainIncrementalHash = false;
+
+std::map< LevelDBKind, LevelDBTuning > c_leveldbTuning = {
+    { LevelDBKind::State, { 10, 16 * 1024 * 1024, true } },
+    { LevelDBKind::Historic, { 10, 16 * 1024 * 1024, true } },
+};
+size_t c_leveldbBlockCacheSize = 0;
+
+char const* const LevelDB::c_incrementalHashKey = "incrementalHashAccumulator";
+
+std::atomic< uint64_t > LevelDB::s_lookups{ 0 };
+std::atomic< uint64_t > LevelDB::s_missedLookups{ 0 };
 
 namespace {
 inline leveldb::Slice toLDBSlice( Slice _slice ) {
@@ -81,6 +99,43 @@ void LevelDBWriteBatch::kill( Slice _key ) {
     m_writeBatch.Delete( toLDBSlice( _key ) );
 }
 
+// Created on first use, so c_leveldbBlockCacheSize is already read from config. Never
+// deleted, as databases in static objects may be closed after it
+leveldb::Cache* sharedBlockCache() {
+    static leveldb::Cache* const cache =
+        c_leveldbBlockCacheSize > 0 ? leveldb::NewLRUCache( c_leveldbBlockCacheSize ) : nullptr;
+    return cache;
+}
+
+struct OpenDatabases {
+    std::mutex mutex;
+    std::set< LevelDB const* > databases;
+};
+
+// never deleted, like sharedBlockCache()
+OpenDatabases& openDatabases() {
+    static OpenDatabases* const open = new OpenDatabases;
+    return *open;
+}
+
+// options only point to a filter policy, so it is never deleted too
+leveldb::FilterPolicy const* bloomFilterPolicy( int _bitsPerKey ) {
+    static std::mutex mutex;
+    static std::map< int, leveldb::FilterPolicy const* > policies;
+
+    std::lock_guard< std::mutex > lock( mutex );
+    auto& policy = policies[_bitsPerKey];
+    if ( !policy )
+        policy = leveldb::NewBloomFilterPolicy( _bitsPerKey );
+    return policy;
+}
+
+// reads of whole databases shouldn't evict the working set from the block cache
+leveldb::ReadOptions scanReadOptions( leveldb::ReadOptions _options ) {
+    _options.fill_cache = false;
+    return _options;
+}
+
 }  // namespace
 
 leveldb::ReadOptions LevelDB::defaultReadOptions() {
@@ -91,33 +146,66 @@ leveldb::WriteOptions LevelDB::defaultWriteOptions() {
     return leveldb::WriteOptions();
 }
 
-leveldb::Options LevelDB::defaultDBOptions() {
+leveldb::Options LevelDB::defaultDBOptions( LevelDBKind _kind ) {
+    auto const it = c_leveldbTuning.find( _kind );
+    LevelDBTuning const tuning = it != c_leveldbTuning.end() ? it->second : LevelDBTuning();
+
     leveldb::Options options;
     options.create_if_missing = true;
     options.max_open_files = c_maxOpenLeveldbFiles;
+    // lets lookups of absent keys, e.g. of unset storage slots, skip reading table blocks
+    if ( tuning.bloomBitsPerKey > 0 )
+        options.filter_policy = bloomFilterPolicy( tuning.bloomBitsPerKey );
+    if ( tuning.writeBufferSize > 0 )
+        options.write_buffer_size = tuning.writeBufferSize;
+    options.compression =
+        tuning.compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    if ( leveldb::Cache* cache = sharedBlockCache() )
+        options.block_cache = cache;
     return options;
 }
 
 LevelDB::LevelDB( boost::filesystem::path const& _path, leveldb::ReadOptions _readOptions,
-    leveldb::WriteOptions _writeOptions, leveldb::Options _dbOptions )
+    leveldb::WriteOptions _writeOptions, leveldb::Options _dbOptions,
+    IncrementalHash _incrementalHash )
     : m_db( nullptr ),
       m_readOptions( std::move( _readOptions ) ),
       m_writeOptions( std::move( _writeOptions ) ),
-      m_path( _path ) {
+      m_path( _path ),
+      m_maintainIncrementalHash(
+          _incrementalHash == IncrementalHash::Owned && c_maintainIncrementalHash ) {
     auto db = static_cast< leveldb::DB* >( nullptr );
     auto const status = leveldb::DB::Open( _dbOptions, _path.string(), &db );
     checkStatus( status, _path );
 
     assert( db );
     m_db.reset( db );
+
+    loadIncrementalHash( _incrementalHash );
+
+    std::lock_guard< std::mutex > lock( openDatabases().mutex );
+    openDatabases().databases.insert( this );
+}
+
+LevelDB::LevelDB(
+    boost::filesystem::path const& _path, LevelDBKind _kind, IncrementalHash _incrementalHash )
+    : LevelDB( _path, defaultReadOptions(), defaultWriteOptions(), defaultDBOptions( _kind ),
+          _incrementalHash ) {}
+
+LevelDB::~LevelDB() {
+    std::lock_guard< std::mutex > lock( openDatabases().mutex );
+    openDatabases().databases.erase( this );
 }
 
 std::string LevelDB::lookup( Slice _key ) const {
     leveldb::Slice const key( _key.data(), _key.size() );
     std::string value;
     auto const status = m_db->Get( m_readOptions, key, &value );
-    if ( status.IsNotFound() )
+    ++s_lookups;
+    if ( status.IsNotFound() ) {
+        ++s_missedLookups;
         return std::string();
+    }
 
     checkStatus( status );
     return value;
@@ -127,24 +215,26 @@ bool LevelDB::exists( Slice _key ) const {
     std::string value;
     leveldb::Slice const key( _key.data(), _key.size() );
     auto const status = m_db->Get( m_readOptions, key, &value );
-    if ( status.IsNotFound() )
+    ++s_lookups;
+    if ( status.IsNotFound() ) {
+        ++s_missedLookups;
         return false;
+    }
 
     checkStatus( status );
     return true;
 }
 
 void LevelDB::insert( Slice _key, Slice _value ) {
-    leveldb::Slice const key( _key.data(), _key.size() );
-    leveldb::Slice const value( _value.data(), _value.size() );
-    auto const status = m_db->Put( m_writeOptions, key, value );
-    checkStatus( status );
+    leveldb::WriteBatch batch;
+    batch.Put( toLDBSlice( _key ), toLDBSlice( _value ) );
+    write( batch );
 }
 
 void LevelDB::kill( Slice _key ) {
-    leveldb::Slice const key( _key.data(), _key.size() );
-    auto const status = m_db->Delete( m_writeOptions, key );
-    checkStatus( status );
+    leveldb::WriteBatch batch;
+    batch.Delete( toLDBSlice( _key ) );
+    write( batch );
 }
 
 std::unique_ptr< WriteBatchFace > LevelDB::createWriteBatch() const {
@@ -160,8 +250,54 @@ void LevelDB::commit( std::unique_ptr< WriteBatchFace > _batch ) {
         BOOST_THROW_EXCEPTION(
             DatabaseError() << errinfo_comment( "Invalid batch type passed to LevelDB::commit" ) );
     }
-    auto const status = m_db->Write( m_writeOptions, &batchPtr->writeBatch() );
-    checkStatus( status );
+    write( batchPtr->writeBatch() );
+}
+
+void LevelDB::write( leveldb::WriteBatch& _batch ) {
+    if ( !m_maintainIncrementalHash ) {
+        checkStatus( m_db->Write( m_writeOptions, &_batch ) );
+        return;
+    }
+
+    // collect the final value of every key touched by the batch
+    class LatestValues : public leveldb::WriteBatch::Handler {
+    public:
+        void Put( leveldb::Slice const& _key, leveldb::Slice const& _value ) override {
+            values[_key.ToString()] = _value.ToString();
+        }
+        void Delete( leveldb::Slice const& _key ) override {
+            values[_key.ToString()] = boost::none;
+        }
+
+        std::map< std::string, boost::optional< std::string > > values;
+    } latest;
+    checkStatus( _batch.Iterate( &latest ) );
+
+    std::lock_guard< std::mutex > lock( m_incrementalHashMutex );
+
+    LtHash updated = m_incrementalHash;
+    for ( auto const& keyValue : latest.values ) {
+        leveldb::Slice const key( keyValue.first );
+        if ( !isHashed( key ) )
+            continue;
+
+        std::string oldValue;
+        auto const status = m_db->Get( m_readOptions, key, &oldValue );
+        if ( !status.IsNotFound() ) {
+            checkStatus( status );
+            addToHash( updated, key, oldValue, true );
+        }
+        if ( keyValue.second )
+            addToHash( updated, key, *keyValue.second );
+    }
+
+    // hash is written in the same batch, so it can't diverge from the data after a crash
+    bytes const serialized = updated.toBytes();
+    _batch.Put( c_incrementalHashKey,
+        leveldb::Slice( reinterpret_cast< char const* >( serialized.data() ), serialized.size() ) );
+    checkStatus( m_db->Write( m_writeOptions, &_batch ) );
+
+    m_incrementalHash = updated;
 }
 
 void LevelDB::forEach( std::function< bool( Slice, Slice ) > f ) const {
@@ -173,6 +309,8 @@ void LevelDB::forEach( std::function< bool( Slice, Slice ) > f ) const {
     auto keepIterating = true;
     for ( itr->SeekToFirst(); keepIterating && itr->Valid(); itr->Next() ) {
         auto const dbKey = itr->key();
+        if ( dbKey == leveldb::Slice( c_incrementalHashKey ) )
+            continue;
         auto const dbValue = itr->value();
         Slice const key( dbKey.data(), dbKey.size() );
         Slice const value( dbValue.data(), dbValue.size() );
@@ -180,21 +318,43 @@ void LevelDB::forEach( std::function< bool( Slice, Slice ) > f ) const {
     }
 }
 
+void LevelDB::forEachInRange(
+    Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const {
+    std::unique_ptr< leveldb::Iterator > itr( m_db->NewIterator( m_readOptions ) );
+    if ( itr == nullptr ) {
+        BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
+    }
+    leveldb::Slice const end( _end.data(), _end.size() );
+    for ( itr->Seek( leveldb::Slice( _begin.data(), _begin.size() ) ); itr->Valid();
+          itr->Next() ) {
+        auto const dbKey = itr->key();
+        if ( !end.empty() && dbKey.compare( end ) >= 0 )
+            break;
+        if ( dbKey == leveldb::Slice( c_incrementalHashKey ) )
+            continue;
+        auto const dbValue = itr->value();
+        if ( !f( Slice( dbKey.data(), dbKey.size() ), Slice( dbValue.data(), dbValue.size() ) ) )
+            break;
+    }
+    checkStatus( itr->status() );
+}
+
 h256 LevelDB::hashBase() const {
-    std::unique_ptr< leveldb::Iterator > it( m_db->NewIterator( m_readOptions ) );
+    std::unique_ptr< leveldb::Iterator > it(
+        m_db->NewIterator( scanReadOptions( m_readOptions ) ) );
     if ( it == nullptr ) {
         BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
     }
     secp256k1_sha256_t ctx;
     secp256k1_sha256_initialize( &ctx );
     for ( it->SeekToFirst(); it->Valid(); it->Next() ) {
-        std::string key_ = it->key().ToString();
-        std::string value_ = it->value().ToString();
         // HACK! For backward compatibility! When snapshot could happen between update of two nodes
         // - it would lead to stateRoot mismatch
         // TODO Move this logic to separate "compatiliblity layer"!
-        if ( key_ == "pieceUsageBytes" )
+        if ( !isHashed( it->key() ) )
             continue;
+        std::string key_ = it->key().ToString();
+        std::string value_ = it->value().ToString();
         std::string key_value = key_ + value_;
         const std::vector< uint8_t > usc( key_value.begin(), key_value.end() );
         bytesConstRef str_key_value( usc.data(), usc.size() );
@@ -206,14 +366,17 @@ h256 LevelDB::hashBase() const {
 }
 
 h256 LevelDB::hashBaseWithPrefix( char _prefix ) const {
-    std::unique_ptr< leveldb::Iterator > it( m_db->NewIterator( m_readOptions ) );
+    std::unique_ptr< leveldb::Iterator > it(
+        m_db->NewIterator( scanReadOptions( m_readOptions ) ) );
     if ( it == nullptr ) {
         BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
     }
     secp256k1_sha256_t ctx;
     secp256k1_sha256_initialize( &ctx );
-    for ( it->SeekToFirst(); it->Valid(); it->Next() ) {
-        if ( it->key()[0] == _prefix ) {
+    // keys with the prefix are contiguous, so only they are read
+    for ( it->Seek( leveldb::Slice( &_prefix, 1 ) ); it->Valid() && it->key()[0] == _prefix;
+          it->Next() ) {
+        if ( it->key() != leveldb::Slice( c_incrementalHashKey ) ) {
             std::string key_ = it->key().ToString();
             std::string value_ = it->value().ToString();
             std::string key_value = key_ + value_;
@@ -227,6 +390,129 @@ h256 LevelDB::hashBaseWithPrefix( char _prefix ) const {
     return hash;
 }
 
+h256 LevelDB::incrementalHash() const {
+    if ( m_maintainIncrementalHash ) {
+        std::lock_guard< std::mutex > lock( m_incrementalHashMutex );
+        return m_incrementalHash.digest();
+    }
+
+    // written by the owner in the same batch as the data, so it matches the data
+    if ( auto const stored = storedIncrementalHash() )
+        return stored->digest();
+    return scanHash().digest();
+}
+
+h256 LevelDB::verifiedIncrementalHash() const {
+    LtHash const scanned = scanHash();
+    auto const stored = storedIncrementalHash();
+    if ( stored && !( *stored == scanned ) )
+        BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment(
+                                   "incremental hash doesn't match " + m_path.string() ) );
+    return scanned.digest();
+}
+
+std::string LevelDB::property( std::string const& _name ) const {
+    std::string value;
+    if ( !m_db->GetProperty( _name, &value ) )
+        return std::string();
+    return value;
+}
+
+LevelDB::Stats LevelDB::stats() {
+    Stats stats{};
+    stats.lookups = s_lookups;
+    stats.missedLookups = s_missedLookups;
+    if ( leveldb::Cache* cache = sharedBlockCache() )
+        stats.blockCacheCharge = cache->TotalCharge();
+
+    std::lock_guard< std::mutex > lock( openDatabases().mutex );
+    stats.openDatabases = openDatabases().databases.size();
+    for ( LevelDB const* db : openDatabases().databases ) {
+        std::string const usage = db->property( "leveldb.approximate-memory-usage" );
+        if ( !usage.empty() )
+            stats.memoryUsage += std::stoull( usage );
+    }
+    return stats;
+}
+
+bool LevelDB::isHashed( leveldb::Slice const& _key ) {
+    return _key != leveldb::Slice( "pieceUsageBytes" ) &&
+           _key != leveldb::Slice( c_incrementalHashKey );
+}
+
+void LevelDB::addToHash(
+    LtHash& _hash, leveldb::Slice const& _key, leveldb::Slice const& _value, bool _remove ) {
+    // length prefix keeps ( key, value ) pairs unambiguous
+    bytes element( sizeof( uint64_t ) + _key.size() + _value.size() );
+    uint64_t const keySize = _key.size();
+    for ( size_t i = 0; i < sizeof( uint64_t ); ++i )
+        element[i] = static_cast< _byte_ >( keySize >> ( 8 * i ) );
+    std::copy( _key.data(), _key.data() + _key.size(), element.begin() + sizeof( uint64_t ) );
+    std::copy( _value.data(), _value.data() + _value.size(),
+        element.begin() + sizeof( uint64_t ) + _key.size() );
+
+    if ( _remove )
+        _hash.remove( &element );
+    else
+        _hash.add( &element );
+}
+
+LtHash LevelDB::scanHash() const {
+    std::unique_ptr< leveldb::Iterator > it(
+        m_db->NewIterator( scanReadOptions( m_readOptions ) ) );
+    if ( it == nullptr ) {
+        BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
+    }
+    LtHash hash;
+    for ( it->SeekToFirst(); it->Valid(); it->Next() ) {
+        if ( isHashed( it->key() ) )
+            addToHash( hash, it->key(), it->value() );
+    }
+    checkStatus( it->status() );
+    return hash;
+}
+
+boost::optional< LtHash > LevelDB::storedIncrementalHash() const {
+    std::string stored;
+    auto const status = m_db->Get( m_readOptions, c_incrementalHashKey, &stored );
+    if ( status.IsNotFound() )
+        return boost::none;
+    checkStatus( status, m_path );
+
+    LtHash hash;
+    if ( !hash.fromBytes( bytesConstRef(
+             reinterpret_cast< _byte_ const* >( stored.data() ), stored.size() ) ) )
+        return boost::none;
+    return hash;
+}
+
+void LevelDB::loadIncrementalHash( IncrementalHash _incrementalHash ) {
+    // databases which are only read or belong to others are never changed here
+    if ( _incrementalHash != IncrementalHash::Owned )
+        return;
+
+    if ( !m_maintainIncrementalHash ) {
+        // following writes won't update it, so drop it instead of leaving it stale
+        std::string stored;
+        if ( m_db->Get( m_readOptions, c_incrementalHashKey, &stored ).ok() )
+            checkStatus( m_db->Delete( m_writeOptions, c_incrementalHashKey ), m_path );
+        return;
+    }
+
+    if ( auto const stored = storedIncrementalHash() ) {
+        m_incrementalHash = *stored;
+        return;
+    }
+
+    // first open since incremental hashing was enabled
+    m_incrementalHash = scanHash();
+    bytes const serialized = m_incrementalHash.toBytes();
+    checkStatus( m_db->Put( m_writeOptions, c_incrementalHashKey,
+                     leveldb::Slice( reinterpret_cast< char const* >( serialized.data() ),
+                         serialized.size() ) ),
+        m_path );
+}
+
 // void LevelDB::doCompaction() const {
 //    m_db->CompactRange( NULL, NULL );
 //}
@@ -19,24 +19,73 @@
 
 #pragma once
 
+#include "LtHash.h"
 #include "db.h"
 
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
 
 namespace dev {
 namespace db {
+
+/// Keep an incremental hash of the databases opened with IncrementalHash::Owned up to date on
+/// each write, see LevelDB::incrementalHash(). Must be the same on all nodes of a chain.
+extern bool c_maintainIncrementalHash;
+
+/// What a LevelDB does with its persisted incremental hash
+enum class IncrementalHash {
+    /// Only read it. For databases opened to read or hash them and ones written by others,
+    /// which must not be changed.
+    Untouched,
+    /// Databases skaled writes and hashes into snapshots: the hash is kept up to date when
+    /// c_maintainIncrementalHash is set and dropped otherwise, so it is never stale
+    Owned
+};
+
+/// Databases with different access patterns, tuned separately
+enum class LevelDBKind { Default, State, Blocks, Historic };
+
+struct LevelDBTuning {
+    int bloomBitsPerKey = 10;  ///< 0 disables the bloom filter
+    size_t writeBufferSize = 4 * 1024 * 1024;
+    bool compression = true;
+};
+
+/// Tuning of each kind of database, kinds not present here use LevelDBTuning defaults
+extern std::map< LevelDBKind, LevelDBTuning > c_leveldbTuning;
+
+/// Size of the LRU block cache shared by all databases; 0 leaves leveldb's own
+/// small cache in each one
+extern size_t c_leveldbBlockCacheSize;
+
 class LevelDB : public DatabaseFace {
 public:
+    struct Stats {
+        size_t openDatabases;
+        uint64_t lookups;
+        uint64_t missedLookups;  ///< lookups of absent keys
+        size_t blockCacheCharge;
+        uint64_t memoryUsage;  ///< memtables and table readers of all open databases
+    };
+
     static leveldb::ReadOptions defaultReadOptions();
     static leveldb::WriteOptions defaultWriteOptions();
-    static leveldb::Options defaultDBOptions();
+    static leveldb::Options defaultDBOptions( LevelDBKind _kind = LevelDBKind::Default );
 
     explicit LevelDB( boost::filesystem::path const& _path,
         leveldb::ReadOptions _readOptions = defaultReadOptions(),
         leveldb::WriteOptions _writeOptions = defaultWriteOptions(),
-        leveldb::Options _dbOptions = defaultDBOptions() );
+        leveldb::Options _dbOptions = defaultDBOptions(),
+        IncrementalHash _incrementalHash = IncrementalHash::Untouched );
+    explicit LevelDB( boost::filesystem::path const& _path, LevelDBKind _kind,
+        IncrementalHash _incrementalHash = IncrementalHash::Untouched );
+    ~LevelDB() override;
 
     std::string lookup( Slice _key ) const override;
     bool exists( Slice _key ) const override;
@@ -47,17 +96,57 @@ public:
     void commit( std::unique_ptr< WriteBatchFace > _batch ) override;
 
     void forEach( std::function< bool( Slice, Slice ) > f ) const override;
+    void forEachInRange(
+        Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const override;
 
     h256 hashBase() const override;
     h256 hashBaseWithPrefix( char _prefix ) const;
 
+    /// Order-independent hash of all entries, kept up to date by every write of an owned
+    /// database when c_maintainIncrementalHash is set, so it costs nothing to get. Other
+    /// databases, such as snapshot copies, return the hash persisted by the owner, or compute it
+    /// by a full scan if there is none. Doesn't match hashBase().
+    h256 incrementalHash() const;
+
+    /// Same as incrementalHash(), but always computed by a full scan, for databases written by
+    /// others, such as downloaded snapshots. Throws DatabaseError if the persisted hash doesn't
+    /// match the entries, so that a database with a forged hash is never used.
+    h256 verifiedIncrementalHash() const;
+
+    /// Key under which the incremental hash is persisted, skipped by hashing and iteration
+    static char const* const c_incrementalHashKey;
+
+    /// Value of a leveldb property such as "leveldb.stats", empty if it is unknown
+    std::string property( std::string const& _name ) const;
+
+    /// Totals over all open databases
+    static Stats stats();
+
     //    void doCompaction() const;
 
 private:
+    static bool isHashed( leveldb::Slice const& _key );
+    static void addToHash( LtHash& _hash, leveldb::Slice const& _key,
+        leveldb::Slice const& _value, bool _remove = false );
+
+    LtHash scanHash() const;
+    /// Hash persisted by the owner of the database, if there is a valid one
+    boost::optional< LtHash > storedIncrementalHash() const;
+    void loadIncrementalHash( IncrementalHash _incrementalHash );
+    void write( leveldb::WriteBatch& _batch );
+
     std::unique_ptr< leveldb::DB > m_db;
     leveldb::ReadOptions const m_readOptions;
     leveldb::WriteOptions const m_writeOptions;
     boost::filesystem::path const m_path;
+
+    bool const m_maintainIncrementalHash;
+    LtHash m_incrementalHash;
+    /// Serializes writes while m_incrementalHash is maintained
+    mutable std::mutex m_incrementalHashMutex;
+
+    static std::atomic< uint64_t > s_lookups;
+    static std::atomic< uint64_t > s_missedLookups;
 };
 
 }  // namespace db
@@ -4,16 +4,17 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <unordered_map>
 
 namespace dev {
-template < class Key, class Value >
+template < class Key, class Value, class Hash = std::hash< Key > >
 class LruCache {
     using key_type = Key;
     using value_type = Value;
     using list_type = std::list< std::pair< key_type, value_type > >;
-    using map_type = std::unordered_map< key_type, typename list_type::const_iterator >;
+    using map_type = std::unordered_map< key_type, typename list_type::const_iterator, Hash >;
 
 public:
     explicit LruCache( size_t _capacity ) : m_capacity( _capacity ) {}
@@ -52,6 +53,15 @@ public:
         return false;
     }
 
+    /// @returns the value and marks it as most recently used, nullptr if there is no such key
+    value_type const* find( key_type const& _key ) {
+        auto const cIter = m_index.find( _key );
+        if ( cIter == m_index.cend() )
+            return nullptr;
+        m_data.splice( m_data.begin(), m_data, cIter->second );
+        return &cIter->second->second;
+    }
+
     bool contains( key_type const& _key ) const { return m_index.find( _key ) != m_index.cend(); }
 
     bool contains( key_type const& _key, value_type const& _value ) const {
@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LtHash.cpp
+ * @date 2026
+ */
+
+#include "LtHash.h"
+
+#include <secp256k1_sha256.h>
+
+namespace dev {
+
+void LtHash::expand( bytesConstRef _element, Lanes& o_lanes ) {
+    h256 seed;
+    secp256k1_sha256_t ctx;
+    secp256k1_sha256_initialize( &ctx );
+    secp256k1_sha256_write( &ctx, _element.data(), _element.size() );
+    secp256k1_sha256_finalize( &ctx, seed.data() );
+
+    // each block of 16 lanes is sha256( seed || block index )
+    size_t const lanesPerBlock = h256::size / sizeof( uint16_t );
+    for ( size_t block = 0; block < c_laneCount / lanesPerBlock; ++block ) {
+        _byte_ const index[2] = {
+            static_cast< _byte_ >( block >> 8 ), static_cast< _byte_ >( block ) };
+        h256 blockHash;
+        secp256k1_sha256_initialize( &ctx );
+        secp256k1_sha256_write( &ctx, seed.data(), seed.size );
+        secp256k1_sha256_write( &ctx, index, sizeof( index ) );
+        secp256k1_sha256_finalize( &ctx, blockHash.data() );
+
+        for ( size_t i = 0; i < lanesPerBlock; ++i )
+            o_lanes[block * lanesPerBlock + i] =
+                static_cast< uint16_t >( blockHash[2 * i] | ( blockHash[2 * i + 1] << 8 ) );
+    }
+}
+
+void LtHash::add( bytesConstRef _element ) {
+    Lanes lanes;
+    expand( _element, lanes );
+    for ( size_t i = 0; i < c_laneCount; ++i )
+        m_lanes[i] = static_cast< uint16_t >( m_lanes[i] + lanes[i] );
+}
+
+void LtHash::remove( bytesConstRef _element ) {
+    Lanes lanes;
+    expand( _element, lanes );
+    for ( size_t i = 0; i < c_laneCount; ++i )
+        m_lanes[i] = static_cast< uint16_t >( m_lanes[i] - lanes[i] );
+}
+
+bytes LtHash::toBytes() const {
+    bytes result( c_size );
+    for ( size_t i = 0; i < c_laneCount; ++i ) {
+        result[2 * i] = static_cast< _byte_ >( m_lanes[i] );
+        result[2 * i + 1] = static_cast< _byte_ >( m_lanes[i] >> 8 );
+    }
+    return result;
+}
+
+bool LtHash::fromBytes( bytesConstRef _data ) {
+    if ( _data.size() != c_size )
+        return false;
+    for ( size_t i = 0; i < c_laneCount; ++i )
+        m_lanes[i] = static_cast< uint16_t >( _data[2 * i] | ( _data[2 * i + 1] << 8 ) );
+    return true;
+}
+
+h256 LtHash::digest() const {
+    bytes const serialized = toBytes();
+    h256 result;
+    secp256k1_sha256_t ctx;
+    secp256k1_sha256_initialize( &ctx );
+    secp256k1_sha256_write( &ctx, serialized.data(), serialized.size() );
+    secp256k1_sha256_finalize( &ctx, result.data() );
+    return result;
+}
+
+}  // namespace dev
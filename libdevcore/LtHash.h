@@ -0,0 +1,65 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LtHash.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "Common.h"
+#include "FixedHash.h"
+
+#include <array>
+
+namespace dev {
+
+/// Homomorphic hash of a multiset (LtHash with 1024 16-bit lanes).
+/// The result does not depend on the order of elements, and every element can be added or
+/// removed at any time, so the hash of a large set is kept up to date at the cost of the changes.
+class LtHash {
+public:
+    static constexpr size_t c_laneCount = 1024;
+    static constexpr size_t c_size = c_laneCount * sizeof( uint16_t );
+
+    LtHash() { m_lanes.fill( 0 ); }
+
+    void add( bytesConstRef _element );
+    void remove( bytesConstRef _element );
+
+    /// Serialized lanes, c_size bytes
+    bytes toBytes() const;
+    /// @returns false if _data is not a serialized LtHash
+    bool fromBytes( bytesConstRef _data );
+
+    /// Short digest of the lanes
+    h256 digest() const;
+
+    bool operator==( LtHash const& _other ) const { return m_lanes == _other.m_lanes; }
+    bool operator!=( LtHash const& _other ) const { return m_lanes != _other.m_lanes; }
+
+private:
+    using Lanes = std::array< uint16_t, c_laneCount >;
+
+    static void expand( bytesConstRef _element, Lanes& o_lanes );
+
+    Lanes m_lanes;
+};
+
+}  // namespace dev
@@ -67,6 +67,20 @@ void ManuallyRotatingLevelDB::forEach( std::function< bool( Slice, Slice ) > f )
     }
 }
 
+void ManuallyRotatingLevelDB::forEachInRange(
+    Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const {
+    std::shared_lock< std::shared_mutex > lock( m_mutex );
+    bool keepIterating = true;
+    for ( const auto& p : *io_backend ) {
+        p->forEachInRange( _begin, _end, [&]( Slice _key, Slice _val ) -> bool {
+            keepIterating = f( _key, _val );
+            return keepIterating;
+        } );
+        if ( !keepIterating )
+            break;
+    }
+}
+
 h256 ManuallyRotatingLevelDB::hashBase() const {
     std::shared_lock< std::shared_mutex > lock( m_mutex );
     secp256k1_sha256_t ctx;
@@ -41,6 +41,9 @@ public:
     }
 
     virtual void forEach( std::function< bool( Slice, Slice ) > f ) const;
+    // pieces are visited one after another, newest first
+    virtual void forEachInRange(
+        Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const;
     virtual h256 hashBase() const;
 };
 
@@ -0,0 +1,394 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file RocksDB.cpp
+ * @date 2026
+ */
+
+#include "RocksDB.h"
+#include "Assertions.h"
+#include "Log.h"
+#include <secp256k1_sha256.h>
+
+#include <rocksdb/cache.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+#include <rocksdb/write_batch.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace dev {
+namespace db {
+
+extern unsigned c_maxOpenLeveldbFiles;
+
+namespace {
+inline rocksdb::Slice toRocksSlice( Slice _slice ) {
+    return rocksdb::Slice( _slice.data(), _slice.size() );
+}
+
+DatabaseStatus toDatabaseStatus( rocksdb::Status const& _status ) {
+    if ( _status.ok() )
+        return DatabaseStatus::Ok;
+    else if ( _status.IsIOError() )
+        return DatabaseStatus::IOError;
+    else if ( _status.IsCorruption() )
+        return DatabaseStatus::Corruption;
+    else if ( _status.IsNotFound() )
+        return DatabaseStatus::NotFound;
+    else if ( _status.IsNotSupported() )
+        return DatabaseStatus::NotSupported;
+    else if ( _status.IsInvalidArgument() )
+        return DatabaseStatus::InvalidArgument;
+    else
+        return DatabaseStatus::Unknown;
+}
+
+void checkStatus( rocksdb::Status const& _status, boost::filesystem::path const& _path = {} ) {
+    if ( _status.ok() )
+        return;
+
+    DatabaseError ex;
+    ex << errinfo_dbStatusCode( toDatabaseStatus( _status ) )
+       << errinfo_dbStatusString( _status.ToString() );
+    if ( !_path.empty() )
+        ex << errinfo_path( _path.string() );
+
+    BOOST_THROW_EXCEPTION( ex );
+}
+
+char const* const c_prefixFamilyName = "prefix-";
+
+std::string prefixFamilyName( unsigned _prefix ) {
+    return c_prefixFamilyName + std::to_string( _prefix );
+}
+
+bool parsePrefixFamilyName( std::string const& _name, unsigned& o_prefix ) {
+    std::string const start( c_prefixFamilyName );
+    if ( _name.compare( 0, start.size(), start ) != 0 )
+        return false;
+    try {
+        o_prefix = std::stoul( _name.substr( start.size() ) );
+    } catch ( std::exception const& ) {
+        return false;
+    }
+    return o_prefix < 256;
+}
+
+// created on first use, so c_leveldbBlockCacheSize is already read from config
+std::shared_ptr< rocksdb::Cache > sharedBlockCache() {
+    static std::shared_ptr< rocksdb::Cache > const cache =
+        c_leveldbBlockCacheSize > 0 ? rocksdb::NewLRUCache( c_leveldbBlockCacheSize ) : nullptr;
+    return cache;
+}
+
+// reads of whole databases shouldn't evict the working set from the block cache
+rocksdb::ReadOptions scanReadOptions( rocksdb::ReadOptions _options ) {
+    _options.fill_cache = false;
+    return _options;
+}
+
+}  // namespace
+
+class RocksDBWriteBatch : public WriteBatchFace {
+public:
+    explicit RocksDBWriteBatch( RocksDB const& _db ) : m_db( _db ) {}
+
+    void insert( Slice _key, Slice _value ) override;
+    void kill( Slice _key ) override;
+
+    rocksdb::WriteBatch& writeBatch() { return m_writeBatch; }
+
+private:
+    RocksDB const& m_db;
+    rocksdb::WriteBatch m_writeBatch;
+};
+
+void RocksDBWriteBatch::insert( Slice _key, Slice _value ) {
+    RocksDB::Route const route = m_db.route( _key );
+    m_writeBatch.Put( route.family, route.key, toRocksSlice( _value ) );
+}
+
+void RocksDBWriteBatch::kill( Slice _key ) {
+    RocksDB::Route const route = m_db.route( _key );
+    m_writeBatch.Delete( route.family, route.key );
+}
+
+rocksdb::ReadOptions RocksDB::defaultReadOptions() {
+    return rocksdb::ReadOptions();
+}
+
+rocksdb::WriteOptions RocksDB::defaultWriteOptions() {
+    return rocksdb::WriteOptions();
+}
+
+rocksdb::Options RocksDB::defaultDBOptions( LevelDBKind _kind ) {
+    auto const it = c_leveldbTuning.find( _kind );
+    LevelDBTuning const tuning = it != c_leveldbTuning.end() ? it->second : LevelDBTuning();
+
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    options.create_missing_column_families = true;
+    options.max_open_files = c_maxOpenLeveldbFiles;
+    // flushes and compactions run in parallel, so writes don't stall behind them
+    options.IncreaseParallelism(
+        static_cast< int >( std::max( 2u, std::thread::hardware_concurrency() ) ) );
+    // compaction output doesn't push the working set out of the page cache
+    options.use_direct_io_for_flush_and_compaction = true;
+    if ( tuning.writeBufferSize > 0 )
+        options.write_buffer_size = tuning.writeBufferSize;
+    options.compression =
+        tuning.compression ? rocksdb::kSnappyCompression : rocksdb::kNoCompression;
+
+    rocksdb::BlockBasedTableOptions table;
+    if ( tuning.bloomBitsPerKey > 0 ) {
+        table.filter_policy.reset( rocksdb::NewBloomFilterPolicy( tuning.bloomBitsPerKey, false ) );
+        // only the partitions of the filter that are needed are read and cached
+        table.partition_filters = true;
+        table.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+        table.cache_index_and_filter_blocks = true;
+        table.pin_top_level_index_and_filter = true;
+    }
+    if ( std::shared_ptr< rocksdb::Cache > cache = sharedBlockCache() ) {
+        table.block_cache = cache;
+        // block cache sized for the node replaces the page cache for reads too
+        options.use_direct_reads = true;
+    }
+    options.table_factory.reset( rocksdb::NewBlockBasedTableFactory( table ) );
+    return options;
+}
+
+RocksDB::RocksDB(
+    boost::filesystem::path const& _path, LevelDBKind _kind, unsigned _prefixFamilies )
+    : m_readOptions( defaultReadOptions() ),
+      m_writeOptions( defaultWriteOptions() ),
+      m_path( _path ) {
+    rocksdb::Options const options = defaultDBOptions( _kind );
+
+    // all families of an existing DB must be opened
+    std::vector< std::string > existing;
+    if ( rocksdb::DB::ListColumnFamilies( options, _path.string(), &existing ).ok() ) {
+        for ( auto const& name : existing ) {
+            unsigned prefix;
+            if ( parsePrefixFamilyName( name, prefix ) )
+                _prefixFamilies = std::max( _prefixFamilies, prefix + 1 );
+        }
+    }
+    assert( _prefixFamilies <= 256 );
+
+    std::vector< rocksdb::ColumnFamilyDescriptor > families;
+    families.emplace_back( rocksdb::kDefaultColumnFamilyName, options );
+    for ( unsigned i = 0; i < _prefixFamilies; ++i )
+        families.emplace_back( prefixFamilyName( i ), options );
+
+    std::vector< rocksdb::ColumnFamilyHandle* > handles;
+    auto db = static_cast< rocksdb::DB* >( nullptr );
+    auto const status = rocksdb::DB::Open( options, _path.string(), families, &handles, &db );
+    checkStatus( status, _path );
+
+    assert( db );
+    m_db.reset( db );
+    m_defaultFamily = handles.front();
+    m_prefixFamilies.assign( handles.begin() + 1, handles.end() );
+}
+
+RocksDB::~RocksDB() {
+    for ( rocksdb::ColumnFamilyHandle* family : m_prefixFamilies )
+        m_db->DestroyColumnFamilyHandle( family );
+    m_db->DestroyColumnFamilyHandle( m_defaultFamily );
+}
+
+RocksDB::Route RocksDB::route( Slice _key ) const {
+    if ( !_key.empty() ) {
+        unsigned char const prefix = _key[0];
+        if ( prefix < m_prefixFamilies.size() )
+            return { m_prefixFamilies[prefix],
+                rocksdb::Slice( _key.data() + 1, _key.size() - 1 ) };
+    }
+    return { m_defaultFamily, toRocksSlice( _key ) };
+}
+
+std::string RocksDB::lookup( Slice _key ) const {
+    Route const route = this->route( _key );
+    std::string value;
+    auto const status = m_db->Get( m_readOptions, route.family, route.key, &value );
+    if ( status.IsNotFound() )
+        return std::string();
+
+    checkStatus( status );
+    return value;
+}
+
+bool RocksDB::exists( Slice _key ) const {
+    Route const route = this->route( _key );
+    std::string value;
+    auto const status = m_db->Get( m_readOptions, route.family, route.key, &value );
+    if ( status.IsNotFound() )
+        return false;
+
+    checkStatus( status );
+    return true;
+}
+
+void RocksDB::insert( Slice _key, Slice _value ) {
+    Route const route = this->route( _key );
+    checkStatus( m_db->Put( m_writeOptions, route.family, route.key, toRocksSlice( _value ) ) );
+}
+
+void RocksDB::kill( Slice _key ) {
+    Route const route = this->route( _key );
+    checkStatus( m_db->Delete( m_writeOptions, route.family, route.key ) );
+}
+
+std::unique_ptr< WriteBatchFace > RocksDB::createWriteBatch() const {
+    return std::unique_ptr< WriteBatchFace >( new RocksDBWriteBatch( *this ) );
+}
+
+void RocksDB::commit( std::unique_ptr< WriteBatchFace > _batch ) {
+    if ( !_batch ) {
+        BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "Cannot commit null batch" ) );
+    }
+    auto* batchPtr = dynamic_cast< RocksDBWriteBatch* >( _batch.get() );
+    if ( !batchPtr ) {
+        BOOST_THROW_EXCEPTION(
+            DatabaseError() << errinfo_comment( "Invalid batch type passed to RocksDB::commit" ) );
+    }
+    checkStatus( m_db->Write( m_writeOptions, &batchPtr->writeBatch() ) );
+}
+
+void RocksDB::forEachEntry( rocksdb::ReadOptions const& _options, rocksdb::Slice _begin,
+    rocksdb::Slice _end, std::function< bool( rocksdb::Slice, rocksdb::Slice ) > _f ) const {
+    auto const beyondEnd = [&_end]( rocksdb::Slice const& _key ) {
+        return !_end.empty() && _key.compare( _end ) >= 0;
+    };
+
+    std::unique_ptr< rocksdb::Iterator > rest( m_db->NewIterator( _options, m_defaultFamily ) );
+    if ( rest == nullptr ) {
+        BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
+    }
+
+    // prefixed keys go after an empty key and before all keys of the default family
+    rest->Seek( _begin );
+    if ( rest->Valid() && rest->key().empty() ) {
+        if ( beyondEnd( rest->key() ) || !_f( rest->key(), rest->value() ) )
+            return;
+        rest->Next();
+    }
+
+    std::string key;
+    for ( size_t prefix = 0; prefix < m_prefixFamilies.size(); ++prefix ) {
+        char const prefixByte = static_cast< char >( prefix );
+        if ( beyondEnd( rocksdb::Slice( &prefixByte, 1 ) ) )
+            return;
+        if ( !_begin.empty() && static_cast< unsigned char >( _begin[0] ) > prefix )
+            continue;
+
+        std::unique_ptr< rocksdb::Iterator > it(
+            m_db->NewIterator( _options, m_prefixFamilies[prefix] ) );
+        if ( it == nullptr ) {
+            BOOST_THROW_EXCEPTION( DatabaseError() << errinfo_comment( "null iterator" ) );
+        }
+        if ( !_begin.empty() && static_cast< unsigned char >( _begin[0] ) == prefix )
+            it->Seek( rocksdb::Slice( _begin.data() + 1, _begin.size() - 1 ) );
+        else
+            it->SeekToFirst();
+        for ( ; it->Valid(); it->Next() ) {
+            key.assign( 1, prefixByte );
+            key.append( it->key().data(), it->key().size() );
+            if ( beyondEnd( key ) || !_f( key, it->value() ) )
+                return;
+        }
+        checkStatus( it->status() );
+    }
+
+    for ( ; rest->Valid(); rest->Next() ) {
+        if ( beyondEnd( rest->key() ) || !_f( rest->key(), rest->value() ) )
+            return;
+    }
+    checkStatus( rest->status() );
+}
+
+void RocksDB::forEach( std::function< bool( Slice, Slice ) > f ) const {
+    cwarn << "Iterating over the entire RocksDB database: " << this->m_path;
+    forEachEntry( m_readOptions, rocksdb::Slice(), rocksdb::Slice(),
+        [&f]( rocksdb::Slice _key, rocksdb::Slice _value ) {
+            return f( Slice( _key.data(), _key.size() ), Slice( _value.data(), _value.size() ) );
+        } );
+}
+
+void RocksDB::forEachInRange(
+    Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const {
+    forEachEntry( m_readOptions, rocksdb::Slice( _begin.data(), _begin.size() ),
+        rocksdb::Slice( _end.data(), _end.size() ),
+        [&f]( rocksdb::Slice _key, rocksdb::Slice _value ) {
+            if ( _key == rocksdb::Slice( LevelDB::c_incrementalHashKey ) )
+                return true;
+            return f( Slice( _key.data(), _key.size() ), Slice( _value.data(), _value.size() ) );
+        } );
+}
+
+h256 RocksDB::hashBase() const {
+    secp256k1_sha256_t ctx;
+    secp256k1_sha256_initialize( &ctx );
+    forEachEntry( scanReadOptions( m_readOptions ), rocksdb::Slice(), rocksdb::Slice(),
+        [&ctx]( rocksdb::Slice _key, rocksdb::Slice _value ) {
+            // same entries as in LevelDB::hashBase()
+            if ( _key == rocksdb::Slice( "pieceUsageBytes" ) ||
+                 _key == rocksdb::Slice( LevelDB::c_incrementalHashKey ) )
+                return true;
+            secp256k1_sha256_write(
+                &ctx, reinterpret_cast< unsigned char const* >( _key.data() ), _key.size() );
+            secp256k1_sha256_write(
+                &ctx, reinterpret_cast< unsigned char const* >( _value.data() ), _value.size() );
+            return true;
+        } );
+    h256 hash;
+    secp256k1_sha256_finalize( &ctx, hash.data() );
+    return hash;
+}
+
+h256 RocksDB::hashBaseWithPrefix( char _prefix ) const {
+    std::string const end = prefixUpperBound( Slice( &_prefix, 1 ) );
+    secp256k1_sha256_t ctx;
+    secp256k1_sha256_initialize( &ctx );
+    forEachEntry( scanReadOptions( m_readOptions ), rocksdb::Slice( &_prefix, 1 ), end,
+        [&ctx]( rocksdb::Slice _key, rocksdb::Slice _value ) {
+            if ( _key == rocksdb::Slice( LevelDB::c_incrementalHashKey ) )
+                return true;
+            secp256k1_sha256_write(
+                &ctx, reinterpret_cast< unsigned char const* >( _key.data() ), _key.size() );
+            secp256k1_sha256_write(
+                &ctx, reinterpret_cast< unsigned char const* >( _value.data() ), _value.size() );
+            return true;
+        } );
+    h256 hash;
+    secp256k1_sha256_finalize( &ctx, hash.data() );
+    return hash;
+}
+
+std::string RocksDB::property( std::string const& _name ) const {
+    std::string value;
+    if ( !m_db->GetProperty( _name, &value ) )
+        return std::string();
+    return value;
+}
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file RocksDB.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "LevelDB.h"
+#include "db.h"
+
+#include <rocksdb/db.h>
+#include <rocksdb/options.h>
+#include <boost/filesystem.hpp>
+
+#include <functional>
+#include <vector>
+
+namespace dev {
+namespace db {
+
+/// Storage backend on RocksDB, tuned per database kind by c_leveldbTuning and
+/// c_leveldbBlockCacheSize like LevelDB.
+///
+/// Keys whose first byte is below the number of prefix families are stored without that byte
+/// in a column family of its own, so data of each batched_io::db_splitter interface is
+/// compacted separately. Other keys go to the default column family. hashBase() and
+/// hashBaseWithPrefix() hash the original keys and match LevelDB for the same content.
+class RocksDB : public DatabaseFace {
+public:
+    /// One-byte prefixes of the blocks DB (blocks and extras)
+    static constexpr unsigned c_blocksPrefixFamilies = 2;
+
+    static rocksdb::ReadOptions defaultReadOptions();
+    static rocksdb::WriteOptions defaultWriteOptions();
+    static rocksdb::Options defaultDBOptions( LevelDBKind _kind = LevelDBKind::Default );
+
+    /// Prefix families already present in the DB are always opened, even if more than
+    /// _prefixFamilies
+    explicit RocksDB( boost::filesystem::path const& _path,
+        LevelDBKind _kind = LevelDBKind::Default, unsigned _prefixFamilies = 0 );
+    ~RocksDB() override;
+
+    std::string lookup( Slice _key ) const override;
+    bool exists( Slice _key ) const override;
+    void insert( Slice _key, Slice _value ) override;
+    void kill( Slice _key ) override;
+
+    std::unique_ptr< WriteBatchFace > createWriteBatch() const override;
+    void commit( std::unique_ptr< WriteBatchFace > _batch ) override;
+
+    void forEach( std::function< bool( Slice, Slice ) > f ) const override;
+    void forEachInRange(
+        Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const override;
+
+    h256 hashBase() const override;
+    h256 hashBaseWithPrefix( char _prefix ) const;
+
+    /// Value of a RocksDB property such as "rocksdb.stats", empty if it is unknown
+    std::string property( std::string const& _name ) const;
+
+private:
+    friend class RocksDBWriteBatch;
+
+    struct Route {
+        rocksdb::ColumnFamilyHandle* family;
+        rocksdb::Slice key;
+    };
+    Route route( Slice _key ) const;
+
+    /// Visits entries with original keys in [_begin, _end) in their order, an empty _end
+    /// meaning no upper bound
+    void forEachEntry( rocksdb::ReadOptions const& _options, rocksdb::Slice _begin,
+        rocksdb::Slice _end, std::function< bool( rocksdb::Slice, rocksdb::Slice ) > _f ) const;
+
+    std::unique_ptr< rocksdb::DB > m_db;
+    rocksdb::ReadOptions const m_readOptions;
+    rocksdb::WriteOptions const m_writeOptions;
+    boost::filesystem::path const m_path;
+
+    rocksdb::ColumnFamilyHandle* m_defaultFamily = nullptr;
+    /// Indexed by key prefix
+    std::vector< rocksdb::ColumnFamilyHandle* > m_prefixFamilies;
+};
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,172 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file ShardedLruCache.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "Guards.h"
+#include "LruCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace dev {
+
+/**
+ * @brief LruCache split into shards by key hash, each with its own lock and LRU order, so that
+ * concurrent users rarely wait for each other. Values are returned by copy, so they stay valid
+ * after eviction.
+ * @threadsafe
+ */
+template < class Key, class Value, class Hash = std::hash< Key > >
+class ShardedLruCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+    };
+
+    /// @param _capacity max number of entries of all shards, 0 disables the cache
+    explicit ShardedLruCache( size_t _capacity, unsigned _shards = 16 ) : m_capacity( _capacity ) {
+        if ( m_capacity == 0 )
+            return;
+        size_t shards = std::max< size_t >( std::min< size_t >( _shards, m_capacity ), 1 );
+        for ( size_t i = 0; i < shards; ++i )
+            m_shards.emplace_back( new Shard( ( m_capacity + shards - 1 ) / shards ) );
+    }
+
+    ShardedLruCache( ShardedLruCache const& ) = delete;
+    ShardedLruCache& operator=( ShardedLruCache const& ) = delete;
+
+    /// @returns copy of the value and marks it as most recently used, counted in stats
+    std::optional< Value > find( Key const& _key ) {
+        std::optional< Value > ret = peek( _key );
+        if ( ret )
+            ++m_hits;
+        else
+            ++m_misses;
+        return ret;
+    }
+
+    /// Same as find() but not counted in stats
+    std::optional< Value > peek( Key const& _key ) {
+        if ( m_shards.empty() )
+            return std::nullopt;
+        Shard& shard = shardOf( _key );
+        Guard l( shard.lock );
+        if ( Value const* value = shard.entries.find( _key ) )
+            return *value;
+        return std::nullopt;
+    }
+
+    /// Keeps the value of a cached key, like LruCache::insert(), but marks it as most recently
+    /// used. @returns true if _key was not cached before
+    bool insert( Key const& _key, Value const& _value ) {
+        if ( m_shards.empty() )
+            return false;
+        Shard& shard = shardOf( _key );
+        Guard l( shard.lock );
+        if ( shard.entries.touch( _key ) )
+            return false;
+        insert_WITH_LOCK( shard, _key, _value );
+        return true;
+    }
+
+    /// Inserts _value, replacing the value of a cached key
+    void replace( Key const& _key, Value const& _value ) {
+        if ( m_shards.empty() )
+            return;
+        Shard& shard = shardOf( _key );
+        Guard l( shard.lock );
+        shard.entries.remove( _key );
+        insert_WITH_LOCK( shard, _key, _value );
+    }
+
+    void remove( Key const& _key ) {
+        if ( m_shards.empty() )
+            return;
+        Shard& shard = shardOf( _key );
+        Guard l( shard.lock );
+        shard.entries.remove( _key );
+    }
+
+    bool contains( Key const& _key ) const {
+        if ( m_shards.empty() )
+            return false;
+        Shard& shard = shardOf( _key );
+        Guard l( shard.lock );
+        return shard.entries.contains( _key );
+    }
+
+    void clear() {
+        for ( auto& shard : m_shards ) {
+            Guard l( shard->lock );
+            shard->entries.clear();
+        }
+    }
+
+    Stats stats() const {
+        Stats ret;
+        ret.hits = m_hits;
+        ret.misses = m_misses;
+        ret.evictions = m_evictions;
+        for ( auto const& shard : m_shards ) {
+            Guard l( shard->lock );
+            ret.size += shard->entries.size();
+        }
+        return ret;
+    }
+
+    size_t capacity() const { return m_capacity; }
+    bool enabled() const { return !m_shards.empty(); }
+
+private:
+    struct Shard {
+        explicit Shard( size_t _capacity ) : entries( _capacity ) {}
+
+        LruCache< Key, Value, Hash > entries;
+        mutable Mutex lock;
+    };
+
+    Shard& shardOf( Key const& _key ) const { return *m_shards[Hash{}( _key ) % m_shards.size()]; }
+
+    void insert_WITH_LOCK( Shard& _shard, Key const& _key, Value const& _value ) {
+        if ( _shard.entries.size() == _shard.entries.capacity() )
+            ++m_evictions;
+        _shard.entries.insert( _key, _value );
+    }
+
+    size_t m_capacity;
+    std::vector< std::unique_ptr< Shard > > m_shards;
+
+    std::atomic< uint64_t > m_hits{ 0 };
+    std::atomic< uint64_t > m_misses{ 0 };
+    std::atomic< uint64_t > m_evictions{ 0 };
+};
+
+}  // namespace dev
@@ -1,5 +1,9 @@
 #include "SplitDB.h"
 
+#if SKALED_ROCKSDB
+#include "RocksDB.h"
+#endif
+
 #include <memory>
 
 namespace dev {
@@ -100,13 +104,28 @@ void SplitDB::PrefixedDB::forEach( std::function< bool( Slice, Slice ) > f ) con
     } );
 }
 
+void SplitDB::PrefixedDB::forEachInRange(
+    Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const {
+    std::string const begin = prefix + _begin.toString();
+    std::string const end =
+        _end.empty() ? prefixUpperBound( Slice( &prefix, 1 ) ) : prefix + _end.toString();
+    std::unique_lock< std::shared_mutex > lock( this->backend_mutex );
+    backend->forEachInRange( begin, end, [&]( Slice _key, Slice _val ) -> bool {
+        return f( Slice( _key.data() + 1, _key.size() - 1 ), _val );
+    } );
+}
+
 h256 SplitDB::PrefixedDB::hashBase() const {
     // HACK TODO implement that it would work with any DatabaseFace*
     const LevelDB* ldb = dynamic_cast< const LevelDB* >( backend.get() );
     if ( ldb )
         return ldb->hashBaseWithPrefix( prefix );
-    else
-        return h256();
+#if SKALED_ROCKSDB
+    const RocksDB* rdb = dynamic_cast< const RocksDB* >( backend.get() );
+    if ( rdb )
+        return rdb->hashBaseWithPrefix( prefix );
+#endif
+    return h256();
 }
 
 }  // namespace db
@@ -36,6 +36,8 @@ private:
         virtual void commit( std::unique_ptr< WriteBatchFace > _batch );
 
         virtual void forEach( std::function< bool( Slice, Slice ) > f ) const;
+        virtual void forEachInRange(
+            Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const;
         virtual h256 hashBase() const;
 
     private:
@@ -92,6 +94,11 @@ public:
         backend->forEach( f );
     }
 
+    void forEachInRange(
+        Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const override {
+        backend->forEachInRange( _begin, _end, f );
+    }
+
     h256 hashBase() const override { return backend->hashBase(); }
 
 private:
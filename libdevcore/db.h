@@ -26,11 +26,22 @@
 #include "Exceptions.h"
 #include "dbfwd.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 
 namespace dev {
 namespace db {
+/// Smallest key greater than every key starting with _prefix, empty if there is no such key
+inline std::string prefixUpperBound( Slice _prefix ) {
+    std::string bound( _prefix.begin(), _prefix.end() );
+    while ( !bound.empty() && static_cast< unsigned char >( bound.back() ) == 0xff )
+        bound.pop_back();
+    if ( !bound.empty() )
+        bound.back() = static_cast< char >( static_cast< unsigned char >( bound.back() ) + 1 );
+    return bound;
+}
+
 // WriteBatchFace implements database write batch for a specific concrete
 // database implementation.
 class WriteBatchFace {
@@ -66,6 +77,18 @@ public:
     // of each record in the database. If `f` returns false, the `forEach`
     // method must return immediately.
     virtual void forEach( std::function< bool( Slice, Slice ) > f ) const = 0;
+
+    // `forEachInRange` calls `f` like `forEach` but only for the records with
+    // keys in [_begin, _end), in key order. An empty `_end` means no upper bound.
+    // Implementations seek to `_begin` and stop at `_end` instead of scanning
+    // the whole database.
+    virtual void forEachInRange(
+        Slice _begin, Slice _end, std::function< bool( Slice, Slice ) > f ) const = 0;
+    void forEachWithPrefix( Slice _prefix, std::function< bool( Slice, Slice ) > f ) const {
+        std::string const end = prefixUpperBound( _prefix );
+        forEachInRange( _prefix, end, std::move( f ) );
+    }
+
     virtual h256 hashBase() const = 0;
 
     virtual bool discardCreatedBatches() { return false; }
@@ -32,7 +32,8 @@ using namespace dev;
 using namespace eth;
 
 PrecompiledContract::PrecompiledContract( unsigned _base, unsigned _word,
-    PrecompiledExecutor const& _exec, u256 const& _startingBlock, h160Set const& _allowedAddresses )
+    PrecompiledExecutor const& _exec, u256 const& _startingBlock, h160Set const& _allowedAddresses,
+    std::string const& _name )
     : PrecompiledContract(
           [=]( bytesConstRef _in, ChainOperationParams const&, u256 const& ) -> bigint {
               bigint s = _in.size();
@@ -40,7 +41,7 @@ PrecompiledContract::PrecompiledContract( unsigned _base, unsigned _word,
               bigint w = _word;
               return b + ( s + 31 ) / 32 * w;
           },
-          _exec, _startingBlock, _allowedAddresses ) {}
+          _exec, _startingBlock, _allowedAddresses, _name ) {}
 
 ChainOperationParams::ChainOperationParams()
     : m_blockReward( "0x4563918244F40000" ),
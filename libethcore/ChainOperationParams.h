@@ -39,13 +39,16 @@ class PrecompiledContract {
 public:
     PrecompiledContract() = default;
     PrecompiledContract( PrecompiledPricer const& _cost, PrecompiledExecutor const& _exec,
-        u256 const& _startingBlock = 0, h160Set const& _allowedAddresses = h160Set() )
+        u256 const& _startingBlock = 0, h160Set const& _allowedAddresses = h160Set(),
+        std::string const& _name = std::string() )
         : m_cost( _cost ),
           m_execute( _exec ),
           m_startingBlock( _startingBlock ),
-          m_allowed_addresses( _allowedAddresses ) {}
+          m_allowed_addresses( _allowedAddresses ),
+          m_name( _name ) {}
     PrecompiledContract( unsigned _base, unsigned _word, PrecompiledExecutor const& _exec,
-        u256 const& _startingBlock = 0, h160Set const& _allowedAddresses = h160Set() );
+        u256 const& _startingBlock = 0, h160Set const& _allowedAddresses = h160Set(),
+        std::string const& _name = std::string() );
 
     bigint cost( bytesConstRef _in, ChainOperationParams const& _chainParams,
         u256 const& _blockNumber ) const {
@@ -55,6 +58,9 @@ public:
 
     u256 const& startingBlock() const { return m_startingBlock; }
 
+    /// Name of the registered executor, empty if the contract was built from a bare function
+    std::string const& name() const { return m_name; }
+
     bool executionAllowedFrom( const Address& _from, bool _readOnly ) const {
         return m_allowed_addresses.empty() ||
                ( m_allowed_addresses.count( _from ) != 0 && !_readOnly );
@@ -65,6 +71,7 @@ private:
     PrecompiledExecutor m_execute;
     u256 m_startingBlock = 0;
     h160Set m_allowed_addresses;
+    std::string m_name;
 };
 
 static constexpr int64_t c_infiniteBlockNumber = std::numeric_limits< int64_t >::max();
@@ -173,6 +180,7 @@ public:
     time_t contractStoragePatchTimestamp = 0;
     time_t contractStorageZeroValuePatchTimestamp = 0;
     time_t verifyDaSigsPatchTimestamp = 0;
+    time_t incrementalSnapshotHashPatchTimestamp = 0;
 
     SChain() {
         name = "TestChain";
@@ -84,7 +84,7 @@ PrecompiledContract createPrecompiledContract( js::mObject const& _precompiled )
 
         if ( !_precompiled.count( "linear" ) )
             return PrecompiledContract( PrecompiledRegistrar::pricer( n ),
-                PrecompiledRegistrar::executor( n ), startingBlock );
+                PrecompiledRegistrar::executor( n ), startingBlock, h160Set(), n );
 
         auto const& l = _precompiled.at( "linear" ).get_obj();
         unsigned base = toUnsigned( l.at( "base" ) );
@@ -112,7 +112,7 @@ PrecompiledContract createPrecompiledContract( js::mObject const& _precompiled )
         }  // restrictAccessIt
 
         return PrecompiledContract(
-            base, word, PrecompiledRegistrar::executor( n ), startingBlock, allowedAddresses );
+            base, word, PrecompiledRegistrar::executor( n ), startingBlock, allowedAddresses, n );
     } catch ( PricerNotFound const& ) {
         cwarn << "Couldn't create a precompiled contract account. Missing a pricer called:" << n;
         throw;
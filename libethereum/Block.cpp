@@ -42,6 +42,7 @@
 #include <libdevcore/microprofile.h>
 
 #include <skutils/console_colors.h>
+#include <skutils/thread_pool.h>
 
 using namespace std;
 using namespace dev;
@@ -56,6 +57,8 @@ using skale::State;
 
 static const unsigned c_maxSyncTransactions = 1024;
 
+unsigned dev::eth::c_parallelExecutionThreads = 0;
+
 namespace {
 class DummyLastBlockHashes : public eth::LastBlockHashesFace {
 public:
@@ -63,6 +66,29 @@ public:
     void clear() override {}
 };
 
+skutils::thread_pool& speculationPool() {
+    static skutils::thread_pool pool( c_parallelExecutionThreads );
+    return pool;
+}
+
+/// Drops changes staged in block-scoped mode if the block throws before commitBlock(), so that
+/// neither they nor the mode leak into the next block through copies of the state
+class BlockScopedCommitGuard {
+public:
+    explicit BlockScopedCommitGuard( skale::State& _state ) : m_state( _state ) {}
+    ~BlockScopedCommitGuard() {
+        try {
+            m_state.abortBlockScopedCommit();
+        } catch ( ... ) {
+            cerror << "Failed to drop changes of unfinished block: "
+                   << boost::current_exception_diagnostic_information();
+        }
+    }
+
+private:
+    skale::State& m_state;
+};
+
 }  // namespace
 
 Block::Block( BlockChain const& _bc, boost::filesystem::path const& _dbPath,
@@ -447,6 +473,12 @@ tuple< TransactionReceipts, unsigned > Block::syncEveryone(
     this->resetCurrent( _timestamp );
 
     m_state = m_state.createStateModifyCopyAndPassLock();  // mainly for debugging
+    BlockScopedCommitGuard blockScopedCommitGuard( m_state );
+    if ( skale::c_blockScopedStateCommit )
+        m_state.startBlockScopedCommit();
+    // unless transactions are staged for the whole block, each one is committed, so the parent
+    // block must be on disk before the first commit; it is written during speculation meanwhile
+    bool parentPersisted = skale::c_blockScopedStateCommit;
     TransactionReceipts saved_receipts = this->m_state.safePartialTransactionReceipts();
     if ( vecMissing ) {
         assert( saved_receipts.size() == _transactions.size() - vecMissing->size() );
@@ -455,6 +487,20 @@ tuple< TransactionReceipts, unsigned > Block::syncEveryone(
         m_state.clearPartialTransactionReceipts();
 
 
+    // Optimistic parallel execution: every transaction is first executed against the block start
+    // state, then results are committed in block order. A result is used only if none of the
+    // accounts it has read were written by earlier transactions of this block, otherwise the
+    // transaction is executed again serially. Author receives fees from every transaction,
+    // so it counts as written from the beginning.
+    std::vector< skale::SpeculativeExecution > speculative;
+    auto written = std::make_shared< std::unordered_set< Address > >();
+    if ( c_parallelExecutionThreads > 0 && !vecMissing && _transactions.size() > 1 ) {
+        speculative = speculate( _bc.lastBlockHashes(), _transactions, _gasPrice );
+        written->insert( info().author() );
+        m_state.setWriteLog( written );
+    }
+    unsigned count_speculative = 0;
+
     unsigned count_bad = 0;
     for ( unsigned i = 0; i < _transactions.size(); ++i ) {
         Transaction const& tr = _transactions[i];
@@ -502,8 +548,17 @@ tuple< TransactionReceipts, unsigned > Block::syncEveryone(
                 continue;
             }
 
-            ExecutionResult res =
-                execute( _bc.lastBlockHashes(), tr, Permanence::Committed, OnOpFunc() );
+            if ( !parentPersisted ) {
+                _bc.waitForPersistence();
+                parentPersisted = true;
+            }
+
+            ExecutionResult res;
+            if ( i < speculative.size() && canApplySpeculation( speculative[i], tr, *written ) ) {
+                res = applySpeculation( _bc.lastBlockHashes(), tr, speculative[i] );
+                ++count_speculative;
+            } else
+                res = execute( _bc.lastBlockHashes(), tr, Permanence::Committed, OnOpFunc() );
             receipts.push_back( m_receipts.back() );
 
             if ( res.excepted == TransactionException::WouldNotBeInBlock )
@@ -529,6 +584,17 @@ tuple< TransactionReceipts, unsigned > Block::syncEveryone(
         }
     }
 
+    if ( !speculative.empty() ) {
+        m_state.setWriteLog( nullptr );
+        LOG( m_loggerDetailed ) << "Speculative execution results used for " << count_speculative
+                                << " of " << _transactions.size() << " transactions";
+    }
+
+    // single write for the whole block if transactions were only staged; the parent block is
+    // written meanwhile and must reach the disk first
+    _bc.waitForPersistence();
+    m_state.commitBlock();
+
 #ifdef HISTORIC_STATE
     m_state.mutableHistoricState().saveRootForBlock( m_currentBlock.number() );
 #endif
@@ -873,6 +939,79 @@ ExecutionResult Block::execute(
     return resultReceipt.first;
 }
 
+std::vector< skale::SpeculativeExecution > Block::speculate( LastBlockHashesFace const& _lh,
+    Transactions const& _transactions, u256 const& _gasPrice ) const {
+    MICROPROFILE_SCOPEI( "Block", "speculate", MP_CORNFLOWERBLUE );
+
+    std::vector< skale::SpeculativeExecution > speculative( _transactions.size() );
+
+    // block gas limit is checked on commit
+    EnvInfo const envInfo( info(), _lh, 0, m_sealEngine->chainParams().chainID );
+
+    std::vector< std::future< void > > futures;
+    futures.reserve( _transactions.size() );
+    for ( size_t i = 0; i < _transactions.size(); ++i ) {
+        Transaction const& tr = _transactions[i];
+        if ( tr.isInvalid() || ( !tr.hasExternalGas() && tr.gasPrice() < _gasPrice ) )
+            continue;
+
+        futures.push_back( speculationPool().submit( [this, &envInfo, &tr, &speculative, i]() {
+            try {
+                State state = m_state.createStateReadOnlyCopy();
+                speculative[i] = state.executeSpeculatively( envInfo, *m_sealEngine, tr );
+            } catch ( ... ) {
+                // leave it for serial execution
+            }
+        } ) );
+    }
+
+    // read-only copies are gone after this point, so commits can take the exclusive lock
+    for ( auto& future : futures )
+        future.wait();
+
+    return speculative;
+}
+
+bool Block::canApplySpeculation( skale::SpeculativeExecution const& _spec, Transaction const& _t,
+    std::unordered_set< Address > const& _written ) const {
+    if ( !_spec.reusable )
+        return false;
+
+    if ( gasUsed() + static_cast< bigint >( _t.gas() ) > info().gasLimit() )
+        return false;
+
+    if ( !m_state.storageLimitAllows( _spec ) )
+        return false;
+
+    for ( Address const& address : _spec.readSet )
+        if ( _written.count( address ) )
+            return false;
+
+    return true;
+}
+
+ExecutionResult Block::applySpeculation( LastBlockHashesFace const& _lh, Transaction const& _t,
+    skale::SpeculativeExecution const& _spec ) {
+    MICROPROFILE_SCOPEI( "Block", "apply speculation", MP_CORNFLOWERBLUE );
+    if ( isSealed() )
+        BOOST_THROW_EXCEPTION( InvalidOperationOnSealedBlock() );
+
+    uncommitToSeal();
+
+    State stateSnapshot = m_state.createStateModifyCopyAndPassLock();
+
+    EnvInfo envInfo = EnvInfo( info(), _lh, gasUsed(), m_sealEngine->chainParams().chainID );
+    std::pair< ExecutionResult, TransactionReceipt > resultReceipt =
+        stateSnapshot.applySpeculativeExecution( envInfo, *m_sealEngine, _t, _spec );
+
+    m_transactions.push_back( _t );
+    m_receipts.push_back( resultReceipt.second );
+    m_transactionSet.insert( _t.sha3() );
+    m_state = stateSnapshot.createStateModifyCopyAndPassLock();
+
+    return resultReceipt.first;
+}
+
 void Block::applyRewards(
     vector< BlockHeader > const& _uncleBlockHeaders, u256 const& _blockReward ) {
     u256 r = _blockReward;
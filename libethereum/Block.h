@@ -25,6 +25,7 @@
 
 #include <array>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <libdevcore/Common.h>
 #include <libdevcore/OverlayDB.h>
@@ -64,6 +65,10 @@ struct PopulationStatistics {
     double enact;
 };
 
+/// Node-local setting: number of threads executing block transactions speculatively
+/// in syncEveryone(), 0 means serial execution only
+extern unsigned c_parallelExecutionThreads;
+
 DEV_SIMPLE_EXCEPTION( ChainOperationWithUnknownBlockChain );
 DEV_SIMPLE_EXCEPTION( InvalidOperationOnSealedBlock );
 
@@ -303,6 +308,20 @@ private:
     /// Undo the changes to the state for committing to mine.
     void uncommitToSeal();
 
+    /// Execute @a _transactions in parallel against the current state without committing.
+    /// Entries for transactions that would be skipped by syncEveryone() are left not reusable.
+    std::vector< skale::SpeculativeExecution > speculate( LastBlockHashesFace const& _lh,
+        Transactions const& _transactions, u256 const& _gasPrice ) const;
+
+    /// @returns true if @a _spec gives the same result as executing @a _t now,
+    /// i.e. nothing it has read is in @a _written and block limits still hold.
+    bool canApplySpeculation( skale::SpeculativeExecution const& _spec, Transaction const& _t,
+        std::unordered_set< Address > const& _written ) const;
+
+    /// Same as execute() with Permanence::Committed, but takes the result from @a _spec
+    ExecutionResult applySpeculation( LastBlockHashesFace const& _lh, Transaction const& _t,
+        skale::SpeculativeExecution const& _spec );
+
     /// Execute the given block, assuming it corresponds to m_currentBlock.
     /// Throws on failure.
     u256 enact( VerifiedBlockRef const& _block, BlockChain const& _bc );
@@ -35,6 +35,7 @@
 // #include <libdevcore/DBImpl.h>
 #include <libdevcore/ManuallyRotatingLevelDB.h>
 
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/FileSystem.h>
 #include <libdevcore/FixedHash.h>
 #include <libdevcore/RLP.h>
@@ -172,6 +173,8 @@ unsigned c_maxCacheSize = 1024 * 1024 * 64;
 /// Min size, below which we don't bother flushing it.
 unsigned c_minCacheSize = 1024 * 1024 * 32;
 
+bool dev::eth::c_pipelinedBlockImport = false;
+
 string BlockChain::getChainDirName( const ChainParams& _cp ) {
     return toHex( BlockHeader( _cp.genesisBlock() ).hash().ref().cropped( 0, 4 ) );
 }
@@ -219,21 +222,27 @@ void BlockChain::open( fs::path const& _path, bool _applyPatches, WithExisting _
     fs::path chainPath = path / getChainDirName( m_params );
     fs::path extrasPath = chainPath / fs::path( toString( c_databaseVersion ) );
 
+    // before anything is created in chainPath, so that existing data is recognized
+    db::checkDatabaseKind( chainPath );
+
     fs::create_directories( extrasPath );
     DEV_IGNORE_EXCEPTIONS( fs::permissions( extrasPath, fs::owner_all ) );
 
     if ( _we == WithExisting::Kill ) {
         cnote << "Killing blockchain & extras database (WithExisting::Kill).";
         fs::remove_all( chainPath / fs::path( "blocks_and_extras" ) );
+        fs::remove_all( chainPath / fs::path( "log_index" ) );
     }
 
     try {
         fs::create_directories( chainPath / fs::path( "blocks_and_extras" ) );
+        // hashed into snapshots
         auto rotator = std::make_shared< batched_io::rotating_db_io >(
-            chainPath / fs::path( "blocks_and_extras" ), 5, chainParams().nodeInfo.archiveMode );
+            chainPath / fs::path( "blocks_and_extras" ), 5, chainParams().nodeInfo.archiveMode,
+            db::IncrementalHash::Owned );
         m_rotating_db = std::make_shared< db::ManuallyRotatingLevelDB >( rotator );
         auto db = std::make_shared< batched_io::batched_db >();
-        db->open( m_rotating_db );
+        db->open( m_rotating_db, c_pipelinedBlockImport );
         m_db = db;
         m_db_splitter = std::make_unique< batched_io::db_splitter >( m_db );
         m_blocksDB = m_db_splitter->new_interface();
@@ -303,12 +312,34 @@ void BlockChain::open( fs::path const& _path, bool _applyPatches, WithExisting _
     cdebug << cc::info( "Opened blockchain DB. Latest: " ) << currentHash() << ' '
            << m_lastBlockNumber;
 
+    if ( c_logIndex )
+        openLogIndex( chainPath / fs::path( "log_index" ) );
+
     //    dump_blocks_and_extras_db( *this, 0 );
 
     if ( _applyPatches && TotalStorageUsedPatch::isInitOnChainNeeded( *m_db ) )
         TotalStorageUsedPatch::initOnChain( *this );
 }
 
+void BlockChain::openLogIndex( fs::path const& _path ) {
+    fs::create_directories( _path );
+    m_logIndex = std::make_unique< LogIndex >(
+        _path, m_rotating_db->piecesCount(), chainParams().nodeInfo.archiveMode );
+
+    auto indexed = m_logIndex->blocks();
+    // do not index the existing chain, only blocks imported from now on
+    if ( !indexed ) {
+        m_logIndex->startAfter( m_lastBlockNumber );
+        return;
+    }
+
+    // blocks imported before a crash or a restart without the index
+    for ( unsigned n = indexed->second + 1; n <= m_lastBlockNumber; ++n )
+        m_logIndex->insertBlock( n, receipts( numberHash( n ) ).receipts );
+    cdebug << cc::info( "Opened log index. Blocks: " ) << indexed->first << '-'
+           << m_lastBlockNumber;
+}
+
 void BlockChain::reopen( ChainParams const& _p, bool _applyPatches, WithExisting _we ) {
     close();
     init( _p );
@@ -323,6 +354,7 @@ void BlockChain::close() {
     m_db_splitter.reset();
     m_db.reset();
     m_rotating_db.reset();
+    m_logIndex.reset();
 
     DEV_WRITE_GUARDED( x_lastBlockHash ) {
         m_lastBlockHash = m_genesisHash;
@@ -493,6 +525,7 @@ ImportRoute BlockChain::import( VerifiedBlockRef const& _block, State& _state, b
     try {
         // Check transactions are valid and that they result in a state equivalent to our
         // state_root. Get total difficulty increase and update state, checking it.
+        waitForPersistence();
         Block s( *this, m_lastBlockHash, _state );
         auto tdIncrease = s.enactOn( _block, *this );
 
@@ -575,6 +608,18 @@ ImportRoute BlockChain::import( const Block& _block ) {
         _block.info().difficulty(), performanceLogger );
 }
 
+void BlockChain::waitForPersistence() const {
+    try {
+        m_db->wait_committed();
+    } catch ( boost::exception const& ex ) {
+        cwarn << "Error writing to blocks_and_extras database: "
+              << boost::diagnostic_information( ex );
+        cwarn << "Fail writing to blocks_and_extras database. Bombing out.";
+        cerror << DETAILED_ERROR;
+        exit( -1 );
+    }
+}
+
 void BlockChain::checkBlockIsNew( VerifiedBlockRef const& _block ) const {
     if ( isKnown( _block.info.hash() ) ) {
         LOG( m_logger ) << _block.info.hash() << " : Not new.";
@@ -626,6 +671,8 @@ bool BlockChain::rotateDBIfNeeded( uint64_t pieceUsageBytes ) {
     clearCaches();
     m_db->revert();  // cancel pending changes
     m_rotating_db->rotate();
+    if ( m_logIndex )
+        m_logIndex->rotate();
 
     // re-insert genesis
     auto r = details.rlp();
@@ -957,7 +1004,8 @@ ImportRoute BlockChain::insertBlockAndExtras( VerifiedBlockRef const& _block,
             m_db->insert( db::Slice( "\x1"
                                      "best" ),
                 db::Slice( ( char const* ) &m_lastBlockHash, 32 ) );
-            m_db->commit( "insertBlockAndExtras" );
+            // written in background with c_pipelinedBlockImport, readable at once
+            m_db->commit_async( "insertBlockAndExtras" );
         } catch ( boost::exception const& ex ) {
             cwarn << "Error writing to blocks_and_extras database: "
                   << boost::diagnostic_information( ex );
@@ -969,6 +1017,18 @@ ImportRoute BlockChain::insertBlockAndExtras( VerifiedBlockRef const& _block,
         }
     }
 
+    if ( m_logIndex ) {
+        try {
+            TransactionReceipts blockReceipts;
+            for ( auto r : RLP( _receipts ) )
+                blockReceipts.emplace_back( r.data() );
+            m_logIndex->insertBlock( ( unsigned ) _block.info.number(), blockReceipts );
+        } catch ( std::exception const& ex ) {
+            // will be indexed again on restart
+            cwarn << "Error writing to log index: " << ex.what();
+        }
+    }
+
 #if ETH_PARANOIA
     checkConsistency();
 #endif  // ETH_PARANOIA
@@ -48,6 +48,7 @@
 #include "BlockQueue.h"
 #include "ChainParams.h"
 #include "LastBlockHashesFace.h"
+#include "LogIndex.h"
 #include "Transaction.h"
 #include "VerifiedBlock.h"
 
@@ -77,6 +78,9 @@ class ManuallyRotatingLevelDB;
 namespace eth {
 static const h256s NullH256s;
 
+/// Write blocks and extras in background while the next block executes
+extern bool c_pipelinedBlockImport;
+
 class Block;
 class ImportPerformanceLogger;
 
@@ -451,6 +455,14 @@ public:
     /// snapshot import.
     unsigned chainStartBlockNumber() const;
 
+    /// Waits until imported blocks are written to disk. State of a block must not be committed
+    /// before its parent is written, so that restart can continue from the last executed
+    /// transaction.
+    void waitForPersistence() const;
+
+    /// @returns index of logs by address and topic, nullptr if c_logIndex is off
+    LogIndex const* logIndex() const { return m_logIndex.get(); }
+
     uint64_t pieceUsageBytes() const {
         if ( this->m_db->exists( ( db::Slice ) "pieceUsageBytes" ) ) {
             return std::stoull( this->m_db->lookup( ( db::Slice ) "pieceUsageBytes" ) );
@@ -476,6 +488,9 @@ public:
 private:
     bool rotateDBIfNeeded( uint64_t pieceUsageBytes );
 
+    /// Open m_logIndex and index blocks imported since it was last written
+    void openLogIndex( boost::filesystem::path const& _path );
+
     // auxiliary method for insertBlockAndExtras
     size_t prepareDbDataAndReturnSize( VerifiedBlockRef const& _block, bytesConstRef _receipts,
         u256 const& _totalDifficulty, const LogBloom* pLogBloomFull,
@@ -595,6 +610,7 @@ private:
     std::unique_ptr< batched_io::db_splitter > m_db_splitter;      // new_interface()
     batched_io::db_operations_face* m_blocksDB;                    // working horse 1!
     batched_io::db_operations_face* m_extrasDB;                    // working horse 2!
+    std::unique_ptr< LogIndex > m_logIndex;                        // rotated with m_rotating_db
                                                  // assigned here later in Client::init()
 private:
     /// Hash of the last (valid) block on the longest chain.
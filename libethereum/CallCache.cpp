@@ -0,0 +1,176 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file CallCache.cpp
+ * @date 2026
+ */
+
+#include "CallCache.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+size_t dev::eth::c_callCacheSize = 1024;
+
+CallCache::CallCache( size_t _capacity )
+    : m_capacity( _capacity ), m_entries( max< size_t >( _capacity, 1 ) ) {}
+
+ExecutionResult CallCache::get( h256 const& _key, bool _latest, Execute const& _execute ) {
+    if ( m_capacity == 0 )
+        return _execute( nullptr );
+
+    shared_ptr< promise< ExecutionResult > > result;
+    shared_future< ExecutionResult > waitFor;
+    uint64_t generation;
+    {
+        Guard l( x_cache );
+        if ( Entry const* entry = m_entries.find( _key ) ) {
+            ++m_stats.hits;
+            return entry->result;
+        }
+
+        auto it = m_inFlight.find( _key );
+        // a call started before the last commit may see the previous state
+        if ( it != m_inFlight.end() && it->second.generation == m_generation ) {
+            ++m_stats.coalesced;
+            waitFor = it->second.result;
+        } else {
+            ++m_stats.misses;
+            result = make_shared< promise< ExecutionResult > >();
+            m_inFlight[_key] = { m_generation, result->get_future().share() };
+        }
+        generation = m_generation;
+    }
+    if ( !result )
+        return waitFor.get();
+
+    Entry entry;
+    if ( _latest )
+        entry.readLog = make_shared< skale::StateAccessLog >();
+    try {
+        entry.result = _execute( entry.readLog );
+    } catch ( ... ) {
+        {
+            Guard l( x_cache );
+            auto it = m_inFlight.find( _key );
+            if ( it != m_inFlight.end() && it->second.generation == generation )
+                m_inFlight.erase( it );
+        }
+        result->set_exception( current_exception() );
+        throw;
+    }
+
+    {
+        Guard l( x_cache );
+        auto it = m_inFlight.find( _key );
+        if ( it != m_inFlight.end() && it->second.generation == generation )
+            m_inFlight.erase( it );
+        // state has changed during execution, result might be out of date already
+        if ( !_latest || generation == m_generation )
+            insert_WITH_LOCK( _key, entry );
+    }
+    result->set_value( entry.result );
+    return entry.result;
+}
+
+void CallCache::noteCommitted( skale::StateAccessLog const& _written ) {
+    Guard l( x_cache );
+    ++m_generation;
+
+    vector< h256 > stale( m_external.begin(), m_external.end() );
+    for ( Address const& address : _written.accounts ) {
+        auto it = m_byAccount.find( address );
+        if ( it != m_byAccount.end() )
+            stale.insert( stale.end(), it->second.begin(), it->second.end() );
+    }
+    for ( auto const& slot : _written.storage ) {
+        auto it = m_byStorage.find( slot );
+        if ( it != m_byStorage.end() )
+            stale.insert( stale.end(), it->second.begin(), it->second.end() );
+    }
+
+    for ( h256 const& key : stale )
+        if ( m_entries.contains( key ) ) {
+            remove_WITH_LOCK( key );
+            ++m_stats.invalidations;
+        }
+}
+
+void CallCache::clear() {
+    Guard l( x_cache );
+    ++m_generation;
+    m_entries.clear();
+    m_byAccount.clear();
+    m_byStorage.clear();
+    m_external.clear();
+}
+
+CallCache::Stats CallCache::stats() const {
+    Guard l( x_cache );
+    Stats ret = m_stats;
+    ret.size = m_entries.size();
+    return ret;
+}
+
+void CallCache::insert_WITH_LOCK( h256 const& _key, Entry const& _entry ) {
+    if ( m_entries.contains( _key ) )
+        remove_WITH_LOCK( _key );
+    else if ( m_entries.size() == m_entries.capacity() ) {
+        h256 oldest = prev( m_entries.cend() )->first;
+        remove_WITH_LOCK( oldest );
+    }
+
+    m_entries.insert( _key, _entry );
+    if ( !_entry.readLog )
+        return;
+    if ( _entry.readLog->external )
+        m_external.insert( _key );
+    for ( Address const& address : _entry.readLog->accounts )
+        m_byAccount[address].insert( _key );
+    for ( auto const& slot : _entry.readLog->storage ) {
+        m_byAccount[slot.first].insert( _key );
+        m_byStorage[slot].insert( _key );
+    }
+}
+
+void CallCache::remove_WITH_LOCK( h256 const& _key ) {
+    Entry const* entry = m_entries.find( _key );
+    if ( !entry )
+        return;
+
+    if ( entry->readLog ) {
+        auto unindex = [&_key]( auto& _index, auto const& _indexKey ) {
+            auto it = _index.find( _indexKey );
+            if ( it == _index.end() )
+                return;
+            it->second.erase( _key );
+            if ( it->second.empty() )
+                _index.erase( it );
+        };
+        m_external.erase( _key );
+        for ( Address const& address : entry->readLog->accounts )
+            unindex( m_byAccount, address );
+        for ( auto const& slot : entry->readLog->storage ) {
+            unindex( m_byAccount, slot.first );
+            unindex( m_byStorage, slot );
+        }
+    }
+    m_entries.remove( _key );
+}
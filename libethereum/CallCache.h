@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file CallCache.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "Transaction.h"
+
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libskale/State.h>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dev {
+namespace eth {
+
+/// Max number of call results kept by a CallCache, 0 to disable it
+extern size_t c_callCacheSize;
+
+/**
+ * @brief Results of calls (eth_call) with the accounts and storage slots each of them has read.
+ * A result of a call on the latest state stays valid until a committed block changes something
+ * it has read, so it can be used for many blocks. Results on historic state are never
+ * invalidated. Identical calls made while the first of them is executing wait for its result
+ * instead of executing again.
+ * @threadsafe
+ */
+class CallCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t coalesced = 0;  ///< calls which waited for an identical call to finish
+        uint64_t invalidations = 0;
+        size_t size = 0;
+    };
+
+    /// Executes a call collecting what it reads into the log, if the log is not null
+    using Execute =
+        std::function< ExecutionResult( std::shared_ptr< skale::StateAccessLog > const& ) >;
+
+    explicit CallCache( size_t _capacity = c_callCacheSize );
+
+    /// @returns cached result of the call identified by _key or executes it with _execute.
+    /// _latest is true for calls on the latest state. Exceptions thrown by _execute are passed
+    /// to all callers waiting for the result and are not cached.
+    ExecutionResult get( h256 const& _key, bool _latest, Execute const& _execute );
+
+    /// Drops results which read anything from _written. Must be called for every commit to
+    /// the latest state before the committed block becomes visible to calls.
+    void noteCommitted( skale::StateAccessLog const& _written );
+
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        ExecutionResult result;
+        /// null for results on historic state
+        std::shared_ptr< skale::StateAccessLog > readLog;
+    };
+
+    struct InFlight {
+        uint64_t generation;
+        std::shared_future< ExecutionResult > result;
+    };
+
+    void insert_WITH_LOCK( h256 const& _key, Entry const& _entry );
+    void remove_WITH_LOCK( h256 const& _key );
+
+    size_t m_capacity;
+
+    mutable Mutex x_cache;
+    LruCache< h256, Entry > m_entries;
+    std::unordered_map< h256, InFlight > m_inFlight;
+    /// keys of results by accounts they have read, including reads of the account storage
+    std::unordered_map< Address, std::unordered_set< h256 > > m_byAccount;
+    std::map< std::pair< Address, u256 >, std::unordered_set< h256 > > m_byStorage;
+    /// keys of results which read something besides the state and are dropped on every commit
+    std::unordered_set< h256 > m_external;
+    /// incremented by noteCommitted(), results computed meanwhile are not cached
+    uint64_t m_generation = 0;
+
+    Stats m_stats;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -54,13 +54,17 @@ ChainParams::ChainParams() {
         genesisState[Address( i )] = Account( 0, 1 );
     // Setup default precompiled contracts as equal to genesis of Frontier.
     precompiled.insert( make_pair( Address( 1 ),
-        PrecompiledContract( 3000, 0, PrecompiledRegistrar::executor( "ecrecover" ) ) ) );
-    precompiled.insert( make_pair(
-        Address( 2 ), PrecompiledContract( 60, 12, PrecompiledRegistrar::executor( "sha256" ) ) ) );
+        PrecompiledContract( 3000, 0, PrecompiledRegistrar::executor( "ecrecover" ), 0,
+            h160Set(), "ecrecover" ) ) );
+    precompiled.insert( make_pair( Address( 2 ),
+        PrecompiledContract(
+            60, 12, PrecompiledRegistrar::executor( "sha256" ), 0, h160Set(), "sha256" ) ) );
     precompiled.insert( make_pair( Address( 3 ),
-        PrecompiledContract( 600, 120, PrecompiledRegistrar::executor( "ripemd160" ) ) ) );
+        PrecompiledContract( 600, 120, PrecompiledRegistrar::executor( "ripemd160" ), 0,
+            h160Set(), "ripemd160" ) ) );
     precompiled.insert( make_pair( Address( 4 ),
-        PrecompiledContract( 15, 3, PrecompiledRegistrar::executor( "identity" ) ) ) );
+        PrecompiledContract(
+            15, 3, PrecompiledRegistrar::executor( "identity" ), 0, h160Set(), "identity" ) ) );
 
     // fill empty stateRoot
     secp256k1_sha256_t ctx;
@@ -257,6 +261,11 @@ ChainParams ChainParams::loadConfig(
                 sChainObj.at( "verifyDaSigsPatchTimestamp" ).get_int64() :
                 0;
 
+        s.incrementalSnapshotHashPatchTimestamp =
+            sChainObj.count( "incrementalSnapshotHashPatchTimestamp" ) ?
+                sChainObj.at( "incrementalSnapshotHashPatchTimestamp" ).get_int64() :
+                0;
+
         if ( sChainObj.count( "nodeGroups" ) ) {
             std::vector< NodeGroup > nodeGroups;
             for ( const auto& nodeGroupConf : sChainObj["nodeGroups"].get_obj() ) {
@@ -574,6 +583,8 @@ const std::string& ChainParams::getOriginalJson() const {
     sChainObj["snpshotIntervalMs"] = sChain.snapshotIntervalSec;
     sChainObj["freeContractDeployment"] = sChain.freeContractDeployment;
     sChainObj["multiTransactionMode"] = sChain.multiTransactionMode;
+    sChainObj["incrementalSnapshotHashPatchTimestamp"] =
+        ( int64_t ) sChain.incrementalSnapshotHashPatchTimestamp;
     sChainObj["contractStorageLimit"] = ( int64_t ) sChain.contractStorageLimit;
     sChainObj["dbStorageLimit"] = sChain.dbStorageLimit;
 
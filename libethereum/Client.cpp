@@ -50,6 +50,7 @@
 
 #include <libskale/ContractStorageLimitPatch.h>
 #include <libskale/ContractStorageZeroValuePatch.h>
+#include <libskale/IncrementalSnapshotHashPatch.h>
 #include <libskale/RevertableFSPatch.h>
 #include <libskale/State.h>
 #include <libskale/TotalStorageUsedPatch.h>
@@ -69,6 +70,8 @@ using namespace skale::error;
 
 static_assert( BOOST_VERSION >= 106400, "Wrong boost headers version" );
 
+bool dev::eth::c_asyncFilterNotifications = false;
+
 namespace {
 std::string filtersToString( h256Hash const& _fs ) {
     std::stringstream str;
@@ -182,6 +185,8 @@ void Client::stopWorking() {
         }
     }
 
+    stopFilterNotifier();
+
     m_new_block_watch.uninstallAll();
     m_new_pending_transaction_watch.uninstallAll();
 
@@ -264,6 +269,12 @@ void Client::initStateFromDiskOrGenesis() {
         }
 #endif
     }
+
+#ifdef HISTORIC_STATE
+    m_historicStateView.reset( new HistoricStateView( chainParams().accountStartNonce,
+        m_state.mutableHistoricState().db(),
+        m_state.mutableHistoricState().blockToStateRootDB() ) );
+#endif
 }
 
 
@@ -318,6 +329,9 @@ void Client::init( WithExisting _forceAction, u256 _networkId ) {
     // HACK Needed to set env var for consensus
     AmsterdamFixPatch::isEnabled( *this );
 
+    if ( c_asyncFilterNotifications )
+        startFilterNotifier();
+
     doWork( false );
 }
 
@@ -439,42 +453,109 @@ void Client::appendFromNewPending(
     Guard l( x_filtersWatches );
     io_changed.insert( PendingChangedFilter );
     m_specialFilters.at( PendingChangedFilter ).push_back( _sha3 );
-    for ( pair< h256 const, InstalledFilter >& i : m_filters ) {
-        // acceptable number.
-        auto m = i.second.filter.matches( _receipt );
+    for ( h256 const& id : m_filterIndex.candidates( _receipt ) ) {
+        InstalledFilter& f = m_filters.at( id );
+        auto m = f.filter.matches( _receipt );
         if ( m.size() ) {
             // filter catches them
             for ( LogEntry const& l : m )
-                i.second.changes_.push_back( LocalisedLogEntry( l ) );
-            io_changed.insert( i.first );
+                f.changes_.push_back( LocalisedLogEntry( l ) );
+            io_changed.insert( id );
         }
     }
 }
 
 void Client::appendFromBlock( h256 const& _block, BlockPolarity _polarity, h256Hash& io_changed ) {
-    // TODO: more precise check on whether the txs match.
-    auto receipts = bc().receipts( _block ).receipts;
+    {
+        Guard l( x_filtersWatches );
+        io_changed.insert( ChainChangedFilter );
+        m_specialFilters.at( ChainChangedFilter ).push_back( _block );
+        // nobody needs the receipts
+        if ( m_filterIndex.empty() )
+            return;
+    }
+
+    BlockLogs logs;
+    logs.hash = _block;
+    logs.number = ( BlockNumber ) bc().number( _block );
+    logs.polarity = _polarity;
+    logs.receipts = bc().receipts( _block ).receipts;
+    logs.transactionHashes = bc().transactionHashes( _block );
+
+    if ( m_filterNotifier.joinable() ) {
+        std::lock_guard< std::mutex > l( x_filterNotifications );
+        m_filterNotifications.push_back( std::move( logs ) );
+        m_filterNotificationsChanged.notify_one();
+        return;
+    }
 
     Guard l( x_filtersWatches );
-    io_changed.insert( ChainChangedFilter );
-    m_specialFilters.at( ChainChangedFilter ).push_back( _block );
-    for ( pair< h256 const, InstalledFilter >& i : m_filters ) {
-        // acceptable number & looks like block may contain a matching log entry.
-        for ( size_t j = 0; j < receipts.size(); j++ ) {
-            auto tr = receipts[j];
-            auto m = i.second.filter.matches( tr );
+    appendFromBlockLogs_WITH_LOCK( logs, io_changed );
+}
+
+void Client::appendFromBlockLogs_WITH_LOCK( BlockLogs const& _logs, h256Hash& io_changed ) {
+    size_t count = std::min( _logs.receipts.size(), _logs.transactionHashes.size() );
+    for ( size_t j = 0; j < count; j++ ) {
+        TransactionReceipt const& tr = _logs.receipts[j];
+        // only filters watching some address or topic of this receipt
+        for ( h256 const& id : m_filterIndex.candidates( tr ) ) {
+            InstalledFilter& f = m_filters.at( id );
+            auto m = f.filter.matches( tr );
             if ( m.size() ) {
-                auto transactionHash = transaction( _block, j ).sha3();
                 // filter catches them
                 for ( LogEntry const& l : m )
-                    i.second.changes_.push_back( LocalisedLogEntry( l, _block,
-                        ( BlockNumber ) bc().number( _block ), transactionHash, j, 0, _polarity ) );
-                io_changed.insert( i.first );
+                    f.changes_.push_back( LocalisedLogEntry( l, _logs.hash, _logs.number,
+                        _logs.transactionHashes[j], j, 0, _logs.polarity ) );
+                io_changed.insert( id );
             }
         }
     }
 }
 
+void Client::startFilterNotifier() {
+    m_stopFilterNotifier = false;
+    m_filterNotifier = std::thread( [this]() { filterNotifierLoop(); } );
+}
+
+void Client::stopFilterNotifier() {
+    if ( !m_filterNotifier.joinable() )
+        return;
+    {
+        std::lock_guard< std::mutex > l( x_filterNotifications );
+        m_stopFilterNotifier = true;
+    }
+    m_filterNotificationsChanged.notify_all();
+    m_filterNotifier.join();
+}
+
+void Client::filterNotifierLoop() {
+    setThreadName( "filterNotifier" );
+    for ( ;; ) {
+        std::deque< BlockLogs > blocks;
+        {
+            std::unique_lock< std::mutex > l( x_filterNotifications );
+            m_filterNotificationsChanged.wait( l, [this]() {
+                return m_stopFilterNotifier || !m_filterNotifications.empty();
+            } );
+            if ( m_stopFilterNotifier )
+                return;
+            blocks.swap( m_filterNotifications );
+        }
+
+        // matching and delivery must not be separated by noteChanged() of the import thread,
+        // as it drops changes of all filters
+        try {
+            h256Hash changeds;
+            Guard l( x_filtersWatches );
+            for ( BlockLogs const& logs : blocks )
+                appendFromBlockLogs_WITH_LOCK( logs, changeds );
+            noteChanged_WITH_LOCK( changeds );
+        } catch ( std::exception const& ex ) {
+            cerror << "Filter notification failed: " << ex.what();
+        }
+    }
+}
+
 unsigned static const c_syncMin = 1;
 unsigned static const c_syncMax = 1000;
 double static const c_targetDuration = 1;
@@ -655,6 +736,7 @@ size_t Client::importTransactionsAsBlock(
                 m_debugTracer.tracepoint( "doing_snapshot" );
 
                 t1 = boost::chrono::high_resolution_clock::now();
+                bc().waitForPersistence();
                 m_snapshotManager->doSnapshot( block_number );
                 t2 = boost::chrono::high_resolution_clock::now();
                 this->snapshot_calculation_time_ms =
@@ -683,7 +765,11 @@ size_t Client::importTransactionsAsBlock(
                     boost::chrono::high_resolution_clock::time_point t2;
 
                     t1 = boost::chrono::high_resolution_clock::now();
-                    this->m_snapshotManager->computeSnapshotHash( latest_snapshots.second );
+                    bool incrementalHash = IncrementalSnapshotHashPatch::isEnabledWhen(
+                        chainParams(), m_snapshotManager->getBlockTimestamp(
+                                           latest_snapshots.second, chainParams() ) );
+                    this->m_snapshotManager->computeSnapshotHash(
+                        latest_snapshots.second, false, incrementalHash );
                     t2 = boost::chrono::high_resolution_clock::now();
                     this->snapshot_hash_calculation_time_ms =
                         boost::chrono::duration_cast< boost::chrono::milliseconds >( t2 - t1 )
@@ -749,8 +835,12 @@ size_t Client::syncTransactions(
         assert( !m_working.isSealed() );
 
         // assert(m_state.m_db_write_lock.has_value());
+        auto written = std::make_shared< skale::StateAccessLog >();
+        m_working.mutableState().setCommitLog( written );
         tie( newPendingReceipts, goodReceipts ) =
             m_working.syncEveryone( bc(), _transactions, _timestamp, _gasPrice, vecMissing );
+        m_working.mutableState().setCommitLog( nullptr );
+        m_callCache.noteCommitted( *written );
         m_state = m_state.createNewCopyWithLocks();
 #ifdef HISTORIC_STATE
         // make sure the trie in new state object points to the new state root
@@ -1057,6 +1147,10 @@ void Client::importWorkingBlock() {
 
 void Client::noteChanged( h256Hash const& _filters ) {
     Guard l( x_filtersWatches );
+    noteChanged_WITH_LOCK( _filters );
+}
+
+void Client::noteChanged_WITH_LOCK( h256Hash const& _filters ) {
     if ( _filters.size() )
         LOG( m_loggerWatch ) << cc::notice( "noteChanged: " ) << filtersToString( _filters );
     // accrue all changes left in each filter into the watches.
@@ -1313,6 +1407,70 @@ h256 Client::importTransaction( Transaction const& _t ) {
     return _t.sha3();
 }
 
+size_t Client::importTransactions( Transactions const& _transactions ) {
+    prepareForTransaction();
+
+    m_tq.recoverSenders( _transactions );
+
+    State state;
+    u256 gasBidPrice;
+
+    DEV_GUARDED( m_blockImportMutex ) {
+        state = this->state().createStateReadOnlyCopy();
+        gasBidPrice = this->gasBidPrice();
+    }
+    BlockHeader const header =
+        bc().number() ? this->blockInfo( bc().currentHash() ) : bc().genesis();
+
+    // the same checks as importTransaction(); in multi transaction mode a nonce is current
+    // if it follows the current ones in the queue or earlier ones of this batch
+    Transactions current;
+    Transactions future;
+    std::map< Address, u256 > nextCurrentNonce;
+    for ( Transaction const& t : _transactions ) {
+        try {
+            const_cast< Transaction& >( t ).checkOutExternalGas(
+                chainParams().externalGasDifficulty );
+            Executive::verifyTransaction( t, header, state, *bc().sealEngine(), 0, gasBidPrice,
+                chainParams().sChain.multiTransactionMode );
+        } catch ( std::exception const& ex ) {
+            LOG( m_loggerDetail ) << "Skipping invalid transaction " << t.sha3() << ": "
+                                  << ex.what();
+            continue;
+        }
+
+        if ( chainParams().sChain.multiTransactionMode ) {
+            auto it = nextCurrentNonce.find( t.sender() );
+            if ( it == nextCurrentNonce.end() )
+                it = nextCurrentNonce.emplace( t.sender(), m_tq.maxCurrentNonce( t.sender() ) )
+                         .first;
+            if ( state.getNonce( t.sender() ) < t.nonce() && it->second != t.nonce() ) {
+                future.push_back( t );
+                continue;
+            }
+            it->second = std::max( it->second, t.nonce() + 1 );
+        }
+        current.push_back( t );
+    }
+
+    size_t imported = 0;
+    auto noteImported = [&]( Transactions const& _imported,
+                            std::vector< ImportResult > const& _results ) {
+        for ( size_t i = 0; i < _imported.size(); ++i ) {
+            if ( _results[i] != ImportResult::Success ) {
+                LOG( m_loggerDetail ) << "Transaction " << _imported[i].sha3()
+                                      << " not imported: " << int( _results[i] );
+                continue;
+            }
+            m_new_pending_transaction_watch.invoke( _imported[i] );
+            ++imported;
+        }
+    };
+    noteImported( current, m_tq.importBatch( current ) );
+    noteImported( future, m_tq.importBatch( future, IfDropped::Ignore, true ) );
+    return imported;
+}
+
 // TODO: remove try/catch, allow exceptions
 
 
@@ -1322,11 +1480,40 @@ ExecutionResult Client::call( Address const& _from, u256 _value, Address _dest,
     BlockNumber _blockNumber,
 #endif
     FudgeFactor _ff ) {
+    bool latest = true;
+#ifdef HISTORIC_STATE
+    latest = _blockNumber >= bc().number();
+#endif
+    RLPStream key( 8 );
+    key << _from << _value << _dest << _data << _gas << _gasPrice << unsigned( _ff );
+#ifdef HISTORIC_STATE
+    key << ( latest ? LatestBlock : _blockNumber );
+#else
+    key << LatestBlock;
+#endif
+
+    return m_callCache.get( sha3( key.out() ), latest,
+        [&]( std::shared_ptr< skale::StateAccessLog > const& _readLog ) {
+            return executeCall( _from, _value, _dest, _data, _gas, _gasPrice,
+#ifdef HISTORIC_STATE
+                _blockNumber,
+#endif
+                _ff, _readLog );
+        } );
+}
+
+ExecutionResult Client::executeCall( Address const& _from, u256 _value, Address _dest,
+    bytes const& _data, u256 _gas, u256 _gasPrice,
+#ifdef HISTORIC_STATE
+    BlockNumber _blockNumber,
+#endif
+    FudgeFactor _ff, std::shared_ptr< skale::StateAccessLog > const& _readLog ) {
     ExecutionResult ret;
     try {
 #ifdef HISTORIC_STATE
-        Block historicBlock = blockByNumber( _blockNumber );
-        if ( _blockNumber < bc().number() ) {
+        // reads are recorded on the latest state only
+        if ( !_readLog && _blockNumber < bc().number() ) {
+            Block historicBlock = blockByNumber( _blockNumber );
             // historic state
             try {
                 u256 nonce = historicBlock.mutableState().mutableHistoricState().getNonce( _from );
@@ -1351,6 +1538,12 @@ ExecutionResult Client::call( Address const& _from, u256 _value, Address _dest,
 #endif
 
         Block temp = latestBlock();
+        if ( _readLog ) {
+            temp.mutableState().setReadLog( _readLog );
+            // address of a created contract depends on pending transactions
+            if ( !_dest )
+                _readLog->external = true;
+        }
 
         // TODO there can be race conditions between prev and next line!
         State readStateForLock = temp.mutableState().createStateReadOnlyCopy();
@@ -1538,27 +1731,29 @@ const dev::h256 Client::empty_str_hash =
 
 
 #ifdef HISTORIC_STATE
-u256 Client::historicStateBalanceAt( Address _a, BlockNumber _block ) const {
-    auto block = blockByNumber( _block );
-
-    auto aState = block.mutableState().mutableHistoricState();
+uint64_t Client::historicBlockNumber( BlockNumber _block ) const {
+    if ( _block == LatestBlock || _block == PendingBlock )
+        return bc().number();
+    return _block;
+}
 
-    return aState.balance( _a );
+u256 Client::historicStateBalanceAt( Address _a, BlockNumber _block ) const {
+    return m_historicStateView->balance( _a, historicBlockNumber( _block ) );
 }
 
 u256 Client::historicStateCountAt( Address _a, BlockNumber _block ) const {
-    return blockByNumber( _block ).mutableState().mutableHistoricState().getNonce( _a );
+    return m_historicStateView->getNonce( _a, historicBlockNumber( _block ) );
 }
 
 u256 Client::historicStateAt( Address _a, u256 _l, BlockNumber _block ) const {
-    return blockByNumber( _block ).mutableState().mutableHistoricState().storage( _a, _l );
+    return m_historicStateView->storage( _a, _l, historicBlockNumber( _block ) );
 }
 
 h256 Client::historicStateRootAt( Address _a, BlockNumber _block ) const {
-    return blockByNumber( _block ).mutableState().mutableHistoricState().storageRoot( _a );
+    return m_historicStateView->storageRoot( _a, historicBlockNumber( _block ) );
 }
 
 bytes Client::historicStateCodeAt( Address _a, BlockNumber _block ) const {
-    return blockByNumber( _block ).mutableState().mutableHistoricState().code( _a );
+    return m_historicStateView->code( _a, historicBlockNumber( _block ) );
 }
 #endif
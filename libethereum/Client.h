@@ -26,6 +26,7 @@
 #include <array>
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <list>
 #include <map>
@@ -48,6 +49,7 @@
 
 #include "Block.h"
 #include "BlockChain.h"
+#include "CallCache.h"
 #include "ClientBase.h"
 #include "CommonNet.h"
 #include "InstanceMonitor.h"
@@ -58,6 +60,10 @@
 #include <skutils/atomic_shared_ptr.h>
 #include <skutils/multithreading.h>
 
+#ifdef HISTORIC_STATE
+#include <libhistoric/HistoricStateView.h>
+#endif
+
 class ConsensusHost;
 
 namespace dev {
@@ -67,6 +73,9 @@ class DownloadMan;
 
 enum ClientWorkState { Active = 0, Deleting, Deleted };
 
+/// Match logs of imported blocks against installed filters in a separate thread
+extern bool c_asyncFilterNotifications;
+
 struct ActivityReport {
     unsigned ticks = 0;
     std::chrono::system_clock::time_point since = std::chrono::system_clock::now();
@@ -111,6 +120,11 @@ public:
     /// Imports the given transaction into the transaction queue
     h256 importTransaction( Transaction const& _t ) override;
 
+    /// Imports transactions received together, recovering their senders in parallel and
+    /// inserting them into the queue in one batch. Invalid transactions are logged and skipped
+    /// @returns number of transactions imported
+    size_t importTransactions( Transactions const& _transactions );
+
     /// Makes the given call. Nothing is recorded into the state.
     ExecutionResult call( Address const& _secret, u256 _value, Address _dest, bytes const& _data,
         u256 _gas, u256 _gasPrice,
@@ -263,6 +277,14 @@ public:
 
     std::shared_ptr< SkaleHost > skaleHost() const { return m_skaleHost; }
 
+    CallCache::Stats callCacheStats() const { return m_callCache.stats(); }
+
+#ifdef HISTORIC_STATE
+    HistoricTrieNodeCache::Stats historicTrieNodeCacheStats() const {
+        return m_historicStateView->trieNodeCacheStats();
+    }
+#endif
+
     // main entry point after consensus
     size_t importTransactionsAsBlock( const Transactions& _transactions, u256 _gasPrice,
         uint64_t _timestamp = ( uint64_t ) utcTime() );
@@ -276,6 +298,19 @@ public:
         return path;
     }
 
+    SnapshotManager::DiffJob createSnapshotFileAsync( unsigned _blockNumber ) {
+        if ( _blockNumber > this->getLatestSnapshotBlockNumer() )
+            throw std::invalid_argument( "Too new snapshot requested" );
+        SnapshotManager::DiffJob job = m_snapshotManager->makeOrGetDiffAsync( _blockNumber );
+        m_snapshotManager->leaveNLastDiffs( 2 );
+        return job;
+    }
+
+    // waits for the diff if it is still being made
+    void removeSnapshotFile( unsigned _blockNumber ) {
+        m_snapshotManager->removeDiff( _blockNumber );
+    }
+
     // set exiting time for node rotation
     void setSchainExitTime( uint64_t _timestamp ) const;
 
@@ -375,11 +410,30 @@ protected:
 
     /// Collate the changed filters for the hash of the given block.
     /// Insert any filters that are activated into @a o_changed.
+    /// Matching is done by the filter notification thread if it is running.
     void appendFromBlock( h256 const& _blockHash, BlockPolarity _polarity, h256Hash& io_changed );
 
+    /// Receipts of a block added to or removed from the chain
+    struct BlockLogs {
+        h256 hash;
+        BlockNumber number = 0;
+        BlockPolarity polarity = BlockPolarity::Unknown;
+        TransactionReceipts receipts;
+        TransactionHashes transactionHashes;
+    };
+
+    /// Collate the changed filters for the logs of the given block. Needs x_filtersWatches.
+    void appendFromBlockLogs_WITH_LOCK( BlockLogs const& _logs, h256Hash& io_changed );
+
     /// Record that the set of filters @a _filters have changed.
     /// This doesn't actually make any callbacks, but increments some counters in m_watches.
     void noteChanged( h256Hash const& _filters );
+    void noteChanged_WITH_LOCK( h256Hash const& _filters );
+
+    /// Start and stop the thread delivering block logs to watches
+    void startFilterNotifier();
+    void stopFilterNotifier();
+    void filterNotifierLoop();
 
     /// Submit
     virtual bool submitSealed( bytes const& _s );
@@ -465,6 +519,8 @@ protected:
     OverlayDB m_historicStateDB;  ///< Acts as the central point for the state database, so multiple
                                   ///< States can share it.
     OverlayDB m_historicBlockToStateRootDB;  /// Maps hashes of block IDs to state roots
+    std::unique_ptr< HistoricStateView > m_historicStateView;  ///< Serves historicState*At()
+                                                                ///< queries without a Block.
 #endif
 
     std::shared_ptr< GasPricer > m_gp;  ///< The gas pricer.
@@ -543,7 +599,24 @@ private:
     inline bool isTimeToDoSnapshot( uint64_t _timestamp ) const;
     void initHashes();
 
+    /// Executes call() without m_callCache, recording what it reads on the latest state into
+    /// _readLog if it is not null
+    ExecutionResult executeCall( Address const& _from, u256 _value, Address _dest,
+        bytes const& _data, u256 _gas, u256 _gasPrice,
+#ifdef HISTORIC_STATE
+        BlockNumber _blockNumber,
+#endif
+        FudgeFactor _ff, std::shared_ptr< skale::StateAccessLog > const& _readLog );
+
+    CallCache m_callCache;
+
     std::unique_ptr< std::thread > m_snapshotHashComputing;
+
+    std::thread m_filterNotifier;
+    std::deque< BlockLogs > m_filterNotifications;  ///< Blocks not yet matched against filters
+    std::mutex x_filterNotifications;
+    std::condition_variable m_filterNotificationsChanged;
+    bool m_stopFilterNotifier = false;
     // time of last physical snapshot
     int64_t last_snapshot_creation_time = 0;
     // usually this is snapshot before last!
@@ -648,6 +721,12 @@ public:
     u256 historicStateAt( Address _a, u256 _l, BlockNumber _block ) const override;
     h256 historicStateRootAt( Address _a, BlockNumber _block ) const override;
     bytes historicStateCodeAt( Address _a, BlockNumber _block ) const override;
+
+private:
+    /// Resolves LatestBlock and PendingBlock for the historic state queries
+    uint64_t historicBlockNumber( BlockNumber _block ) const;
+
+public:
 #endif
     void initStateFromDiskOrGenesis();
     void populateNewChainStateFromGenesis();
@@ -41,6 +41,8 @@ using skale::State;
 
 static const int64_t c_maxGasEstimate = 50000000;
 
+size_t dev::eth::c_maxLogsPerQuery = 0;
+
 ClientWatch::ClientWatch() : lastPoll( std::chrono::system_clock::now() ) {}
 
 ClientWatch::ClientWatch(
@@ -203,39 +205,132 @@ LocalisedLogEntries ClientBase::logs( unsigned _watchId ) const {
 
 LocalisedLogEntries ClientBase::logs( LogFilter const& _f ) const {
     LocalisedLogEntries ret;
-    unsigned begin = min( bc().number() + 1, ( unsigned ) _f.latest() );
-    unsigned end = min( bc().number(), min( begin, ( unsigned ) _f.earliest() ) );
+    forEachLog( _f, LogCursor(), [&ret]( LocalisedLogEntry const& _e ) {
+        if ( c_maxLogsPerQuery && ret.size() == c_maxLogsPerQuery )
+            BOOST_THROW_EXCEPTION( TooManyLogs() );
+        ret.push_back( _e );
+        return true;
+    } );
+    return ret;
+}
+
+optional< LogCursor > ClientBase::forEachLog( LogFilter const& _f, LogCursor const& _from,
+    function< bool( LocalisedLogEntry const& ) > const& _callback ) const {
+    unsigned number = bc().number();
+    unsigned begin = min( number, ( unsigned ) _f.latest() );
+    unsigned end = max( _from.block, min( begin, ( unsigned ) _f.earliest() ) );
+
+    optional< LogCursor > next;
+    // passes entries of one block to _callback, false if it stopped
+    auto emit = [&]( LocalisedLogEntries const& _entries, unsigned _block ) -> bool {
+        unsigned logIndex = 0;
+        for ( LocalisedLogEntry const& e : _entries ) {
+            unsigned position = e.mined ? e.logIndex : logIndex++;
+            if ( _block == _from.block && position < _from.log )
+                continue;
+            if ( !_callback( e ) ) {
+                next = LogCursor{ _block, position };
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // blocks which may contain matching entries, checked one by one
+    auto withBlockBlooms = [&]( unsigned _lo, unsigned _hi ) -> bool {
+        if ( _lo > _hi )
+            return true;
+        vector< unsigned > blocks;
+        if ( !_f.isRangeFilter() ) {
+            for ( auto const& i : _f.bloomPossibilities() ) {
+                vector< unsigned > found = bc().withBlockBloom( i, _lo, _hi );
+                blocks.insert( blocks.end(), found.begin(), found.end() );
+            }
+            sort( blocks.begin(), blocks.end() );
+            blocks.erase( unique( blocks.begin(), blocks.end() ), blocks.end() );
+        }
+        // if it is a range filter, we want to get all logs from all blocks in given range
+        for ( uint64_t n = _lo; n <= _hi; ++n ) {
+            if ( !_f.isRangeFilter() && !binary_search( blocks.begin(), blocks.end(), n ) )
+                continue;
+            LocalisedLogEntries blockLogs;
+            prependLogsFromBlock( _f, bc().numberHash( n ), BlockPolarity::Live, blockLogs );
+            reverse( blockLogs.begin(), blockLogs.end() );
+            if ( !emit( blockLogs, n ) )
+                return false;
+        }
+        return true;
+    };
+
+    // Handle blocks from main chain, using the log index where it covers them
+    bool more = true;
+    auto indexed = bc().logIndex() && !_f.isRangeFilter() ? bc().logIndex()->blocks() : nullopt;
+    if ( end <= begin && indexed &&
+         max( end, indexed->first ) <= min( begin, indexed->second ) ) {
+        unsigned from = max( end, indexed->first );
+        unsigned to = min( begin, indexed->second );
+        more = from == 0 || withBlockBlooms( end, from - 1 );
+
+        // positions come in order, so entries are loaded block by block
+        vector< LogPosition > positions;
+        auto flush = [&]() -> bool {
+            if ( positions.empty() )
+                return true;
+            LocalisedLogEntries blockLogs;
+            appendLogsAt( bc().numberHash( positions[0].block ), positions, blockLogs );
+            unsigned block = positions[0].block;
+            positions.clear();
+            return emit( blockLogs, block );
+        };
+        if ( more )
+            bc().logIndex()->forEachMatch( _f, from, to, [&]( LogPosition const& _p ) {
+                if ( !positions.empty() && positions[0].block != _p.block )
+                    more = flush();
+                positions.push_back( _p );
+                return more;
+            } );
+        more = more && flush();
+        more = more && ( to == begin || withBlockBlooms( to + 1, begin ) );
+    } else if ( end <= begin )
+        more = withBlockBlooms( end, begin );
 
     // Handle pending transactions differently as they're not on the block chain.
-    if ( begin > bc().number() ) {
+    // They are positioned after the mined blocks, so cursors into mined blocks stay valid.
+    if ( more && ( unsigned ) _f.latest() > number ) {
         Block temp = postSeal();
+        LocalisedLogEntries pending;
         for ( unsigned i = 0; i < temp.pending().size(); ++i ) {
             // Might have a transaction that contains a matching log.
             TransactionReceipt const& tr = temp.receipt( i );
             LogEntries le = _f.matches( tr );
             for ( unsigned j = 0; j < le.size(); ++j )
-                ret.insert( ret.begin(), LocalisedLogEntry( le[j] ) );
+                pending.push_back( LocalisedLogEntry( le[j] ) );
         }
-        begin = bc().number();
+        emit( pending, number + 1 );
     }
 
-    // Handle blocks from main chain
-    set< unsigned > matchingBlocks;
-    if ( !_f.isRangeFilter() )
-        for ( auto const& i : _f.bloomPossibilities() ) {
-            std::vector< unsigned > matchingBlocksVector = bc().withBlockBloom( i, end, begin );
-            matchingBlocks.insert( matchingBlocksVector.begin(), matchingBlocksVector.end() );
-        }
-    else
-        // if it is a range filter, we want to get all logs from all blocks in given range
-        for ( unsigned i = end; i <= begin; i++ )
-            matchingBlocks.insert( i );
+    return next;
+}
 
-    for ( auto n : matchingBlocks )
-        prependLogsFromBlock( _f, bc().numberHash( n ), BlockPolarity::Live, ret );
+void ClientBase::appendLogsAt( h256 const& _blockHash, vector< LogPosition > const& _positions,
+    LocalisedLogEntries& io_logs ) const {
+    auto receipts = bc().receipts( _blockHash ).receipts;
+    auto hashes = bc().transactionHashes( _blockHash );
 
-    reverse( ret.begin(), ret.end() );
-    return ret;
+    // log index of the first entry of each transaction
+    vector< unsigned > firstLog( 1, 0 );
+    for ( auto const& r : receipts )
+        firstLog.push_back( firstLog.back() + r.log().size() );
+
+    for ( LogPosition const& p : _positions ) {
+        // block was rotated out
+        if ( p.transaction >= receipts.size() || p.transaction >= hashes.size() ||
+             p.log < firstLog[p.transaction] || p.log >= firstLog[p.transaction + 1] )
+            continue;
+        io_logs.push_back( LocalisedLogEntry(
+            receipts[p.transaction].log()[p.log - firstLog[p.transaction]], _blockHash, p.block,
+            hashes[p.transaction], p.transaction, p.log, BlockPolarity::Live ) );
+    }
 }
 
 void ClientBase::prependLogsFromBlock( LogFilter const& _f, h256 const& _blockHash,
@@ -291,6 +386,7 @@ unsigned ClientBase::installWatch(
         if ( !m_filters.count( h ) ) {
             LOG( m_loggerWatch ) << "FFF" << _f << h;
             m_filters.insert( make_pair( h, _f ) );
+            m_filterIndex.insert( h, _f );
         }
     }
     return installWatch( h, _r, fnOnNewChanges, isWS );
@@ -332,6 +428,7 @@ bool ClientBase::uninstallWatch( unsigned _i ) {
     if ( fit != m_filters.end() )
         if ( !--fit->second.refCount ) {
             LOG( m_loggerWatch ) << "*X*" << fit->first << ":" << fit->second.filter;
+            m_filterIndex.remove( fit->first );
             m_filters.erase( fit );
         }
     return true;
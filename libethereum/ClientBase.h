@@ -28,11 +28,19 @@
 #include "CommonNet.h"
 #include "Interface.h"
 #include "LogFilter.h"
+#include "LogFilterIndex.h"
+#include "LogIndex.h"
 #include "TransactionQueue.h"
 #include <chrono>
 
 namespace dev {
 namespace eth {
+
+/// Max number of log entries returned by a log query, 0 for no limit
+extern size_t c_maxLogsPerQuery;
+
+DEV_SIMPLE_EXCEPTION( TooManyLogs );
+
 struct InstalledFilter {
     InstalledFilter( LogFilter const& _f ) : filter( _f ) {}
 
@@ -103,8 +111,13 @@ public:
 
     LocalisedLogEntries logs( unsigned _watchId ) const override;
     LocalisedLogEntries logs( LogFilter const& _filter ) const override;
+    std::optional< LogCursor > forEachLog( LogFilter const& _filter, LogCursor const& _from,
+        std::function< bool( LocalisedLogEntry const& ) > const& _f ) const override;
     virtual void prependLogsFromBlock( LogFilter const& _filter, h256 const& _blockHash,
         BlockPolarity _polarity, LocalisedLogEntries& io_logs ) const;
+    /// Appends log entries of the given block at positions found in the log index
+    void appendLogsAt( h256 const& _blockHash, std::vector< LogPosition > const& _positions,
+        LocalisedLogEntries& io_logs ) const;
 
     /// Install, uninstall and query watches.
     unsigned installWatch( LogFilter const& _filter, Reaping _r = Reaping::Automatic,
@@ -206,6 +219,7 @@ protected:
     mutable Mutex x_filtersWatches;                         ///< Our lock.
     std::unordered_map< h256, InstalledFilter > m_filters;  ///< The dictionary of filters that are
                                                             ///< active.
+    LogFilterIndex m_filterIndex;  ///< m_filters by address and topic
     std::unordered_map< h256, h256s > m_specialFilters =
         std::unordered_map< h256, std::vector< h256 > >{ { PendingChangedFilter, {} },
             { ChainChangedFilter, {} } };
@@ -27,6 +27,7 @@
 #include <libdevcore/CommonIO.h>
 #include <libdevcore/microprofile.h>
 #include <libethcore/CommonJS.h>
+#include <libevm/FramePool.h>
 #include <libevm/LegacyVM.h>
 #include <libevm/VMFactory.h>
 
@@ -34,6 +35,7 @@
 #include "BlockChain.h"
 #include "ExtVM.h"
 #include "Interface.h"
+#include "Precompiled.h"
 
 using namespace std;
 using namespace dev;
@@ -60,6 +62,11 @@ std::string dumpStorage( ExtVM const& _ext ) {
     return o.str();
 }
 
+// Ethereum precompiles are pure functions of their input, SKALE ones read file storage and config
+bool isEthereumPrecompiled( ChainOperationParams const& _params, Address const& _address ) {
+    auto const it = _params.precompiled.find( _address );
+    return it != _params.precompiled.end() && PrecompiledRegistrar::isPure( it->second.name() );
+}
 
 }  // namespace
 
@@ -320,12 +327,24 @@ bool Executive::call( CallParameters const& _p, u256 const& _gasPrice, Address c
 
             return true;  // true actually means "all finished - nothing more to be done regarding
                           // go().
+        } else if ( m_s.isSpeculative() &&
+                    !isEthereumPrecompiled( m_sealEngine.chainParams(), _p.codeAddress ) ) {
+            // SKALE precompiles work with global file storage and config,
+            // such transactions are executed serially
+            m_s.abandonSpeculation();
+            m_gas = 0;
+            m_excepted = TransactionException::OutOfGas;
+            return true;
         } else {
             m_gas = ( u256 )( _p.gas - g );
             bytes output;
             bool success;
             // dev::eth::g_state = m_s.delegateWrite();
-            dev::eth::g_overlayFS = m_s.fs();
+            if ( !m_s.isSpeculative() )
+                dev::eth::g_overlayFS = m_s.fs();
+            // SKALE precompiles read file storage and config
+            if ( !isEthereumPrecompiled( m_sealEngine.chainParams(), _p.codeAddress ) )
+                m_s.noteExternalRead();
             tie( success, output ) =
                 m_sealEngine.executePrecompiled( _p.codeAddress, _p.data, m_envInfo.number() );
             // m_s = dev::eth::g_state.delegateWrite();
@@ -345,9 +364,11 @@ bool Executive::call( CallParameters const& _p, u256 const& _gasPrice, Address c
             h256 codeHash = m_s.codeHash( _p.codeAddress );
             // Contract will be executed with the version stored in account
             auto const version = m_s.version( _p.codeAddress );
-            m_ext = make_shared< ExtVM >( m_s, m_envInfo, m_sealEngine, _p.receiveAddress,
-                _p.senderAddress, _origin, _p.apparentValue, _gasPrice, _p.data, &c, codeHash,
-                version, m_depth, false, _p.staticCall, m_readOnly );
+            // the ExtVM of a nested call reuses memory of a finished one
+            m_ext = allocate_shared< ExtVM >( FrameAllocator< ExtVM >(), m_s, m_envInfo,
+                m_sealEngine, _p.receiveAddress, _p.senderAddress, _origin, _p.apparentValue,
+                _gasPrice, _p.data, &c, codeHash, version, m_depth, false, _p.staticCall,
+                m_readOnly );
         }
     }
 
@@ -422,9 +443,9 @@ bool Executive::executeCreate( Address const& _sender, u256 const& _endowment,
 
     // Schedule _init execution if not empty.
     if ( !_init.empty() )
-        m_ext = make_shared< ExtVM >( m_s, m_envInfo, m_sealEngine, m_newAddress, _sender, _origin,
-            _endowment, _gasPrice, bytesConstRef(), _init, sha3( _init ), _version, m_depth, true,
-            false );
+        m_ext = allocate_shared< ExtVM >( FrameAllocator< ExtVM >(), m_s, m_envInfo, m_sealEngine,
+            m_newAddress, _sender, _origin, _endowment, _gasPrice, bytesConstRef(), _init,
+            sha3( _init ), _version, m_depth, true, false );
     else
         // code stays empty, but we set the version
         m_s.setCode( m_newAddress, {}, _version );
@@ -560,7 +581,10 @@ bool Executive::finalize() {
         m_s.addBalance( m_t.sender(), m_gas * m_t.gasPrice() );
 
         u256 feesEarned = ( m_t.gas() - m_gas ) * m_t.gasPrice();
-        m_s.addBalance( m_envInfo.author(), feesEarned );
+        if ( m_s.isSpeculative() )
+            m_s.deferAuthorFees( feesEarned );
+        else
+            m_s.addBalance( m_envInfo.author(), feesEarned );
     }
 
     // Suicides...
@@ -217,8 +217,8 @@ private:
     EnvInfo m_envInfo;               ///< Information on the runtime environment.
     std::shared_ptr< ExtVM > m_ext;  ///< The VM externality object for the VM execution or null if
                                      ///< no VM is required. shared_ptr used only to allow ExtVM
-                                     ///< forward reference. This field does *NOT* survive this
-                                     ///< object.
+                                     ///< forward reference, it is allocated with FrameAllocator.
+                                     ///< This field does *NOT* survive this object.
     owning_bytes_ref m_output;       ///< Execution output.
     ExecutionResult* m_res = nullptr;  ///< Optional storage for execution results.
 
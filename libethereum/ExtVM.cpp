@@ -180,6 +180,7 @@ void ExtVM::suicide( Address _a ) {
 }
 
 h256 ExtVM::blockHash( u256 _number ) {
+    noteEnvRead();
     u256 const currentNumber = envInfo().number();
 
     if ( _number >= currentNumber || _number < ( std::max< u256 >( 256, currentNumber ) - 256 ) )
@@ -104,6 +104,8 @@ public:
     /// Hash of a block if within the last 256 blocks, or h256() otherwise.
     h256 blockHash( u256 _number ) override;
 
+    void noteEnvRead() override { m_s.noteExternalRead(); }
+
 private:
     EVMSchedule const& initEvmSchedule( int64_t _blockNumber, u256 const& _version ) const {
         // If _version is latest for the block, select corresponding latest schedule.
@@ -34,6 +34,7 @@
 
 #include <skutils/multifunction.h>
 #include <functional>
+#include <optional>
 
 namespace dev {
 namespace eth {
@@ -144,8 +145,18 @@ public:
     // [LOGS API]
 
     virtual LocalisedLogEntries logs( unsigned _watchId ) const = 0;
+    /// @returns log entries matching _filter in the order of forEachLog()
     virtual LocalisedLogEntries logs( LogFilter const& _filter ) const = 0;
 
+    /// Calls _f for log entries matching _filter in chain order, starting at _from, until _f
+    /// returns false. Entries of pending transactions come last, as if they were in the block
+    /// after the last mined one, so that a LogCursor stays valid while blocks are mined (they
+    /// used to come first). @returns position of the entry _f returned false for, nullopt if all
+    /// entries were passed to _f.
+    virtual std::optional< LogCursor > forEachLog( LogFilter const& _filter,
+        LogCursor const& _from,
+        std::function< bool( LocalisedLogEntry const& ) > const& _f ) const = 0;
+
     /// Install, uninstall and query watches.
     virtual unsigned installWatch( LogFilter const& _filter, Reaping _r = Reaping::Automatic,
         fnClientWatchHandlerMulti_t fnOnNewChanges = fnClientWatchHandlerMulti_t(),
@@ -104,6 +104,13 @@ private:
     BlockNumber m_latest = PendingBlock;
 };
 
+/// Position of a log entry to continue a log query from. Logs of pending transactions follow
+/// the last mined block as if they were in the next block.
+struct LogCursor {
+    unsigned block = 0;
+    unsigned log = 0;  ///< Index of the entry among all logs of the block
+};
+
 }  // namespace eth
 
 }  // namespace dev
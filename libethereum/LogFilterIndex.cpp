@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogFilterIndex.cpp
+ * @date 2026
+ */
+
+#include "LogFilterIndex.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+namespace {
+
+/// @returns first topic position constrained by _filter or -1
+int firstConstrainedTopic( LogFilter const& _filter ) {
+    auto topics = _filter.getTopics();
+    for ( size_t i = 0; i < topics.size(); ++i )
+        if ( !topics[i].empty() )
+            return int( i );
+    return -1;
+}
+
+template < class Key >
+void eraseFrom( unordered_map< Key, h256Hash >& _index, Key const& _key, h256 const& _id ) {
+    auto it = _index.find( _key );
+    if ( it == _index.end() )
+        return;
+    it->second.erase( _id );
+    if ( it->second.empty() )
+        _index.erase( it );
+}
+
+template < class Key >
+void addFrom( unordered_map< Key, h256Hash > const& _index, Key const& _key, h256Hash& o_ids ) {
+    auto it = _index.find( _key );
+    if ( it != _index.end() )
+        o_ids.insert( it->second.begin(), it->second.end() );
+}
+
+}  // namespace
+
+void LogFilterIndex::insert( h256 const& _id, LogFilter const& _filter ) {
+    if ( !m_filters.emplace( _id, _filter ).second )
+        return;
+
+    auto addresses = _filter.getAddresses();
+    if ( !addresses.empty() ) {
+        for ( auto const& a : addresses )
+            m_byAddress[a].insert( _id );
+        return;
+    }
+
+    int position = firstConstrainedTopic( _filter );
+    if ( position < 0 ) {
+        m_unconstrained.insert( _id );
+        return;
+    }
+    for ( auto const& t : _filter.getTopics()[position] )
+        m_byTopic[position][t].insert( _id );
+}
+
+void LogFilterIndex::remove( h256 const& _id ) {
+    auto it = m_filters.find( _id );
+    if ( it == m_filters.end() )
+        return;
+    LogFilter const& filter = it->second;
+
+    for ( auto const& a : filter.getAddresses() )
+        eraseFrom( m_byAddress, a, _id );
+    int position = firstConstrainedTopic( filter );
+    if ( position >= 0 )
+        for ( auto const& t : filter.getTopics()[position] )
+            eraseFrom( m_byTopic[position], t, _id );
+    m_unconstrained.erase( _id );
+
+    m_filters.erase( it );
+}
+
+h256Hash LogFilterIndex::candidates( TransactionReceipt const& _receipt ) const {
+    h256Hash ret;
+    if ( _receipt.log().empty() )
+        return ret;
+
+    ret = m_unconstrained;
+    for ( LogEntry const& e : _receipt.log() ) {
+        addFrom( m_byAddress, e.address, ret );
+        for ( size_t i = 0; i < e.topics.size() && i < m_byTopic.size(); ++i )
+            addFrom( m_byTopic[i], e.topics[i], ret );
+    }
+    return ret;
+}
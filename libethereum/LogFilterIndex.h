@@ -0,0 +1,62 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogFilterIndex.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "LogFilter.h"
+#include "TransactionReceipt.h"
+
+#include <array>
+#include <unordered_map>
+
+namespace dev {
+namespace eth {
+
+/**
+ * @brief Inverted index of installed log filters by address and topic.
+ * Every filter is indexed by its addresses, or by the topics of its first constrained position
+ * if it has no addresses. Filters without addresses and topics match every log entry.
+ * candidates() returns a superset of the filters matching a receipt, so they still have to be
+ * checked with LogFilter::matches().
+ * @threadunsafe
+ */
+class LogFilterIndex {
+public:
+    void insert( h256 const& _id, LogFilter const& _filter );
+    void remove( h256 const& _id );
+
+    /// @returns ids of filters that may match some log entry of _receipt
+    h256Hash candidates( TransactionReceipt const& _receipt ) const;
+
+    size_t size() const { return m_filters.size(); }
+    bool empty() const { return m_filters.empty(); }
+
+private:
+    std::unordered_map< h256, LogFilter > m_filters;
+    std::unordered_map< Address, h256Hash > m_byAddress;
+    std::array< std::unordered_map< h256, h256Hash >, 4 > m_byTopic;
+    h256Hash m_unconstrained;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,217 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogIndex.cpp
+ * @date 2026
+ */
+
+#include "LogIndex.h"
+
+#include <libbatched-io/batched_rotating_db_io.h>
+
+#include <algorithm>
+#include <map>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+bool dev::eth::c_logIndex = false;
+
+namespace {
+
+// keys are <kind><address or topic><big endian block number>,
+// values are <big endian transaction index><big endian log index> for every entry
+const char c_addressKind = 'a';
+const char c_topicKind = '0';  // '0'..'3' by topic position
+const db::Slice c_firstBlockKey( "firstBlock" );
+const db::Slice c_lastBlockKey( "lastBlock" );
+
+// blocks merged and intersected at once
+const uint64_t c_window = 4096;
+
+void appendBigEndian( string& _out, uint64_t _value, size_t _bytes ) {
+    for ( size_t i = _bytes; i-- > 0; )
+        _out.push_back( char( ( _value >> ( 8 * i ) ) & 0xff ) );
+}
+
+uint64_t readBigEndian( char const* _data, size_t _bytes ) {
+    uint64_t ret = 0;
+    for ( size_t i = 0; i < _bytes; ++i )
+        ret = ( ret << 8 ) | uint8_t( _data[i] );
+    return ret;
+}
+
+string postingKey( char _kind, bytesConstRef _term, uint64_t _block ) {
+    string ret;
+    ret.reserve( 1 + _term.size() + 8 );
+    ret.push_back( _kind );
+    ret.append( reinterpret_cast< char const* >( _term.data() ), _term.size() );
+    appendBigEndian( ret, _block, 8 );
+    return ret;
+}
+
+/// Addresses or topics of one position of a filter, any of them has to match
+struct Dimension {
+    char kind;
+    vector< bytes > terms;
+};
+
+vector< Dimension > dimensionsOf( LogFilter const& _filter ) {
+    vector< Dimension > ret;
+    Dimension addresses{ c_addressKind, {} };
+    for ( Address const& a : _filter.getAddresses() )
+        addresses.terms.push_back( a.asBytes() );
+    if ( !addresses.terms.empty() )
+        ret.push_back( std::move( addresses ) );
+
+    auto topics = _filter.getTopics();
+    for ( size_t i = 0; i < topics.size(); ++i ) {
+        Dimension d{ char( c_topicKind + i ), {} };
+        for ( h256 const& t : topics[i] )
+            d.terms.push_back( t.asBytes() );
+        if ( !d.terms.empty() )
+            ret.push_back( std::move( d ) );
+    }
+    return ret;
+}
+
+}  // namespace
+
+LogIndex::LogIndex( boost::filesystem::path const& _path, size_t _pieces, bool _archiveMode ) {
+    auto rotator = make_shared< batched_io::rotating_db_io >( _path, _pieces, _archiveMode );
+    m_db = make_shared< db::ManuallyRotatingLevelDB >( rotator );
+
+    if ( m_db->exists( c_firstBlockKey ) && m_db->exists( c_lastBlockKey ) ) {
+        m_first = stoul( m_db->lookup( c_firstBlockKey ) );
+        m_last = stoul( m_db->lookup( c_lastBlockKey ) );
+    }
+}
+
+void LogIndex::insertBlock( unsigned _number, TransactionReceipts const& _receipts ) {
+    Guard l( x_blocks );
+    // keep indexed blocks contiguous if some block failed, the rest is indexed on restart
+    if ( m_last && _number > *m_last + 1 )
+        return;
+
+    map< string, string > postings;
+    unsigned logIndex = 0;
+    for ( size_t i = 0; i < _receipts.size(); ++i )
+        for ( LogEntry const& e : _receipts[i].log() ) {
+            string position;
+            appendBigEndian( position, i, 4 );
+            appendBigEndian( position, logIndex++, 4 );
+
+            postings[postingKey( c_addressKind, e.address.ref(), _number )] += position;
+            for ( size_t t = 0; t < e.topics.size() && t < 4; ++t )
+                postings[postingKey( char( c_topicKind + t ), e.topics[t].ref(), _number )] +=
+                    position;
+        }
+
+    unsigned first = m_first ? *m_first : _number;
+    unsigned last = m_last ? std::max( *m_last, _number ) : _number;
+    auto batch = m_db->createWriteBatch();
+    for ( auto const& p : postings )
+        batch->insert( db::Slice( p.first ), db::Slice( p.second ) );
+    writeBlocks( *batch, first, last );
+    m_db->commit( std::move( batch ) );
+    m_first = first;
+    m_last = last;
+}
+
+void LogIndex::startAfter( unsigned _number ) {
+    Guard l( x_blocks );
+    auto batch = m_db->createWriteBatch();
+    writeBlocks( *batch, _number + 1, _number );
+    m_db->commit( std::move( batch ) );
+    m_first = _number + 1;
+    m_last = _number;
+}
+
+optional< pair< unsigned, unsigned > > LogIndex::blocks() const {
+    Guard l( x_blocks );
+    if ( !m_first || !m_last )
+        return nullopt;
+    return make_pair( *m_first, *m_last );
+}
+
+void LogIndex::rotate() {
+    Guard l( x_blocks );
+    m_db->rotate();
+    // keep the markers in the newest piece
+    if ( m_first && m_last ) {
+        auto batch = m_db->createWriteBatch();
+        writeBlocks( *batch, *m_first, *m_last );
+        m_db->commit( std::move( batch ) );
+    }
+}
+
+void LogIndex::writeBlocks( db::WriteBatchFace& _batch, unsigned _first, unsigned _last ) {
+    _batch.insert( c_firstBlockKey, db::Slice( to_string( _first ) ) );
+    _batch.insert( c_lastBlockKey, db::Slice( to_string( _last ) ) );
+}
+
+void LogIndex::forEachMatch( LogFilter const& _filter, unsigned _from, unsigned _to,
+    function< bool( LogPosition const& ) > const& _f ) const {
+    vector< Dimension > dimensions = dimensionsOf( _filter );
+    if ( dimensions.empty() )
+        return;
+
+    for ( uint64_t begin = _from; begin <= _to; begin += c_window ) {
+        uint64_t end = min< uint64_t >( begin + c_window, uint64_t( _to ) + 1 );
+
+        vector< LogPosition > matches;
+        for ( size_t d = 0; d < dimensions.size(); ++d ) {
+            // union of positions of all terms
+            vector< LogPosition > found;
+            for ( bytes const& term : dimensions[d].terms ) {
+                m_db->forEachInRange( db::Slice( postingKey( dimensions[d].kind, &term, begin ) ),
+                    db::Slice( postingKey( dimensions[d].kind, &term, end ) ),
+                    [&found]( db::Slice _key, db::Slice _value ) -> bool {
+                        LogPosition p;
+                        p.block = unsigned( readBigEndian( _key.data() + _key.size() - 8, 8 ) );
+                        for ( size_t i = 0; i + 8 <= _value.size(); i += 8 ) {
+                            p.transaction = unsigned( readBigEndian( _value.data() + i, 4 ) );
+                            p.log = unsigned( readBigEndian( _value.data() + i + 4, 4 ) );
+                            found.push_back( p );
+                        }
+                        return true;
+                    } );
+            }
+            sort( found.begin(), found.end() );
+            // pieces may repeat a block after re-import
+            found.erase( unique( found.begin(), found.end() ), found.end() );
+
+            if ( d == 0 )
+                matches = std::move( found );
+            else {
+                vector< LogPosition > both;
+                set_intersection( matches.begin(), matches.end(), found.begin(), found.end(),
+                    back_inserter( both ) );
+                matches = std::move( both );
+            }
+            if ( matches.empty() )
+                break;
+        }
+
+        for ( LogPosition const& p : matches )
+            if ( !_f( p ) )
+                return;
+    }
+}
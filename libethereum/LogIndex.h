@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogIndex.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "LogFilter.h"
+#include "TransactionReceipt.h"
+
+#include <libdevcore/Guards.h>
+#include <libdevcore/ManuallyRotatingLevelDB.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+
+namespace dev {
+namespace eth {
+
+/// Keep an on-disk index of logs by address and topic to answer log queries
+extern bool c_logIndex;
+
+/// Position of a log entry in the chain
+struct LogPosition {
+    unsigned block = 0;
+    unsigned transaction = 0;
+    unsigned log = 0;  ///< Index of the entry among all logs of the block
+
+    bool operator<( LogPosition const& _other ) const {
+        return std::tie( block, transaction, log ) <
+               std::tie( _other.block, _other.transaction, _other.log );
+    }
+    bool operator==( LogPosition const& _other ) const {
+        return std::tie( block, transaction, log ) ==
+               std::tie( _other.block, _other.transaction, _other.log );
+    }
+};
+
+/**
+ * @brief Inverted index of logs by address and topic, stored in its own rotating LevelDB.
+ * For every address and every topic position it keeps the positions of matching log entries
+ * block by block, so a filter is resolved by merging and intersecting these posting lists
+ * instead of walking block blooms and decoding receipts of false positive blocks.
+ * Rotated together with the blocks database.
+ * @threadsafe
+ */
+class LogIndex {
+public:
+    LogIndex( boost::filesystem::path const& _path, size_t _pieces, bool _archiveMode );
+
+    /// Index logs of block _number. Blocks must come in ascending order, a block after a gap
+    /// is ignored.
+    void insertBlock( unsigned _number, TransactionReceipts const& _receipts );
+
+    /// Start indexing with block _number + 1, on chains which had no index before
+    void startAfter( unsigned _number );
+
+    /// @returns [first, last] indexed blocks, nullopt if indexing has not started yet
+    std::optional< std::pair< unsigned, unsigned > > blocks() const;
+
+    void rotate();
+
+    /// Calls _f for positions of log entries in blocks [_from, _to] matching addresses and
+    /// topics of _filter, in chain order, until it returns false.
+    /// _filter must not be a range filter.
+    void forEachMatch( LogFilter const& _filter, unsigned _from, unsigned _to,
+        std::function< bool( LogPosition const& ) > const& _f ) const;
+
+private:
+    static void writeBlocks( db::WriteBatchFace& _batch, unsigned _first, unsigned _last );
+
+    std::shared_ptr< db::ManuallyRotatingLevelDB > m_db;
+
+    mutable Mutex x_blocks;
+    std::optional< unsigned > m_first;
+    std::optional< unsigned > m_last;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -49,6 +49,7 @@
 #include <functional>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 
 namespace dev {
@@ -81,6 +82,13 @@ PrecompiledPricer const& PrecompiledRegistrar::pricer( std::string const& _name
     return get()->m_pricers[_name];
 }
 
+bool PrecompiledRegistrar::isPure( std::string const& _name ) {
+    static std::unordered_set< std::string > const c_pure = { "ecrecover", "sha256", "ripemd160",
+        "identity", "modexp", "alt_bn128_G1_add", "alt_bn128_G1_mul",
+        "alt_bn128_pairing_product" };
+    return c_pure.count( _name ) != 0;
+}
+
 namespace {
 
 ETH_REGISTER_PRECOMPILED( ecrecover )( bytesConstRef _in ) {
@@ -70,6 +70,10 @@ public:
     /// Get the price calculator object for @a _name function or @throw PricerNotFound if not found.
     static PrecompiledPricer const& pricer( std::string const& _name );
 
+    /// Whether the @a _name function depends on its input only. SKALE functions that read file
+    /// storage, config or chain state are not.
+    static bool isPure( std::string const& _name );
+
     /// Register an executor. In general just use ETH_REGISTER_PRECOMPILED.
     static PrecompiledExecutor registerExecutor(
         std::string const& _name, PrecompiledExecutor const& _exec ) {
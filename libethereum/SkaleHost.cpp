@@ -24,9 +24,11 @@
 
 #include "SkaleHost.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <future>
+#include <optional>
 #include <string>
 
 using namespace std;
@@ -320,13 +322,19 @@ SkaleHost::~SkaleHost() {}
 void SkaleHost::logState() {
     LOG( m_traceLogger ) << cc::debug( " sent_to_consensus = " ) << total_sent
                          << cc::debug( " got_from_consensus = " ) << total_arrived
-                         << cc::debug( " m_transaction_cache = " ) << m_m_transaction_cache.size()
+                         << cc::debug( " m_transaction_cache = " )
+                         << m_tq.decodedTransactions().stats().size
                          << cc::debug( " m_tq = " ) << m_tq.status().current
                          << cc::debug( " m_bcast_counter = " ) << m_bcast_counter;
 }
 
+TransactionCache::Stats SkaleHost::transactionCacheStats() const {
+    return m_tq.decodedTransactions().stats();
+}
+
 h256 SkaleHost::receiveTransaction( std::string _rlp ) {
-    Transaction transaction( jsToBytes( _rlp, OnFailed::Throw ), CheckTransaction::None );
+    bytes const rlp = jsToBytes( _rlp, OnFailed::Throw );
+    Transaction transaction = m_tq.decodedTransactions().decode( &rlp );
 
     h256 sha = transaction.sha3();
 
@@ -359,6 +367,48 @@ h256 SkaleHost::receiveTransaction( std::string _rlp ) {
     return sha;
 }
 
+size_t SkaleHost::receiveTransactions( bytesConstRef _frame ) {
+    RLP const frame( _frame );
+    if ( !frame.isList() )
+        BOOST_THROW_EXCEPTION( BadRLP() );
+
+    std::vector< Transaction > transactions;
+    transactions.reserve( frame.itemCount() );
+    for ( auto const& item : frame ) {
+        try {
+            transactions.push_back( m_tq.decodedTransactions().decode( item.toBytesConstRef() ) );
+        } catch ( const std::exception& ex ) {
+            LOG( m_debugLogger ) << "Received bad transaction in broadcast frame: " << ex.what();
+        }
+    }
+
+    //
+    static std::atomic_size_t g_nReceiveFramesTaskNumber = 0;
+    size_t nReceiveFramesTaskNumber = g_nReceiveFramesTaskNumber++;
+    std::string strPerformanceQueueName = "bc/receive_transactions";
+    std::string strPerformanceActionName =
+        skutils::tools::format( "receive frame task %zu", nReceiveFramesTaskNumber );
+    skutils::task::performance::json jsn = skutils::task::performance::json::object();
+    jsn["count"] = transactions.size();
+    skutils::task::performance::action a(
+        strPerformanceQueueName, strPerformanceActionName, jsn );
+    //
+    {
+        std::lock_guard< std::mutex > localGuard( m_receivedMutex );
+        for ( Transaction const& transaction : transactions )
+            m_received.insert( transaction.sha3() );
+        LOG( m_debugLogger ) << "m_received = " << m_received.size() << std::endl;
+    }
+
+    for ( size_t i = 0; i < transactions.size(); ++i )
+        m_debugTracer.tracepoint( "receive_transaction" );
+    size_t const imported = m_client.importTransactions( transactions );
+    for ( size_t i = 0; i < imported; ++i )
+        m_debugTracer.tracepoint( "receive_transaction_success" );
+
+    return frame.itemCount();
+}
+
 // keeps mutex unlocked when exists
 template < class M >
 class unlock_guard {
@@ -434,63 +484,61 @@ ConsensusExtFace::transactions_vector SkaleHost::pendingTransactions(
     //
     m_debugTracer.tracepoint( "fetch_transactions" );
 
-    int counter = 0;
-
-    Transactions txns = m_tq.topTransactionsSync(
-        _limit, [this, &to_delete, &counter]( const Transaction& tx ) -> bool {
-            if ( m_tq.getCategory( tx.sha3() ) != 1 )  // take broadcasted
-                return false;
-
-            // XXX TODO Invent good way to do this
-            if ( counter++ == 0 )
-                m_pending_createMutex.lock();
-
-            if ( tx.verifiedOn < m_lastBlockWithBornTransactions )
-                try {
-                    bool isMtmEnabled = m_client.chainParams().sChain.multiTransactionMode;
-                    Executive::verifyTransaction( tx,
-                        static_cast< const Interface& >( m_client ).blockInfo( LatestBlock ),
-                        m_client.state().createStateReadOnlyCopy(), *m_client.sealEngine(), 0,
-                        getGasPrice(), isMtmEnabled );
-                } catch ( const exception& ex ) {
-                    if ( to_delete.count( tx.sha3() ) == 0 )
-                        clog( VerbosityInfo, "skale-host" )
-                            << "Dropped now-invalid transaction in pending queue " << tx.sha3()
-                            << ":" << ex.what();
-                    to_delete.insert( tx.sha3() );
-                    return false;
-                }
+    // take broadcasted transactions from a snapshot of the queue, so importers are not
+    // blocked while they are verified
+    auto hasBroadcasted = []( TransactionQueue::PendingSnapshot const& _snapshot ) {
+        return std::find( _snapshot.categories.begin(), _snapshot.categories.end(), 1 ) !=
+               _snapshot.categories.end();
+    };
+    std::shared_ptr< TransactionQueue::PendingSnapshot const > snapshot = m_tq.pendingSnapshot();
+    if ( !hasBroadcasted( *snapshot ) ) {
+        MICROPROFILE_SCOPEI( "SkaleHost", "wait_for txns 100", MP_DIMGRAY );
+        // 100 ms lets ConsensusStub terminate nicely
+        m_tq.waitForChange( snapshot->version, std::chrono::milliseconds( 100 ) );
+    }
 
-            return true;
-        } );
+    std::lock_guard< std::recursive_mutex > lock( m_pending_createMutex );
+    snapshot = m_tq.pendingSnapshot();
+
+    Transactions txns;
+    h256s verified;
+    int64_t verifiedOn = -1;
+    std::optional< BlockHeader > latestInfo;
+    std::optional< skale::State > latestState;
+    for ( size_t i = 0; i < snapshot->transactions.size() && txns.size() < _limit; ++i ) {
+        if ( snapshot->categories[i] != 1 )
+            continue;
+
+        Transaction tx = snapshot->transactions[i];
+        if ( tx.verifiedOn < m_lastBlockWithBornTransactions )
+            try {
+                if ( !latestInfo ) {
+                    latestInfo =
+                        static_cast< const Interface& >( m_client ).blockInfo( LatestBlock );
+                    latestState.emplace( m_client.state().createStateReadOnlyCopy() );
+                }
+                bool isMtmEnabled = m_client.chainParams().sChain.multiTransactionMode;
+                Executive::verifyTransaction( tx, *latestInfo, *latestState,
+                    *m_client.sealEngine(), 0, getGasPrice(), isMtmEnabled );
+                verified.push_back( tx.sha3() );
+                verifiedOn = tx.verifiedOn;
+            } catch ( const exception& ex ) {
+                if ( to_delete.count( tx.sha3() ) == 0 )
+                    clog( VerbosityInfo, "skale-host" )
+                        << "Dropped now-invalid transaction in pending queue " << tx.sha3() << ":"
+                        << ex.what();
+                to_delete.insert( tx.sha3() );
+                continue;
+            }
 
+        txns.push_back( std::move( tx ) );
+    }
+    m_tq.setVerifiedOn( verified, verifiedOn );
 
     //
     a_fetch_transactions.finish();
     //
 
-    if ( counter++ == 0 )
-        m_pending_createMutex.lock();
-
-    std::lock_guard< std::recursive_mutex > lock( m_pending_createMutex, std::adopt_lock );
-
-    // HACK For IS-348
-    auto saved_txns = txns;
-    std::stable_sort( txns.begin(), txns.end(), TransactionQueue::PriorityCompare{ m_tq } );
-    bool found_difference = false;
-    for ( size_t i = 0; i < txns.size(); ++i ) {
-        if ( txns[i].sha3() != saved_txns[i].sha3() )
-            found_difference = true;
-    }
-    if ( found_difference ) {
-        clog( VerbosityError, "skale-host" ) << "Transaction order disorder detected!!";
-        clog( VerbosityTrace, "skale-host" ) << "<i> <old> <new>";
-        for ( size_t i = 0; i < txns.size(); ++i ) {
-            clog( VerbosityTrace, "skale-host" )
-                << i << " " << saved_txns[i].sha3() << " " << txns[i].sha3();
-        }
-    }
-
     // drop by block gas limit
     u256 blockGasLimit = this->m_client.chainParams().gasLimit;
     u256 gasAcc = 0;
@@ -523,9 +571,9 @@ ConsensusExtFace::transactions_vector SkaleHost::pendingTransactions(
             strPerformanceQueueName_drop_bad_transactions,
             strPerformanceActionName_drop_bad_transactions, jsn );
         //
+        m_tq.drop( to_delete );
         for ( auto sha : to_delete ) {
             m_debugTracer.tracepoint( "drop_bad" );
-            m_tq.drop( sha );
             if ( m_received.count( sha ) != 0 )
                 m_received.erase( sha );
             LOG( m_debugLogger ) << "m_received = " << m_received.size() << std::endl;
@@ -548,12 +596,8 @@ ConsensusExtFace::transactions_vector SkaleHost::pendingTransactions(
 
             h256 sha = txn.sha3();
 
-            if ( m_m_transaction_cache.find( sha.asArray() ) != m_m_transaction_cache.cend() )
-                m_debugTracer.tracepoint( "sent_txn_again" );
-            else {
-                m_debugTracer.tracepoint( "sent_txn_new" );
-                m_m_transaction_cache[sha.asArray()] = txn;
-            }
+            // createBlock finds it there unless it was evicted
+            m_tq.decodedTransactions().insert( sha, txn );
 
             out_vector.push_back( txn.rlp() );
 
@@ -606,10 +650,11 @@ void SkaleHost::createBlock( const ConsensusExtFace::transactions_vector& _appro
     jsn_create_block["stateRoot"] = toJS( _stateRoot );
     skutils::task::performance::json jarrApprovedTransactions =
         skutils::task::performance::json::array();
-    for ( auto it = _approvedTransactions.begin(); it != _approvedTransactions.end(); ++it ) {
-        const bytes& data = *it;
-        h256 sha = sha3( data );
-        jarrApprovedTransactions.push_back( toJS( sha ) );
+    h256s approvedHashes;
+    approvedHashes.reserve( _approvedTransactions.size() );
+    for ( const bytes& data : _approvedTransactions ) {
+        approvedHashes.push_back( sha3( data ) );
+        jarrApprovedTransactions.push_back( toJS( approvedHashes.back() ) );
     }
     jsn_create_block["approvedTransactions"] = jarrApprovedTransactions;
     skutils::task::performance::action a_create_block( strPerformanceQueueName_create_block,
@@ -673,9 +718,10 @@ void SkaleHost::createBlock( const ConsensusExtFace::transactions_vector& _appro
         skutils::task::performance::json jarrProcessedTxns =
             skutils::task::performance::json::array();
 
-        for ( auto it = _approvedTransactions.begin(); it != _approvedTransactions.end(); ++it ) {
-            const bytes& data = *it;
-            h256 sha = sha3( data );
+        TransactionCache& decoded = m_tq.decodedTransactions();
+        for ( size_t i = 0; i < _approvedTransactions.size(); ++i ) {
+            const bytes& data = _approvedTransactions[i];
+            h256 const& sha = approvedHashes[i];
             LOG( m_traceLogger ) << cc::debug( "Arrived txn: " ) << sha << std::endl;
             jarrProcessedTxns.push_back( toJS( sha ) );
 #ifdef DEBUG_TX_BALANCE
@@ -688,23 +734,30 @@ void SkaleHost::createBlock( const ConsensusExtFace::transactions_vector& _appro
             arrived.insert( sha );
 #endif
 
-            // if already known
-            // TODO clear occasionally this cache?!
-            if ( m_m_transaction_cache.find( sha.asArray() ) != m_m_transaction_cache.cend() ) {
-                Transaction t = m_m_transaction_cache.at( sha.asArray() );
+            // if already known: current in our queue, so dropGood() has something to remove.
+            // The cache also holds transactions only decoded on receive or not imported, those
+            // are executed like consensus-born ones, reusing the decoding
+            std::optional< Transaction > cached = decoded.find( sha );
+            if ( cached && m_tq.getCategory( *cached ) >= 0 ) {
+                Transaction& t = *cached;
+                // cached before import could have skipped it
+                t.checkOutExternalGas( m_client.chainParams().externalGasDifficulty );
                 out_txns.push_back( t );
                 LOG( m_debugLogger ) << "Dropping good txn " << sha << std::endl;
                 m_debugTracer.tracepoint( "drop_good" );
                 m_tq.dropGood( t );
                 MICROPROFILE_SCOPEI( "SkaleHost", "erase from caches", MP_GAINSBORO );
-                m_m_transaction_cache.erase( sha.asArray() );
+                decoded.remove( sha );
                 std::lock_guard< std::mutex > localGuard( m_receivedMutex );
                 m_received.erase( sha );
                 LOG( m_debugLogger ) << "m_received = " << m_received.size() << std::endl;
                 // for test std::thread( [t, this]() { m_client.importTransaction( t ); }
                 // ).detach();
             } else {
-                Transaction t( data, CheckTransaction::Everything, true );
+                // not verified by this node, but may be decoded already
+                Transaction t =
+                    cached ? *cached : Transaction( data, CheckTransaction::Everything, true );
+                decoded.remove( sha );
                 t.checkOutExternalGas( m_client.chainParams().externalGasDifficulty );
                 out_txns.push_back( t );
                 LOG( m_debugLogger ) << "Will import consensus-born txn!";
@@ -719,7 +772,6 @@ void SkaleHost::createBlock( const ConsensusExtFace::transactions_vector& _appro
             }
 
         }  // for
-        // TODO Monitor somehow m_transaction_cache and delete long-lasting elements?
 
         total_arrived += out_txns.size();
 
@@ -901,34 +953,47 @@ void SkaleHost::broadcastFunc() {
         try {
             m_broadcaster->broadcast( "" );  // HACK this is just to initialize sockets
 
-            dev::eth::Transactions txns = m_tq.topTransactionsSync( 1, 0, 1 );
+            size_t const batchSize = std::max< size_t >( c_broadcastBatchSize, 1 );
+            dev::eth::Transactions txns = m_tq.topTransactionsSync( batchSize, 0, 1 );
             if ( txns.empty() )  // means timeout
                 continue;
 
+            // give more transactions a chance to fill the frame
+            auto const deadline = std::chrono::steady_clock::now() +
+                                  std::chrono::microseconds( c_broadcastBatchTimeUs );
+            while ( txns.size() < batchSize && !m_exitNeeded &&
+                    std::chrono::steady_clock::now() < deadline ) {
+                dev::eth::Transactions more = m_tq.topTransactions( batchSize - txns.size(), 0, 1 );
+                if ( more.empty() )
+                    std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+                else
+                    txns.insert( txns.end(), more.begin(), more.end() );
+            }
+
             this->logState();
 
             MICROPROFILE_SCOPEI( "SkaleHost", "broadcastFunc", MP_BISQUE );
 
-            assert( txns.size() == 1 );
-            Transaction& txn = txns[0];
-            h256 sha = txn.sha3();
-
             // TODO XXX such blocks are bad :(
-            size_t received;
+            std::vector< const Transaction* > toSend;
             {
                 std::lock_guard< std::mutex > lock( m_receivedMutex );
-                received = m_received.count( sha );
+                for ( const Transaction& txn : txns )
+                    if ( m_received.count( txn.sha3() ) == 0 )
+                        toSend.push_back( &txn );
             }
+            for ( size_t i = toSend.size(); i < txns.size(); ++i )
+                m_debugTracer.tracepoint( "broadcast_already_have" );
 
-            if ( received == 0 ) {
-                try {
-                    if ( !m_broadcastPauseFlag ) {
-                        MICROPROFILE_SCOPEI(
-                            "SkaleHost", "broadcastFunc.broadcast", MP_CHARTREUSE1 );
+            try {
+                if ( !toSend.empty() && !m_broadcastPauseFlag ) {
+                    MICROPROFILE_SCOPEI( "SkaleHost", "broadcastFunc.broadcast", MP_CHARTREUSE1 );
+                    std::string strPerformanceQueueName = "bc/broadcast";
+                    if ( c_broadcastBatchSize == 0 ) {
+                        const Transaction& txn = *toSend[0];
                         std::string rlp = toJS( txn.rlp() );
                         std::string h = toJS( txn.sha3() );
                         //
-                        std::string strPerformanceQueueName = "bc/broadcast";
                         std::string strPerformanceActionName =
                             skutils::tools::format( "broadcast %zu", nBroadcastTaskNumber++ );
                         skutils::task::performance::json jsn =
@@ -940,17 +1005,31 @@ void SkaleHost::broadcastFunc() {
                         //
                         m_debugTracer.tracepoint( "broadcast" );
                         m_broadcaster->broadcast( rlp );
+                    } else {
+                        std::vector< dev::bytes > rlps;
+                        rlps.reserve( toSend.size() );
+                        for ( const Transaction* txn : toSend )
+                            rlps.push_back( txn->rlp() );
+                        //
+                        std::string strPerformanceActionName =
+                            skutils::tools::format( "broadcast %zu", nBroadcastTaskNumber++ );
+                        skutils::task::performance::json jsn =
+                            skutils::task::performance::json::object();
+                        jsn["count"] = rlps.size();
+                        skutils::task::performance::action a(
+                            strPerformanceQueueName, strPerformanceActionName, jsn );
+                        //
+                        for ( size_t i = 0; i < rlps.size(); ++i )
+                            m_debugTracer.tracepoint( "broadcast" );
+                        m_broadcaster->broadcastBatch( rlps );
                     }
-                } catch ( const std::exception& ex ) {
-                    cwarn << "BROADCAST EXCEPTION CAUGHT" << endl;
-                    cwarn << ex.what() << endl;
-                }  // catch
-
-            }  // if
-            else
-                m_debugTracer.tracepoint( "broadcast_already_have" );
+                }
+            } catch ( const std::exception& ex ) {
+                cwarn << "BROADCAST EXCEPTION CAUGHT" << endl;
+                cwarn << ex.what() << endl;
+            }  // catch
 
-            ++m_bcast_counter;
+            m_bcast_counter += txns.size();
 
             logState();
         } catch ( const std::exception& ex ) {
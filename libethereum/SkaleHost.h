@@ -37,6 +37,7 @@
 #include <libethcore/Common.h>
 #include <libethereum/InstanceMonitor.h>
 #include <libethereum/Transaction.h>
+#include <libethereum/TransactionCache.h>
 #include <libskale/SkaleClient.h>
 
 #include <jsonrpccpp/client/client.h>
@@ -121,6 +122,9 @@ public:
     void onBlockImported( dev::eth::BlockHeader const& _info );
 
     dev::h256 receiveTransaction( std::string );
+    /// Imports all transactions of a broadcast frame, skipping bad ones
+    /// @returns number of transactions in the frame
+    size_t receiveTransactions( dev::bytesConstRef _frame );
 
     dev::u256 getGasPrice() const;
     dev::u256 getBlockRandom() const;
@@ -148,6 +152,12 @@ public:
 
     SkaleDebugInterface::handler getDebugHandler() const { return m_debugHandler; }
 
+    Broadcaster::Stats broadcastStats() const {
+        return m_broadcaster ? m_broadcaster->stats() : Broadcaster::Stats();
+    }
+
+    dev::eth::TransactionCache::Stats transactionCacheStats() const;
+
 private:
     std::atomic_bool working = false;
     std::atomic_bool m_exitedForcefully = false;
@@ -186,9 +196,6 @@ private:
     std::atomic_bool m_consensusPaused = false;
     std::atomic_bool m_broadcastPauseFlag = false;  // not pause - just ignore
 
-    std::map< std::array< uint8_t, 32 >, dev::eth::Transaction >
-        m_m_transaction_cache;  // used to find Transaction objects when
-                                // creating block
     dev::eth::Client& m_client;
     dev::eth::TransactionQueue& m_tq;  // transactions ready to go to consensus
     std::shared_ptr< InstanceMonitor > m_instanceMonitor;
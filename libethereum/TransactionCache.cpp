@@ -0,0 +1,64 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file TransactionCache.cpp
+ * @date 2026
+ */
+
+#include "TransactionCache.h"
+
+#include <libdevcore/SHA3.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+size_t dev::eth::c_transactionCacheSize = 16384;
+
+TransactionCache::TransactionCache( size_t _capacity, unsigned _shards )
+    : m_transactions( _capacity, _shards ) {}
+
+Transaction TransactionCache::decode( bytesConstRef _rlp ) {
+    return decode( _rlp, sha3( _rlp ) );
+}
+
+Transaction TransactionCache::decode( bytesConstRef _rlp, h256 const& _hash ) {
+    if ( std::optional< Transaction > cached = find( _hash ) )
+        return *cached;
+
+    Transaction t( _rlp, CheckTransaction::Everything );
+    // non-canonical RLP hashes differently from the transaction
+    insert( t.sha3(), t );
+    return t;
+}
+
+bool TransactionCache::insert( Transaction const& _t ) {
+    return insert( _t.sha3(), _t );
+}
+
+bool TransactionCache::insert( h256 const& _hash, Transaction const& _t ) {
+    if ( !m_transactions.enabled() || _t.isInvalid() )
+        return false;
+    try {
+        _t.sender();
+    } catch ( ... ) {
+        return false;
+    }
+    return m_transactions.insert( _hash, _t );
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file TransactionCache.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "Transaction.h"
+
+#include <libdevcore/ShardedLruCache.h>
+
+#include <optional>
+
+namespace dev {
+namespace eth {
+
+/// Max number of decoded transactions kept by a TransactionCache, 0 to disable it
+extern size_t c_transactionCacheSize;
+
+/**
+ * @brief Decoded transactions with recovered senders, keyed by transaction hash.
+ * Lets the broadcast receive path, the transaction queue and block creation share one decoding
+ * and one signature recovery per transaction. Least recently used entries are evicted.
+ * @threadsafe
+ */
+class TransactionCache {
+public:
+    using Stats = ShardedLruCache< h256, Transaction >::Stats;
+
+    explicit TransactionCache( size_t _capacity = c_transactionCacheSize, unsigned _shards = 16 );
+
+    /// @returns the transaction encoded in _rlp with its sender recovered. Decodes it only if it
+    /// is not cached yet. Throws like Transaction( _rlp, CheckTransaction::Everything ).
+    Transaction decode( bytesConstRef _rlp );
+
+    /// Same as decode( _rlp ) if the hash of _rlp is already known
+    Transaction decode( bytesConstRef _rlp, h256 const& _hash );
+
+    /// @returns cached transaction with hash _hash
+    std::optional< Transaction > find( h256 const& _hash ) { return m_transactions.find( _hash ); }
+
+    /// Caches _t, recovering its sender if needed. Transactions with invalid signatures are not
+    /// cached. @returns true if _t was not cached before.
+    bool insert( Transaction const& _t );
+    bool insert( h256 const& _hash, Transaction const& _t );
+
+    void remove( h256 const& _hash ) { m_transactions.remove( _hash ); }
+
+    bool contains( h256 const& _hash ) const { return m_transactions.contains( _hash ); }
+
+    Stats stats() const { return m_transactions.stats(); }
+
+    size_t capacity() const { return m_transactions.capacity(); }
+
+private:
+    ShardedLruCache< h256, Transaction > m_transactions;
+};
+
+}  // namespace eth
+}  // namespace dev
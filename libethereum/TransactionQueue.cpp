@@ -27,6 +27,7 @@
 #include <libdevcore/Log.h>
 #include <libethcore/Exceptions.h>
 
+#include <future>
 #include <list>
 #include <thread>
 #include <vector>
@@ -38,21 +39,53 @@ using namespace dev::eth;
 namespace {
 constexpr size_t c_maxVerificationQueueSize = 8192;
 constexpr size_t c_maxDroppedTransactionCount = 1024;
+/// Max number of enqueued transactions a verifier inserts under one lock
+constexpr size_t c_maxVerifierBatchSize = 64;
+/// Fewer recoveries are not worth handing to another thread
+constexpr size_t c_minRecoveriesPerThread = 4;
 }  // namespace
 
-TransactionQueue::TransactionQueue( unsigned _limit, unsigned _futureLimit )
+unsigned dev::eth::c_transactionVerifierThreads = 2;
+unsigned dev::eth::c_transactionQueueShards = 16;
+
+bool TransactionQueue::PriorityCompare::operator()(
+    VerifiedTransaction const& _first, VerifiedTransaction const& _second ) const {
+    int cat1 = _first.category;
+    int cat2 = _second.category;
+
+    // HACK special case for "dummy" transaction - it is always to the left of others with
+    // the same category
+    if ( !_first.transaction && _second.transaction )
+        return cat1 >= cat2;
+    else if ( _first.transaction && !_second.transaction )
+        return cat1 > cat2;
+    else if ( !_first.transaction && !_second.transaction )
+        return cat1 < cat2;
+
+    u256 const& height1 =
+        _first.transaction.nonce() -
+        shard.currentByAddressAndNonce[_first.transaction.sender()].begin()->first;
+
+    u256 const& height2 =
+        _second.transaction.nonce() -
+        shard.currentByAddressAndNonce[_second.transaction.sender()].begin()->first;
+
+    return cat1 > cat2 ||
+           ( cat1 == cat2 &&
+               ( height1 < height2 ||
+                   ( height1 == height2 &&
+                       _first.transaction.gasPrice() > _second.transaction.gasPrice() ) ) );
+}
+
+TransactionQueue::TransactionQueue( unsigned _limit, unsigned _futureLimit, unsigned _shards )
     : m_dropped{ c_maxDroppedTransactionCount },
-      m_current( PriorityCompare{ *this } ),
       m_limit( _limit ),
       m_futureLimit( _futureLimit ),
       m_aborting( false ) {
-    m_readyCondNotifier = this->onReady( [this]() {
-        this->m_cond.notify_all();
-        return;
-    } );
+    for ( unsigned i = 0; i < std::max( _shards, 1U ); ++i )
+        m_shards.emplace_back( new Shard );
 
-    unsigned verifierThreads = 0;  // std::max( thread::hardware_concurrency(), 3U ) - 2U;
-    for ( unsigned i = 0; i < verifierThreads; ++i )
+    for ( unsigned i = 0; i < c_transactionVerifierThreads; ++i )
         m_verifiers.emplace_back( [this, i]() {
             setThreadName( "txcheck" + toString( i ) );
             this->verifierBody();
@@ -69,6 +102,7 @@ void TransactionQueue::HandleDestruction() {
         DEV_GUARDED( x_queue ) {
             m_aborting = true;
             m_queueReady.notify_all();
+            m_changed.notify_all();
             for ( auto& i : m_verifiers ) {
                 try {
                     if ( i.joinable() )
@@ -88,76 +122,196 @@ void TransactionQueue::HandleDestruction() {
     }
 }
 
+size_t TransactionQueue::shardIndex( Address const& _a ) const {
+    return std::hash< Address >{}( _a ) % m_shards.size();
+}
+
+bool TransactionQueue::isBefore(
+    VerifiedTransaction const& _first, VerifiedTransaction const& _second ) {
+    // the same order as PriorityCompare, with heights fixed when transactions became current
+    if ( _first.category != _second.category )
+        return _first.category > _second.category;
+    if ( _first.height != _second.height )
+        return _first.height < _second.height;
+    if ( _first.transaction.gasPrice() != _second.transaction.gasPrice() )
+        return _first.transaction.gasPrice() > _second.transaction.gasPrice();
+    return _first.sequence < _second.sequence;
+}
+
 ImportResult TransactionQueue::import(
     bytesConstRef _transactionRLP, IfDropped _ik, bool _isFuture ) {
     try {
-        Transaction t = Transaction( _transactionRLP, CheckTransaction::Everything );
-        return import( t, _ik, _isFuture );
+        return import( m_decoded.decode( _transactionRLP ), _ik, _isFuture );
     } catch ( Exception const& ) {
         return ImportResult::Malformed;
     }
 }
 
-ImportResult TransactionQueue::check_WITH_LOCK( h256 const& _h, IfDropped _ik ) {
-    if ( m_known.count( _h ) )
+ImportResult TransactionQueue::check_WITH_LOCK( Shard& _shard, h256 const& _h, IfDropped _ik ) {
+    if ( _shard.known.count( _h ) )
         return ImportResult::AlreadyKnown;
 
+    Guard l( x_dropped );
     if ( m_dropped.touch( _h ) && _ik == IfDropped::Ignore )
         return ImportResult::AlreadyInChain;
 
     return ImportResult::Success;
 }
 
-ImportResult TransactionQueue::import(
-    Transaction const& _transaction, IfDropped _ik, bool _isFuture ) {
+ImportResult TransactionQueue::importVerified_WITH_LOCK(
+    Shard& _shard, Transaction const& _transaction, IfDropped _ik, bool _isFuture ) {
     if ( _transaction.hasZeroSignature() )
         return ImportResult::ZeroSignature;
-    // Check if we already know this transaction.
-    h256 h = _transaction.sha3( WithSignature );
 
-    ImportResult ret;
-    {
-        MICROPROFILE_SCOPEI( "TransactionQueue", "import", MP_THISTLE );
-        // WriteGuard l2( m_lock );
-        UpgradableGuard l( m_lock );
+    try {
+        // Check if we already know this transaction.
+        h256 h = _transaction.sha3( WithSignature );
 
         // HACK remove it from future and re-insert (allows to "push" stuck transaction)
-        auto fs = m_future.find( _transaction.from() );
-        if ( fs != m_future.end() ) {
+        auto fs = _shard.future.find( _transaction.from() );
+        if ( fs != _shard.future.end() ) {
             auto t = fs->second.find( _transaction.nonce() );
 
             // if transaction found:
             if ( t != fs->second.end() ) {
-                //                if( t == fs->second.begin() ){
-                UpgradeGuard ul( l );
                 --m_futureSize;
                 auto erasedHash = t->second.transaction.sha3();
                 LOG( m_loggerDetail ) << "Re-inserting future transaction " << erasedHash;
-                m_known.erase( erasedHash );
+                _shard.known.erase( erasedHash );
                 fs->second.erase( t->second.transaction.nonce() );
                 if ( fs->second.empty() )
-                    m_future.erase( fs );
-                //                }
+                    _shard.future.erase( fs );
             }  // if found
         }      // if fs->second
 
-        auto ir = check_WITH_LOCK( h, _ik );
+        auto ir = check_WITH_LOCK( _shard, h, _ik );
         if ( ir != ImportResult::Success )
             return ir;
 
-        {
-            _transaction.safeSender();  // Perform EC recovery outside of the write lock
+        ImportResult ret = manageImport_WITH_LOCK( _shard, h, _transaction );
+        if ( ret == ImportResult::Success )
+            m_decoded.insert( h, _transaction );
+        if ( _isFuture )
+            setFuture_WITH_LOCK( _shard, h );
+        return ret;
+    } catch ( Exception const& _e ) {
+        // sender could not be recovered
+        LOG( m_loggerDetail ) << "Ignoring invalid transaction: " << diagnostic_information( _e );
+        return ImportResult::Malformed;
+    } catch ( std::exception const& _e ) {
+        LOG( m_loggerDetail ) << "Ignoring invalid transaction: " << _e.what();
+        return ImportResult::Malformed;
+    }
+}
+
+ImportResult TransactionQueue::import(
+    Transaction const& _transaction, IfDropped _ik, bool _isFuture ) {
+    if ( _transaction.hasZeroSignature() )
+        return ImportResult::ZeroSignature;
 
-            UpgradeGuard ul( l );
-            ret = manageImport_WITH_LOCK( h, _transaction );
+    // Perform EC recovery before taking the lock of the sender's shard
+    Shard& shard = *m_shards[shardIndex( _transaction.safeSender() )];
 
-            if ( _isFuture )
-                setFuture_WITH_LOCK( h );
-        }
+    ImportResult ret;
+    {
+        MICROPROFILE_SCOPEI( "TransactionQueue", "import", MP_THISTLE );
+        WriteGuard l( shard.lock );
+        ret = importVerified_WITH_LOCK( shard, _transaction, _ik, _isFuture );
+    }
+    enforceLimit();
+    return ret;
+}
+
+std::vector< ImportResult > TransactionQueue::importBatch(
+    Transactions const& _transactions, IfDropped _ik, bool _isFuture ) {
+    recoverSenders( _transactions );
+    return importVerified( _transactions, _ik, _isFuture );
+}
+
+std::vector< ImportResult > TransactionQueue::importVerified(
+    Transactions const& _transactions, IfDropped _ik, bool _isFuture ) {
+    MICROPROFILE_SCOPEI( "TransactionQueue", "importVerified", MP_THISTLE );
+    std::vector< ImportResult > ret( _transactions.size(), ImportResult::Success );
+
+    std::vector< std::vector< size_t > > byShard( m_shards.size() );
+    for ( size_t i = 0; i < _transactions.size(); ++i )
+        byShard[shardIndex( _transactions[i].safeSender() )].push_back( i );
+
+    for ( size_t s = 0; s < byShard.size(); ++s ) {
+        if ( byShard[s].empty() )
+            continue;
+        Shard& shard = *m_shards[s];
+        WriteGuard l( shard.lock );
+        for ( size_t i : byShard[s] )
+            ret[i] = importVerified_WITH_LOCK( shard, _transactions[i], _ik, _isFuture );
     }
+    enforceLimit();
     return ret;
 }
 
+void TransactionQueue::recoverSenders( Transactions const& _transactions ) {
+    MICROPROFILE_SCOPEI( "TransactionQueue", "recoverSenders", MP_THISTLE );
+    std::atomic< size_t > next{ 0 };
+    auto recoverNext = [&]() {
+        for ( size_t i = next++; i < _transactions.size(); i = next++ )
+            _transactions[i].safeSender();
+    };
+
+    std::vector< std::future< void > > helpers;
+    {
+        Guard l( x_queue );
+        size_t helperCount = std::min(
+            m_verifiers.size(), _transactions.size() / c_minRecoveriesPerThread );
+        for ( size_t i = 0; !m_aborting && i < helperCount; ++i ) {
+            auto done = std::make_shared< std::promise< void > >();
+            helpers.push_back( done->get_future() );
+            m_recoveryJobs.emplace_back( [recoverNext, done]() {
+                recoverNext();
+                done->set_value();
+            } );
+        }
+    }
+    if ( !helpers.empty() )
+        m_queueReady.notify_all();
+
+    recoverNext();
+    for ( auto& helper : helpers )
+        helper.wait();
+}
+
+void TransactionQueue::enforceLimit() {
+    if ( m_currentSize <= m_limit )
+        return;
+
+    MICROPROFILE_SCOPEI( "TransactionQueue", "enforceLimit", MP_LIGHTGOLDENRODYELLOW );
+    // shards are locked one at a time, so imports into other shards go on meanwhile
+    while ( m_currentSize > m_limit ) {
+        size_t worstShard = 0;
+        std::unique_ptr< VerifiedTransaction > worst;
+        for ( size_t i = 0; i < m_shards.size(); ++i ) {
+            Shard const& shard = *m_shards[i];
+            ReadGuard l( shard.lock );
+            if ( !shard.current.empty() &&
+                 ( !worst || isBefore( *worst, *shard.current.rbegin() ) ) ) {
+                worst.reset( new VerifiedTransaction( *shard.current.rbegin() ) );
+                worstShard = i;
+            }
+        }
+        if ( !worst )
+            break;
+
+        Shard& shard = *m_shards[worstShard];
+        WriteGuard l( shard.lock );
+        h256 const h = worst->transaction.sha3();
+        // look again if the shard has changed or another thread has dropped enough
+        if ( m_currentSize <= m_limit || shard.current.empty() ||
+             shard.current.rbegin()->transaction.sha3() != h )
+            continue;
+        LOG( m_loggerDetail ) << "Dropping out of bounds transaction " << h;
+        remove_WITH_LOCK( shard, h );
+    }
+}
+
 Transactions TransactionQueue::topTransactions( unsigned _limit, h256Hash const& _avoid ) const {
     return topTransactions(
         _limit, [&]( const Transaction& t ) -> bool { return _avoid.count( t.sha3() ) == 0; } );
@@ -171,82 +325,123 @@ Transactions TransactionQueue::topTransactions_WITH_LOCK(
 
 Transactions TransactionQueue::topTransactions(
     unsigned _limit, int _maxCategory, int _setCategory ) {
-    ReadGuard l( m_lock );
-    return topTransactions_WITH_LOCK( _limit, _maxCategory, _setCategory );
+    Transactions topTransactions;
+    {
+        auto locks = lockShards< ReadGuard >();
+        topTransactions = topTransactions_WITH_LOCK( _limit, _maxCategory );
+    }
+    if ( _setCategory < 0 )
+        return topTransactions;
+
+    // categories are set one shard at a time, so imports into other shards go on meanwhile;
+    // transactions dropped after they were read are skipped
+    std::vector< std::vector< h256 > > byShard( m_shards.size() );
+    for ( auto const& t : topTransactions )
+        byShard[shardIndex( t.safeSender() )].push_back( t.sha3() );
+
+    bool changed = false;
+    for ( size_t i = 0; i < m_shards.size(); ++i ) {
+        if ( byShard[i].empty() )
+            continue;
+        Shard& shard = *m_shards[i];
+        WriteGuard l( shard.lock );
+        for ( h256 const& h : byShard[i] ) {
+            auto t = shard.currentByHash.find( h );
+            if ( t == shard.currentByHash.end() || t->second->category == _setCategory )
+                continue;
+            auto queueNode = shard.current.extract( t->second );
+            queueNode.value().category = _setCategory;
+            shard.current.insert( std::move( queueNode ) );
+            changed = true;
+        }
+    }
+    if ( changed )
+        noteChanged_WITH_LOCK();
+
+    return topTransactions;
 }
 
 Transactions TransactionQueue::topTransactions_WITH_LOCK(
-    unsigned _limit, int _maxCategory, int _setCategory ) {
+    unsigned _limit, int _maxCategory ) const {
     MICROPROFILE_SCOPEI( "TransactionQueue", "topTransactions_WITH_LOCK_cat", MP_PAPAYAWHIP );
 
     Transactions topTransactions;
-    std::vector< PriorityQueue::node_type > found;
+    if ( _limit == 0 )
+        return topTransactions;
 
     VerifiedTransaction dummy = VerifiedTransaction( Transaction() );
     dummy.category = _maxCategory;
 
-    PriorityQueue::iterator my_begin = m_current.lower_bound( dummy );
-
-    for ( PriorityQueue::iterator transaction_ptr = my_begin;
-          topTransactions.size() < _limit && transaction_ptr != m_current.end();
-          ++transaction_ptr ) {
-        topTransactions.push_back( transaction_ptr->transaction );
-        if ( _setCategory >= 0 ) {
-            found.push_back( m_current.extract( transaction_ptr ) );
-        }
-    }
+    std::vector< PriorityQueue::iterator > my_begins;
+    for ( auto const& shard : m_shards )
+        my_begins.push_back( shard->current.lower_bound( dummy ) );
 
-    // set all at once
-    if ( _setCategory >= 0 ) {
-        for ( PriorityQueue::node_type& queueNode : found ) {
-            queueNode.value().category = _setCategory;
-            m_current.insert( std::move( queueNode ) );
-        }
-    }
+    forEachCurrent_WITH_LOCK( my_begins, [&]( size_t, PriorityQueue::iterator _transaction ) {
+        topTransactions.push_back( _transaction->transaction );
+        return topTransactions.size() < _limit;
+    } );
 
     return topTransactions;
 }
 
 const h256Hash TransactionQueue::knownTransactions() const {
     h256Hash rv;
-    {  // block
-        ReadGuard l( m_lock );
-        rv = m_known;
-    }  // block
+    for ( auto const& shard : m_shards ) {
+        ReadGuard l( shard->lock );
+        rv.insert( shard->known.begin(), shard->known.end() );
+    }
     return rv;
 }
 
+int TransactionQueue::getCategory( Transaction const& _t ) const {
+    Shard const& shard = *m_shards[shardIndex( _t.safeSender() )];
+    ReadGuard l( shard.lock );
+    auto it = shard.currentByHash.find( _t.sha3() );
+    if ( it != shard.currentByHash.end() )
+        return it->second->category;
+    return -1;
+}
+
+TransactionQueue::Status TransactionQueue::status() const {
+    Status ret;
+    DEV_GUARDED( x_queue ) { ret.unverified = m_unverified.size(); }
+    DEV_GUARDED( x_dropped ) { ret.dropped = m_dropped.size(); }
+    ret.current = 0;
+    ret.future = 0;
+    for ( auto const& shard : m_shards ) {
+        ReadGuard l( shard->lock );
+        ret.current += shard->currentByHash.size();
+        ret.future += shard->future.size();
+    }
+    return ret;
+}
+
 ImportResult TransactionQueue::manageImport_WITH_LOCK(
-    h256 const& _h, Transaction const& _transaction ) {
+    Shard& _shard, h256 const& _h, Transaction const& _transaction ) {
     try {
         assert( _h == _transaction.sha3() );
         // Remove any prior transaction with the same nonce but a lower gas price.
         // Bomb out if there's a prior transaction with higher gas price.
-        auto cs = m_currentByAddressAndNonce.find( _transaction.from() );
-        if ( cs != m_currentByAddressAndNonce.end() ) {
+        auto cs = _shard.currentByAddressAndNonce.find( _transaction.from() );
+        if ( cs != _shard.currentByAddressAndNonce.end() ) {
             auto t = cs->second.find( _transaction.nonce() );
             if ( t != cs->second.end() ) {
                 return ImportResult::SameNonceAlreadyInQueue;
             }
         }
 
-        auto fs = m_future.find( _transaction.from() );
-        if ( fs != m_future.end() ) {
+        auto fs = _shard.future.find( _transaction.from() );
+        if ( fs != _shard.future.end() ) {
             auto t = fs->second.find( _transaction.nonce() );
             if ( t != fs->second.end() ) {
                 return ImportResult::SameNonceAlreadyInQueue;
             }  // if found
         }      // if fs->second
 
-        // If valid, append to transactions.
-        insertCurrent_WITH_LOCK( make_pair( _h, _transaction ) );
+        // If valid, append to transactions. Out of bounds ones are dropped by enforceLimit()
+        insertCurrent_WITH_LOCK( _shard, make_pair( _h, _transaction ) );
         LOG( m_loggerDetail ) << "Queued vaguely legit-looking transaction " << _h;
 
-        while ( m_current.size() > m_limit ) {
-            LOG( m_loggerDetail ) << "Dropping out of bounds transaction " << _h;
-            remove_WITH_LOCK( m_current.rbegin()->transaction.sha3() );
-        }
-
         m_onReady();
     } catch ( Exception const& _e ) {
         LOG( m_loggerDetail ) << "Ignoring invalid transaction: " << diagnostic_information( _e );
@@ -260,142 +455,166 @@ ImportResult TransactionQueue::manageImport_WITH_LOCK(
 }
 
 u256 TransactionQueue::maxNonce( Address const& _a ) const {
-    ReadGuard l( m_lock );
-    return maxNonce_WITH_LOCK( _a );
+    Shard const& shard = *m_shards[shardIndex( _a )];
+    ReadGuard l( shard.lock );
+    return maxNonce_WITH_LOCK( shard, _a );
 }
 
 u256 TransactionQueue::maxCurrentNonce( Address const& _a ) const {
-    ReadGuard l( m_lock );
-    return maxCurrentNonce_WITH_LOCK( _a );
+    Shard const& shard = *m_shards[shardIndex( _a )];
+    ReadGuard l( shard.lock );
+    return maxCurrentNonce_WITH_LOCK( shard, _a );
 }
 
-u256 TransactionQueue::maxNonce_WITH_LOCK( Address const& _a ) const {
+u256 TransactionQueue::maxNonce_WITH_LOCK( Shard const& _shard, Address const& _a ) const {
     u256 ret = 0;
-    auto cs = m_currentByAddressAndNonce.find( _a );
-    if ( cs != m_currentByAddressAndNonce.end() && !cs->second.empty() )
+    auto cs = _shard.currentByAddressAndNonce.find( _a );
+    if ( cs != _shard.currentByAddressAndNonce.end() && !cs->second.empty() )
         ret = cs->second.rbegin()->first + 1;
-    auto fs = m_future.find( _a );
-    if ( fs != m_future.end() && !fs->second.empty() )
+    auto fs = _shard.future.find( _a );
+    if ( fs != _shard.future.end() && !fs->second.empty() )
         ret = std::max( ret, fs->second.rbegin()->first + 1 );
     return ret;
 }
 
-u256 TransactionQueue::maxCurrentNonce_WITH_LOCK( Address const& _a ) const {
+u256 TransactionQueue::maxCurrentNonce_WITH_LOCK( Shard const& _shard, Address const& _a ) const {
     u256 ret = 0;
-    auto cs = m_currentByAddressAndNonce.find( _a );
-    if ( cs != m_currentByAddressAndNonce.end() && !cs->second.empty() )
+    auto cs = _shard.currentByAddressAndNonce.find( _a );
+    if ( cs != _shard.currentByAddressAndNonce.end() && !cs->second.empty() )
         ret = cs->second.rbegin()->first + 1;
     return ret;
 }
 
-void TransactionQueue::insertCurrent_WITH_LOCK( std::pair< h256, Transaction > const& _p ) {
-    if ( m_currentByHash.count( _p.first ) ) {
+void TransactionQueue::insertCurrent_WITH_LOCK(
+    Shard& _shard, std::pair< h256, Transaction > const& _p ) {
+    if ( _shard.currentByHash.count( _p.first ) ) {
         cwarn << "Transaction hash" << _p.first << "already in current?!";
         return;
     }
 
     Transaction const& t = _p.second;
     // Insert into current
-    auto inserted = m_currentByAddressAndNonce[t.from()].insert(
-        std::make_pair( t.nonce(), PriorityQueue::iterator() ) );
-    PriorityQueue::iterator handle = m_current.emplace( VerifiedTransaction( t ) );
+    auto& nonces = _shard.currentByAddressAndNonce[t.from()];
+    auto inserted = nonces.insert( std::make_pair( t.nonce(), PriorityQueue::iterator() ) );
+    VerifiedTransaction verified( t );
+    verified.height = t.nonce() - nonces.begin()->first;
+    verified.sequence = m_sequence++;
+    PriorityQueue::iterator handle = _shard.current.emplace( std::move( verified ) );
     inserted.first->second = handle;
-    m_currentByHash[_p.first] = handle;
+    _shard.currentByHash[_p.first] = handle;
+    ++m_currentSize;
 
     // Move following transactions from future to current
-    makeCurrent_WITH_LOCK( t );
-    m_known.insert( _p.first );
+    makeCurrent_WITH_LOCK( _shard, t );
+    _shard.known.insert( _p.first );
+    noteChanged_WITH_LOCK();
 }
 
-bool TransactionQueue::remove_WITH_LOCK( h256 const& _txHash ) {
+bool TransactionQueue::remove_WITH_LOCK( Shard& _shard, h256 const& _txHash ) {
     MICROPROFILE_SCOPEI( "TransactionQueue", "remove_WITH_LOCK", MP_LIGHTGOLDENRODYELLOW );
 
-    auto t = m_currentByHash.find( _txHash );
-    if ( t == m_currentByHash.end() )
+    auto t = _shard.currentByHash.find( _txHash );
+    if ( t == _shard.currentByHash.end() )
         return false;
 
     Address from = ( *t->second ).transaction.from();
-    auto it = m_currentByAddressAndNonce.find( from );
-    assert( it != m_currentByAddressAndNonce.end() );
+    auto it = _shard.currentByAddressAndNonce.find( from );
+    assert( it != _shard.currentByAddressAndNonce.end() );
     it->second.erase( ( *t->second ).transaction.nonce() );
-    m_current.erase( t->second );
-    m_currentByHash.erase( t );
+    _shard.current.erase( t->second );
+    _shard.currentByHash.erase( t );
     if ( it->second.empty() )
-        m_currentByAddressAndNonce.erase( it );
-    m_known.erase( _txHash );
+        _shard.currentByAddressAndNonce.erase( it );
+    _shard.known.erase( _txHash );
+    --m_currentSize;
+    noteChanged_WITH_LOCK();
     return true;
 }
 
 unsigned TransactionQueue::waiting( Address const& _a ) const {
-    ReadGuard l( m_lock );
+    Shard const& shard = *m_shards[shardIndex( _a )];
+    ReadGuard l( shard.lock );
     unsigned ret = 0;
-    auto cs = m_currentByAddressAndNonce.find( _a );
-    if ( cs != m_currentByAddressAndNonce.end() )
+    auto cs = shard.currentByAddressAndNonce.find( _a );
+    if ( cs != shard.currentByAddressAndNonce.end() )
         ret = cs->second.size();
-    auto fs = m_future.find( _a );
-    if ( fs != m_future.end() )
+    auto fs = shard.future.find( _a );
+    if ( fs != shard.future.end() )
         ret += fs->second.size();
     return ret;
 }
 
-void TransactionQueue::setFuture_WITH_LOCK( h256 const& _txHash ) {
-    auto it = m_currentByHash.find( _txHash );
-    if ( it == m_currentByHash.end() )
+void TransactionQueue::setFuture_WITH_LOCK( Shard& _shard, h256 const& _txHash ) {
+    auto it = _shard.currentByHash.find( _txHash );
+    if ( it == _shard.currentByHash.end() )
         return;
 
     VerifiedTransaction const& st = *( it->second );
 
     Address from = st.transaction.from();
-    auto& queue = m_currentByAddressAndNonce[from];
-    auto& target = m_future[from];
+    auto& queue = _shard.currentByAddressAndNonce[from];
+    auto& target = _shard.future[from];
     auto cutoff = queue.lower_bound( st.transaction.nonce() );
+    if ( cutoff != queue.end() )
+        noteChanged_WITH_LOCK();
     for ( auto m = cutoff; m != queue.end(); ++m ) {
         VerifiedTransaction& t = const_cast< VerifiedTransaction& >(
             *( m->second ) );  // set has only const iterators. Since we are moving out of container
                                // that's fine
-        m_currentByHash.erase( t.transaction.sha3() );
+        _shard.currentByHash.erase( t.transaction.sha3() );
         target.emplace( t.transaction.nonce(), move( t ) );
-        m_current.erase( m->second );
+        _shard.current.erase( m->second );
+        --m_currentSize;
         ++m_futureSize;
     }
     queue.erase( cutoff, queue.end() );
     if ( queue.empty() )
-        m_currentByAddressAndNonce.erase( from );
+        _shard.currentByAddressAndNonce.erase( from );
 
-    while ( m_futureSize > m_futureLimit ) {
+    while ( m_futureSize > m_futureLimit && !_shard.future.empty() ) {
         // TODO: priority queue for future transactions
-        // For now just drop random chain end
+        // For now just drop chain end of this sender, or of another one in the shard
+        auto fs = _shard.future.find( from );
+        if ( fs == _shard.future.end() )
+            fs = _shard.future.begin();
         --m_futureSize;
-        auto erasedHash = m_future.begin()->second.rbegin()->second.transaction.sha3();
+        auto erasedHash = fs->second.rbegin()->second.transaction.sha3();
         LOG( m_loggerDetail ) << "Dropping out of bounds future transaction " << erasedHash;
-        m_known.erase( erasedHash );
-        m_future.begin()->second.erase( --m_future.begin()->second.end() );
-        if ( m_future.begin()->second.empty() )
-            m_future.erase( m_future.begin() );
+        _shard.known.erase( erasedHash );
+        fs->second.erase( --fs->second.end() );
+        if ( fs->second.empty() )
+            _shard.future.erase( fs );
     }
 }
 
 void TransactionQueue::setFuture( h256 const& _txHash ) {
-    WriteGuard l( m_lock );
-    return setFuture_WITH_LOCK( _txHash );
+    for ( auto const& shard : m_shards ) {
+        WriteGuard l( shard->lock );
+        if ( shard->currentByHash.count( _txHash ) )
+            return setFuture_WITH_LOCK( *shard, _txHash );
+    }
 }
 
-void TransactionQueue::makeCurrent_WITH_LOCK( Transaction const& _t ) {
+void TransactionQueue::makeCurrent_WITH_LOCK( Shard& _shard, Transaction const& _t ) {
     MICROPROFILE_SCOPEI( "TransactionQueue", "makeCurrent_WITH_LOCK", MP_DEEPSKYBLUE );
 
     bool newCurrent = false;
-    auto fs = m_future.find( _t.from() );
-    if ( fs != m_future.end() ) {
+    auto fs = _shard.future.find( _t.from() );
+    if ( fs != _shard.future.end() ) {
         u256 nonce = _t.nonce() + 1;
         auto fb = fs->second.find( nonce );
         if ( fb != fs->second.end() ) {
             auto ft = fb;
+            auto& nonces = _shard.currentByAddressAndNonce[_t.from()];
             while ( ft != fs->second.end() && ft->second.transaction.nonce() == nonce ) {
-                auto inserted = m_currentByAddressAndNonce[_t.from()].insert(
+                auto inserted = nonces.insert(
                     std::make_pair( ft->second.transaction.nonce(), PriorityQueue::iterator() ) );
-                PriorityQueue::iterator handle = m_current.emplace( move( ft->second ) );
+                ft->second.height = nonce - nonces.begin()->first;
+                ft->second.sequence = m_sequence++;
+                PriorityQueue::iterator handle = _shard.current.emplace( move( ft->second ) );
                 inserted.first->second = handle;
-                m_currentByHash[( *handle ).transaction.sha3()] = handle;
+                _shard.currentByHash[( *handle ).transaction.sha3()] = handle;
+                ++m_currentSize;
                 --m_futureSize;
                 ++ft;
                 ++nonce;
@@ -403,49 +622,145 @@ void TransactionQueue::makeCurrent_WITH_LOCK( Transaction const& _t ) {
             }
             fs->second.erase( fb, ft );
             if ( fs->second.empty() )
-                m_future.erase( _t.from() );
+                _shard.future.erase( _t.from() );
         }
     }
 
-    if ( newCurrent )
+    if ( newCurrent ) {
+        noteChanged_WITH_LOCK();
         m_onReady();
+    }
 }
 
 void TransactionQueue::drop( h256 const& _txHash ) {
-    UpgradableGuard l( m_lock );
+    for ( auto const& shard : m_shards ) {
+        UpgradableGuard l( shard->lock );
+
+        if ( !shard->known.count( _txHash ) )
+            continue;
+
+        UpgradeGuard ul( l );
+        DEV_GUARDED( x_dropped ) { m_dropped.insert( _txHash, true ); }
+        remove_WITH_LOCK( *shard, _txHash );
+        return;
+    }
+}
+
+void TransactionQueue::drop( h256Hash const& _txHashes ) {
+    if ( _txHashes.empty() )
+        return;
+
+    for ( auto const& shard : m_shards ) {
+        WriteGuard l( shard->lock );
+        for ( h256 const& h : _txHashes ) {
+            if ( !shard->known.count( h ) )
+                continue;
+            DEV_GUARDED( x_dropped ) { m_dropped.insert( h, true ); }
+            remove_WITH_LOCK( *shard, h );
+        }
+    }
+}
 
-    if ( !m_known.count( _txHash ) )
+void TransactionQueue::setVerifiedOn( h256s const& _txHashes, int64_t _blockNumber ) {
+    if ( _txHashes.empty() )
         return;
 
-    UpgradeGuard ul( l );
-    m_dropped.insert( _txHash, true );
-    remove_WITH_LOCK( _txHash );
+    for ( auto const& shard : m_shards ) {
+        WriteGuard l( shard->lock );
+        bool changed = false;
+        for ( h256 const& h : _txHashes ) {
+            auto it = shard->currentByHash.find( h );
+            if ( it == shard->currentByHash.end() )
+                continue;
+            it->second->transaction.verifiedOn = _blockNumber;
+            changed = true;
+        }
+        // snapshots keep their own copies of verifiedOn
+        if ( changed )
+            noteChanged_WITH_LOCK();
+    }
 }
 
 void TransactionQueue::dropGood( Transaction const& _t ) {
     MICROPROFILE_SCOPEI( "TransactionQueue", "dropGood", MP_CORNSILK );
+    h256 h = _t.sha3();
+
+    if ( _t.isInvalid() ) {
+        for ( auto const& shard : m_shards ) {
+            WriteGuard l( shard->lock );
+            if ( remove_WITH_LOCK( *shard, h ) )
+                return;
+        }
+        return;
+    }
+
+    Shard& shard = *m_shards[shardIndex( _t.from() )];
     MICROPROFILE_ENTERI( "TransactionQueue", "lock", MP_OLDLACE );
-    WriteGuard l( m_lock );
+    WriteGuard l( shard.lock );
     MICROPROFILE_LEAVE();
 
-    if ( !_t.isInvalid() )
-        makeCurrent_WITH_LOCK( _t );
+    makeCurrent_WITH_LOCK( shard, _t );
 
-    if ( !m_known.count( _t.sha3() ) )
+    if ( !shard.known.count( h ) )
         return;
 
-    remove_WITH_LOCK( _t.sha3() );
+    remove_WITH_LOCK( shard, h );
 }
 
 void TransactionQueue::clear() {
-    WriteGuard l( m_lock );
-    m_known.clear();
-    m_current.clear();
-    m_dropped.clear();
-    m_currentByAddressAndNonce.clear();
-    m_currentByHash.clear();
-    m_future.clear();
+    auto locks = lockShards< WriteGuard >();
+    for ( auto const& shard : m_shards ) {
+        shard->known.clear();
+        shard->current.clear();
+        shard->currentByAddressAndNonce.clear();
+        shard->currentByHash.clear();
+        shard->future.clear();
+    }
+    DEV_GUARDED( x_dropped ) { m_dropped.clear(); }
+    m_currentSize = 0;
     m_futureSize = 0;
+    noteChanged_WITH_LOCK();
+}
+
+void TransactionQueue::noteChanged_WITH_LOCK() {
+    {
+        Guard l( x_changed );
+        ++m_version;
+    }
+    m_changed.notify_all();
+}
+
+std::shared_ptr< TransactionQueue::PendingSnapshot const > TransactionQueue::pendingSnapshot()
+    const {
+    std::shared_ptr< PendingSnapshot const > snapshot = std::atomic_load( &m_snapshot );
+    if ( snapshot && snapshot->version == m_version )
+        return snapshot;
+
+    MICROPROFILE_SCOPEI( "TransactionQueue", "pendingSnapshot", MP_AZURE );
+    auto fresh = std::make_shared< PendingSnapshot >();
+    {
+        auto locks = lockShards< ReadGuard >();
+        fresh->version = m_version;
+        std::vector< PriorityQueue::iterator > begins;
+        for ( auto const& shard : m_shards )
+            begins.push_back( shard->current.begin() );
+        forEachCurrent_WITH_LOCK( begins, [&]( size_t, PriorityQueue::iterator _t ) {
+            fresh->transactions.push_back( _t->transaction );
+            fresh->categories.push_back( _t->category );
+            return true;
+        } );
+    }
+    // a concurrent reader may store an older copy, the next call rebuilds it then
+    snapshot = std::move( fresh );
+    std::atomic_store( &m_snapshot, snapshot );
+    return snapshot;
+}
+
+void TransactionQueue::waitForChange(
+    uint64_t _version, std::chrono::milliseconds _timeout ) const {
+    unique_lock< Mutex > l( x_changed );
+    m_changed.wait_for(
+        l, _timeout, [&]() { return m_version != _version || bool( m_aborting ); } );
 }
 
 void TransactionQueue::enqueue( RLP const& _data, h512 const& _nodeId ) {
@@ -468,30 +783,61 @@ void TransactionQueue::enqueue( RLP const& _data, h512 const& _nodeId ) {
 }
 
 void TransactionQueue::verifierBody() {
-    while ( !m_aborting ) {
-        UnverifiedTransaction work;
+    while ( true ) {
+        std::function< void() > job;
+        std::vector< UnverifiedTransaction > work;
 
         {  // block
             MICROPROFILE_SCOPEI( "TransactionQueue", "unique_lock<Mutex> l(x_queue)", MP_DIMGRAY );
             unique_lock< Mutex > l( x_queue );
             {
                 MICROPROFILE_SCOPEI( "TransactionQueue", "m_queueReady.wait", MP_DIMGRAY );
-                m_queueReady.wait(
-                    l, [&]() { return bool( m_aborting ) || ( !m_unverified.empty() ); } );
+                m_queueReady.wait( l, [&]() {
+                    return bool( m_aborting ) || !m_recoveryJobs.empty() ||
+                           !m_unverified.empty();
+                } );
             }
-            if ( m_aborting )
+            // recovery jobs are awaited by importBatch() callers, so finish them even when
+            // aborting
+            if ( !m_recoveryJobs.empty() ) {
+                job = std::move( m_recoveryJobs.front() );
+                m_recoveryJobs.pop_front();
+            } else if ( m_aborting )
                 return;
-            MICROPROFILE_ENTERI(
-                "TransactionQueue", "verifierBody while", MP_LIGHTGOLDENRODYELLOW );
-            work = move( m_unverified.front() );
-            m_unverified.pop_front();
+            else {
+                while ( work.size() < c_maxVerifierBatchSize && !m_unverified.empty() ) {
+                    work.push_back( move( m_unverified.front() ) );
+                    m_unverified.pop_front();
+                }
+            }
         }  // block
 
+        if ( job ) {
+            job();
+            continue;
+        }
+
+        MICROPROFILE_ENTERI( "TransactionQueue", "verifierBody while", MP_LIGHTGOLDENRODYELLOW );
         try {
-            Transaction t( work.transaction, CheckTransaction::Cheap );  // Signature will be
-                                                                         // checked later
-            ImportResult ir = import( t );
-            m_onImport( ir, t.sha3(), work.nodeId );
+            // decode and recover senders without any lock
+            Transactions decoded;
+            std::vector< h512 > nodeIds;
+            for ( UnverifiedTransaction const& w : work ) {
+                try {
+                    Transaction t( w.transaction, CheckTransaction::Cheap );
+                    t.safeSender();
+                    decoded.push_back( std::move( t ) );
+                    nodeIds.push_back( w.nodeId );
+                } catch ( Exception const& ) {
+                    cwarn << "Bad transaction:"
+                          << boost::current_exception_diagnostic_information();
+                }
+            }
+
+            std::vector< ImportResult > results =
+                importVerified( decoded, IfDropped::Ignore, false );
+            for ( size_t i = 0; i < decoded.size(); ++i )
+                m_onImport( results[i], decoded[i].sha3(), nodeIds[i] );
         } catch ( ... ) {
             // should not happen as exceptions are handled in import.
             cwarn << "Bad transaction:" << boost::current_exception_diagnostic_information();
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "Transaction.h"
+#include "TransactionCache.h"
 
 #include <libdevcore/microprofile.h>
 
@@ -35,18 +36,28 @@
 #include <libdevcore/LruCache.h>
 #include <libethcore/Common.h>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 
 namespace dev {
 namespace eth {
 
+/// Number of threads recovering transaction senders of every TransactionQueue, 0 to recover them
+/// in the importing thread
+extern unsigned c_transactionVerifierThreads;
+/// Number of sender shards of a TransactionQueue
+extern unsigned c_transactionQueueShards;
+
 /**
  * @brief A queue of Transactions, each stored as RLP.
  * Maintains a transaction queue sorted by nonce diff and gas price.
+ * Transactions are partitioned into shards by sender, each with its own lock, so imports from
+ * different senders do not wait for each other. Reads merge the shards in priority order.
  * @threadsafe
  */
 class TransactionQueue {
@@ -59,7 +70,9 @@ public:
     /// @brief TransactionQueue
     /// @param _limit Maximum number of pending transactions in the queue.
     /// @param _futureLimit Maximum number of future nonce transactions.
-    TransactionQueue( unsigned _limit = 1024, unsigned _futureLimit = 1024 );
+    /// @param _shards Number of sender shards.
+    TransactionQueue( unsigned _limit = 1024, unsigned _futureLimit = 1024,
+        unsigned _shards = c_transactionQueueShards );
     TransactionQueue( Limits const& _l ) : TransactionQueue( _l.current, _l.future ) {}
     ~TransactionQueue();
     void HandleDestruction();
@@ -86,11 +99,34 @@ public:
     ImportResult import(
         Transaction const& _tx, IfDropped _ik = IfDropped::Ignore, bool _isFuture = false );
 
+    /// Verify and add transactions to the queue synchronously. Senders are recovered on the
+    /// verifier threads, then all transactions are inserted under one lock.
+    /// @param _txs Transactions in the order of import.
+    /// @param _ik Set to Retry to force re-adding a transaction that was previously dropped.
+    /// @param _isFuture True if transactions should be put in future queue
+    /// @returns Import result code for each transaction.
+    std::vector< ImportResult > importBatch(
+        Transactions const& _txs, IfDropped _ik = IfDropped::Ignore, bool _isFuture = false );
+
+    /// Recovers senders of _transactions on the calling thread and on idle verifier threads
+    void recoverSenders( Transactions const& _transactions );
+
     /// Remove transaction from the queue
     /// @param _txHash Transaction hash
     void drop( h256 const& _txHash );
 
-    int getCategory( const h256& hash ) { return m_currentByHash[hash]->category; }
+    /// Remove transactions from the queue under one lock
+    /// @param _txHashes Transaction hashes
+    void drop( h256Hash const& _txHashes );
+
+    /// Remember that transactions were verified against the state of a block
+    /// @param _txHashes Transaction hashes
+    /// @param _blockNumber Value for Transaction::verifiedOn
+    void setVerifiedOn( h256s const& _txHashes, int64_t _blockNumber );
+
+    /// @returns category of a current transaction, -1 if it is not current. Only the shard of
+    /// the sender is looked at, so the sender must be recovered
+    int getCategory( Transaction const& _t ) const;
 
     /// Get number of pending transactions for account.
     /// @returns Pending transaction count.
@@ -110,6 +146,20 @@ public:
     template < class Pred >
     Transactions topTransactions( unsigned _limit, Pred pred ) const;
 
+    /// Immutable copy of the current transactions in priority order
+    struct PendingSnapshot {
+        uint64_t version = 0;      ///< Queue version the copy was made at
+        Transactions transactions;
+        std::vector< int > categories;  ///< Category of each transaction
+    };
+
+    /// Get a copy of the current transactions. It is rebuilt only after the queue changes, so
+    /// readers share one copy and take the lock at most once per change.
+    std::shared_ptr< PendingSnapshot const > pendingSnapshot() const;
+
+    /// Wait until the queue changes after _version or until _timeout passes
+    void waitForChange( uint64_t _version, std::chrono::milliseconds _timeout ) const;
+
     /// Synchronuous version of topTransactions
     template < class... Args >
     Transactions topTransactionsSync( unsigned _limit, Args... args ) const;
@@ -145,15 +195,7 @@ public:
         size_t dropped;
     };
     /// @returns the status of the transaction queue.
-    Status status() const {
-        Status ret;
-        DEV_GUARDED( x_queue ) { ret.unverified = m_unverified.size(); }
-        ReadGuard l( m_lock );
-        ret.dropped = m_dropped.size();
-        ret.current = m_currentByHash.size();
-        ret.future = m_future.size();
-        return ret;
-    }
+    Status status() const;
 
     /// @returns the transaction limits on current/future.
     Limits limits() const { return Limits{ m_limit, m_futureLimit }; }
@@ -164,6 +206,10 @@ public:
     /// Clear the queue
     void clear();
 
+    /// @returns decoded transactions with recovered senders, filled by imports
+    TransactionCache& decodedTransactions() { return m_decoded; }
+    TransactionCache const& decodedTransactions() const { return m_decoded; }
+
     /// Register a handler that will be called once there is a new transaction imported
     template < class T >
     Handler<> onReady( T const& _t ) {
@@ -189,7 +235,9 @@ public:
     struct VerifiedTransaction {
         VerifiedTransaction( Transaction const& _t ) : transaction( _t ) {}
         VerifiedTransaction( VerifiedTransaction&& _t )
-            : transaction( std::move( _t.transaction ) ) {}
+            : transaction( std::move( _t.transaction ) ),
+              height( _t.height ),
+              sequence( _t.sequence ) {}
 
         VerifiedTransaction( VerifiedTransaction const& ) = default;  // XXX removed "delete" for
                                                                       // tricks with queue
@@ -197,6 +245,8 @@ public:
 
         Transaction transaction;  ///< Transaction data
         int category = 0;         // for sorting
+        u256 height = 0;          ///< Nonce height when it became current, for merging shards
+        uint64_t sequence = 0;    ///< Order of becoming current, for merging shards
 
         Counter< VerifiedTransaction > c;
 
@@ -233,37 +283,12 @@ public:
 
     // private:
     // HACK for IS-348
+    struct Shard;
     struct PriorityCompare {
-        TransactionQueue& queue;
+        Shard& shard;
         /// Compare transaction by nonce height and gas price.
         bool operator()(
-            VerifiedTransaction const& _first, VerifiedTransaction const& _second ) const {
-            int cat1 = _first.category;
-            int cat2 = _second.category;
-
-            // HACK special case for "dummy" transaction - it is always to the left of others with
-            // the same category
-            if ( !_first.transaction && _second.transaction )
-                return cat1 >= cat2;
-            else if ( _first.transaction && !_second.transaction )
-                return cat1 > cat2;
-            else if ( !_first.transaction && !_second.transaction )
-                return cat1 < cat2;
-
-            u256 const& height1 =
-                _first.transaction.nonce() -
-                queue.m_currentByAddressAndNonce[_first.transaction.sender()].begin()->first;
-
-            u256 const& height2 =
-                _second.transaction.nonce() -
-                queue.m_currentByAddressAndNonce[_second.transaction.sender()].begin()->first;
-
-            return cat1 > cat2 ||
-                   ( cat1 == cat2 &&
-                       ( height1 < height2 ||
-                           ( height1 == height2 &&
-                               _first.transaction.gasPrice() > _second.transaction.gasPrice() ) ) );
-        }
+            VerifiedTransaction const& _first, VerifiedTransaction const& _second ) const;
     };
 
 private:
@@ -271,44 +296,75 @@ private:
     // account min account nonce. Updating it does not affect the order.
     using PriorityQueue = boost::container::multiset< VerifiedTransaction, PriorityCompare >;
 
+public:
+    /// Transactions of the senders that hash to one shard
+    struct Shard {
+        Shard() : current( PriorityCompare{ *this } ) {}
+        Shard( Shard const& ) = delete;
+        Shard& operator=( Shard const& ) = delete;
+
+        mutable SharedMutex lock;
+
+        h256Hash known;  ///< Headers of transactions in both sets.
+
+        std::unordered_map< Address, std::map< u256, PriorityQueue::iterator > >
+            currentByAddressAndNonce;  ///< Transactions grouped by account and nonce
+        PriorityQueue current;
+        std::unordered_map< h256, PriorityQueue::iterator > currentByHash;  ///< Transaction
+                                                                            ///< hash to set ref
+        /// Future transactions
+        std::unordered_map< Address, std::map< u256, VerifiedTransaction > > future;
+    };
+
+private:
+    size_t shardIndex( Address const& _a ) const;
+    /// Locks all shards in the same order
+    template < class GuardType >
+    std::vector< GuardType > lockShards() const;
+    /// Order of transactions from different shards
+    static bool isBefore( VerifiedTransaction const& _first, VerifiedTransaction const& _second );
+    /// Visits current transactions of all shards in priority order starting at _positions, while
+    /// _f( shard index, iterator ) returns true. All shards must be locked.
+    template < class F >
+    void forEachCurrent_WITH_LOCK( std::vector< PriorityQueue::iterator > _positions, F _f ) const;
+
     ImportResult import(
         bytesConstRef _tx, IfDropped _ik = IfDropped::Ignore, bool _isFuture = false );
-    ImportResult check_WITH_LOCK( h256 const& _h, IfDropped _ik );
-    ImportResult manageImport_WITH_LOCK( h256 const& _h, Transaction const& _transaction );
+    ImportResult check_WITH_LOCK( Shard& _shard, h256 const& _h, IfDropped _ik );
+    /// Inserts a transaction whose sender is already recovered
+    ImportResult importVerified_WITH_LOCK(
+        Shard& _shard, Transaction const& _transaction, IfDropped _ik, bool _isFuture );
+    /// Inserts transactions whose senders are already recovered, locking each shard once
+    std::vector< ImportResult > importVerified(
+        Transactions const& _transactions, IfDropped _ik, bool _isFuture );
+    ImportResult manageImport_WITH_LOCK(
+        Shard& _shard, h256 const& _h, Transaction const& _transaction );
+    /// Drops the lowest priority transactions of all shards while there are more than m_limit
+    void enforceLimit();
 
     Transactions topTransactions_WITH_LOCK(
         unsigned _limit, h256Hash const& _avoid = h256Hash() ) const;
     template < class Pred >
     Transactions topTransactions_WITH_LOCK( unsigned _limit, Pred _pred ) const;
-    Transactions topTransactions_WITH_LOCK(
-        unsigned _limit, int _maxCategory = 0, int _setCategory = -1 );
-
-    void insertCurrent_WITH_LOCK( std::pair< h256, Transaction > const& _p );
-    void makeCurrent_WITH_LOCK( Transaction const& _t );
-    bool remove_WITH_LOCK( h256 const& _txHash );
-    u256 maxNonce_WITH_LOCK( Address const& _a ) const;
-    u256 maxCurrentNonce_WITH_LOCK( Address const& _a ) const;
-    void setFuture_WITH_LOCK( h256 const& _t );
+    Transactions topTransactions_WITH_LOCK( unsigned _limit, int _maxCategory ) const;
+
+    void insertCurrent_WITH_LOCK( Shard& _shard, std::pair< h256, Transaction > const& _p );
+    void makeCurrent_WITH_LOCK( Shard& _shard, Transaction const& _t );
+    bool remove_WITH_LOCK( Shard& _shard, h256 const& _txHash );
+    u256 maxNonce_WITH_LOCK( Shard const& _shard, Address const& _a ) const;
+    u256 maxCurrentNonce_WITH_LOCK( Shard const& _shard, Address const& _a ) const;
+    void setFuture_WITH_LOCK( Shard& _shard, h256 const& _t );
+    /// Invalidates pendingSnapshot() after current transactions or categories change
+    void noteChanged_WITH_LOCK();
     void verifierBody();
 
-    mutable SharedMutex m_lock;                    ///< General lock.
-    mutable boost::condition_variable_any m_cond;  // for wait/notify
-    Handler<> m_readyCondNotifier;
-
-    h256Hash m_known;  ///< Headers of transactions in both sets.
+    std::vector< std::unique_ptr< Shard > > m_shards;
 
     std::unordered_map< h256, std::function< void( ImportResult ) > > m_callbacks;  ///< Called
                                                                                     ///< once.
     LruCache< h256, bool > m_dropped;  ///< Transactions that have previously been dropped
-
-    PriorityQueue m_current;
-    std::unordered_map< h256, PriorityQueue::iterator > m_currentByHash;  ///< Transaction hash to
-                                                                          ///< set ref
-
-    std::unordered_map< Address, std::map< u256, PriorityQueue::iterator > >
-        m_currentByAddressAndNonce;  ///< Transactions grouped by account and nonce
-    std::unordered_map< Address, std::map< u256, VerifiedTransaction > > m_future;  /// Future
-                                                                                    /// transactions
+    mutable Mutex x_dropped;
+    TransactionCache m_decoded;  ///< Imported transactions, shared with consensus
 
     Signal<> m_onReady;  ///< Called when a subsequent call to import transactions will return a
                          ///< non-empty container. Be nice and exit fast.
@@ -321,59 +377,83 @@ private:
                                          ///< import() to make room for another transaction.
     unsigned m_limit;                    ///< Max number of pending transactions
     unsigned m_futureLimit;              ///< Max number of future transactions
-    unsigned m_futureSize = 0;           ///< Current number of future transactions
+    std::atomic< unsigned > m_futureSize{ 0 };  ///< Current number of future transactions
+    std::atomic< size_t > m_currentSize{ 0 };   ///< Current number of current transactions
+    std::atomic< uint64_t > m_sequence{ 0 };    ///< Next VerifiedTransaction::sequence
 
     std::condition_variable m_queueReady;  ///< Signaled when m_unverified has a new entry.
     std::vector< std::thread > m_verifiers;
     std::deque< UnverifiedTransaction > m_unverified;  ///< Pending verification queue
+    std::deque< std::function< void() > > m_recoveryJobs;  ///< Sender recovery for importBatch()
     mutable Mutex x_queue;                             ///< Verification queue mutex
     std::atomic_bool m_aborting;                       ///< Exit condition for verifier.
 
+    std::atomic< uint64_t > m_version{ 0 };  ///< Changed with current transactions, guarded by
+                                             ///< x_changed
+    mutable Mutex x_changed;
+    mutable std::condition_variable m_changed;  ///< Signaled when m_version changes
+    mutable std::shared_ptr< PendingSnapshot const > m_snapshot;  ///< Use atomic_load/store
+
     Logger m_logger{ createLogger( VerbosityInfo, "tq" ) };
     Logger m_loggerDetail{ createLogger( VerbosityDebug, "tq" ) };
 };
 
 template < class... Args >
 Transactions TransactionQueue::topTransactionsSync( unsigned _limit, Args... args ) const {
-    UpgradableGuard rGuard( m_lock );
-    Transactions res;
-
-    res = topTransactions_WITH_LOCK( _limit, args... );
-    // TODO Why wait_for needs exclusive lock?!
-    if ( res.size() == 0 ) {
-        UpgradeGuard wGuard( rGuard );
-        MICROPROFILE_SCOPEI( "TransactionQueue", "wait_for txns 100", MP_DIMGRAY );
-        m_cond.wait_for( *wGuard.mutex(),
-            boost::chrono::milliseconds( 100 ) );  // TODO 100 ms was chosen randomly. it's used in
-                                                   // nice thread termination in ConsensusStub
-    } else
+    uint64_t version = m_version;
+    Transactions res = topTransactions( _limit, args... );
+    if ( !res.empty() )
         return res;
-    res = topTransactions_WITH_LOCK( _limit, args... );
-    return res;
+
+    MICROPROFILE_SCOPEI( "TransactionQueue", "wait_for txns 100", MP_DIMGRAY );
+    // TODO 100 ms was chosen randomly. it's used in nice thread termination in ConsensusStub
+    waitForChange( version, std::chrono::milliseconds( 100 ) );
+    return topTransactions( _limit, args... );
 }
 
 template < class... Args >
 Transactions TransactionQueue::topTransactionsSync( unsigned _limit, Args... args ) {
-    UpgradableGuard rGuard( m_lock );
-    Transactions res;
-
-    res = topTransactions_WITH_LOCK( _limit, args... );
-    // TODO Why wait_for needs exclusive lock?!
-    if ( res.size() == 0 ) {
-        UpgradeGuard wGuard( rGuard );
-        MICROPROFILE_SCOPEI( "TransactionQueue", "wait_for txns 100", MP_DIMGRAY );
-        m_cond.wait_for( *wGuard.mutex(),
-            boost::chrono::milliseconds( 100 ) );  // TODO 100 ms was chosen randomly. it's used in
-                                                   // nice thread termination in ConsensusStub
-    } else
+    uint64_t version = m_version;
+    Transactions res = topTransactions( _limit, args... );
+    if ( !res.empty() )
         return res;
-    res = topTransactions_WITH_LOCK( _limit, args... );
-    return res;
+
+    MICROPROFILE_SCOPEI( "TransactionQueue", "wait_for txns 100", MP_DIMGRAY );
+    // TODO 100 ms was chosen randomly. it's used in nice thread termination in ConsensusStub
+    waitForChange( version, std::chrono::milliseconds( 100 ) );
+    return topTransactions( _limit, args... );
+}
+
+template < class GuardType >
+std::vector< GuardType > TransactionQueue::lockShards() const {
+    std::vector< GuardType > locks;
+    locks.reserve( m_shards.size() );
+    for ( auto const& shard : m_shards )
+        locks.emplace_back( shard->lock );
+    return locks;
+}
+
+template < class F >
+void TransactionQueue::forEachCurrent_WITH_LOCK(
+    std::vector< PriorityQueue::iterator > _positions, F _f ) const {
+    size_t const none = _positions.size();
+    while ( true ) {
+        size_t best = none;
+        for ( size_t i = 0; i < _positions.size(); ++i ) {
+            if ( _positions[i] == m_shards[i]->current.end() )
+                continue;
+            if ( best == none || isBefore( *_positions[i], *_positions[best] ) )
+                best = i;
+        }
+        // step past the visited transaction first, so _f may extract it
+        if ( best == none || !_f( best, _positions[best]++ ) )
+            return;
+    }
 }
 
 template < class Pred >
 Transactions TransactionQueue::topTransactions( unsigned _limit, Pred _pred ) const {
-    ReadGuard l( m_lock );
+    auto locks = lockShards< ReadGuard >();
     return topTransactions_WITH_LOCK( _limit, _pred );
 }
 
@@ -381,9 +461,17 @@ template < class Pred >
 Transactions TransactionQueue::topTransactions_WITH_LOCK( unsigned _limit, Pred _pred ) const {
     MICROPROFILE_SCOPEI( "TransactionQueue", "topTransactions_WITH_LOCK", MP_AZURE );
     Transactions ret;
-    for ( auto t = m_current.begin(); ret.size() < _limit && t != m_current.end(); ++t )
-        if ( _pred( t->transaction ) )
-            ret.push_back( t->transaction );
+    if ( _limit == 0 )
+        return ret;
+
+    std::vector< PriorityQueue::iterator > begins;
+    for ( auto const& shard : m_shards )
+        begins.push_back( shard->current.begin() );
+    forEachCurrent_WITH_LOCK( begins, [&]( size_t, PriorityQueue::iterator _t ) {
+        if ( _pred( _t->transaction ) )
+            ret.push_back( _t->transaction );
+        return ret.size() < _limit;
+    } );
     return ret;
 }
 
@@ -170,6 +170,25 @@ void validateConfigJson( js::mObject const& _obj ) {
             { "collectionDuration", { { js::int_type }, JsonFieldPresence::Optional } },
             { "transactionQueueSize", { { js::int_type }, JsonFieldPresence::Optional } },
             { "maxOpenLeveldbFiles", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "leveldbBlockCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "leveldbTuning", { { js::obj_type }, JsonFieldPresence::Optional } },
+            { "dbBackend", { { js::str_type }, JsonFieldPresence::Optional } },
+            { "broadcastBatchSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "broadcastBatchTimeUs", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "transactionVerifierThreads", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "transactionQueueShards", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "transactionCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "blockScopedStateCommit", { { js::bool_type }, JsonFieldPresence::Optional } },
+            { "pipelinedBlockImport", { { js::bool_type }, JsonFieldPresence::Optional } },
+            { "asyncFilterNotifications", { { js::bool_type }, JsonFieldPresence::Optional } },
+            { "logIndex", { { js::bool_type }, JsonFieldPresence::Optional } },
+            { "maxLogsPerQuery", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "callCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "vmCodeCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "historicTrieNodeCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "parallelExecutionThreads", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "snapshotHashingThreads", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "stateCacheSize", { { js::int_type }, JsonFieldPresence::Optional } },
             { "logLevel", { { js::str_type }, JsonFieldPresence::Optional } },
             { "logLevelConfig", { { js::str_type }, JsonFieldPresence::Optional } },
             { "logLevelProposal", { { js::str_type }, JsonFieldPresence::Optional } },
@@ -259,6 +278,8 @@ void validateConfigJson( js::mObject const& _obj ) {
             { "contractStorageZeroValuePatchTimestamp",
                 { { js::int_type }, JsonFieldPresence::Optional } },
             { "verifyDaSigsPatchTimestamp", { { js::int_type }, JsonFieldPresence::Optional } },
+            { "incrementalSnapshotHashPatchTimestamp",
+                { { js::int_type }, JsonFieldPresence::Optional } },
             { "nodeGroups", { { js::obj_type }, JsonFieldPresence::Optional } } } );
 
     js::mArray const& nodes = sChain.at( "nodes" ).get_array();
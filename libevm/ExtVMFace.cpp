@@ -127,6 +127,7 @@ evmc_tx_context EvmCHost::get_tx_context() noexcept {
     result.tx_gas_price = toEvmC( m_extVM.gasPrice );
     result.tx_origin = toEvmC( m_extVM.origin );
 
+    m_extVM.noteEnvRead();
     auto const& envInfo = m_extVM.envInfo();
     result.block_coinbase = toEvmC( envInfo.author() );
     result.block_number = envInfo.number();
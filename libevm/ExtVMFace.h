@@ -246,6 +246,9 @@ public:
     /// Get the execution environment information.
     EnvInfo const& envInfo() const { return m_envInfo; }
 
+    /// Called when block info or gas price is read, they are not part of the state
+    virtual void noteEnvRead() {}
+
     /// Return the EVM gas-price schedule for this execution context.
     virtual EVMSchedule const& evmSchedule() const { return DefaultSchedule; }
 
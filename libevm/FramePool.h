@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file FramePool.h
+ * @date 2026
+ * VMs and other objects of finished call frames kept by every thread for the frames it runs next
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace dev {
+namespace eth {
+
+/// Most objects of one type kept by a thread: one for every call depth and the outermost frame
+constexpr size_t c_maxRecycledFrames = 1025;
+
+/// Nested calls take their VM from here instead of allocating it, together with its stack and
+/// the memory and return data buffers grown by earlier frames. T::recycle() is called when a
+/// frame is given back and drops whatever should not be kept.
+template < class T >
+class FramePool {
+public:
+    FramePool() = delete;
+    ~FramePool() = delete;
+
+    static T* acquire() {
+        auto& frames = pool();
+        if ( frames.empty() )
+            return new T;
+        T* frame = frames.back().release();
+        frames.pop_back();
+        return frame;
+    }
+
+    static void release( T* _frame ) noexcept {
+        auto& frames = pool();
+        if ( frames.size() >= c_maxRecycledFrames ) {
+            delete _frame;
+            return;
+        }
+        _frame->recycle();
+        frames.emplace_back( _frame );
+    }
+
+    /// Number of VMs this thread keeps now
+    static size_t size() { return pool().size(); }
+
+private:
+    static std::vector< std::unique_ptr< T > >& pool() {
+        // reserved, so that giving a frame back never allocates
+        thread_local std::vector< std::unique_ptr< T > > t_frames = [] {
+            std::vector< std::unique_ptr< T > > frames;
+            frames.reserve( c_maxRecycledFrames );
+            return frames;
+        }();
+        return t_frames;
+    }
+};
+
+/// Allocator for std::allocate_shared of objects made for every call frame, such as ExtVM.
+/// Freed blocks are kept by the thread for the objects of the next frames.
+template < class T >
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template < class U >
+    FrameAllocator( FrameAllocator< U > const& ) noexcept {}
+
+    T* allocate( size_t _n ) {
+        auto& blocks = freeBlocks().blocks;
+        if ( _n != 1 || blocks.empty() )
+            return static_cast< T* >( ::operator new( _n * sizeof( T ) ) );
+        void* block = blocks.back();
+        blocks.pop_back();
+        return static_cast< T* >( block );
+    }
+
+    void deallocate( T* _p, size_t _n ) noexcept {
+        auto& blocks = freeBlocks().blocks;
+        if ( _n != 1 || blocks.size() >= c_maxRecycledFrames )
+            ::operator delete( _p );
+        else
+            blocks.push_back( _p );
+    }
+
+    template < class U >
+    bool operator==( FrameAllocator< U > const& ) const noexcept {
+        return true;
+    }
+    template < class U >
+    bool operator!=( FrameAllocator< U > const& ) const noexcept {
+        return false;
+    }
+
+private:
+    struct FreeBlocks {
+        FreeBlocks() { blocks.reserve( c_maxRecycledFrames ); }
+        ~FreeBlocks() {
+            for ( void* block : blocks )
+                ::operator delete( block );
+        }
+        std::vector< void* > blocks;
+    };
+
+    static FreeBlocks& freeBlocks() {
+        thread_local FreeBlocks t_blocks;
+        return t_blocks;
+    }
+};
+
+}  // namespace eth
+}  // namespace dev
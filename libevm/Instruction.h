@@ -168,10 +168,14 @@ enum class Instruction : uint8_t {
     LOG4,         ///< Makes a log entry; 4 topics.
 
     // these are generated by the interpreter - should never be in user code
-    PUSHC = 0xac,  ///< push value from constant pool
-    JUMPC,         ///< alter the program counter - pre-verified
-    JUMPCI,        ///< conditionally alter the program counter - pre-verified
-    UNDEFINED,     ///< Replaces PUSHC/JUMPC/JUMPCI in the original code
+    PUSHADD = 0xa5,  ///< PUSHn followed by ADD
+    PUSHJUMPI,       ///< PUSHn followed by JUMPI
+    PUSHMSTORE,      ///< PUSHn followed by MSTORE
+    DUPSWAP,         ///< DUPn followed by SWAPn
+    PUSHC = 0xac,    ///< push value from constant pool
+    JUMPC,           ///< alter the program counter - pre-verified
+    JUMPCI,          ///< conditionally alter the program counter - pre-verified
+    UNDEFINED,       ///< Replaces the generated instructions in the original code
 
     JUMPTO = 0xb0,  ///< alter the program counter to a jumpdest
     JUMPIF,         ///< conditionally alter the program counter
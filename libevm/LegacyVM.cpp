@@ -17,12 +17,25 @@
 
 #include "LegacyVM.h"
 
+#if EVM_NATIVE_UINT256
+#include "Uint256.h"
+#endif
+
 using namespace std;
 using namespace dev;
 using namespace dev::eth;
 
 uint64_t LegacyVM::memNeed( u256 const& _offset, u256 const& _size ) {
+#if EVM_NATIVE_UINT256
+    if ( !_size )
+        return 0;
+    // the sum is too big if any of them is
+    if ( _offset > 0x7FFFFFFFFFFFFFFF || _size > 0x7FFFFFFFFFFFFFFF )
+        throwOutOfGas();
+    return toInt63( uint64_t( _offset ) + uint64_t( _size ) );
+#else
     return toInt63( _size ? u512( _offset ) + _size : u512( 0 ) );
+#endif
 }
 
 template < class S >
@@ -144,10 +157,19 @@ void LegacyVM::updateSSGasEIP1283( u256 const& _currentValue, u256 const& _newVa
 }
 
 
-uint64_t LegacyVM::gasForMem( u512 const& _size ) {
+#if EVM_NATIVE_UINT256
+uint64_t LegacyVM::gasForMem( uint64_t _size ) {
+    // _size < 2^64, so this cannot overflow
+    native::uint128 s = _size / 32;
+    return toInt63(
+        native::uint128( m_schedule->memoryGas ) * s + s * s / m_schedule->quadCoeffDiv );
+}
+#else
+uint64_t LegacyVM::gasForMem( uint64_t _size ) {
     u512 s = _size / 32;
     return toInt63( ( u512 ) m_schedule->memoryGas * s + s * s / m_schedule->quadCoeffDiv );
 }
+#endif
 
 void LegacyVM::updateIOGas() {
     if ( m_io_gas < m_runGas )
@@ -203,6 +225,12 @@ owning_bytes_ref LegacyVM::exec( u256& _io_gas, ExtVMFace& _ext, OnOpFunc const&
                                         // in the trace
     m_PC = 0;
 
+    // the VM may have run other frames before
+    m_SP = m_SPP = m_stackEnd;
+    m_mem.clear();
+    m_returnData.clear();
+    m_nSteps = 0;
+
     try {
         // trampoline to minimize depth of call stack when calling out
         m_bounce = &LegacyVM::initEntry;
@@ -272,7 +300,7 @@ void LegacyVM::interpretCases() {
 
             uint64_t b = ( uint64_t ) m_SP[0];
             uint64_t s = ( uint64_t ) m_SP[1];
-            m_output = owning_bytes_ref{ std::move( m_mem ), b, s };
+            m_output = returnedMemory( b, s );
             m_bounce = 0;
         }
         BREAK
@@ -289,8 +317,7 @@ void LegacyVM::interpretCases() {
 
             uint64_t b = ( uint64_t ) m_SP[0];
             uint64_t s = ( uint64_t ) m_SP[1];
-            owning_bytes_ref output{ move( m_mem ), b, s };
-            throwRevertInstruction( move( output ) );
+            throwRevertInstruction( returnedMemory( b, s ) );
         }
         BREAK;
 
@@ -457,7 +484,11 @@ void LegacyVM::interpretCases() {
             updateIOGas();
 
             // pops two items and pushes their sum mod 2^256.
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::add( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] + m_SP[1];
+#endif
         }
         NEXT
 
@@ -466,7 +497,11 @@ void LegacyVM::interpretCases() {
             updateIOGas();
 
             // pops two items and pushes their product mod 2^256.
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mul( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] * m_SP[1];
+#endif
         }
         NEXT
 
@@ -474,7 +509,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sub( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] - m_SP[1];
+#endif
         }
         NEXT
 
@@ -482,7 +521,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::div( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? divWorkaround( m_SP[0], m_SP[1] ) : 0;
+#endif
         }
         NEXT
 
@@ -490,7 +533,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sdiv( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? s2u( divWorkaround( u2s( m_SP[0] ), u2s( m_SP[1] ) ) ) : 0;
+#endif
             --m_SP;
         }
         NEXT
@@ -499,7 +546,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mod( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? modWorkaround( m_SP[0], m_SP[1] ) : 0;
+#endif
         }
         NEXT
 
@@ -507,7 +558,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::smod( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? s2u( modWorkaround( u2s( m_SP[0] ), u2s( m_SP[1] ) ) ) : 0;
+#endif
         }
         NEXT
 
@@ -608,10 +663,14 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::shl( m_SP[1], m_SP[0] );
+#else
             if ( m_SP[0] >= 256 )
                 m_SPP[0] = 0;
             else
                 m_SPP[0] = m_SP[1] << unsigned( m_SP[0] );
+#endif
         }
         NEXT
 
@@ -623,10 +682,14 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::shr( m_SP[1], m_SP[0] );
+#else
             if ( m_SP[0] >= 256 )
                 m_SPP[0] = 0;
             else
                 m_SPP[0] = m_SP[1] >> unsigned( m_SP[0] );
+#endif
         }
         NEXT
 
@@ -638,6 +701,9 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sar( m_SP[1], m_SP[0] );
+#else
             static u256 const hibit = u256( 1 ) << 255;
             static u256 const allbits =
                 u256( "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" );
@@ -654,6 +720,7 @@ void LegacyVM::interpretCases() {
                 if ( shiftee & hibit )
                     m_SPP[0] |= allbits << ( 256 - amount );
             }
+#endif
         }
         NEXT
 
@@ -661,7 +728,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::addmod( m_SP[0], m_SP[1], m_SP[2] );
+#else
             m_SPP[0] = m_SP[2] ? u256( ( u512( m_SP[0] ) + u512( m_SP[1] ) ) % m_SP[2] ) : 0;
+#endif
         }
         NEXT
 
@@ -669,7 +740,11 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mulmod( m_SP[0], m_SP[1], m_SP[2] );
+#else
             m_SPP[0] = m_SP[2] ? u256( ( u512( m_SP[0] ) * u512( m_SP[1] ) ) % m_SP[2] ) : 0;
+#endif
         }
         NEXT
 
@@ -677,6 +752,9 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::signextend( m_SP[0], m_SP[1] );
+#else
             if ( m_SP[0] < 31 ) {
                 unsigned testBit = static_cast< unsigned >( m_SP[0] ) * 8 + 7;
                 u256& number = m_SP[1];
@@ -686,6 +764,7 @@ void LegacyVM::interpretCases() {
                 else
                     number &= mask;
             }
+#endif
         }
         NEXT
 #if EIP_615
@@ -693,7 +772,7 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
 
-            m_PC = decodeJumpDest( m_code.data(), m_PC );
+            m_PC = decodeJumpDest( m_code, m_PC );
         }
         CONTINUE
 
@@ -702,7 +781,7 @@ void LegacyVM::interpretCases() {
             updateIOGas();
 
             if ( m_SP[0] )
-                m_PC = decodeJumpDest( m_code.data(), m_PC );
+                m_PC = decodeJumpDest( m_code, m_PC );
             else
                 ++m_PC;
         }
@@ -711,7 +790,7 @@ void LegacyVM::interpretCases() {
         CASE( JUMPV ) {
             ON_OP();
             updateIOGas();
-            m_PC = decodeJumpvDest( m_code.data(), m_PC, byte( m_SP[0] ) );
+            m_PC = decodeJumpvDest( m_code, m_PC, byte( m_SP[0] ) );
         }
         CONTINUE
 
@@ -719,7 +798,7 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC++;
-            m_PC = decodeJumpDest( m_code.data(), m_PC );
+            m_PC = decodeJumpDest( m_code, m_PC );
         }
         CONTINUE
 
@@ -727,7 +806,7 @@ void LegacyVM::interpretCases() {
             ON_OP();
             updateIOGas();
             *m_RP++ = m_PC;
-            m_PC = decodeJumpvDest( m_code.data(), m_PC, byte( m_SP[0] ) );
+            m_PC = decodeJumpvDest( m_code, m_PC, byte( m_SP[0] ) );
         }
         CONTINUE
 
@@ -1249,6 +1328,7 @@ void LegacyVM::interpretCases() {
         CASE( GASPRICE ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = m_ext->gasPrice;
         }
@@ -1266,6 +1346,7 @@ void LegacyVM::interpretCases() {
         CASE( COINBASE ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = ( u160 ) m_ext->envInfo().author();
         }
@@ -1274,6 +1355,7 @@ void LegacyVM::interpretCases() {
         CASE( TIMESTAMP ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = m_ext->envInfo().timestamp();
         }
@@ -1282,6 +1364,7 @@ void LegacyVM::interpretCases() {
         CASE( NUMBER ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = m_ext->envInfo().number();
         }
@@ -1290,6 +1373,7 @@ void LegacyVM::interpretCases() {
         CASE( DIFFICULTY ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = m_ext->envInfo().difficulty();
         }
@@ -1298,6 +1382,7 @@ void LegacyVM::interpretCases() {
         CASE( GASLIMIT ) {
             ON_OP();
             updateIOGas();
+            m_ext->noteEnvRead();
 
             m_SPP[0] = m_ext->envInfo().gasLimit();
         }
@@ -1347,7 +1432,7 @@ void LegacyVM::interpretCases() {
             off = m_code[m_PC++] << 8;
             off |= m_code[m_PC++];
             m_PC += m_code[m_PC];
-            m_SPP[0] = m_pool[off];
+            m_SPP[0] = m_analysis->pool[off];
             TRACE_VAL( 2, "Retrieved pooled const", m_SPP[0] );
 #else
             throwBadInstruction();
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "Instruction.h"
+#include "LegacyVMCodeCache.h"
 #include "LegacyVMConfig.h"
 #include "VMFace.h"
 
@@ -42,6 +43,12 @@ public:
         return stack;
     };
 
+    /// Drops the state of the finished frame before the VM is kept for reuse. Memory is kept
+    /// unless it grew over c_maxRecycledMemory.
+    void recycle();
+
+    static constexpr size_t c_maxRecycledMemory = 1024 * 1024;
+
 private:
     u256* m_io_gas_p = 0;
     uint64_t m_io_gas = 0;
@@ -51,7 +58,6 @@ private:
     static std::array< InstructionMetric, 256 > c_metrics;
     static void initMetrics();
     static u256 exp256( u256 _base, u256 _exponent );
-    void copyCode( int );
     typedef void ( LegacyVM::*MemFnPtr )();
     MemFnPtr m_bounce = 0;
     MemFnPtr m_onFail = 0;
@@ -60,16 +66,21 @@ private:
 
     // return bytes
     owning_bytes_ref m_output;
+    owning_bytes_ref returnedMemory( uint64_t _begin, uint64_t _size );
 
     // space for memory
     bytes m_mem;
 
-    // space for code
-    bytes m_code;
+    // analyzed code, shared with other VMs executing the same code
+    std::shared_ptr< LegacyVMCode const > m_analysis;
+    _byte_ const* m_code = nullptr;
 
     /// RETURNDATA buffer for memory returned from direct subcalls.
     bytes m_returnData;
 
+    /// parameters of the current CALL, kept here to not allocate them for every call
+    CallParameters m_callParams;
+
     // space for data stack, grows towards smaller addresses from the end
     u256 m_stack[1024];
     u256* m_stackEnd = &m_stack[1024];
@@ -83,9 +94,6 @@ private:
     std::vector< size_t > m_frameSize;
 #endif
 
-    // constant pool
-    std::vector< u256 > m_pool;
-
     // interpreter state
     Instruction m_OP;         // current operation
     uint64_t m_PC = 0;        // program counter
@@ -124,13 +132,11 @@ private:
     void throwBufferOverrun( bigint const& _enfOfAccess );
     void throwStorageOverflow( const std::string& _addr );
 
-    std::vector< uint64_t > m_beginSubs;
-    std::vector< uint64_t > m_jumpDests;
     int64_t verifyJumpDest( u256 const& _dest, bool _throw = true );
 
     void onOperation();
     void adjustStack( unsigned _removed, unsigned _added );
-    uint64_t gasForMem( u512 const& _size );
+    uint64_t gasForMem( uint64_t _size );
     void updateSSGas();
     void updateSSGasPreEIP1283( u256 const& _currentValue, u256 const& _newValue );
     void updateSSGasEIP1283( u256 const& _currentValue, u256 const& _newValue );
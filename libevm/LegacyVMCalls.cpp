@@ -37,6 +37,28 @@ void LegacyVM::copyDataToMemory( bytesConstRef _data, u256* _sp ) {
         std::memset( m_mem.data() + offset + sizeToBeCopied, 0, size - sizeToBeCopied );
 }
 
+// copy of the memory returned by RETURN or REVERT, memory itself stays with the VM for reuse
+owning_bytes_ref LegacyVM::returnedMemory( uint64_t _begin, uint64_t _size ) {
+    if ( !_size )
+        return {};
+    auto const begin = m_mem.begin() + _begin;
+    return owning_bytes_ref{ bytes( begin, begin + _size ), 0, _size };
+}
+
+void LegacyVM::recycle() {
+    m_ext = nullptr;
+    m_onOp = {};
+    m_output = {};
+    m_analysis.reset();
+    m_code = nullptr;
+    m_callParams = CallParameters();
+    m_returnData.clear();
+    if ( m_mem.capacity() > c_maxRecycledMemory )
+        bytes().swap( m_mem );
+    else
+        m_mem.clear();
+}
+
 
 // consolidate exception throws to avoid spraying boost code all over interpreter
 
@@ -96,9 +118,8 @@ int64_t LegacyVM::verifyJumpDest( u256 const& _dest, bool _throw ) {
     // check for overflow
     if ( _dest <= 0x7FFFFFFFFFFFFFFF ) {
         // check for within bounds and to a jump destination
-        // use binary search of array because hashtable collisions are exploitable
         uint64_t pc = uint64_t( _dest );
-        if ( std::binary_search( m_jumpDests.begin(), m_jumpDests.end(), pc ) )
+        if ( m_analysis->isJumpDest( pc ) )
             return pc;
     }
     if ( _throw )
@@ -148,7 +169,7 @@ void LegacyVM::caseCreate() {
 
         CreateResult result = m_ext->create( endowment, gas, initCode, m_OP, salt, m_onOp );
         m_SPP[0] = ( u160 ) result.address;  // Convert address to integer.
-        m_returnData = result.output.toBytes();
+        m_returnData.assign( result.output.begin(), result.output.end() );
 
         *m_io_gas_p -= ( createGas - gas );
         m_io_gas = uint64_t( *m_io_gas_p );
@@ -160,15 +181,15 @@ void LegacyVM::caseCreate() {
 void LegacyVM::caseCall() {
     m_bounce = &LegacyVM::interpretCases;
 
-    // TODO: Please check if that does not actually increases the stack size.
-    //       That was the case before.
-    unique_ptr< CallParameters > callParams( new CallParameters() );
+    // reset the parameters of the previous call
+    m_callParams = CallParameters();
+    CallParameters* const callParams = &m_callParams;
 
     // Clear the return data buffer. This will not free the memory.
     m_returnData.clear();
 
     bytesRef output;
-    if ( caseCallSetup( callParams.get(), output ) ) {
+    if ( caseCallSetup( callParams, output ) ) {
         CallResult result = m_ext->call( *callParams );
         result.output.copyTo( output );
 
@@ -177,8 +198,8 @@ void LegacyVM::caseCall() {
         //    higher memory footprint, no memory copy.
         // 2. Copy only the return data from the returned memory buffer:
         //    minimal memory footprint, additional memory copy.
-        // Option 2 used:
-        m_returnData = result.output.toBytes();
+        // Option 2 used, into the buffer kept from earlier calls:
+        m_returnData.assign( result.output.begin(), result.output.end() );
 
         m_SPP[0] = result.status == EVMC_SUCCESS ? 1 : 0;
     } else
@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LegacyVMCodeCache.cpp
+ * @date 2026
+ */
+
+#include "LegacyVMCodeCache.h"
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+size_t dev::eth::c_legacyVMCodeCacheSize = 1024;
+
+LegacyVMCodeCache::LegacyVMCodeCache( size_t _capacity, unsigned _shards )
+    : m_codes( _capacity, _shards ) {}
+
+LegacyVMCodeCache& LegacyVMCodeCache::instance() {
+    static LegacyVMCodeCache s_instance;
+    return s_instance;
+}
+
+shared_ptr< LegacyVMCode const > LegacyVMCodeCache::get(
+    h256 const& _codeHash, bytesConstRef _code ) {
+    if ( !m_codes.enabled() )
+        return make_shared< LegacyVMCode const >( _code );
+
+    auto cached = m_codes.find( _codeHash );
+    // size check is a cheap guard against hashes which do not match the code
+    if ( cached && ( *cached )->size == _code.size() )
+        return *cached;
+
+    // analyze without the lock, other threads may do the same meanwhile
+    auto ret = make_shared< LegacyVMCode const >( _code );
+    m_codes.insert( _codeHash, ret );
+    return ret;
+}
@@ -0,0 +1,93 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LegacyVMCodeCache.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include "LegacyVMConfig.h"
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/ShardedLruCache.h>
+
+#include <memory>
+#include <vector>
+
+namespace dev {
+namespace eth {
+
+/// Max number of analyzed contracts kept by LegacyVMCodeCache, 0 to disable it
+extern size_t c_legacyVMCodeCacheSize;
+
+/**
+ * @brief Code prepared for LegacyVM: padded, with synthetic opcodes disabled, optimizations
+ * applied and jump destinations found. Never changes after construction, so it is shared by all
+ * VMs executing the same code.
+ */
+struct LegacyVMCode {
+    explicit LegacyVMCode( bytesConstRef _code );
+
+    bool isJumpDest( uint64_t _pc ) const {
+        return _pc < size && ( ( jumpDests[_pc / 64] >> ( _pc % 64 ) ) & 1 );
+    }
+
+    /// code extended by 33 zero bytes, so that data of a PUSH32 at the end can be read
+    /// without bounds checks
+    bytes code;
+    /// size of the original code
+    size_t size;
+    /// bit per code byte, set for JUMPDEST opcodes outside of push data
+    std::vector< uint64_t > jumpDests;
+    /// constant pool
+    std::vector< u256 > pool;
+#if EIP_615
+    std::vector< uint64_t > beginSubs;
+#endif
+};
+
+/**
+ * @brief Analyzed code keyed by code hash. Calls into the same contract skip the copying and
+ * scanning of its code. Least recently used entries are evicted.
+ * @threadsafe
+ */
+class LegacyVMCodeCache {
+public:
+    using Stats = ShardedLruCache< h256, std::shared_ptr< LegacyVMCode const > >::Stats;
+
+    explicit LegacyVMCodeCache( size_t _capacity = c_legacyVMCodeCacheSize, unsigned _shards = 16 );
+
+    /// Cache shared by all LegacyVM instances, created with c_legacyVMCodeCacheSize on first use
+    static LegacyVMCodeCache& instance();
+
+    /// @returns analysis of _code, analyzes it if it is not cached yet
+    std::shared_ptr< LegacyVMCode const > get( h256 const& _codeHash, bytesConstRef _code );
+
+    Stats stats() const { return m_codes.stats(); }
+
+    size_t capacity() const { return m_codes.capacity(); }
+
+private:
+    ShardedLruCache< h256, std::shared_ptr< LegacyVMCode const > > m_codes;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -34,6 +34,8 @@ namespace eth {
 //
 // EVM_REPLACE_CONST_JUMP - pre-verified jumps to save runtime lookup
 //
+// EVM_NATIVE_UINT256     - 256-bit arithmetic on 4 64-bit limbs instead of boost::multiprecision
+//
 // EVM_TRACE              - provides various levels of tracing
 
 #ifndef EIP_615
@@ -68,6 +70,10 @@ namespace eth {
 #define EVM_DO_FIRST_PASS_OPTIMIZATION ( EVM_REPLACE_CONST_JUMP || EVM_USE_CONSTANT_POOL )
 #endif
 
+#ifndef EVM_NATIVE_UINT256
+#define EVM_NATIVE_UINT256 false
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -17,6 +17,10 @@
 
 #include "LegacyVM.h"
 
+#if EVM_NATIVE_UINT256
+#include "Uint256.h"
+#endif
+
 using namespace dev;
 using namespace dev::eth;
 using byte = _byte_;
@@ -35,36 +39,32 @@ void LegacyVM::initMetrics() {
     ( void ) done;
 }
 
-void LegacyVM::copyCode( int _extraBytes ) {
+LegacyVMCode::LegacyVMCode( bytesConstRef _code ) : size( _code.size() ) {
     // Copy code so that it can be safely modified and extend code by
-    // _extraBytes zero bytes to allow reading virtual data at the end
+    // 33 zero bytes to allow reading virtual data at the end
     // of the code without bounds checks.
-    auto extendedSize = m_ext->code.size() + _extraBytes;
-    m_code.reserve( extendedSize );
-    m_code = m_ext->code;
-    m_code.resize( extendedSize );
-}
-
-void LegacyVM::optimize() {
-    copyCode( 33 );
+    code.reserve( size + 33 );
+    code.assign( _code.begin(), _code.end() );
+    code.resize( size + 33 );
+    jumpDests.resize( ( size + 63 ) / 64 );
 
-    size_t const nBytes = m_ext->code.size();
+    size_t const nBytes = size;
 
     // build a table of jump destinations for use in verifyJumpDest
 
     TRACE_STR( 1, "Build JUMPDEST table" )
     for ( size_t pc = 0; pc < nBytes; ++pc ) {
-        Instruction op = Instruction( m_code[pc] );
+        Instruction op = Instruction( code[pc] );
         TRACE_OP( 2, pc, op );
 
         // make synthetic ops in user code trigger invalid instruction if run
         if ( op == Instruction::PUSHC || op == Instruction::JUMPC || op == Instruction::JUMPCI ) {
             TRACE_OP( 1, pc, op );
-            m_code[pc] = ( _byte_ ) Instruction::INVALID;
+            code[pc] = ( _byte_ ) Instruction::INVALID;
         }
 
         if ( op == Instruction::JUMPDEST ) {
-            m_jumpDests.push_back( pc );
+            jumpDests[pc / 64] |= uint64_t( 1 ) << ( pc % 64 );
         } else if ( ( byte ) Instruction::PUSH1 <= ( byte ) op &&
                     ( byte ) op <= ( byte ) Instruction::PUSH32 ) {
             pc += ( _byte_ ) op - ( _byte_ ) Instruction::PUSH1 + 1;
@@ -76,9 +76,9 @@ void LegacyVM::optimize() {
             pc += 4;
         } else if ( op == Instruction::JUMPV || op == Instruction::JUMPSUBV ) {
             ++pc;
-            pc += 4 * m_code[pc];  // number of 4-byte dests followed by table
+            pc += 4 * code[pc];  // number of 4-byte dests followed by table
         } else if ( op == Instruction::BEGINSUB ) {
-            m_beginSubs.push_back( pc );
+            beginSubs.push_back( pc );
         } else if ( op == Instruction::BEGINDATA ) {
             break;
         }
@@ -90,16 +90,16 @@ void LegacyVM::optimize() {
     TRACE_STR( 1, "Do first pass optimizations" )
     for ( size_t pc = 0; pc < nBytes; ++pc ) {
         u256 val = 0;
-        Instruction op = Instruction( m_code[pc] );
+        Instruction op = Instruction( code[pc] );
 
         if ( ( byte ) Instruction::PUSH1 <= ( byte ) op &&
              ( byte ) op <= ( byte ) Instruction::PUSH32 ) {
             byte nPush = ( byte ) op - ( byte ) Instruction::PUSH1 + 1;
 
             // decode pushed bytes to integral value
-            val = m_code[pc + 1];
+            val = code[pc + 1];
             for ( uint64_t i = pc + 2, n = nPush; --n; ++i ) {
-                val = ( val << 8 ) | m_code[i];
+                val = ( val << 8 ) | code[i];
             }
 
 #if EVM_USE_CONSTANT_POOL
@@ -108,16 +108,16 @@ void LegacyVM::optimize() {
             // place offset in code as 2 bytes MSB-first
             // followed by one byte count of remaining pushed bytes
             if ( 5 < nPush ) {
-                uint16_t pool_off = m_pool.size();
+                uint16_t pool_off = pool.size();
                 TRACE_VAL( 1, "stash", val );
                 TRACE_VAL( 1, "... in pool at offset", pool_off );
-                m_pool.push_back( val );
+                pool.push_back( val );
 
                 TRACE_PRE_OPT( 1, pc, op );
-                m_code[pc] = byte( op = Instruction::PUSHC );
-                m_code[pc + 3] = nPush - 2;
-                m_code[pc + 2] = pool_off & 0xff;
-                m_code[pc + 1] = pool_off >> 8;
+                code[pc] = byte( op = Instruction::PUSHC );
+                code[pc + 3] = nPush - 2;
+                code[pc + 2] = pool_off & 0xff;
+                code[pc + 1] = pool_off >> 8;
                 TRACE_POST_OPT( 1, pc, op );
             }
 
@@ -125,25 +125,23 @@ void LegacyVM::optimize() {
 
 #if EVM_REPLACE_CONST_JUMP
             // replace JUMP or JUMPI to constant location with JUMPC or JUMPCI
-            // verifyJumpDest is M = log(number of jump destinations)
-            // outer loop is N = number of bytes in code array
-            // so complexity is N log M, worst case is N log N
+            // jump destinations are a bitmap, so this is linear in the code size
             size_t i = pc + nPush + 1;
-            op = Instruction( m_code[i] );
+            op = Instruction( code[i] );
             if ( op == Instruction::JUMP ) {
                 TRACE_VAL( 1, "Replace const JUMP with JUMPC to", val )
                 TRACE_PRE_OPT( 1, i, op );
 
-                if ( 0 <= verifyJumpDest( val, false ) )
-                    m_code[i] = _byte_( op = Instruction::JUMPC );
+                if ( val <= 0x7FFFFFFFFFFFFFFF && isJumpDest( uint64_t( val ) ) )
+                    code[i] = _byte_( op = Instruction::JUMPC );
 
                 TRACE_POST_OPT( 1, i, op );
             } else if ( op == Instruction::JUMPI ) {
                 TRACE_VAL( 1, "Replace const JUMPI with JUMPCI to", val )
                 TRACE_PRE_OPT( 1, i, op );
 
-                if ( 0 <= verifyJumpDest( val, false ) )
-                    m_code[i] = _byte_( op = Instruction::JUMPCI );
+                if ( val <= 0x7FFFFFFFFFFFFFFF && isJumpDest( uint64_t( val ) ) )
+                    code[i] = _byte_( op = Instruction::JUMPCI );
 
                 TRACE_POST_OPT( 1, i, op );
             }
@@ -156,6 +154,15 @@ void LegacyVM::optimize() {
 #endif
 }
 
+void LegacyVM::optimize() {
+    // init code mostly runs once, keep it from evicting code of contracts
+    if ( m_ext->isCreate )
+        m_analysis = std::make_shared< LegacyVMCode const >( &m_ext->code );
+    else
+        m_analysis = LegacyVMCodeCache::instance().get( m_ext->codeHash, &m_ext->code );
+    m_code = m_analysis->code.data();
+}
+
 
 //
 // Init interpreter on entry.
@@ -174,6 +181,9 @@ void LegacyVM::initEntry() {
 // mod operation.
 // Do not inline it.
 u256 LegacyVM::exp256( u256 _base, u256 _exponent ) {
+#if EVM_NATIVE_UINT256
+    return native::exp( _base, _exponent );
+#else
     using boost::multiprecision::limb_type;
     u256 result = 1;
     while ( _exponent ) {
@@ -183,4 +193,5 @@ u256 LegacyVM::exp256( u256 _base, u256 _exponent ) {
         _exponent >>= 1;
     }
     return result;
+#endif
 }
@@ -0,0 +1,442 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file Uint256.h
+ * @date 2026
+ * Fixed width 256-bit arithmetic for the EVM interpreters, used instead of the generic
+ * boost::multiprecision code when EVM_NATIVE_UINT256 is enabled.
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#ifndef __SIZEOF_INT128__
+#error "Uint256.h needs unsigned __int128, build with EVM_NATIVE_UINT256=OFF"
+#endif
+
+namespace dev {
+namespace eth {
+namespace native {
+
+using uint128 = unsigned __int128;
+
+/// 256-bit unsigned number as 4 64-bit limbs, least significant first
+struct Uint256 {
+    uint64_t w[4];
+};
+
+static_assert( sizeof( boost::multiprecision::limb_type ) == sizeof( uint64_t ),
+    "u256 is expected to have 64-bit limbs" );
+
+/// u256 keeps its limbs inline, so conversions are copies of 4 words. Limbs past the size of
+/// the backend are not guaranteed to be zero.
+inline Uint256 load( u256 const& _v ) {
+    auto const& backend = _v.backend();
+    auto const* limbs = backend.limbs();
+    unsigned const size = backend.size();
+    Uint256 ret;
+    for ( unsigned i = 0; i < 4; ++i )
+        ret.w[i] = i < size ? limbs[i] : 0;
+    return ret;
+}
+
+inline u256 store( Uint256 const& _v ) {
+    u256 ret;
+    auto& backend = ret.backend();
+    unsigned const size = _v.w[3] ? 4 : _v.w[2] ? 3 : _v.w[1] ? 2 : 1;
+    backend.resize( size, size );
+    auto* limbs = backend.limbs();
+    for ( unsigned i = 0; i < 4; ++i )
+        limbs[i] = _v.w[i];
+    return ret;
+}
+
+inline bool isZero( Uint256 const& _v ) {
+    return ( _v.w[0] | _v.w[1] | _v.w[2] | _v.w[3] ) == 0;
+}
+
+inline bool isNegative( Uint256 const& _v ) {
+    return _v.w[3] >> 63;
+}
+
+inline Uint256 add( Uint256 const& _a, Uint256 const& _b ) {
+    Uint256 ret;
+    uint128 carry = 0;
+    for ( unsigned i = 0; i < 4; ++i ) {
+        carry += uint128( _a.w[i] ) + _b.w[i];
+        ret.w[i] = uint64_t( carry );
+        carry >>= 64;
+    }
+    return ret;
+}
+
+inline Uint256 sub( Uint256 const& _a, Uint256 const& _b ) {
+    Uint256 ret;
+    uint64_t borrow = 0;
+    for ( unsigned i = 0; i < 4; ++i ) {
+        uint128 d = uint128( _a.w[i] ) - _b.w[i] - borrow;
+        ret.w[i] = uint64_t( d );
+        borrow = uint64_t( d >> 64 ) & 1;
+    }
+    return ret;
+}
+
+inline Uint256 negate( Uint256 const& _v ) {
+    return sub( Uint256{}, _v );
+}
+
+/// Product mod 2^256
+inline Uint256 mul( Uint256 const& _a, Uint256 const& _b ) {
+    Uint256 ret{};
+    for ( unsigned i = 0; i < 4; ++i ) {
+        uint64_t carry = 0;
+        for ( unsigned j = 0; i + j < 4; ++j ) {
+            uint128 p = uint128( _a.w[i] ) * _b.w[j] + ret.w[i + j] + carry;
+            ret.w[i + j] = uint64_t( p );
+            carry = uint64_t( p >> 64 );
+        }
+    }
+    return ret;
+}
+
+/// Full 512-bit product into 8 limbs
+inline void mulFull( Uint256 const& _a, Uint256 const& _b, uint64_t* o_product ) {
+    std::fill( o_product, o_product + 8, 0 );
+    for ( unsigned i = 0; i < 4; ++i ) {
+        uint64_t carry = 0;
+        for ( unsigned j = 0; j < 4; ++j ) {
+            uint128 p = uint128( _a.w[i] ) * _b.w[j] + o_product[i + j] + carry;
+            o_product[i + j] = uint64_t( p );
+            carry = uint64_t( p >> 64 );
+        }
+        o_product[i + 4] = carry;
+    }
+}
+
+/// @returns number of limbs without the leading zero ones
+inline unsigned significantLimbs( uint64_t const* _v, unsigned _size ) {
+    while ( _size > 0 && _v[_size - 1] == 0 )
+        --_size;
+    return _size;
+}
+
+/// Knuth's algorithm D. Divides _u of _m <= 8 limbs by non-zero _v of _n <= 8 limbs. Writes _m
+/// limbs of quotient to o_q and _n limbs of remainder to o_r.
+inline void divmod( uint64_t const* _u, unsigned _m, uint64_t const* _v, unsigned _n,
+    uint64_t* o_q, uint64_t* o_r ) {
+    std::fill( o_q, o_q + _m, 0 );
+    std::fill( o_r, o_r + _n, 0 );
+    unsigned const m = significantLimbs( _u, _m );
+    unsigned const n = significantLimbs( _v, _n );
+
+    if ( m < n ) {
+        std::copy( _u, _u + m, o_r );
+        return;
+    }
+
+    if ( n == 1 ) {
+        uint64_t rem = 0;
+        for ( unsigned j = m; j-- > 0; ) {
+            uint128 cur = ( uint128( rem ) << 64 ) | _u[j];
+            o_q[j] = uint64_t( cur / _v[0] );
+            rem = uint64_t( cur % _v[0] );
+        }
+        o_r[0] = rem;
+        return;
+    }
+
+    // normalize, so that the top bit of the divisor is set
+    unsigned const s = __builtin_clzll( _v[n - 1] );
+    uint64_t vn[8];
+    uint64_t un[9];
+    for ( unsigned i = n - 1; i > 0; --i )
+        vn[i] = ( _v[i] << s ) | ( s ? _v[i - 1] >> ( 64 - s ) : 0 );
+    vn[0] = _v[0] << s;
+    un[m] = s ? _u[m - 1] >> ( 64 - s ) : 0;
+    for ( unsigned i = m - 1; i > 0; --i )
+        un[i] = ( _u[i] << s ) | ( s ? _u[i - 1] >> ( 64 - s ) : 0 );
+    un[0] = _u[0] << s;
+
+    for ( unsigned j = m - n + 1; j-- > 0; ) {
+        // estimate quotient limb, it is at most 1 too big after the correction
+        uint128 num = ( uint128( un[j + n] ) << 64 ) | un[j + n - 1];
+        uint128 qhat = num / vn[n - 1];
+        uint128 rhat = num % vn[n - 1];
+        while ( ( qhat >> 64 ) || qhat * vn[n - 2] > ( ( rhat << 64 ) | un[j + n - 2] ) ) {
+            --qhat;
+            rhat += vn[n - 1];
+            if ( rhat >> 64 )
+                break;
+        }
+
+        // multiply and subtract
+        uint64_t borrow = 0;
+        uint64_t carry = 0;
+        for ( unsigned i = 0; i < n; ++i ) {
+            uint128 p = qhat * vn[i] + carry;
+            carry = uint64_t( p >> 64 );
+            uint128 t = uint128( un[i + j] ) - uint64_t( p ) - borrow;
+            un[i + j] = uint64_t( t );
+            borrow = uint64_t( t >> 64 ) & 1;
+        }
+        uint128 t = uint128( un[j + n] ) - carry - borrow;
+        un[j + n] = uint64_t( t );
+        o_q[j] = uint64_t( qhat );
+
+        // subtracted too much, add back
+        if ( uint64_t( t >> 64 ) ) {
+            --o_q[j];
+            uint64_t c = 0;
+            for ( unsigned i = 0; i < n; ++i ) {
+                uint128 sum = uint128( un[i + j] ) + vn[i] + c;
+                un[i + j] = uint64_t( sum );
+                c = uint64_t( sum >> 64 );
+            }
+            un[j + n] += c;
+        }
+    }
+
+    for ( unsigned i = 0; i + 1 < n; ++i )
+        o_r[i] = ( un[i] >> s ) | ( s ? un[i + 1] << ( 64 - s ) : 0 );
+    o_r[n - 1] = un[n - 1] >> s;
+}
+
+/// Quotient, 0 if _b is 0
+inline Uint256 div( Uint256 const& _a, Uint256 const& _b ) {
+    Uint256 q{}, r;
+    if ( !isZero( _b ) )
+        divmod( _a.w, 4, _b.w, 4, q.w, r.w );
+    return q;
+}
+
+/// Remainder, 0 if _b is 0
+inline Uint256 mod( Uint256 const& _a, Uint256 const& _b ) {
+    Uint256 q, r{};
+    if ( !isZero( _b ) )
+        divmod( _a.w, 4, _b.w, 4, q.w, r.w );
+    return r;
+}
+
+/// Signed quotient rounded towards zero, -2^255 / -1 overflows to -2^255
+inline Uint256 sdiv( Uint256 const& _a, Uint256 const& _b ) {
+    bool const negA = isNegative( _a );
+    bool const negB = isNegative( _b );
+    Uint256 q = div( negA ? negate( _a ) : _a, negB ? negate( _b ) : _b );
+    return negA != negB ? negate( q ) : q;
+}
+
+/// Signed remainder, has the sign of _a
+inline Uint256 smod( Uint256 const& _a, Uint256 const& _b ) {
+    bool const negA = isNegative( _a );
+    Uint256 r = mod( negA ? negate( _a ) : _a, isNegative( _b ) ? negate( _b ) : _b );
+    return negA ? negate( r ) : r;
+}
+
+/// (_a + _b) % _m without overflow, 0 if _m is 0
+inline Uint256 addmod( Uint256 const& _a, Uint256 const& _b, Uint256 const& _m ) {
+    Uint256 r{};
+    if ( isZero( _m ) )
+        return r;
+    uint64_t sum[5];
+    uint128 carry = 0;
+    for ( unsigned i = 0; i < 4; ++i ) {
+        carry += uint128( _a.w[i] ) + _b.w[i];
+        sum[i] = uint64_t( carry );
+        carry >>= 64;
+    }
+    sum[4] = uint64_t( carry );
+    uint64_t q[5];
+    divmod( sum, 5, _m.w, 4, q, r.w );
+    return r;
+}
+
+/// (_a * _b) % _m without overflow, 0 if _m is 0
+inline Uint256 mulmod( Uint256 const& _a, Uint256 const& _b, Uint256 const& _m ) {
+    Uint256 r{};
+    if ( isZero( _m ) )
+        return r;
+    uint64_t product[8];
+    mulFull( _a, _b, product );
+    uint64_t q[8];
+    divmod( product, 8, _m.w, 4, q, r.w );
+    return r;
+}
+
+/// _base ^ _exponent mod 2^256 by squaring
+inline Uint256 exp( Uint256 _base, Uint256 const& _exponent ) {
+    Uint256 ret{ { 1, 0, 0, 0 } };
+    unsigned const limbs = significantLimbs( _exponent.w, 4 );
+    for ( unsigned i = 0; i < limbs; ++i ) {
+        uint64_t e = _exponent.w[i];
+        for ( unsigned bit = 0; bit < 64; ++bit, e >>= 1 ) {
+            if ( e & 1 )
+                ret = mul( ret, _base );
+            if ( i + 1 == limbs && ( e >> 1 ) == 0 )
+                break;
+            _base = mul( _base, _base );
+        }
+    }
+    return ret;
+}
+
+inline Uint256 shl( Uint256 const& _v, unsigned _shift ) {
+    Uint256 ret{};
+    if ( _shift >= 256 )
+        return ret;
+    unsigned const limbs = _shift / 64;
+    unsigned const bits = _shift % 64;
+    for ( unsigned i = limbs; i < 4; ++i ) {
+        ret.w[i] = _v.w[i - limbs] << bits;
+        if ( bits && i > limbs )
+            ret.w[i] |= _v.w[i - limbs - 1] >> ( 64 - bits );
+    }
+    return ret;
+}
+
+inline Uint256 shr( Uint256 const& _v, unsigned _shift ) {
+    Uint256 ret{};
+    if ( _shift >= 256 )
+        return ret;
+    unsigned const limbs = _shift / 64;
+    unsigned const bits = _shift % 64;
+    for ( unsigned i = 0; i + limbs < 4; ++i ) {
+        ret.w[i] = _v.w[i + limbs] >> bits;
+        if ( bits && i + limbs + 1 < 4 )
+            ret.w[i] |= _v.w[i + limbs + 1] << ( 64 - bits );
+    }
+    return ret;
+}
+
+/// Arithmetic shift right
+inline Uint256 sar( Uint256 const& _v, unsigned _shift ) {
+    Uint256 const ones{ { ~uint64_t( 0 ), ~uint64_t( 0 ), ~uint64_t( 0 ), ~uint64_t( 0 ) } };
+    if ( !isNegative( _v ) )
+        return shr( _v, _shift );
+    if ( _shift >= 256 )
+        return ones;
+    Uint256 ret = shr( _v, _shift );
+    Uint256 const fill = shl( ones, 256 - _shift );
+    for ( unsigned i = 0; i < 4; ++i )
+        ret.w[i] |= fill.w[i];
+    return ret;
+}
+
+/// Extends sign of the lowest _byte + 1 bytes of _v, _v is returned as is if _byte >= 31
+inline Uint256 signextend( unsigned _byte, Uint256 _v ) {
+    if ( _byte >= 31 )
+        return _v;
+    unsigned const testBit = _byte * 8 + 7;
+    unsigned const limb = testBit / 64;
+    unsigned const bit = testBit % 64;
+    bool const negative = ( _v.w[limb] >> bit ) & 1;
+    uint64_t const high = bit == 63 ? 0 : ~uint64_t( 0 ) << ( bit + 1 );
+    _v.w[limb] = negative ? _v.w[limb] | high : _v.w[limb] & ~high;
+    for ( unsigned i = limb + 1; i < 4; ++i )
+        _v.w[i] = negative ? ~uint64_t( 0 ) : 0;
+    return _v;
+}
+
+//
+// u256 versions for the interpreters, with EVM semantics of the opcodes
+//
+
+/// Counters, offsets and amounts mostly fit into one limb, there 128 bits are enough
+inline bool isSingleLimb( u256 const& _a, u256 const& _b ) {
+    return ( _a.backend().size() | _b.backend().size() ) == 1;
+}
+
+inline u256 fromUint128( uint128 _v ) {
+    u256 ret;
+    auto& backend = ret.backend();
+    uint64_t const high = uint64_t( _v >> 64 );
+    backend.resize( high ? 2 : 1, 1 );
+    backend.limbs()[0] = uint64_t( _v );
+    backend.limbs()[1] = high;
+    return ret;
+}
+
+inline u256 add( u256 const& _a, u256 const& _b ) {
+    if ( isSingleLimb( _a, _b ) )
+        return fromUint128( uint128( *_a.backend().limbs() ) + *_b.backend().limbs() );
+    return store( add( load( _a ), load( _b ) ) );
+}
+
+inline u256 sub( u256 const& _a, u256 const& _b ) {
+    if ( isSingleLimb( _a, _b ) && *_a.backend().limbs() >= *_b.backend().limbs() )
+        return fromUint128( *_a.backend().limbs() - *_b.backend().limbs() );
+    return store( sub( load( _a ), load( _b ) ) );
+}
+
+inline u256 mul( u256 const& _a, u256 const& _b ) {
+    if ( isSingleLimb( _a, _b ) )
+        return fromUint128( uint128( *_a.backend().limbs() ) * *_b.backend().limbs() );
+    return store( mul( load( _a ), load( _b ) ) );
+}
+
+inline u256 div( u256 const& _a, u256 const& _b ) {
+    return store( div( load( _a ), load( _b ) ) );
+}
+
+inline u256 mod( u256 const& _a, u256 const& _b ) {
+    return store( mod( load( _a ), load( _b ) ) );
+}
+
+inline u256 sdiv( u256 const& _a, u256 const& _b ) {
+    return store( sdiv( load( _a ), load( _b ) ) );
+}
+
+inline u256 smod( u256 const& _a, u256 const& _b ) {
+    return store( smod( load( _a ), load( _b ) ) );
+}
+
+inline u256 addmod( u256 const& _a, u256 const& _b, u256 const& _m ) {
+    return store( addmod( load( _a ), load( _b ), load( _m ) ) );
+}
+
+inline u256 mulmod( u256 const& _a, u256 const& _b, u256 const& _m ) {
+    return store( mulmod( load( _a ), load( _b ), load( _m ) ) );
+}
+
+inline u256 exp( u256 const& _base, u256 const& _exponent ) {
+    return store( exp( load( _base ), load( _exponent ) ) );
+}
+
+inline u256 shl( u256 const& _v, u256 const& _shift ) {
+    return _shift >= 256 ? u256( 0 ) : store( shl( load( _v ), unsigned( _shift ) ) );
+}
+
+inline u256 shr( u256 const& _v, u256 const& _shift ) {
+    return _shift >= 256 ? u256( 0 ) : store( shr( load( _v ), unsigned( _shift ) ) );
+}
+
+inline u256 sar( u256 const& _v, u256 const& _shift ) {
+    return store( sar( load( _v ), _shift >= 256 ? 256 : unsigned( _shift ) ) );
+}
+
+inline u256 signextend( u256 const& _byte, u256 const& _v ) {
+    return _byte >= 31 ? _v : store( signextend( unsigned( _byte ), load( _v ) ) );
+}
+
+}  // namespace native
+}  // namespace eth
+}  // namespace dev
@@ -17,6 +17,7 @@
 
 #include "VMFactory.h"
 #include "EVMC.h"
+#include "FramePool.h"
 #include "LegacyVM.h"
 
 #include <libskale-interpreter/interpreter.h>
@@ -166,19 +167,25 @@ VMPtr VMFactory::create() {
 }
 
 VMPtr VMFactory::create( VMKind _kind ) {
-    static const auto default_delete = []( VMFace* _vm ) noexcept { delete _vm; };
     static const auto null_delete = []( VMFace* ) noexcept {};
+    static const auto legacy_release = []( VMFace* _vm ) noexcept {
+        FramePool< LegacyVM >::release( static_cast< LegacyVM* >( _vm ) );
+    };
 
     switch ( _kind ) {
-    case VMKind::Interpreter:
-        return { new EVMC{ evmc_create_interpreter() }, default_delete };
+    case VMKind::Interpreter: {
+        // The wrapper is stateless, skale-interpreter keeps its own frames.
+        static EVMC s_interpreter{ evmc_create_interpreter() };
+        return { &s_interpreter, null_delete };
+    }
     case VMKind::DLL:
         assert( g_evmcDll != nullptr );
         // Return "fake" owning pointer to global EVMC DLL VM.
         return { g_evmcDll.get(), null_delete };
     case VMKind::Legacy:
     default:
-        return { new LegacyVM, default_delete };
+        // recycled by this thread once the frame finishes
+        return { FramePool< LegacyVM >::acquire(), legacy_release };
     }
 }
 }  // namespace eth
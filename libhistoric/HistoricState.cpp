@@ -9,6 +9,7 @@
 #include "DatabasePaths.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/DBFactory.h>
+#include <libdevcore/LevelDB.h>
 #include <libdevcore/MemoryDB.h>
 #include <libdevcore/TrieHash.h>
 #include <libethereum/Block.h>
@@ -65,7 +66,8 @@ OverlayDB HistoricState::openDB(
 
     try {
         clog( VerbosityTrace, "statedb" ) << "Opening state database";
-        std::unique_ptr< db::DatabaseFace > db = db::DBFactory::create( dbPaths.statePath() );
+        std::unique_ptr< db::DatabaseFace > db = db::DBFactory::create(
+            dbPaths.statePath(), db::LevelDBKind::Historic );
         return OverlayDB( std::move( db ) );
     } catch ( boost::exception const& ex ) {
         if ( db::isDiskDatabase() ) {
@@ -142,6 +142,7 @@ public:
         WithExisting _we = WithExisting::Trust );
     OverlayDB const& db() const { return m_db; }
     OverlayDB& db() { return m_db; }
+    OverlayDB const& blockToStateRootDB() const { return m_blockToStateRootDB; }
 
 
     /// @returns the set containing all addresses currently in use in Ethereum.
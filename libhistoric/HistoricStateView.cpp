@@ -0,0 +1,135 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file HistoricStateView.cpp
+ * @date 2026
+ */
+
+#include "HistoricStateView.h"
+#include "SecureTrieDB.h"
+
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libethereum/BlockChain.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+size_t dev::eth::c_historicTrieNodeCacheSize = 65536;
+size_t dev::eth::c_historicStateRootCacheSize = 1024;
+
+HistoricTrieNodeCache::HistoricTrieNodeCache(
+    OverlayDB const& _db, size_t _capacity, unsigned _shards )
+    : m_db( _db ), m_nodes( _capacity, _shards ) {}
+
+string HistoricTrieNodeCache::lookup( h256 const& _h ) const {
+    if ( !m_nodes.enabled() )
+        return m_db.lookup( _h );
+
+    if ( std::optional< string > cached = m_nodes.find( _h ) )
+        return *cached;
+
+    // read the database without the lock, other threads may do the same meanwhile
+    string ret = m_db.lookup( _h );
+    if ( !ret.empty() )
+        m_nodes.insert( _h, ret );
+    return ret;
+}
+
+bool HistoricTrieNodeCache::exists( h256 const& _h ) const {
+    return m_nodes.contains( _h ) || m_db.exists( _h );
+}
+
+void HistoricTrieNodeCache::insert( h256 const&, bytesConstRef ) {
+    BOOST_THROW_EXCEPTION( FailedInvariant() << errinfo_comment( "historic state is read-only" ) );
+}
+
+HistoricStateView::HistoricStateView( u256 const& _accountStartNonce, OverlayDB const& _db,
+    OverlayDB const& _blockToStateRootDB )
+    : m_accountStartNonce( _accountStartNonce ),
+      m_blockToStateRootDB( _blockToStateRootDB ),
+      m_nodes( _db ),
+      m_roots( std::max< size_t >( c_historicStateRootCacheSize, 1 ) ) {}
+
+h256 HistoricStateView::stateRoot( uint64_t _blockNumber ) const {
+    {
+        Guard l( x_roots );
+        if ( auto const* cached = m_roots.find( _blockNumber ) )
+            return *cached;
+    }
+
+    // roots are only added for new blocks, so the cached ones stay valid
+    auto const key = h256( _blockNumber );
+    auto const value = m_blockToStateRootDB.lookup( key );
+    if ( value.empty() )
+        BOOST_THROW_EXCEPTION( UnknownBlockNumberInRootDB() );
+    auto const root = h256( value, h256::ConstructFromStringType::FromBinary );
+
+    Guard l( x_roots );
+    m_roots.insert( _blockNumber, root );
+    return root;
+}
+
+string HistoricStateView::account( Address const& _address, uint64_t _blockNumber ) const {
+    h256 const root = stateRoot( _blockNumber );
+    if ( root == EmptyTrie )
+        return string();
+    // every query opens its own trie, only the node cache is shared
+    SecureTrieDB< Address, HistoricTrieNodeCache > const state(
+        const_cast< HistoricTrieNodeCache* >( &m_nodes ), root, Verification::Skip );
+    return state.at( _address );
+}
+
+u256 HistoricStateView::balance( Address const& _address, uint64_t _blockNumber ) const {
+    string const s = account( _address, _blockNumber );
+    return s.empty() ? 0 : RLP( s )[1].toInt< u256 >();
+}
+
+u256 HistoricStateView::getNonce( Address const& _address, uint64_t _blockNumber ) const {
+    string const s = account( _address, _blockNumber );
+    return s.empty() ? m_accountStartNonce : RLP( s )[0].toInt< u256 >();
+}
+
+h256 HistoricStateView::storageRoot( Address const& _address, uint64_t _blockNumber ) const {
+    string const s = account( _address, _blockNumber );
+    return s.empty() ? EmptyTrie : RLP( s )[2].toHash< h256 >();
+}
+
+u256 HistoricStateView::storage(
+    Address const& _address, u256 const& _key, uint64_t _blockNumber ) const {
+    h256 const root = storageRoot( _address, _blockNumber );
+    if ( root == EmptyTrie )
+        return 0;
+    SecureTrieDB< h256, HistoricTrieNodeCache > const storage(
+        const_cast< HistoricTrieNodeCache* >( &m_nodes ), root, Verification::Skip );
+    string const payload = storage.at( h256( _key ) );
+    return payload.size() ? RLP( payload ).toInt< u256 >() : 0;
+}
+
+bytes HistoricStateView::code( Address const& _address, uint64_t _blockNumber ) const {
+    string const s = account( _address, _blockNumber );
+    if ( s.empty() )
+        return bytes();
+    h256 const codeHash = RLP( s )[3].toHash< h256 >();
+    if ( codeHash == EmptySHA3 )
+        return bytes();
+    // code is large and read rarely, it does not go through the node cache
+    return asBytes( m_nodes.db().lookup( codeHash ) );
+}
@@ -0,0 +1,106 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file HistoricStateView.h
+ * @date 2026
+ * Point queries into the historic state of any block
+ */
+
+#pragma once
+
+#include <libdevcore/Address.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/ShardedLruCache.h>
+
+namespace dev {
+namespace eth {
+
+/// Max number of trie nodes kept by HistoricTrieNodeCache, 0 to disable it
+extern size_t c_historicTrieNodeCacheSize;
+/// Max number of block state roots kept by HistoricStateView
+extern size_t c_historicStateRootCacheSize;
+
+/**
+ * @brief Read-only node source for tries of the historic state database. A node is stored under
+ * the hash of its RLP and never changes, so once read it is kept for all later queries.
+ * Least recently used nodes are evicted.
+ * @threadsafe
+ */
+class HistoricTrieNodeCache {
+public:
+    using Stats = ShardedLruCache< h256, std::string >::Stats;
+
+    explicit HistoricTrieNodeCache( OverlayDB const& _db,
+        size_t _capacity = c_historicTrieNodeCacheSize, unsigned _shards = 16 );
+
+    std::string lookup( h256 const& _h ) const;
+    bool exists( h256 const& _h ) const;
+    /// Never called for tries opened with Verification::Skip, GenericTrieDB::init() needs it
+    void insert( h256 const& _h, bytesConstRef _v );
+
+    OverlayDB const& db() const { return m_db; }
+
+    Stats stats() const { return m_nodes.stats(); }
+
+private:
+    OverlayDB m_db;
+    mutable ShardedLruCache< h256, std::string > m_nodes;
+};
+
+/**
+ * @brief Read-only historic state of any committed block. Accounts and storage are read right
+ * from the tries under the state root of the block, without the State and HistoricState copies a
+ * Block is made of. Roots of recent blocks and trie nodes are shared by all queries.
+ * @threadsafe
+ */
+class HistoricStateView {
+public:
+    HistoricStateView( u256 const& _accountStartNonce, OverlayDB const& _db,
+        OverlayDB const& _blockToStateRootDB );
+
+    /// @returns state root after _blockNumber, throws UnknownBlockNumberInRootDB if there is none
+    h256 stateRoot( uint64_t _blockNumber ) const;
+
+    u256 balance( Address const& _address, uint64_t _blockNumber ) const;
+    /// @returns account start nonce for accounts which do not exist
+    u256 getNonce( Address const& _address, uint64_t _blockNumber ) const;
+    u256 storage( Address const& _address, u256 const& _key, uint64_t _blockNumber ) const;
+    h256 storageRoot( Address const& _address, uint64_t _blockNumber ) const;
+    bytes code( Address const& _address, uint64_t _blockNumber ) const;
+
+    HistoricTrieNodeCache::Stats trieNodeCacheStats() const { return m_nodes.stats(); }
+
+private:
+    /// @returns RLP of the account, empty if it does not exist at _blockNumber
+    std::string account( Address const& _address, uint64_t _blockNumber ) const;
+
+    u256 m_accountStartNonce;
+    OverlayDB m_blockToStateRootDB;
+    HistoricTrieNodeCache m_nodes;
+
+    mutable LruCache< uint64_t, h256 > m_roots;
+    mutable Mutex x_roots;
+};
+
+}  // namespace eth
+}  // namespace dev
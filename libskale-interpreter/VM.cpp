@@ -18,8 +18,13 @@
 #include "VM.h"
 #include "interpreter.h"
 
+#include <libevm/FramePool.h>
 #include <skale/version.h>
 
+#if EVM_NATIVE_UINT256
+#include <libevm/Uint256.h>
+#endif
+
 namespace {
 void destroy( evmc_instance* _instance ) {
     ( void ) _instance;
@@ -37,7 +42,9 @@ void delete_output( const evmc_result* result ) {
 evmc_result execute( evmc_instance* _instance, evmc_context* _context, evmc_revision _rev,
     const evmc_message* _msg, uint8_t const* _code, size_t _codeSize ) noexcept {
     ( void ) _instance;
-    std::unique_ptr< dev::eth::VM > vm{ new dev::eth::VM };
+    using Frames = dev::eth::FramePool< dev::eth::VM >;
+    std::unique_ptr< dev::eth::VM, void ( * )( dev::eth::VM* ) > vm{
+        Frames::acquire(), Frames::release };
 
     evmc_result result = {};
     dev::eth::owning_bytes_ref output;
@@ -102,7 +109,16 @@ extern "C" evmc_instance* evmc_create_interpreter() noexcept {
 namespace dev {
 namespace eth {
 uint64_t VM::memNeed( u256 const& _offset, u256 const& _size ) {
+#if EVM_NATIVE_UINT256
+    if ( !_size )
+        return 0;
+    // the sum is too big if any of them is
+    if ( _offset > 0x7FFFFFFFFFFFFFFF || _size > 0x7FFFFFFFFFFFFFFF )
+        throwOutOfGas();
+    return toInt63( uint64_t( _offset ) + uint64_t( _size ) );
+#else
     return toInt63( _size ? u512( _offset ) + _size : u512( 0 ) );
+#endif
 }
 
 template < class S >
@@ -145,6 +161,19 @@ uint64_t VM::decodeJumpvDest( const _byte_* const _code, uint64_t& _pc, _byte_ _
     return dest;
 }
 
+#if EVM_BASIC_BLOCKS
+//
+// for decoding the PUSH of a superinstruction, _pc is moved to the instruction after the PUSH
+//
+u256 VM::decodePush( uint64_t& _pc ) {
+    int numBytes = ( int ) m_code[_pc] - ( int ) Instruction::PUSH1 + 1;
+    u256 value = 0;
+    for ( ++_pc; numBytes--; ++_pc )
+        value = ( value << 8 ) | m_code[_pc];
+    return value;
+}
+#endif
+
 
 //
 // set current SP to SP', adjust SP' per _removed and _added items
@@ -161,12 +190,22 @@ void VM::adjustStack( int _removed, int _added ) {
         throwBadStack( _removed, _added );
 }
 
-uint64_t VM::gasForMem( u512 const& _size ) {
+#if EVM_NATIVE_UINT256
+uint64_t VM::gasForMem( uint64_t _size ) {
+    constexpr int64_t memoryGas = VMSchedule::memoryGas;
+    constexpr int64_t quadCoeffDiv = VMSchedule::quadCoeffDiv;
+    // _size < 2^64, so this cannot overflow
+    native::uint128 s = _size / 32;
+    return toInt63( memoryGas * s + s * s / quadCoeffDiv );
+}
+#else
+uint64_t VM::gasForMem( uint64_t _size ) {
     constexpr int64_t memoryGas = VMSchedule::memoryGas;
     constexpr int64_t quadCoeffDiv = VMSchedule::quadCoeffDiv;
     u512 s = _size / 32;
     return toInt63( memoryGas * s + s * s / quadCoeffDiv );
 }
+#endif
 
 void VM::updateIOGas() {
     if ( m_io_gas < m_runGas )
@@ -197,7 +236,47 @@ void VM::logGasMem() {
     updateMem( memNeed( m_SP[0], m_SP[1] ) );
 }
 
+#if EVM_BASIC_BLOCKS
+//
+// charge the block starting at m_PC, if its static gas and stack bounds are fine
+//
+bool VM::beginBlock() {
+    uint32_t const index = m_blockAt[m_PC];
+    if ( !index )
+        return false;
+
+    BasicBlock const& block = m_blocks[index - 1];
+    int64_t const height = m_stackEnd - m_SPP;
+    if ( m_io_gas < block.gas || height < block.stackRequired ||
+         height + block.stackGrowth > VMSchedule::stackLimit ) {
+        // run it instruction by instruction to fail where it would without blocks
+        m_blockBegin = m_blockEnd = 0;
+        return false;
+    }
+
+    m_io_gas -= block.gas;
+    m_blockBegin = m_PC;
+    m_blockEnd = block.end;
+    return true;
+}
+#endif
+
 void VM::fetchInstruction() {
+#if EVM_BASIC_BLOCKS
+    if ( ( m_blockBegin < m_PC && m_PC < m_blockEnd ) || beginBlock() ) {
+        // stack bounds are checked and static gas is charged for the whole block
+        m_OP = Instruction( m_fused[m_PC] );
+        auto const metric = ( *m_blockMetrics )[static_cast< size_t >( m_OP )];
+        m_SP = m_SPP;
+        m_SPP += metric.num_stack_arguments - metric.num_stack_returned_items;
+
+        m_runGas = metric.gas_cost;
+        m_newMemSize = m_mem.size();
+        m_copyMemSize = 0;
+        return;
+    }
+#endif
+
     m_OP = Instruction( m_code[m_PC] );
     auto const metric = ( *m_metrics )[static_cast< size_t >( m_OP )];
     adjustStack( metric.num_stack_arguments, metric.num_stack_returned_items );
@@ -224,12 +303,27 @@ owning_bytes_ref VM::exec( evmc_context* _context, evmc_revision _rev, const evm
     m_context = _context;
     m_rev = _rev;
     m_metrics = &s_metrics[m_rev];
+#if EVM_BASIC_BLOCKS
+    m_blockMetrics = &s_blockMetrics[m_rev];
+#endif
     m_message = _msg;
     m_io_gas = uint64_t( _msg->gas );
     m_PC = 0;
     m_pCode = _code;
     m_codeSize = _codeSize;
 
+    // the VM may have run other frames before
+    m_tx_context = boost::none;
+    m_SP = m_SPP = m_stackEnd;
+    m_mem.clear();
+    m_returnData.clear();
+    m_pool.clear();
+    m_jumpDests.clear();
+    m_nSteps = 0;
+#if EVM_BASIC_BLOCKS
+    m_blockBegin = m_blockEnd = 0;
+#endif
+
     // trampoline to minimize depth of call stack when calling out
     m_bounce = &VM::initEntry;
     do
@@ -292,7 +386,7 @@ void VM::interpretCases() {
 
             uint64_t b = ( uint64_t ) m_SP[0];
             uint64_t s = ( uint64_t ) m_SP[1];
-            m_output = owning_bytes_ref{ std::move( m_mem ), b, s };
+            m_output = returnedMemory( b, s );
             m_bounce = 0;
         }
         BREAK
@@ -309,8 +403,7 @@ void VM::interpretCases() {
 
             uint64_t b = ( uint64_t ) m_SP[0];
             uint64_t s = ( uint64_t ) m_SP[1];
-            owning_bytes_ref output{ std::move( m_mem ), b, s };
-            throwRevertInstruction( std::move( output ) );
+            throwRevertInstruction( returnedMemory( b, s ) );
         }
         BREAK;
 
@@ -509,7 +602,11 @@ void VM::interpretCases() {
             updateIOGas();
 
             // pops two items and pushes their sum mod 2^256.
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::add( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] + m_SP[1];
+#endif
         }
         NEXT
 
@@ -518,7 +615,11 @@ void VM::interpretCases() {
             updateIOGas();
 
             // pops two items and pushes their product mod 2^256.
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mul( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] * m_SP[1];
+#endif
         }
         NEXT
 
@@ -526,7 +627,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sub( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[0] - m_SP[1];
+#endif
         }
         NEXT
 
@@ -534,7 +639,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::div( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? divWorkaround( m_SP[0], m_SP[1] ) : 0;
+#endif
         }
         NEXT
 
@@ -542,7 +651,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sdiv( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? s2u( divWorkaround( u2s( m_SP[0] ), u2s( m_SP[1] ) ) ) : 0;
+#endif
             --m_SP;
         }
         NEXT
@@ -551,7 +664,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mod( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? modWorkaround( m_SP[0], m_SP[1] ) : 0;
+#endif
         }
         NEXT
 
@@ -559,7 +676,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::smod( m_SP[0], m_SP[1] );
+#else
             m_SPP[0] = m_SP[1] ? s2u( modWorkaround( u2s( m_SP[0] ), u2s( m_SP[1] ) ) ) : 0;
+#endif
         }
         NEXT
 
@@ -660,10 +781,14 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::shl( m_SP[1], m_SP[0] );
+#else
             if ( m_SP[0] >= 256 )
                 m_SPP[0] = 0;
             else
                 m_SPP[0] = m_SP[1] << unsigned( m_SP[0] );
+#endif
         }
         NEXT
 
@@ -675,10 +800,14 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::shr( m_SP[1], m_SP[0] );
+#else
             if ( m_SP[0] >= 256 )
                 m_SPP[0] = 0;
             else
                 m_SPP[0] = m_SP[1] >> unsigned( m_SP[0] );
+#endif
         }
         NEXT
 
@@ -690,6 +819,9 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::sar( m_SP[1], m_SP[0] );
+#else
             static u256 const hibit = u256( 1 ) << 255;
             static u256 const allbits =
                 u256( "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" );
@@ -706,6 +838,7 @@ void VM::interpretCases() {
                 if ( shiftee & hibit )
                     m_SPP[0] |= allbits << ( 256 - amount );
             }
+#endif
         }
         NEXT
 
@@ -713,7 +846,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::addmod( m_SP[0], m_SP[1], m_SP[2] );
+#else
             m_SPP[0] = m_SP[2] ? u256( ( u512( m_SP[0] ) + u512( m_SP[1] ) ) % m_SP[2] ) : 0;
+#endif
         }
         NEXT
 
@@ -721,7 +858,11 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::mulmod( m_SP[0], m_SP[1], m_SP[2] );
+#else
             m_SPP[0] = m_SP[2] ? u256( ( u512( m_SP[0] ) * u512( m_SP[1] ) ) % m_SP[2] ) : 0;
+#endif
         }
         NEXT
 
@@ -729,6 +870,9 @@ void VM::interpretCases() {
             ON_OP();
             updateIOGas();
 
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::signextend( m_SP[0], m_SP[1] );
+#else
             if ( m_SP[0] < 31 ) {
                 unsigned testBit = static_cast< unsigned >( m_SP[0] ) * 8 + 7;
                 u256& number = m_SP[1];
@@ -738,6 +882,7 @@ void VM::interpretCases() {
                 else
                     number &= mask;
             }
+#endif
         }
         NEXT
 
@@ -1172,6 +1317,80 @@ void VM::interpretCases() {
         }
         CONTINUE
 
+        //
+        // superinstructions, run only inside of a charged block
+        //
+
+        CASE( PUSHADD ) {
+#if EVM_BASIC_BLOCKS
+            ON_OP();
+            updateIOGas();
+
+            u256 const value = decodePush( m_PC );
+#if EVM_NATIVE_UINT256
+            m_SPP[0] = native::add( m_SP[0], value );
+#else
+            m_SPP[0] = m_SP[0] + value;
+#endif
+            ++m_PC;
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
+        CASE( PUSHJUMPI ) {
+#if EVM_BASIC_BLOCKS
+            ON_OP();
+            updateIOGas();
+
+            // the pushed destination is never on the stack, the condition is on top
+            uint64_t pc = m_PC;
+            u256 const dest = decodePush( pc );
+            if ( !m_SP[0] )
+                m_PC = pc + 1;
+            else if ( Instruction( m_code[pc] ) == Instruction::JUMPCI )
+                m_PC = uint64_t( dest );
+            else
+                m_PC = verifyJumpDest( dest );
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
+        CASE( PUSHMSTORE ) {
+#if EVM_BASIC_BLOCKS
+            ON_OP();
+            uint64_t pc = m_PC;
+            u256 const offset = decodePush( pc );
+            updateMem( toInt63( offset ) + 32 );
+            updateIOGas();
+
+            *( h256* ) &m_mem[( unsigned ) offset] = ( h256 ) m_SP[0];
+            m_PC = pc + 1;
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
+        CASE( DUPSWAP ) {
+#if EVM_BASIC_BLOCKS
+            ON_OP();
+            updateIOGas();
+
+            unsigned const n = ( unsigned ) m_code[m_PC] - ( unsigned ) Instruction::DUP1;
+            unsigned const m = ( unsigned ) m_code[m_PC + 1] - ( unsigned ) Instruction::SWAP1 + 1;
+            new ( m_SPP ) u256( m_SP[n] );
+            std::swap( m_SPP[0], m_SPP[m] );
+            m_PC += 2;
+#else
+            throwBadInstruction();
+#endif
+        }
+        CONTINUE
+
         CASE( DUP1 )
         CASE( DUP2 )
         CASE( DUP3 )
@@ -1277,7 +1496,6 @@ void VM::interpretCases() {
         NEXT
 
         CASE( JUMPDEST ) {
-            m_runGas = VMSchedule::jumpdestGas;
             ON_OP();
             updateIOGas();
         }
@@ -66,6 +66,12 @@ public:
     owning_bytes_ref exec( evmc_context* _context, evmc_revision _rev, const evmc_message* _msg,
         uint8_t const* _code, size_t _codeSize );
 
+    /// Drops the state of the finished frame before the VM is kept for reuse. Memory is kept
+    /// unless it grew over c_maxRecycledMemory.
+    void recycle();
+
+    static constexpr size_t c_maxRecycledMemory = 1024 * 1024;
+
     uint64_t m_io_gas = 0;
 
 private:
@@ -84,6 +90,7 @@ private:
 
     // return bytes
     owning_bytes_ref m_output;
+    owning_bytes_ref returnedMemory( uint64_t _begin, uint64_t _size );
 
     // space for memory
     bytes m_mem;
@@ -119,6 +126,47 @@ private:
     void initEntry();
     void optimize();
 
+#if EVM_BASIC_BLOCKS
+    /// Straight-line code that is charged and checked on entry. It ends before a JUMPDEST,
+    /// after a jump or STOP, or after an instruction that is metered on its own.
+    struct BasicBlock {
+        uint64_t end = 0;       // pc after the last instruction
+        uint64_t gas = 0;       // static gas of the instructions not metered on their own
+        int stackRequired = 0;  // items the block takes from the stack on entry
+        int stackGrowth = 0;    // most items the block has on top of the stack on entry
+    };
+
+    /// Blocks of a contract for one revision. Never changes after construction, so it is shared
+    /// by all VMs running the same code.
+    struct BlockAnalysis {
+        evmc_revision revision = EVMC_FRONTIER;
+        std::vector< BasicBlock > blocks;
+        std::vector< uint32_t > blockAt;  // 1 + index of the block starting at pc, 0 if none
+        // code with superinstructions, run only inside of a charged block
+        bytes fused;
+    };
+    std::shared_ptr< BlockAnalysis const > m_analysis;
+
+    // point into m_analysis
+    BasicBlock const* m_blocks = nullptr;
+    uint32_t const* m_blockAt = nullptr;
+    uint8_t const* m_fused = nullptr;
+
+    // the charged block being run, a jump back to its start charges it again
+    uint64_t m_blockBegin = 0;
+    uint64_t m_blockEnd = 0;
+
+    std::array< evmc_instruction_metrics, 256 >* m_blockMetrics = nullptr;
+    static std::array< std::array< evmc_instruction_metrics, 256 >, EVMC_MAX_REVISION + 1 >
+        s_blockMetrics;
+    static bool meteredAlone( Instruction _op, evmc_instruction_metrics const& _metric );
+
+    void analyzeBlocks();
+    void buildBlocks( BlockAnalysis& o_analysis ) const;
+    bool beginBlock();
+    u256 decodePush( uint64_t& _pc );
+#endif
+
     // interpreter loop & switch
     void interpretCases();
 
@@ -147,7 +195,7 @@ private:
 
     void onOperation() {}
     void adjustStack( int _removed, int _added );
-    uint64_t gasForMem( u512 const& _size );
+    uint64_t gasForMem( uint64_t _size );
     void updateIOGas();
     void updateGas();
     void updateMem( uint64_t _newMem );
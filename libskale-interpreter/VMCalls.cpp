@@ -34,6 +34,33 @@ void VM::copyDataToMemory( bytesConstRef _data, u256* _sp ) {
         std::memset( m_mem.data() + offset + sizeToBeCopied, 0, size - sizeToBeCopied );
 }
 
+// copy of the memory returned by RETURN or REVERT, memory itself stays with the VM for reuse
+owning_bytes_ref VM::returnedMemory( uint64_t _begin, uint64_t _size ) {
+    if ( !_size )
+        return {};
+    auto const begin = m_mem.begin() + _begin;
+    return owning_bytes_ref{ bytes( begin, begin + _size ), 0, _size };
+}
+
+void VM::recycle() {
+    m_context = nullptr;
+    m_message = nullptr;
+    m_tx_context = boost::none;
+    m_output = {};
+    m_returnData.clear();
+#if EVM_BASIC_BLOCKS
+    // the cache may have evicted it
+    m_analysis.reset();
+    m_blocks = nullptr;
+    m_blockAt = nullptr;
+    m_fused = nullptr;
+#endif
+    if ( m_mem.capacity() > c_maxRecycledMemory )
+        bytes().swap( m_mem );
+    else
+        m_mem.clear();
+}
+
 
 // consolidate exception throws to avoid spraying boost code all over interpreter
 
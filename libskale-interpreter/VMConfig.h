@@ -31,6 +31,11 @@ namespace eth {
 //
 // EVM_REPLACE_CONST_JUMP - pre-verified jumps to save runtime lookup
 //
+// EVM_NATIVE_UINT256     - 256-bit arithmetic on 4 64-bit limbs instead of boost::multiprecision
+//
+// EVM_BASIC_BLOCKS       - static gas and stack bounds checked once per basic block, common
+//                          pairs of instructions fused into superinstructions
+//
 // EVM_TRACE              - provides various levels of tracing
 
 #ifndef EVM_JUMP_DISPATCH
@@ -57,6 +62,14 @@ namespace eth {
 #define EVM_DO_FIRST_PASS_OPTIMIZATION ( EVM_REPLACE_CONST_JUMP || EVM_USE_CONSTANT_POOL )
 #endif
 
+#ifndef EVM_NATIVE_UINT256
+#define EVM_NATIVE_UINT256 false
+#endif
+
+#ifndef EVM_BASIC_BLOCKS
+#define EVM_BASIC_BLOCKS false
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //
@@ -313,10 +326,10 @@ namespace eth {
         &&LOG2,                                 \
         &&LOG3,                                 \
         &&LOG4,                                 \
-        &&INVALID,                              \
-        &&INVALID,                              \
-        &&INVALID,                              \
-        &&INVALID,                              \
+        &&PUSHADD,                              \
+        &&PUSHJUMPI,                            \
+        &&PUSHMSTORE,                           \
+        &&DUPSWAP,                              \
         &&INVALID,                              \
         &&INVALID,                              \
         &&INVALID,                              \
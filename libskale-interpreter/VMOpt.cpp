@@ -17,9 +17,23 @@
 
 #include "VM.h"
 
+#if EVM_NATIVE_UINT256
+#include <libevm/Uint256.h>
+#endif
+
+#if EVM_BASIC_BLOCKS
+#include <libdevcore/ShardedLruCache.h>
+
+#include <ethash/keccak.hpp>
+#endif
+
 namespace dev {
 namespace eth {
 std::array< std::array< evmc_instruction_metrics, 256 >, EVMC_MAX_REVISION + 1 > VM::s_metrics;
+#if EVM_BASIC_BLOCKS
+std::array< std::array< evmc_instruction_metrics, 256 >, EVMC_MAX_REVISION + 1 >
+    VM::s_blockMetrics;
+#endif
 
 bool VM::initMetrics() {
     for ( auto revision = 0; revision <= EVMC_MAX_REVISION; ++revision ) {
@@ -35,6 +49,28 @@ bool VM::initMetrics() {
         metrics[uint8_t( Instruction::JUMPC )] = metrics[uint8_t( Instruction::JUMP )];
         metrics[uint8_t( Instruction::JUMPCI )] =
             s_metrics[revision][uint8_t( Instruction::JUMPI )];
+
+#if EVM_BASIC_BLOCKS
+        // Inside of a block only the instructions metered on their own are charged when run.
+        auto& blockMetrics = s_blockMetrics[revision];
+        blockMetrics = metrics;
+        for ( size_t op = 0; op < blockMetrics.size(); ++op )
+            if ( !meteredAlone( Instruction( op ), metrics[op] ) )
+                blockMetrics[op].gas_cost = 0;
+
+        // Superinstructions move the stack pointer as their parts do together.
+        auto const fuse = [&blockMetrics]( Instruction _op, int16_t _gas, int8_t _removed,
+                              int8_t _added ) {
+            auto& metric = blockMetrics[uint8_t( _op )];
+            metric.gas_cost = _gas;
+            metric.num_stack_arguments = _removed;
+            metric.num_stack_returned_items = _added;
+        };
+        fuse( Instruction::PUSHADD, 0, 1, 1 );
+        fuse( Instruction::PUSHJUMPI, 0, 1, 0 );
+        fuse( Instruction::PUSHMSTORE, metrics[uint8_t( Instruction::MSTORE )].gas_cost, 1, 0 );
+        fuse( Instruction::DUPSWAP, 0, 0, 1 );
+#endif
     };
     return true;
 }
@@ -62,7 +98,8 @@ void VM::optimize() {
         TRACE_OP( 2, pc, op );
 
         // make synthetic ops in user code trigger invalid instruction if run
-        if ( op == Instruction::PUSHC || op == Instruction::JUMPC || op == Instruction::JUMPCI ) {
+        if ( op == Instruction::PUSHC || op == Instruction::JUMPC || op == Instruction::JUMPCI ||
+             ( Instruction::PUSHADD <= op && op <= Instruction::DUPSWAP ) ) {
             TRACE_OP( 1, pc, op );
             m_code[pc] = ( _byte_ ) Instruction::UNDEFINED;
         }
@@ -144,8 +181,194 @@ void VM::optimize() {
     }
     TRACE_STR( 1, "Finished optimizations" )
 #endif
+
+#if EVM_BASIC_BLOCKS
+    analyzeBlocks();
+#endif
+}
+
+#if EVM_BASIC_BLOCKS
+
+//
+// Instructions with dynamic gas, reading the gas counter or calling out. They are charged when
+// run, as without blocks, and end the block they are in.
+//
+bool VM::meteredAlone( Instruction _op, evmc_instruction_metrics const& _metric ) {
+    // undefined in this revision
+    if ( _metric.gas_cost < 0 )
+        return true;
+
+    switch ( _op ) {
+    case Instruction::EXP:
+    case Instruction::SHA3:
+    case Instruction::CALLDATACOPY:
+    case Instruction::CODECOPY:
+    case Instruction::EXTCODECOPY:
+    case Instruction::RETURNDATACOPY:
+    case Instruction::BLOCKHASH:
+    case Instruction::MLOAD:
+    case Instruction::MSTORE:
+    case Instruction::MSTORE8:
+    case Instruction::SSTORE:
+    case Instruction::GAS:
+    case Instruction::LOG0:
+    case Instruction::LOG1:
+    case Instruction::LOG2:
+    case Instruction::LOG3:
+    case Instruction::LOG4:
+    case Instruction::CREATE:
+    case Instruction::CREATE2:
+    case Instruction::CALL:
+    case Instruction::CALLCODE:
+    case Instruction::DELEGATECALL:
+    case Instruction::STATICCALL:
+    case Instruction::RETURN:
+    case Instruction::REVERT:
+    case Instruction::SUICIDE:
+    case Instruction::INVALID:
+        return true;
+    default:
+        return false;
+    }
 }
 
+namespace {
+// size of the instruction at _pc in the original code, with its pushed bytes
+uint64_t instructionSize( uint8_t const* _code, uint64_t _pc ) {
+    _byte_ const op = _code[_pc];
+    if ( ( _byte_ ) Instruction::PUSH1 <= op && op <= ( _byte_ ) Instruction::PUSH32 )
+        return op - ( _byte_ ) Instruction::PUSH1 + 2;
+    return 1;
+}
+
+bool isPush( Instruction _op ) {
+    return Instruction::PUSH1 <= _op && _op <= Instruction::PUSH32;
+}
+
+// max number of contracts whose blocks are kept, as for LegacyVMCodeCache
+size_t const c_blockCacheSize = 1024;
+}  // namespace
+
+//
+// Look up blocks of the code by its hash, so that calls into the same contract skip the analysis.
+// evmc does not pass the code hash, hashing is still cheaper than building the tables.
+//
+void VM::analyzeBlocks() {
+    using Cache = ShardedLruCache< h256, std::shared_ptr< BlockAnalysis const > >;
+    static Cache s_cache( c_blockCacheSize );
+
+    ethash::hash256 const hash = ethash::keccak256( m_pCode, m_codeSize );
+    h256 const codeHash( bytesConstRef( hash.bytes, sizeof( hash.bytes ) ) );
+
+    auto cached = s_cache.find( codeHash );
+    // gas costs differ between revisions, size check guards against hash collisions
+    if ( cached && ( *cached )->revision == m_rev && ( *cached )->fused.size() == m_code.size() )
+        m_analysis = *cached;
+    else {
+        // analyze without the lock, other threads may do the same meanwhile
+        auto analysis = std::make_shared< BlockAnalysis >();
+        buildBlocks( *analysis );
+        m_analysis = analysis;
+        s_cache.replace( codeHash, m_analysis );
+    }
+
+    m_blocks = m_analysis->blocks.data();
+    m_blockAt = m_analysis->blockAt.data();
+    m_fused = m_analysis->fused.data();
+}
+
+//
+// Split code into blocks charged on entry, so that static gas and stack bounds are checked once
+// per block. If the checks fail the block is run instruction by instruction, so that errors are
+// raised at the same instruction as without blocks.
+//
+void VM::buildBlocks( BlockAnalysis& o_analysis ) const {
+    auto const& metrics = *m_metrics;
+    auto& blocks = o_analysis.blocks;
+    auto& blockAt = o_analysis.blockAt;
+    auto& fusedCode = o_analysis.fused;
+    o_analysis.revision = m_rev;
+    blockAt.assign( m_code.size(), 0 );
+
+    TRACE_STR( 1, "Build basic blocks" )
+    BasicBlock block;
+    uint64_t begin = 0;
+    int height = 0;
+    bool open = false;
+    auto const close = [&]( uint64_t _end ) {
+        block.end = _end;
+        blocks.push_back( block );
+        blockAt[begin] = uint32_t( blocks.size() );
+        open = false;
+    };
+
+    uint64_t pc = 0;
+    while ( pc < m_codeSize ) {
+        Instruction const op = Instruction( m_code[pc] );
+        uint64_t const next = pc + instructionSize( m_pCode, pc );
+
+        if ( open && op == Instruction::JUMPDEST )
+            close( pc );
+        if ( !open ) {
+            block = BasicBlock();
+            begin = pc;
+            height = 0;
+            open = true;
+        }
+
+        auto const& metric = metrics[static_cast< size_t >( op )];
+        block.stackRequired = std::max( block.stackRequired, metric.num_stack_arguments - height );
+        height += metric.num_stack_returned_items - metric.num_stack_arguments;
+        block.stackGrowth = std::max( block.stackGrowth, height );
+
+        bool const alone = meteredAlone( op, metric );
+        if ( !alone )
+            block.gas += metric.gas_cost;
+        if ( alone || op == Instruction::STOP || op == Instruction::JUMP ||
+             op == Instruction::JUMPI || op == Instruction::JUMPC || op == Instruction::JUMPCI )
+            close( next );
+
+        pc = next;
+    }
+    // the code is followed by STOP
+    if ( open )
+        close( pc );
+
+    // Both parts of a superinstruction are always in the same block: a PUSH or DUP does not end
+    // a block and what follows it is not a JUMPDEST. The parts are read from m_code when run.
+    TRACE_STR( 1, "Fuse superinstructions" )
+    fusedCode = m_code;
+    for ( pc = 0; pc < m_codeSize; ) {
+        Instruction const op = Instruction( m_code[pc] );
+        uint64_t next = pc + instructionSize( m_pCode, pc );
+        if ( next >= m_codeSize )
+            break;
+
+        Instruction const second = Instruction( m_code[next] );
+        Instruction fused = op;
+        if ( isPush( op ) && second == Instruction::ADD )
+            fused = Instruction::PUSHADD;
+        else if ( isPush( op ) &&
+                  ( second == Instruction::JUMPI || second == Instruction::JUMPCI ) )
+            fused = Instruction::PUSHJUMPI;
+        else if ( isPush( op ) && second == Instruction::MSTORE )
+            fused = Instruction::PUSHMSTORE;
+        else if ( Instruction::DUP1 <= op && op <= Instruction::DUP16 &&
+                  Instruction::SWAP1 <= second && second <= Instruction::SWAP16 )
+            fused = Instruction::DUPSWAP;
+
+        if ( fused != op ) {
+            TRACE_PRE_OPT( 1, pc, op );
+            fusedCode[pc] = _byte_( fused );
+            TRACE_POST_OPT( 1, pc, fused );
+            next += 1;
+        }
+        pc = next;
+    }
+}
+
+#endif
+
 
 //
 // Init interpreter on entry.
@@ -163,6 +386,9 @@ void VM::initEntry() {
 // mod operation.
 // Do not inline it.
 u256 VM::exp256( u256 _base, u256 _exponent ) {
+#if EVM_NATIVE_UINT256
+    return native::exp( _base, _exponent );
+#else
     using boost::multiprecision::limb_type;
     u256 result = 1;
     while ( _exponent ) {
@@ -172,6 +398,7 @@ u256 VM::exp256( u256 _base, u256 _exponent ) {
         _exponent >>= 1;
     }
     return result;
+#endif
 }
 }  // namespace eth
 }  // namespace dev
@@ -0,0 +1,83 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file AccountCache.cpp
+ * @date 2026
+ */
+
+#include "AccountCache.h"
+
+using dev::Address;
+using dev::u256;
+
+namespace skale {
+
+AccountCache::AccountCache( size_t _capacity )
+    : m_accounts( std::max< size_t >( _capacity, 1 ) ),
+      m_storage( std::max< size_t >( _capacity, 1 ) ) {}
+
+bool AccountCache::lookup( Address const& _address, CachedAccount& o_account ) {
+    if ( std::optional< CachedAccount > cached = m_accounts.find( _address ) ) {
+        o_account = *cached;
+        return true;
+    }
+    return false;
+}
+
+bool AccountCache::peek( Address const& _address, CachedAccount& o_account ) {
+    if ( std::optional< CachedAccount > cached = m_accounts.peek( _address ) ) {
+        o_account = *cached;
+        return true;
+    }
+    return false;
+}
+
+void AccountCache::insert( Address const& _address, CachedAccount const& _account ) {
+    m_accounts.replace( _address, _account );
+}
+
+void AccountCache::remove( Address const& _address ) {
+    m_accounts.remove( _address );
+}
+
+bool AccountCache::lookup( Address const& _address, u256 const& _key, u256& o_value ) {
+    if ( std::optional< u256 > cached = m_storage.find( { _address, _key } ) ) {
+        o_value = *cached;
+        return true;
+    }
+    return false;
+}
+
+void AccountCache::insert( Address const& _address, u256 const& _key, u256 const& _value ) {
+    m_storage.replace( { _address, _key }, _value );
+}
+
+void AccountCache::clear() {
+    m_accounts.clear();
+    m_storage.clear();
+}
+
+AccountCache::Stats AccountCache::stats() const {
+    auto const accounts = m_accounts.stats();
+    auto const storage = m_storage.stats();
+    return Stats{ accounts.hits, accounts.misses, storage.hits, storage.misses, accounts.size,
+        storage.size };
+}
+
+}  // namespace skale
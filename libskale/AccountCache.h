@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file AccountCache.h
+ * @date 2026
+ */
+
+#pragma once
+
+#include <libdevcore/Address.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/ShardedLruCache.h>
+
+namespace skale {
+
+/// Account fields as they are stored in the state DB
+struct CachedAccount {
+    dev::u256 nonce;
+    dev::u256 balance;
+    dev::h256 codeHash;
+    dev::s256 storageUsed;
+    dev::u256 version;
+};
+
+/// Decoded accounts and storage values of the last committed state.
+/// One instance is shared by a State and all its copies; State::commit() updates it with
+/// everything it writes. Entries are split into shards with own lock and LRU order,
+/// so concurrent readers rarely wait for each other.
+class AccountCache {
+public:
+    struct Stats {
+        uint64_t accountHits;
+        uint64_t accountMisses;
+        uint64_t storageHits;
+        uint64_t storageMisses;
+        size_t accounts;
+        size_t storageValues;
+    };
+
+    /// @param _capacity maximum number of accounts and, separately, of storage values
+    explicit AccountCache( size_t _capacity );
+
+    AccountCache( AccountCache const& ) = delete;
+    AccountCache& operator=( AccountCache const& ) = delete;
+
+    bool lookup( dev::Address const& _address, CachedAccount& o_account );
+    /// Same as lookup() but not counted in stats
+    bool peek( dev::Address const& _address, CachedAccount& o_account );
+    void insert( dev::Address const& _address, CachedAccount const& _account );
+    void remove( dev::Address const& _address );
+
+    bool lookup( dev::Address const& _address, dev::u256 const& _key, dev::u256& o_value );
+    void insert( dev::Address const& _address, dev::u256 const& _key, dev::u256 const& _value );
+
+    void clear();
+
+    Stats stats() const;
+
+private:
+    using StorageKey = std::pair< dev::Address, dev::u256 >;
+
+    struct StorageKeyHash {
+        size_t operator()( StorageKey const& _key ) const {
+            return std::hash< dev::Address >()( _key.first ) ^
+                   ( static_cast< size_t >( _key.second ) * 0x9e3779b97f4a7c15ULL );
+        }
+    };
+
+    dev::ShardedLruCache< dev::Address, CachedAccount > m_accounts;
+    dev::ShardedLruCache< StorageKey, dev::u256, StorageKeyHash > m_storage;
+};
+
+}  // namespace skale
@@ -0,0 +1,13 @@
+#include "IncrementalSnapshotHashPatch.h"
+
+bool IncrementalSnapshotHashPatch::isScheduled( const dev::eth::ChainParams& _cp ) {
+    return _cp.sChain.incrementalSnapshotHashPatchTimestamp != 0;
+}
+
+bool IncrementalSnapshotHashPatch::isEnabledWhen(
+    const dev::eth::ChainParams& _cp, time_t _blockTimestamp ) {
+    if ( !isScheduled( _cp ) ) {
+        return false;
+    }
+    return _cp.sChain.incrementalSnapshotHashPatchTimestamp <= _blockTimestamp;
+}
@@ -0,0 +1,25 @@
+#ifndef INCREMENTALSNAPSHOTHASHPATCH_H
+#define INCREMENTALSNAPSHOTHASHPATCH_H
+
+#include <libethereum/ChainParams.h>
+#include <libethereum/SchainPatch.h>
+
+#include <time.h>
+
+/*
+ * Context: snapshot hashing walked all entries of every DB
+ * Solution: owned DBs keep an order-independent hash up to date on each write, see
+ *     LevelDB::incrementalHash(). It differs from hashBase(), so all nodes switch to it for
+ *     snapshots of blocks after incrementalSnapshotHashPatchTimestamp
+ * Purpose: hash snapshots without reading all state
+ * Version introduced:
+ */
+class IncrementalSnapshotHashPatch : public SchainPatch {
+public:
+    /// DBs keep the incremental hash up to date once the patch is scheduled
+    static bool isScheduled( const dev::eth::ChainParams& _cp );
+    /// Whether snapshot of a block with _blockTimestamp is hashed incrementally
+    static bool isEnabledWhen( const dev::eth::ChainParams& _cp, time_t _blockTimestamp );
+};
+
+#endif  // INCREMENTALSNAPSHOTHASHPATCH_H
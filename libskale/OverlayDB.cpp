@@ -198,7 +198,7 @@ void OverlayDB::commit( const std::string& _debugCommitId ) {
                 commitStorageValues();
 
                 m_db_face->insert( skale::slicing::toSlice( "storageUsed" ),
-                    skale::slicing::toSlice( storageUsed_.str() ) );
+                    skale::slicing::toSlice( storageUsed_.value_or( 0 ).str() ) );
 
                 m_db_face->insert( skale::slicing::toSlice( "safeLastExecutedTransactionHash" ),
                     skale::slicing::toSlice( getLastExecutedTransactionHash() ) );
@@ -240,6 +240,8 @@ void OverlayDB::commit( const std::string& _debugCommitId ) {
             m_cache.clear();
             m_auxiliaryCache.clear();
             m_storageCache.clear();
+            m_killedAccounts.clear();
+            m_killedAuxiliary.clear();
             m_db_face->revert();
         }
     } else {
@@ -248,6 +250,9 @@ void OverlayDB::commit( const std::string& _debugCommitId ) {
 }
 
 string OverlayDB::lookupAuxiliary( h160 const& _address, _byte_ _space ) const {
+    if ( m_killedAuxiliary.count( { _address, _space } ) )
+        return string();
+
     string value;
     auto addressSpacePairPtr = m_auxiliaryCache.find( _address );
     if ( addressSpacePairPtr != m_auxiliaryCache.end() ) {
@@ -280,15 +285,16 @@ void OverlayDB::killAuxiliary( const dev::h160& _address, _byte_ _space ) {
             }
         }
     }
-    if ( !cache_hit ) {
-        if ( m_db_face ) {
-            bytes key = getAuxiliaryKey( _address, _space );
-            if ( m_db_face->exists( skale::slicing::toSlice( key ) ) ) {
-                // NB! This is not committed! So, this can be reverted
-                m_db_face->kill( skale::slicing::toSlice( key ) );
-            } else {
-                ctrace << "Try to delete non existing key " << _address << "(" << _space << ")";
-            }
+    // cached value can also shadow a committed one when several transactions
+    // are staged before a single commit (see State::startBlockScopedCommit)
+    if ( m_db_face ) {
+        bytes key = getAuxiliaryKey( _address, _space );
+        if ( m_db_face->exists( skale::slicing::toSlice( key ) ) ) {
+            // NB! This is not committed! So, this can be reverted
+            m_db_face->kill( skale::slicing::toSlice( key ) );
+            m_killedAuxiliary.insert( { _address, _space } );
+        } else if ( !cache_hit ) {
+            ctrace << "Try to delete non existing key " << _address << "(" << _space << ")";
         }
     }
 }
@@ -306,49 +312,74 @@ void OverlayDB::insertAuxiliary(
     } else {
         m_auxiliaryCache[_address][_space] = _value.toBytes();
     }
+    m_killedAuxiliary.erase( { _address, _space } );
 }
 
 std::unordered_map< h160, string > OverlayDB::accounts() const {
     cnote << "Iterating over all accounts in state";
     unordered_map< h160, string > accounts;
     if ( m_db_face ) {
-        m_db_face->forEach( [&accounts]( Slice key, Slice value ) {
-            if ( key.size() == h160::size ) {
-                // key is account address
-                string keyString( key.begin(), key.end() );
-                h160 address = h160( keyString, h160::ConstructFromStringType::FromBinary );
-                accounts[address] = string( value.begin(), value.end() );
-            }
-            return true;
-        } );
+        // storage and auxiliary keys of an account follow its key, they are skipped by seeking
+        // past the address instead of being read
+        std::string begin;
+        for ( bool seek = true; seek; ) {
+            seek = false;
+            m_db_face->forEachInRange( begin, Slice(), [&]( Slice key, Slice value ) {
+                if ( key.size() == h160::size ) {
+                    // key is account address
+                    string keyString( key.begin(), key.end() );
+                    h160 address = h160( keyString, h160::ConstructFromStringType::FromBinary );
+                    accounts[address] = string( value.begin(), value.end() );
+                } else if ( key.size() > h160::size ) {
+                    begin = dev::db::prefixUpperBound( key.cropped( 0, h160::size ) );
+                    seek = !begin.empty();
+                    return false;
+                }
+                return true;
+            } );
+        }
     } else {
         cerror << "Try to load account but connection to database is not established";
     }
+    for ( auto const& address : m_killedAccounts )
+        accounts.erase( address );
+    for ( auto const& addressValuePair : m_cache )
+        accounts[addressValuePair.first] =
+            string( addressValuePair.second.begin(), addressValuePair.second.end() );
     return accounts;
 }
 
 std::unordered_map< u256, u256 > OverlayDB::storage( const dev::h160& _address ) const {
     unordered_map< u256, u256 > storage;
     if ( m_db_face ) {
-        m_db_face->forEach( [&storage, &_address]( Slice key, Slice value ) {
-            if ( key.size() == h160::size + h256::size ) {
-                // key is storage address
-                string keyString( key.begin(), key.end() );
-                h160 address = h160(
-                    keyString.substr( 0, h160::size ), h160::ConstructFromStringType::FromBinary );
-                if ( address == _address ) {
-                    h256 memoryAddress = h256(
-                        keyString.substr( h160::size ), h256::ConstructFromStringType::FromBinary );
+        // keys of the account's storage are contiguous, only they are read
+        m_db_face->forEachWithPrefix(
+            slicing::toSlice( _address ), [&storage]( Slice key, Slice value ) {
+                if ( key.size() == h160::size + h256::size ) {
+                    // key is storage address
+                    string keyString( key.begin(), key.end() );
+                    h256 memoryAddress = h256( keyString.substr( h160::size ),
+                        h256::ConstructFromStringType::FromBinary );
                     u256 memoryValue = h256( string( value.begin(), value.end() ),
                         h256::ConstructFromStringType::FromBinary );
                     storage[memoryAddress] = memoryValue;
                 }
-            }
-            return true;
-        } );
+                return true;
+            } );
     } else {
         cerror << "Try to load account's storage but connection to database is not established";
     }
+    auto address_ptr = m_storageCache.find( _address );
+    if ( address_ptr != m_storageCache.end() ) {
+        for ( auto const& storageAddressValuePair : address_ptr->second ) {
+            u256 memoryAddress = storageAddressValuePair.first;
+            u256 memoryValue = storageAddressValuePair.second;
+            if ( ContractStorageZeroValuePatch::isEnabled() && memoryValue == 0 )
+                storage.erase( memoryAddress );
+            else
+                storage[memoryAddress] = memoryValue;
+        }
+    }
     return storage;
 }
 
@@ -356,31 +387,28 @@ void OverlayDB::copyStorageIntoAccountMap( dev::eth::AccountMap& _map ) const {
     static uint64_t counter = 0;
 
     if ( m_db_face ) {
-        m_db_face->forEach( [&_map]( Slice key, Slice value ) {
-            if ( key.size() == h160::size + h256::size ) {
-                // key is storage address
-                string keyString( key.begin(), key.end() );
-                [[maybe_unused]] h160 address = h160(
-                    keyString.substr( 0, h160::size ), h160::ConstructFromStringType::FromBinary );
-
-                if ( _map.count( address ) == 0 )
+        for ( auto& addressAccountPair : _map ) {
+            dev::eth::Account& account = addressAccountPair.second;
+            m_db_face->forEachWithPrefix( slicing::toSlice( addressAccountPair.first ),
+                [&account]( Slice key, Slice value ) {
+                    if ( key.size() == h160::size + h256::size ) {
+                        // key is storage address
+                        string keyString( key.begin(), key.end() );
+                        h256 memoryAddress = h256( keyString.substr( h160::size ),
+                            h256::ConstructFromStringType::FromBinary );
+                        u256 memoryValue = h256( string( value.begin(), value.end() ),
+                            h256::ConstructFromStringType::FromBinary );
+
+                        account.setStorage( memoryAddress, memoryValue );
+                        counter++;
+                        if ( counter % 1000000 == 0 ) {
+                            std::cout << ".";
+                            std::cout.flush();
+                        }
+                    }
                     return true;
-
-                [[maybe_unused]] h256 memoryAddress = h256(
-                    keyString.substr( h160::size ), h256::ConstructFromStringType::FromBinary );
-                [[maybe_unused]] u256 memoryValue = h256( string( value.begin(), value.end() ),
-                    h256::ConstructFromStringType::FromBinary );
-
-
-                _map.at( address ).setStorage( memoryAddress, memoryValue );
-                counter++;
-                if ( counter % 1000000 == 0 ) {
-                    std::cout << ".";
-                    std::cout.flush();
-                }
-            }
-            return true;
-        } );
+                } );
+        }
 
         std::cout << std::endl;
     } else {
@@ -396,6 +424,12 @@ void OverlayDB::rollback() {
     m_cache.clear();
     m_auxiliaryCache.clear();
     m_storageCache.clear();
+    m_killedAccounts.clear();
+    m_killedAuxiliary.clear();
+    // reloaded from the DB on next use
+    storageUsed_.reset();
+    lastExecutedTransactionHash.reset();
+    lastExecutedTransactionReceipts.reset();
 }
 
 void OverlayDB::clearDB() {
@@ -444,6 +478,9 @@ dev::bytes OverlayDB::getStorageKey(
 }
 
 string OverlayDB::lookup( h160 const& _h ) const {
+    if ( m_killedAccounts.count( _h ) )
+        return string();
+
     string ret;
     auto p = m_cache.find( _h );
     if ( p != m_cache.end() ) {
@@ -458,21 +495,25 @@ string OverlayDB::lookup( h160 const& _h ) const {
 bool OverlayDB::exists( h160 const& _h ) const {
     if ( m_cache.find( _h ) != m_cache.end() )
         return true;
+    if ( m_killedAccounts.count( _h ) )
+        return false;
     return m_db_face && m_db_face->exists( skale::slicing::toSlice( _h ) );
 }
 
 void OverlayDB::kill( h160 const& _h ) {
+    bool cache_hit = false;
     auto p = m_cache.find( _h );
     if ( p != m_cache.end() ) {
+        cache_hit = true;
         m_cache.erase( p );
-    } else {
-        if ( m_db_face ) {
-            if ( m_db_face->exists( skale::slicing::toSlice( _h ) ) ) {
-                // NB! This is not committed! So, this can be reverted
-                m_db_face->kill( skale::slicing::toSlice( _h ) );
-            } else {
-                ctrace << "Try to delete non existing key " << _h;
-            }
+    }
+    if ( m_db_face ) {
+        if ( m_db_face->exists( skale::slicing::toSlice( _h ) ) ) {
+            // NB! This is not committed! So, this can be reverted
+            m_db_face->kill( skale::slicing::toSlice( _h ) );
+            m_killedAccounts.insert( _h );
+        } else if ( !cache_hit ) {
+            ctrace << "Try to delete non existing key " << _h;
         }
     }
 }
@@ -483,6 +524,7 @@ void OverlayDB::insert( const dev::h160& _address, dev::bytesConstRef _value ) {
         it->second = _value.toBytes();
     } else
         m_cache[_address] = _value.toBytes();
+    m_killedAccounts.erase( _address );
 }
 
 h256 OverlayDB::lookup( const dev::h160& _address, const dev::h256& _storageAddress ) const {
@@ -519,6 +561,8 @@ void OverlayDB::insert(
 }
 
 dev::s256 OverlayDB::storageUsed() const {
+    if ( storageUsed_.has_value() )
+        return storageUsed_.value();
     if ( m_db_face ) {
         return dev::s256( m_db_face->lookup( skale::slicing::toSlice( "storageUsed" ) ) );
     }
@@ -26,6 +26,8 @@
 
 #include <functional>
 #include <memory>
+#include <set>
+#include <unordered_set>
 
 #include <libbatched-io/batched_db.h>
 #include <libdevcore/Common.h>
@@ -109,7 +111,11 @@ private:
     std::unordered_map< dev::h160, dev::bytes > m_cache;
     std::unordered_map< dev::h160, std::unordered_map< _byte_, dev::bytes > > m_auxiliaryCache;
     std::unordered_map< dev::h160, std::unordered_map< dev::h256, dev::h256 > > m_storageCache;
-    dev::s256 storageUsed_ = 0;
+    // keys killed in the pending write batch; they are still visible in the underlying DB
+    // until commit() so lookups must hide them
+    std::unordered_set< dev::h160 > m_killedAccounts;
+    std::set< std::pair< dev::h160, _byte_ > > m_killedAuxiliary;
+    std::optional< dev::s256 > storageUsed_;
 
     std::shared_ptr< batched_io::db_face > m_db_face;
 
@@ -24,18 +24,22 @@
 
 
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include "UnsafeRegion.h"
 #include "boost/filesystem.hpp"
 #include <libbatched-io/batched_io.h>
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/LevelDB.h>
 #include <libdevcore/Log.h>
 #include <libdevcrypto/Hash.h>
 #include <skutils/btrfs.h>
+#include <skutils/thread_pool.h>
 #include <boost/filesystem/operations.hpp>
 #include <boost/interprocess/sync/named_mutex.hpp>
 
@@ -55,7 +59,9 @@ const std::string SnapshotManager::snapshot_hash_file_name = "snapshot_hash.txt"
 // - not btrfs
 // - volumes don't exist
 SnapshotManager::SnapshotManager( const fs::path& _dataDir,
-    const std::vector< std::string >& _volumes, const std::string& _diffsDir ) {
+    const std::vector< std::string >& _volumes, const std::string& _diffsDir )
+    : hashing_pool( new skutils::thread_pool(
+          std::max( 1u, std::thread::hardware_concurrency() ) ) ) {
     assert( _volumes.size() > 0 );
 
     data_dir = _dataDir;
@@ -102,6 +108,13 @@ SnapshotManager::SnapshotManager( const fs::path& _dataDir,
         }
 }
 
+SnapshotManager::~SnapshotManager() {
+    // btrfs send cannot be interrupted, its threads write into diffs_dir until they finish
+    std::lock_guard< std::mutex > lock( diff_jobs_mutex );
+    for ( const auto& job : diff_jobs )
+        job.second.done.wait();
+}
+
 // exceptions:
 // - exists
 // - cannot read
@@ -167,6 +180,8 @@ void SnapshotManager::restoreSnapshot( unsigned _blockNumber ) {
 // - cannot read
 // - cannot create tmp file
 boost::filesystem::path SnapshotManager::makeOrGetDiff( unsigned _toBlock ) {
+    waitForDiffJob( _toBlock );
+
     fs::path path = getDiffPath( _toBlock );
 
     try {
@@ -182,19 +197,11 @@ boost::filesystem::path SnapshotManager::makeOrGetDiff( unsigned _toBlock ) {
         std::throw_with_nested( CannotRead( ex.path1() ) );
     }
 
-    stringstream volumes_cat;
-
-    for ( auto it = volumes.begin(); it != volumes.end(); ++it ) {
-        const string& vol = *it;
-        if ( it + 1 != volumes.end() )
-            volumes_cat << ( snapshots_dir / to_string( _toBlock ) / vol ).string() << " ";
-        else
-            volumes_cat << ( snapshots_dir / to_string( _toBlock ) / vol ).string();
-    }  // for cat
+    std::string volumes_cat = getVolumesToSend( _toBlock );
 
     UnsafeRegion::lock ur_lock;
 
-    if ( btrfs.send( NULL, path.c_str(), volumes_cat.str().c_str() ) ) {
+    if ( btrfs.send( NULL, path.c_str(), volumes_cat.c_str() ) ) {
         try {
             fs::remove( path );
         } catch ( const fs::filesystem_error& ex ) {
@@ -207,6 +214,105 @@ boost::filesystem::path SnapshotManager::makeOrGetDiff( unsigned _toBlock ) {
     return path;
 }
 
+SnapshotManager::DiffJob SnapshotManager::makeOrGetDiffAsync( unsigned _toBlock ) {
+    std::lock_guard< std::mutex > lock( diff_jobs_mutex );
+
+    auto it = diff_jobs.find( _toBlock );
+    if ( it != diff_jobs.end() ) {
+        if ( it->second.done.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+            return it->second;
+        diff_jobs.erase( it );
+    }
+
+    std::promise< void > finished;
+    DiffJob job;
+    job.path = getDiffPath( _toBlock );
+    job.partPath = job.path;
+    job.done = finished.get_future().share();
+
+    try {
+        if ( fs::is_regular( job.path ) ) {
+            finished.set_value();
+            return job;
+        }
+
+        if ( !fs::exists( snapshots_dir / to_string( _toBlock ) ) ) {
+            fs::remove( job.path );
+            throw SnapshotAbsent( _toBlock );
+        }
+    } catch ( const fs::filesystem_error& ex ) {
+        std::throw_with_nested( CannotRead( ex.path1() ) );
+    }
+
+    // diff is written under another name until complete, so makeOrGetDiff() never returns
+    // a partial one; the name is unique, so a leftover of a failed send is never reused.
+    // The file is created here to be readable right away
+    job.partPath = fs::unique_path( job.path.string() + ".%%%%-%%%%.part" );
+    {
+        std::ofstream part( job.partPath.string(), std::ios::trunc );
+        if ( !part )
+            throw CannotCreate( job.partPath );
+    }
+
+    std::string volumes_cat = getVolumesToSend( _toBlock );
+
+    std::thread( [path = job.path, partPath = job.partPath, volumes_cat,
+                     finished = std::move( finished )]() mutable {
+        try {
+            UnsafeRegion::lock ur_lock;
+
+            if ( btrfs.send( NULL, partPath.c_str(), volumes_cat.c_str() ) ) {
+                auto ex = CannotPerformBtrfsOperation( btrfs.last_cmd(), btrfs.strerror() );
+                fs::remove( partPath );
+                throw ex;
+            }
+
+            fs::rename( partPath, path );
+            finished.set_value();
+        } catch ( ... ) {
+            finished.set_exception( std::current_exception() );
+        }
+    } ).detach();
+
+    diff_jobs[_toBlock] = job;
+    return job;
+}
+
+void SnapshotManager::waitForDiffJob( unsigned _toBlock ) {
+    std::shared_future< void > done;
+    {
+        std::lock_guard< std::mutex > lock( diff_jobs_mutex );
+        auto it = diff_jobs.find( _toBlock );
+        if ( it == diff_jobs.end() )
+            return;
+        done = it->second.done;
+    }
+    done.wait();
+}
+
+void SnapshotManager::removeDiff( unsigned _toBlock ) {
+    waitForDiffJob( _toBlock );
+    try {
+        fs::remove( getDiffPath( _toBlock ) );
+    } catch ( const fs::filesystem_error& ex ) {
+        std::throw_with_nested( CannotDelete( ex.path1() ) );
+    }
+}
+
+std::string SnapshotManager::getVolumesToSend( unsigned _toBlock ) const {
+    stringstream volumes_cat;
+
+    for ( auto it = volumes.begin(); it != volumes.end(); ++it ) {
+        const string& vol = *it;
+        if ( it + 1 != volumes.end() )
+            volumes_cat << ( snapshots_dir / to_string( _toBlock ) / vol ).string() << " ";
+        else
+            volumes_cat << ( snapshots_dir / to_string( _toBlock ) / vol ).string();
+    }  // for cat
+
+    return volumes_cat.str();
+}
+
 // exceptions:
 // - no such file/cannot read
 // - cannot input as diff (no base state?)
@@ -364,6 +470,9 @@ std::pair< int, int > SnapshotManager::getLatestSnasphots() const {
 void SnapshotManager::leaveNLastDiffs( unsigned n ) {
     map< int, fs::path, std::greater< int > > numbers;
     for ( auto& f : fs::directory_iterator( diffs_dir ) ) {
+        // diffs still being written are named "<block>.<random>.part"
+        if ( f.path().extension() == ".part" )
+            continue;
         try {
             numbers.insert( make_pair( std::stoi( fs::basename( f ) ), f ) );
         } catch ( ... ) { /*ignore non-numbers*/
@@ -430,22 +539,33 @@ bool SnapshotManager::isSnapshotHashPresent( unsigned _blockNumber ) const {
     }
 }
 
-void SnapshotManager::computeDatabaseHash(
-    const boost::filesystem::path& _dbDir, secp256k1_sha256_t* ctx ) const try {
+dev::h256 SnapshotManager::computeDatabaseHash(
+    const boost::filesystem::path& _dbDir, bool _incrementalHash, bool _verify ) try {
     if ( !boost::filesystem::exists( _dbDir ) ) {
         BOOST_THROW_EXCEPTION( InvalidPath( _dbDir ) );
     }
 
-    std::unique_ptr< dev::db::LevelDB > m_db( new dev::db::LevelDB( _dbDir.string() ) );
-    dev::h256 hash_volume = m_db->hashBase();
+    dev::h256 hash_volume;
+    if ( dev::db::databaseKind() == dev::db::DatabaseKind::LevelDB ) {
+        std::unique_ptr< dev::db::LevelDB > m_db( new dev::db::LevelDB( _dbDir.string() ) );
+        // incremental hash is read from the DB itself instead of walking all its entries,
+        // unless the DB was written by someone else and the stored hash can't be trusted
+        if ( !_incrementalHash )
+            hash_volume = m_db->hashBase();
+        else if ( _verify )
+            hash_volume = m_db->verifiedIncrementalHash();
+        else
+            hash_volume = m_db->incrementalHash();
+    } else
+        hash_volume = dev::db::DBFactory::create( _dbDir )->hashBase();
     cnote << _dbDir << " hash is: " << hash_volume << std::endl;
 
-    secp256k1_sha256_write( ctx, hash_volume.data(), hash_volume.size );
+    return hash_volume;
 } catch ( const fs::filesystem_error& ex ) {
     std::throw_with_nested( CannotRead( ex.path1() ) );
 }
 
-void SnapshotManager::addLastPriceToHash( unsigned _blockNumber, secp256k1_sha256_t* ctx ) const {
+dev::h256 SnapshotManager::computeLastPriceHash( unsigned _blockNumber ) const {
     dev::u256 last_price = 0;
     // manually open DB
     boost::filesystem::path prices_path =
@@ -475,88 +595,84 @@ void SnapshotManager::addLastPriceToHash( unsigned _blockNumber, secp256k1_sha25
 
     dev::h256 last_price_hash = dev::sha256( last_price.str() );
     cnote << "Latest price hash is: " << last_price_hash << std::endl;
-    secp256k1_sha256_write( ctx, last_price_hash.data(), last_price_hash.size );
+    return last_price_hash;
 }
 
-void SnapshotManager::proceedRegularFile(
-    const boost::filesystem::path& path, secp256k1_sha256_t* ctx, bool is_checking ) const {
-    if ( boost::filesystem::extension( path ) == "._hash" ) {
-        return;
+dev::h256 SnapshotManager::hashFileContent( const boost::filesystem::path& _path ) {
+    std::ifstream file( _path.string(), std::ios::binary );
+    if ( !file )
+        throw CannotRead( _path );
+
+    // same digest as sha256 of the whole content, without holding it in memory
+    secp256k1_sha256_t ctx;
+    secp256k1_sha256_initialize( &ctx );
+    std::vector< char > buffer( c_fileHashBufferSize );
+    while ( file ) {
+        file.read( buffer.data(), buffer.size() );
+        secp256k1_sha256_write(
+            &ctx, reinterpret_cast< const unsigned char* >( buffer.data() ), file.gcount() );
     }
+    if ( file.bad() )
+        throw CannotRead( _path );
 
-    std::string relativePath = path.string().substr( path.string().find( "filestorage" ) );
+    dev::h256 hash;
+    secp256k1_sha256_finalize( &ctx, hash.data() );
+    return hash;
+}
+
+boost::optional< dev::h256 > SnapshotManager::computeRegularFileHash(
+    const boost::filesystem::path& path, bool is_checking ) const {
+    if ( boost::filesystem::extension( path ) == "._hash" ) {
+        return boost::none;
+    }
 
     std::string fileHashPathStr = path.string() + "._hash";
-    if ( !is_checking ) {
+    if ( !is_checking && boost::filesystem::exists( fileHashPathStr ) ) {
         dev::h256 fileHash;
-        if ( !boost::filesystem::exists( fileHashPathStr ) ) {
-            // file has not been downloaded fully
-            // calculate hash, add to global hash, do not create ._hash file
-            secp256k1_sha256_t fileData;
-            secp256k1_sha256_initialize( &fileData );
-
-            dev::h256 filePathHash = dev::sha256( relativePath );
-            secp256k1_sha256_write( &fileData, filePathHash.data(), filePathHash.size );
-
-            std::ifstream originFile( path.string() );
-            originFile.seekg( 0, std::ios::end );
-            size_t fileContentSize = originFile.tellg();
-            std::string fileContent( fileContentSize, ' ' );
-            originFile.seekg( 0 );
-            originFile.read( &fileContent[0], fileContentSize );
-
-            dev::h256 fileContentHash = dev::sha256( fileContent );
-
-            secp256k1_sha256_write( &fileData, fileContentHash.data(), fileContentHash.size );
-
-            secp256k1_sha256_finalize( &fileData, fileHash.data() );
-        } else {
-            std::ifstream hash_file( fileHashPathStr );
-            hash_file >> fileHash;
-        }
+        std::ifstream hash_file( fileHashPathStr );
+        hash_file >> fileHash;
+        return fileHash;
+    }
 
-        secp256k1_sha256_write( ctx, fileHash.data(), fileHash.size );
-    } else {
-        secp256k1_sha256_t fileData;
-        secp256k1_sha256_initialize( &fileData );
+    // file has not been downloaded fully, or we are checking all hashes
+    std::string relativePath = path.string().substr( path.string().find( "filestorage" ) );
 
-        dev::h256 filePathHash = dev::sha256( relativePath );
-        secp256k1_sha256_write( &fileData, filePathHash.data(), filePathHash.size );
+    secp256k1_sha256_t fileData;
+    secp256k1_sha256_initialize( &fileData );
 
-        std::ifstream originFile( path.string() );
-        originFile.seekg( 0, std::ios::end );
-        size_t fileContentSize = originFile.tellg();
-        std::string fileContent( fileContentSize, ' ' );
-        originFile.seekg( 0 );
-        originFile.read( &fileContent[0], fileContentSize );
+    dev::h256 filePathHash = dev::sha256( relativePath );
+    secp256k1_sha256_write( &fileData, filePathHash.data(), filePathHash.size );
 
-        dev::h256 fileContentHash = dev::sha256( fileContent );
-        secp256k1_sha256_write( &fileData, fileContentHash.data(), fileContentHash.size );
+    dev::h256 fileContentHash = hashFileContent( path );
+    secp256k1_sha256_write( &fileData, fileContentHash.data(), fileContentHash.size );
 
-        dev::h256 fileHash;
-        secp256k1_sha256_finalize( &fileData, fileHash.data() );
-
-        if ( boost::filesystem::exists( fileHashPathStr ) ) {
-            // write to ._hash if exists
-            // if no ._hash - file has not been fully downloaded
-            std::ofstream hash( fileHashPathStr );
-            hash.clear();
-            hash << fileHash;
-        }
+    dev::h256 fileHash;
+    secp256k1_sha256_finalize( &fileData, fileHash.data() );
 
-        secp256k1_sha256_write( ctx, fileHash.data(), fileHash.size );
+    if ( is_checking && boost::filesystem::exists( fileHashPathStr ) ) {
+        // write to ._hash if exists
+        // if no ._hash - file has not been fully downloaded
+        std::ofstream hash( fileHashPathStr );
+        hash.clear();
+        hash << fileHash;
     }
+
+    return fileHash;
 }
 
-void SnapshotManager::proceedDirectory(
-    const boost::filesystem::path& path, secp256k1_sha256_t* ctx ) const {
+dev::h256 SnapshotManager::computeDirectoryHash( const boost::filesystem::path& path ) const {
     std::string relativePath = path.string().substr( path.string().find( "filestorage" ) );
-    dev::h256 directoryHash = dev::sha256( relativePath );
-    secp256k1_sha256_write( ctx, directoryHash.data(), directoryHash.size );
+    return dev::sha256( relativePath );
 }
 
-void SnapshotManager::proceedFileStorageDirectory( const boost::filesystem::path& _fileSystemDir,
-    secp256k1_sha256_t* ctx, bool is_checking ) const {
+std::vector< std::future< boost::optional< dev::h256 > > >
+SnapshotManager::computeFileStorageEntryHashes(
+    const boost::filesystem::path& _fileSystemDir, bool is_checking ) const {
+    if ( !boost::filesystem::exists( _fileSystemDir ) ) {
+        throw std::logic_error( "filestorage btrfs subvolume was corrupted - " +
+                                _fileSystemDir.string() + " doesn't exist" );
+    }
+
     boost::filesystem::recursive_directory_iterator directory_it( _fileSystemDir ), end;
 
     std::vector< boost::filesystem::path > contents;
@@ -569,34 +685,51 @@ void SnapshotManager::proceedFileStorageDirectory( const boost::filesystem::path
             return lhs.string() < rhs.string();
         } );
 
+    // entries are hashed independently, their hashes must be added in sorted order
+    std::vector< std::future< boost::optional< dev::h256 > > > hashes;
+    hashes.reserve( contents.size() );
     for ( auto& content : contents ) {
-        if ( boost::filesystem::is_regular_file( content ) ) {
-            proceedRegularFile( content, ctx, is_checking );
-        } else {
-            proceedDirectory( content, ctx );
-        }
-    }
+        hashes.push_back( hashing_pool->submit(
+            [this, content, is_checking]() -> boost::optional< dev::h256 > {
+                if ( boost::filesystem::is_regular_file( content ) )
+                    return computeRegularFileHash( content, is_checking );
+                else
+                    return computeDirectoryHash( content );
+            } ) );
+    }
+    return hashes;
 }
 
-void SnapshotManager::computeFileStorageHash( const boost::filesystem::path& _fileSystemDir,
+void SnapshotManager::proceedFileStorageDirectory( const boost::filesystem::path& _fileSystemDir,
     secp256k1_sha256_t* ctx, bool is_checking ) const {
-    if ( !boost::filesystem::exists( _fileSystemDir ) ) {
-        throw std::logic_error( "filestorage btrfs subvolume was corrupted - " +
-                                _fileSystemDir.string() + " doesn't exist" );
-    }
+    auto hashes = computeFileStorageEntryHashes( _fileSystemDir, is_checking );
+
+    // wait for all before rethrowing, as tasks use this
+    for ( auto& hash : hashes )
+        hash.wait();
 
-    this->proceedFileStorageDirectory( _fileSystemDir, ctx, is_checking );
+    for ( auto& hash : hashes ) {
+        boost::optional< dev::h256 > entryHash = hash.get();
+        if ( entryHash )
+            secp256k1_sha256_write( ctx, entryHash->data(), entryHash->size );
+    }
 }
 
-void SnapshotManager::computeAllVolumesHash(
-    unsigned _blockNumber, secp256k1_sha256_t* ctx, bool is_checking ) const {
+void SnapshotManager::computeAllVolumesHash( unsigned _blockNumber, secp256k1_sha256_t* ctx,
+    bool is_checking, bool _incrementalHash ) const {
     assert( this->volumes.size() != 0 );
 
     // TODO XXX Remove volumes structure knowledge from here!!
 
-    this->computeDatabaseHash(
-        this->snapshots_dir / std::to_string( _blockNumber ) / this->volumes[0] / "12041" / "state",
-        ctx );
+    // every DB, filestorage entry and the price are hashed concurrently
+    // and added to ctx in the fixed order below
+    std::vector< std::future< dev::h256 > > db_hashes;
+
+    boost::filesystem::path state_path =
+        this->snapshots_dir / std::to_string( _blockNumber ) / this->volumes[0] / "12041" / "state";
+    db_hashes.push_back( hashing_pool->submit( [state_path, is_checking, _incrementalHash]() {
+        return computeDatabaseHash( state_path, _incrementalHash, is_checking );
+    } ) );
 
     boost::filesystem::path blocks_extras_path = this->snapshots_dir /
                                                  std::to_string( _blockNumber ) / this->volumes[0] /
@@ -621,20 +754,61 @@ void SnapshotManager::computeAllVolumesHash(
     for ( auto& content : contents ) {
         if ( cnt++ >= 5 )
             break;
-        this->computeDatabaseHash( content, ctx );
+        db_hashes.push_back( hashing_pool->submit( [content, is_checking, _incrementalHash]() {
+            return computeDatabaseHash( content, _incrementalHash, is_checking );
+        } ) );
+    }
+
+    std::vector< std::future< boost::optional< dev::h256 > > > file_hashes;
+    std::future< dev::h256 > price_hash;
+    try {
+        // filestorage is walked in full even with the incremental hash: contents of complete
+        // files come from their ._hash, but every entry is still visited
+        file_hashes = this->computeFileStorageEntryHashes(
+            this->snapshots_dir / std::to_string( _blockNumber ) / "filestorage", is_checking );
+
+        // if have prices and blocks
+        if ( this->volumes.size() > 3 ) {
+            price_hash = hashing_pool->submit(
+                [this, _blockNumber]() { return computeLastPriceHash( _blockNumber ); } );
+        }
+    } catch ( ... ) {
+        for ( auto& hash : db_hashes )
+            hash.wait();
+        throw;
     }
 
-    // filestorage
-    this->computeFileStorageHash(
-        this->snapshots_dir / std::to_string( _blockNumber ) / "filestorage", ctx, is_checking );
+    // wait for all before rethrowing, as tasks use this
+    for ( auto& hash : db_hashes )
+        hash.wait();
+    for ( auto& hash : file_hashes )
+        hash.wait();
+    if ( price_hash.valid() )
+        price_hash.wait();
 
-    // if have prices and blocks
-    if ( this->volumes.size() > 3 ) {
-        this->addLastPriceToHash( _blockNumber, ctx );
+    for ( auto& hash : db_hashes ) {
+        dev::h256 volume_hash = hash.get();
+        secp256k1_sha256_write( ctx, volume_hash.data(), volume_hash.size );
     }
+
+    for ( auto& hash : file_hashes ) {
+        boost::optional< dev::h256 > entry_hash = hash.get();
+        if ( entry_hash )
+            secp256k1_sha256_write( ctx, entry_hash->data(), entry_hash->size );
+    }
+
+    if ( price_hash.valid() ) {
+        dev::h256 last_price_hash = price_hash.get();
+        secp256k1_sha256_write( ctx, last_price_hash.data(), last_price_hash.size );
+    }
+}
+
+void SnapshotManager::setHashingThreads( size_t _threads ) {
+    hashing_pool.reset( new skutils::thread_pool( std::max< size_t >( 1, _threads ) ) );
 }
 
-void SnapshotManager::computeSnapshotHash( unsigned _blockNumber, bool is_checking ) {
+void SnapshotManager::computeSnapshotHash(
+    unsigned _blockNumber, bool is_checking, bool _incrementalHash ) {
     if ( this->isSnapshotHashPresent( _blockNumber ) ) {
         return;
     }
@@ -660,7 +834,7 @@ void SnapshotManager::computeSnapshotHash( unsigned _blockNumber, bool is_checki
             batched_io::test_crash_before_commit( "SnapshotManager::doSnapshot" );
     }
 
-    this->computeAllVolumesHash( _blockNumber, &ctx, is_checking );
+    this->computeAllVolumesHash( _blockNumber, &ctx, is_checking, _incrementalHash );
 
     for ( const auto& volume : this->volumes ) {
         int res = btrfs.subvolume.property_set(
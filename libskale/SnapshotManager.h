@@ -28,9 +28,14 @@
 #include <libdevcore/FixedHash.h>
 #include <libethereum/BlockChain.h>
 #include <secp256k1_sha256.h>
+#include <skutils/thread_pool.h>
 
 #include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
 
+#include <future>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -154,9 +159,23 @@ public:
 public:
     SnapshotManager( const boost::filesystem::path& _dataDir,
         const std::vector< std::string >& _volumes, const std::string& diffs_dir = std::string() );
+    /// Waits for diffs still being written by makeOrGetDiffAsync()
+    ~SnapshotManager();
     void doSnapshot( unsigned _blockNumber );
     void restoreSnapshot( unsigned _blockNumber );
     boost::filesystem::path makeOrGetDiff( unsigned _toBlock );
+
+    /// Diff that can be read while btrfs send is still writing it
+    struct DiffJob {
+        boost::filesystem::path path;
+        boost::filesystem::path partPath;  ///< file being written, equals path when complete
+        std::shared_future< void > done;   ///< rethrows if btrfs send failed
+    };
+    /// Like makeOrGetDiff(), but returns as soon as the diff file is created. Requests for a diff
+    /// which is still being written share the same job
+    DiffJob makeOrGetDiffAsync( unsigned _toBlock );
+    /// Waits until btrfs send of the diff finishes if it is in flight, then deletes the diff
+    void removeDiff( unsigned _toBlock );
     void importDiff( unsigned _toBlock );
     boost::filesystem::path getDiffPath( unsigned _toBlock );
     void removeSnapshot( unsigned _blockNumber );
@@ -169,7 +188,10 @@ public:
     dev::h256 getSnapshotHash( unsigned _blockNumber ) const;
     std::pair< int, int > getLatestSnasphots() const;
     bool isSnapshotHashPresent( unsigned _blockNumber ) const;
-    void computeSnapshotHash( unsigned _blockNumber, bool is_checking = false );
+    /// _incrementalHash selects LevelDB::incrementalHash() of the DBs instead of hashBase(), see
+    /// IncrementalSnapshotHashPatch
+    void computeSnapshotHash(
+        unsigned _blockNumber, bool is_checking = false, bool _incrementalHash = false );
 
     uint64_t getBlockTimestamp(
         unsigned _blockNumber, const dev::eth::ChainParams& chain_params ) const;
@@ -177,6 +199,13 @@ public:
     static boost::filesystem::path findMostRecentBlocksDBPath(
         const boost::filesystem::path& _dirPath );
 
+    /// Number of threads hashing DBs and files of a snapshot, number of cores by default
+    void setHashingThreads( size_t _threads );
+
+    /// _verify is set for DBs written by others, their stored incremental hash isn't trusted
+    static dev::h256 computeDatabaseHash( const boost::filesystem::path& _dbDir,
+        bool _incrementalHash = false, bool _verify = false );
+
 private:
     boost::filesystem::path data_dir;
     std::vector< std::string > volumes;
@@ -184,23 +213,31 @@ private:
     boost::filesystem::path diffs_dir;
 
     static const std::string snapshot_hash_file_name;
+    static const size_t c_fileHashBufferSize = 1 << 20;
+    std::unique_ptr< skutils::thread_pool > hashing_pool;
     mutable std::mutex hash_file_mutex;
 
+    // diffs started by makeOrGetDiffAsync(), finished ones are dropped on the next lookup
+    std::map< unsigned, DiffJob > diff_jobs;
+    std::mutex diff_jobs_mutex;
+
     void cleanupDirectory(
         const boost::filesystem::path& p, const boost::filesystem::path& _keepDirectory = "" );
 
-    void computeFileStorageHash( const boost::filesystem::path& _fileSystemDir,
-        secp256k1_sha256_t* ctx, bool is_checking ) const;
+    std::vector< std::future< boost::optional< dev::h256 > > > computeFileStorageEntryHashes(
+        const boost::filesystem::path& _fileSystemDir, bool is_checking ) const;
     void proceedFileStorageDirectory( const boost::filesystem::path& _fileSystemDir,
         secp256k1_sha256_t* ctx, bool is_checking ) const;
-    void proceedRegularFile(
-        const boost::filesystem::path& path, secp256k1_sha256_t* ctx, bool is_checking ) const;
-    void proceedDirectory( const boost::filesystem::path& path, secp256k1_sha256_t* ctx ) const;
-    void computeAllVolumesHash(
-        unsigned _blockNumber, secp256k1_sha256_t* ctx, bool is_checking ) const;
-    void computeDatabaseHash(
-        const boost::filesystem::path& _dbDir, secp256k1_sha256_t* ctx ) const;
-    void addLastPriceToHash( unsigned _blockNumber, secp256k1_sha256_t* ctx ) const;
+    boost::optional< dev::h256 > computeRegularFileHash(
+        const boost::filesystem::path& path, bool is_checking ) const;
+    dev::h256 computeDirectoryHash( const boost::filesystem::path& path ) const;
+    static dev::h256 hashFileContent( const boost::filesystem::path& _path );
+    void computeAllVolumesHash( unsigned _blockNumber, secp256k1_sha256_t* ctx, bool is_checking,
+        bool _incrementalHash ) const;
+    dev::h256 computeLastPriceHash( unsigned _blockNumber ) const;
+    std::string getVolumesToSend( unsigned _toBlock ) const;
+    /// Waits for btrfs send of the diff started by makeOrGetDiffAsync(), if any
+    void waitForDiffJob( unsigned _toBlock );
 };
 
 #endif  // SNAPSHOTAGENT_H
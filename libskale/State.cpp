@@ -30,7 +30,9 @@
 #include <boost/timer.hpp>
 #include <boost/utility/in_place_factory.hpp>
 
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/DBImpl.h>
+#include <libdevcore/LevelDB.h>
 #include <libethcore/SealEngine.h>
 #include <libethereum/CodeSizeCache.h>
 #include <libethereum/Defaults.h>
@@ -66,6 +68,9 @@ using dev::eth::TransactionReceipt;
 #define ETH_VMTRACE 0
 #endif
 
+bool skale::c_blockScopedStateCommit = false;
+size_t skale::c_stateCacheSize = 100000;
+
 State::State( u256 const& _accountStartNonce, OverlayDB const& _db,
 #ifdef HISTORIC_STATE
     dev::OverlayDB const& _historicDb, dev::OverlayDB const& _historicBlockToStateRootDb,
@@ -75,6 +80,8 @@ State::State( u256 const& _accountStartNonce, OverlayDB const& _db,
       m_db_ptr( make_shared< OverlayDB >( _db ) ),
       m_storedVersion( make_shared< size_t >( 0 ) ),
       m_currentVersion( *m_storedVersion ),
+      m_accountCache(
+          c_stateCacheSize > 0 ? make_shared< AccountCache >( c_stateCacheSize ) : nullptr ),
       m_accountStartNonce( _accountStartNonce ),
       m_initial_funds( _initialFunds ),
       contractStorageLimit_( _contractStorageLimit )
@@ -178,7 +185,9 @@ skale::OverlayDB State::openDB(
 
     fs::path state_path = path / fs::path( "state" );
     try {
-        std::shared_ptr< db::DatabaseFace > db( new db::DBImpl( state_path ) );
+        std::shared_ptr< db::DatabaseFace > db(
+            db::DBFactory::create(
+                state_path, db::LevelDBKind::State, db::IncrementalHash::Owned ) );
         std::unique_ptr< batched_io::batched_db > bdb = make_unique< batched_io::batched_db >();
         bdb->open( db );
         assert( bdb->is_open() );
@@ -215,10 +224,16 @@ State::State( const State& _s )
     m_db_ptr = _s.m_db_ptr;
     m_storedVersion = _s.m_storedVersion;
     m_currentVersion = _s.m_currentVersion;
+    m_accountCache = _s.m_accountCache;
     m_cache = _s.m_cache;
     m_unchangedCacheEntries = _s.m_unchangedCacheEntries;
     m_nonExistingAccountsCache = _s.m_nonExistingAccountsCache;
     m_accountStartNonce = _s.m_accountStartNonce;
+    m_blockScopedCommit = _s.m_blockScopedCommit;
+    m_hasStagedChanges = _s.m_hasStagedChanges;
+    m_writeLog = _s.m_writeLog;
+    m_readLog = _s.m_readLog;
+    m_commitLog = _s.m_commitLog;
     m_changeLog = _s.m_changeLog;
     m_initial_funds = _s.m_initial_funds;
     contractStorageLimit_ = _s.contractStorageLimit_;
@@ -236,10 +251,16 @@ State& State::operator=( const State& _s ) {
     m_db_ptr = _s.m_db_ptr;
     m_storedVersion = _s.m_storedVersion;
     m_currentVersion = _s.m_currentVersion;
+    m_accountCache = _s.m_accountCache;
     m_cache = _s.m_cache;
     m_unchangedCacheEntries = _s.m_unchangedCacheEntries;
     m_nonExistingAccountsCache = _s.m_nonExistingAccountsCache;
     m_accountStartNonce = _s.m_accountStartNonce;
+    m_blockScopedCommit = _s.m_blockScopedCommit;
+    m_hasStagedChanges = _s.m_hasStagedChanges;
+    m_writeLog = _s.m_writeLog;
+    m_readLog = _s.m_readLog;
+    m_commitLog = _s.m_commitLog;
     m_changeLog = _s.m_changeLog;
     m_initial_funds = _s.m_initial_funds;
     contractStorageLimit_ = _s.contractStorageLimit_;
@@ -378,6 +399,9 @@ eth::Account const* State::account( Address const& _a ) const {
 }
 
 eth::Account* State::account( Address const& _address ) {
+    if ( m_speculation )
+        m_speculation->readSet.insert( _address );
+
     auto it = m_cache.find( _address );
     if ( it != m_cache.end() )
         return &it->second;
@@ -386,7 +410,7 @@ eth::Account* State::account( Address const& _address ) {
         return nullptr;
 
     // Populate basic info.
-    bytes stateBack;
+    CachedAccount fields;
     {
         boost::shared_lock< boost::shared_mutex > lock( *x_db_ptr );
 
@@ -396,26 +420,33 @@ eth::Account* State::account( Address const& _address ) {
             BOOST_THROW_EXCEPTION( AttemptToReadFromStateInThePast() );
         }
 
-        stateBack = asBytes( m_db_ptr->lookup( _address ) );
-    }
-    if ( stateBack.empty() ) {
-        m_nonExistingAccountsCache.insert( _address );
-        return nullptr;
+        // shared cache is filled under the lock, so commit() can't make it stale in between
+        if ( !m_accountCache || !m_accountCache->lookup( _address, fields ) ) {
+            bytes stateBack = asBytes( m_db_ptr->lookup( _address ) );
+            if ( stateBack.empty() ) {
+                m_nonExistingAccountsCache.insert( _address );
+                return nullptr;
+            }
+
+            RLP state( stateBack );
+            fields.nonce = state[0].toInt< u256 >();
+            fields.balance = state[1].toInt< u256 >();
+            fields.codeHash = state[2].toInt< u256 >();
+            fields.storageUsed = state[3].toInt< s256 >();
+            // version is 0 if absent from RLP
+            fields.version = state[4] ? state[4].toInt< u256 >() : 0;
+
+            if ( m_accountCache )
+                m_accountCache->insert( _address, fields );
+        }
     }
 
     clearCacheIfTooLarge();
 
-    RLP state( stateBack );
-    u256 nonce = state[0].toInt< u256 >();
-    u256 balance = state[1].toInt< u256 >();
-    h256 codeHash = state[2].toInt< u256 >();
-    s256 storageUsed = state[3].toInt< s256 >();
-    // version is 0 if absent from RLP
-    auto const version = state[4] ? state[4].toInt< u256 >() : 0;
-
     auto i = m_cache.emplace( std::piecewise_construct, std::forward_as_tuple( _address ),
-        std::forward_as_tuple( nonce, balance, dev::eth::StorageRoot( EmptyTrie ), codeHash,
-            version, dev::eth::Account::Changedness::Unchanged, storageUsed ) );
+        std::forward_as_tuple( fields.nonce, fields.balance, dev::eth::StorageRoot( EmptyTrie ),
+            fields.codeHash, fields.version, dev::eth::Account::Changedness::Unchanged,
+            fields.storageUsed ) );
     m_unchangedCacheEntries.push_back( _address );
     return &i.first->second;
 }
@@ -423,15 +454,9 @@ eth::Account* State::account( Address const& _address ) {
 void State::clearCacheIfTooLarge() const {
     // TODO: Find a good magic number
     while ( m_unchangedCacheEntries.size() > 1000 ) {
-        // Remove a random element
-        // FIXME: Do not use random device as the engine. The random device should be only used to
-        // seed other engine.
-        size_t const randomIndex = std::uniform_int_distribution< size_t >(
-            0, m_unchangedCacheEntries.size() - 1 )( dev::s_fixedHashEngine );
-
-        Address const addr = m_unchangedCacheEntries[randomIndex];
-        swap( m_unchangedCacheEntries[randomIndex], m_unchangedCacheEntries.back() );
-        m_unchangedCacheEntries.pop_back();
+        // Remove the oldest element, it is cheap to reload from m_accountCache
+        Address const addr = m_unchangedCacheEntries.front();
+        m_unchangedCacheEntries.pop_front();
 
         auto cacheEntry = m_cache.find( addr );
         if ( cacheEntry != m_cache.end() && !cacheEntry->second.isDirty() )
@@ -439,6 +464,17 @@ void State::clearCacheIfTooLarge() const {
     }
 }
 
+void State::noteCommitted( Address const& _address, eth::Account const& _account ) const {
+    // m_accountCache has the last committed fields unless they were evicted
+    CachedAccount old;
+    if ( !_account.isAlive() || !m_accountCache || !m_accountCache->peek( _address, old ) ||
+         old.nonce != _account.nonce() || old.balance != _account.balance() ||
+         old.codeHash != _account.codeHash() || old.version != _account.version() )
+        m_commitLog->accounts.insert( _address );
+    for ( auto const& storageAddressValuePair : _account.storageOverlay() )
+        m_commitLog->storage.emplace( _address, storageAddressValuePair.first );
+}
+
 void State::commit( dev::eth::CommitBehaviour _commitBehaviour ) {
     if ( _commitBehaviour == dev::eth::CommitBehaviour::RemoveEmptyAccounts )
         removeEmptyAccounts();
@@ -457,10 +493,16 @@ void State::commit( dev::eth::CommitBehaviour _commitBehaviour ) {
             const eth::Account& account = addressAccountPair.second;
 
             if ( account.isDirty() ) {
+                if ( m_writeLog )
+                    m_writeLog->insert( address );
+                if ( m_commitLog )
+                    noteCommitted( address, account );
                 if ( !account.isAlive() ) {
                     m_db_ptr->kill( address );
                     m_db_ptr->killAuxiliary( address, Auxiliary::CODE );
                     // TODO: remove account storage
+                    if ( m_accountCache )
+                        m_accountCache->remove( address );
                 } else {
                     RLPStream rlpStream( 4 );
 
@@ -469,12 +511,18 @@ void State::commit( dev::eth::CommitBehaviour _commitBehaviour ) {
                     auto rawValue = rlpStream.out();
 
                     m_db_ptr->insert( address, ref( rawValue ) );
+                    if ( m_accountCache )
+                        m_accountCache->insert( address,
+                            { account.nonce(), account.balance(), account.codeHash(),
+                                account.storageUsed(), account.version() } );
 
                     for ( auto const& storageAddressValuePair : account.storageOverlay() ) {
                         const u256& storageAddress = storageAddressValuePair.first;
                         const u256& value = storageAddressValuePair.second;
 
                         m_db_ptr->insert( address, storageAddress, value );
+                        if ( m_accountCache )
+                            m_accountCache->insert( address, storageAddress, value );
                     }
 
                     if ( account.hasNewCode() ) {
@@ -485,7 +533,11 @@ void State::commit( dev::eth::CommitBehaviour _commitBehaviour ) {
             }
         }
         m_db_ptr->updateStorageUsage( totalStorageUsed_ );
-        m_db_ptr->commit( std::to_string( ++*m_storedVersion ) );
+        ++*m_storedVersion;
+        if ( m_blockScopedCommit )
+            m_hasStagedChanges = true;
+        else
+            m_db_ptr->commit( std::to_string( *m_storedVersion ) );
         m_currentVersion = *m_storedVersion;
     }
 
@@ -499,12 +551,57 @@ void State::commit( dev::eth::CommitBehaviour _commitBehaviour ) {
     m_unchangedCacheEntries.clear();
 }
 
+void State::startBlockScopedCommit() {
+    m_blockScopedCommit = true;
+    m_hasStagedChanges = false;
+}
+
+void State::commitBlock() {
+    if ( !m_blockScopedCommit )
+        return;
+    m_blockScopedCommit = false;
+
+    if ( !m_hasStagedChanges )
+        return;
+    m_hasStagedChanges = false;
+
+    if ( !m_db_write_lock ) {
+        BOOST_THROW_EXCEPTION( AttemptToWriteToNotLockedStateObject() );
+    }
+    boost::upgrade_to_unique_lock< boost::shared_mutex > lock( *m_db_write_lock );
+    if ( !checkVersion() ) {
+        BOOST_THROW_EXCEPTION( AttemptToWriteToStateInThePast() );
+    }
+    m_db_ptr->commit( "block_" + std::to_string( *m_storedVersion ) );
+}
+
+void State::abortBlockScopedCommit() {
+    if ( !m_blockScopedCommit )
+        return;
+    m_blockScopedCommit = false;
+
+    if ( !m_hasStagedChanges )
+        return;
+    m_hasStagedChanges = false;
+
+    clog( VerbosityWarning, "statedb" ) << "Dropping changes staged by unfinished block";
+    if ( m_db_write_lock ) {
+        boost::upgrade_to_unique_lock< boost::shared_mutex > lock( *m_db_write_lock );
+        m_db_ptr->rollback();
+    } else
+        m_db_ptr->rollback();
+    // staged values went into the shared account cache too
+    if ( m_accountCache )
+        m_accountCache->clear();
+}
 
 bool State::addressInUse( Address const& _id ) const {
+    noteRead( _id );
     return !!account( _id );
 }
 
 bool State::accountNonemptyAndExisting( Address const& _address ) const {
+    noteRead( _address );
     if ( eth::Account const* a = account( _address ) )
         return !a->isEmpty();
     else
@@ -512,6 +609,7 @@ bool State::accountNonemptyAndExisting( Address const& _address ) const {
 }
 
 bool State::addressHasCode( Address const& _id ) const {
+    noteRead( _id );
     if ( auto a = account( _id ) )
         return a->codeHash() != EmptySHA3;
     else
@@ -519,6 +617,7 @@ bool State::addressHasCode( Address const& _id ) const {
 }
 
 u256 State::balance( Address const& _id ) const {
+    noteRead( _id );
     if ( auto a = account( _id ) )
         return a->balance();
     else
@@ -632,6 +731,7 @@ std::map< h256, std::pair< u256, u256 > > State::storage( const Address& _contra
 }
 
 u256 State::getNonce( Address const& _addr ) const {
+    noteRead( _addr );
     if ( auto a = account( _addr ) )
         return a->nonce();
     else
@@ -639,6 +739,7 @@ u256 State::getNonce( Address const& _addr ) const {
 }
 
 u256 State::storage( Address const& _id, u256 const& _key ) const {
+    noteRead( _id, _key );
     if ( eth::Account const* acc = account( _id ) ) {
         auto memoryIterator = acc->storageOverlay().find( _key );
         if ( memoryIterator != acc->storageOverlay().end() )
@@ -653,13 +754,24 @@ u256 State::storage( Address const& _id, u256 const& _key ) const {
         if ( !checkVersion() ) {
             BOOST_THROW_EXCEPTION( AttemptToReadFromStateInThePast() );
         }
-        u256 value = m_db_ptr->lookup( _id, _key );
+        u256 value = lookupStorage( _id, _key );
         acc->setStorageCache( _key, value );
         return value;
     } else
         return 0;
 }
 
+u256 State::lookupStorage( Address const& _contract, u256 const& _key ) const {
+    u256 value;
+    if ( m_accountCache && m_accountCache->lookup( _contract, _key, value ) )
+        return value;
+
+    value = m_db_ptr->lookup( _contract, _key );
+    if ( m_accountCache )
+        m_accountCache->insert( _contract, _key, value );
+    return value;
+}
+
 void State::setStorage( Address const& _contract, u256 const& _key, u256 const& _value ) {
     dev::u256 _currentValue = storage( _contract, _key );
 
@@ -677,6 +789,10 @@ void State::setStorage( Address const& _contract, u256 const& _key, u256 const&
     storageUsage[_contract] += count * 32;
     currentStorageUsed_ += count * 32;
 
+    if ( m_speculation )
+        m_speculation->peakStorageUsed =
+            std::max( m_speculation->peakStorageUsed, totalStorageUsed_ + currentStorageUsed_ );
+
     if ( totalStorageUsed_ + currentStorageUsed_ > contractStorageLimit_ ) {
         BOOST_THROW_EXCEPTION( dev::StorageOverflow() << errinfo_comment( _contract.hex() ) );
     }
@@ -684,6 +800,7 @@ void State::setStorage( Address const& _contract, u256 const& _key, u256 const&
 }
 
 u256 State::originalStorageValue( Address const& _contract, u256 const& _key ) const {
+    noteRead( _contract, _key );
     if ( Account const* acc = account( _contract ) ) {
         auto memoryPtr = acc->originalStorageCache().find( _key );
         if ( memoryPtr != acc->originalStorageCache().end() ) {
@@ -694,7 +811,7 @@ u256 State::originalStorageValue( Address const& _contract, u256 const& _key ) c
         if ( !checkVersion() ) {
             BOOST_THROW_EXCEPTION( AttemptToReadFromStateInThePast() );
         }
-        u256 value = m_db_ptr->lookup( _contract, _key );
+        u256 value = lookupStorage( _contract, _key );
         acc->setStorageCache( _key, value );
         return value;
     } else {
@@ -720,6 +837,10 @@ void State::clearStorage( Address const& _contract ) {
         return;
     }
 
+    // total storage usage changes in the middle of execution, limit checks can't be replayed
+    if ( m_speculation )
+        abandonSpeculation();
+
     // TODO: This is extremely inefficient
     for ( auto const& hashPairPair : storage( _contract ) ) {
         auto const& key = hashPairPair.second.first;
@@ -733,6 +854,7 @@ void State::clearStorage( Address const& _contract ) {
 }
 
 bytes const& State::code( Address const& _addr ) const {
+    noteRead( _addr );
     eth::Account const* a = account( _addr );
     if ( !a || a->codeHash() == EmptySHA3 )
         return NullBytes;
@@ -764,6 +886,7 @@ void State::setCode( const Address& _address, const bytes& _code, u256 const& _v
 }
 
 h256 State::codeHash( Address const& _a ) const {
+    noteRead( _a );
     if ( eth::Account const* a = account( _a ) )
         return a->codeHash();
     else
@@ -771,6 +894,7 @@ h256 State::codeHash( Address const& _a ) const {
 }
 
 size_t State::codeSize( Address const& _a ) const {
+    noteRead( _a );
     if ( eth::Account const* a = account( _a ) ) {
         if ( a->hasNewCode() )
             return a->code().size();
@@ -788,6 +912,7 @@ size_t State::codeSize( Address const& _a ) const {
 }
 
 u256 State::version( const Address& _contract ) const {
+    noteRead( _contract );
     Account const* a = account( _contract );
     return a ? a->version() : 0;
 }
@@ -919,6 +1044,20 @@ bool State::empty() const {
     return false;
 }
 
+// decodes and reports the revert message if execution ended with REVERT
+static std::string revertReason( ExecutionResult const& _res ) {
+    std::string strRevertReason;
+    if ( _res.excepted == dev::eth::TransactionException::RevertInstruction ) {
+        strRevertReason = skutils::eth::call_error_message_2_str( _res.output );
+        if ( strRevertReason.empty() )
+            strRevertReason = "EVM revert instruction without description message";
+        std::string strOut = cc::fatal( "Error message from eth_call():" ) + cc::error( " " ) +
+                             cc::warn( strRevertReason );
+        cerror << strOut;
+    }
+    return strRevertReason;
+}
+
 std::pair< ExecutionResult, TransactionReceipt > State::execute( EnvInfo const& _envInfo,
     SealEngineFace const& _sealEngine, Transaction const& _t, Permanence _p,
     OnOpFunc const& _onOp ) {
@@ -940,62 +1079,112 @@ std::pair< ExecutionResult, TransactionReceipt > State::execute( EnvInfo const&
     u256 const startGasUsed = _envInfo.gasUsed();
     bool const statusCode = executeTransaction( e, _t, onOp );
 
-    std::string strRevertReason;
-    if ( res.excepted == dev::eth::TransactionException::RevertInstruction ) {
-        strRevertReason = skutils::eth::call_error_message_2_str( res.output );
-        if ( strRevertReason.empty() )
-            strRevertReason = "EVM revert instruction without description message";
-        std::string strOut = cc::fatal( "Error message from eth_call():" ) + cc::error( " " ) +
-                             cc::warn( strRevertReason );
-        cerror << strOut;
-    }
+    TransactionReceipt receipt =
+        _envInfo.number() >= _sealEngine.chainParams().byzantiumForkBlock ?
+            TransactionReceipt( statusCode, startGasUsed + e.gasUsed(), e.logs() ) :
+            TransactionReceipt( EmptyTrie, startGasUsed + e.gasUsed(), e.logs() );
+    receipt.setRevertReason( revertReason( res ) );
 
-    bool removeEmptyAccounts = false;
     switch ( _p ) {
     case Permanence::Reverted:
     case Permanence::CommittedWithoutState:
         resetStorageChanges();
         m_cache.clear();
         break;
-    case Permanence::Committed: {
-        if ( account( _t.from() ) != nullptr && account( _t.from() )->code() == bytes() ) {
-            totalStorageUsed_ += currentStorageUsed_;
-            updateStorageUsage();
-        }
-        // TODO: review logic|^
-
-        h256 shaLastTx = _t.sha3();  // _t.hasSignature() ? _t.sha3() : _t.sha3(
-                                     // dev::eth::WithoutSignature );
-        this->m_db_ptr->setLastExecutedTransactionHash( shaLastTx );
-        // std::cout << "--- saving \"safeLastExecutedTransactionHash\" = " <<
-        // shaLastTx.hex() << "\n";
-
-        TransactionReceipt receipt =
-            _envInfo.number() >= _sealEngine.chainParams().byzantiumForkBlock ?
-                TransactionReceipt( statusCode, startGasUsed + e.gasUsed(), e.logs() ) :
-                TransactionReceipt( EmptyTrie, startGasUsed + e.gasUsed(), e.logs() );
-        receipt.setRevertReason( strRevertReason );
-        m_db_ptr->addReceiptToPartials( receipt );
-        m_fs_ptr->commit();
-
-        removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().EIP158ForkBlock;
-        commit( removeEmptyAccounts ? dev::eth::CommitBehaviour::RemoveEmptyAccounts :
-                                      dev::eth::CommitBehaviour::KeepEmptyAccounts );
-
+    case Permanence::Committed:
+        commitTransaction( _envInfo, _sealEngine, _t, receipt );
         break;
-    }
     case Permanence::Uncommitted:
         resetStorageChanges();
         break;
     }
 
+    return make_pair( res, receipt );
+}
+
+void State::commitTransaction( EnvInfo const& _envInfo, SealEngineFace const& _sealEngine,
+    Transaction const& _t, TransactionReceipt const& _receipt ) {
+    if ( account( _t.from() ) != nullptr && account( _t.from() )->code() == bytes() ) {
+        totalStorageUsed_ += currentStorageUsed_;
+        updateStorageUsage();
+    }
+    // TODO: review logic|^
+
+    h256 shaLastTx = _t.sha3();  // _t.hasSignature() ? _t.sha3() : _t.sha3(
+                                 // dev::eth::WithoutSignature );
+    this->m_db_ptr->setLastExecutedTransactionHash( shaLastTx );
+    // std::cout << "--- saving \"safeLastExecutedTransactionHash\" = " <<
+    // shaLastTx.hex() << "\n";
+
+    m_db_ptr->addReceiptToPartials( _receipt );
+    m_fs_ptr->commit();
+
+    bool const removeEmptyAccounts =
+        _envInfo.number() >= _sealEngine.chainParams().EIP158ForkBlock;
+    commit( removeEmptyAccounts ? dev::eth::CommitBehaviour::RemoveEmptyAccounts :
+                                  dev::eth::CommitBehaviour::KeepEmptyAccounts );
+}
+
+SpeculativeExecution State::executeSpeculatively(
+    EnvInfo const& _envInfo, SealEngineFace const& _sealEngine, Transaction const& _t ) {
+    SpeculativeExecution spec;
+    spec.reusable = true;
+    spec.baseStorageUsed = totalStorageUsed_;
+    spec.peakStorageUsed = totalStorageUsed_;
+
+    m_speculation = &spec;
+    try {
+        Executive e( *this, _envInfo, _sealEngine, 0, 0, false );
+        e.setResultRecipient( spec.result );
+        spec.statusCode = executeTransaction( e, _t, OnOpFunc() );
+        spec.gasUsed = e.gasUsed();
+        spec.logs = e.logs();
+    } catch ( ... ) {
+        // whatever happened here will happen again in serial execution
+        spec.reusable = false;
+    }
+    m_speculation = nullptr;
+
+    if ( spec.reusable ) {
+        for ( auto const& addressAccountPair : m_cache )
+            if ( addressAccountPair.second.isDirty() )
+                spec.changedAccounts.insert( addressAccountPair );
+        spec.storageUsage = storageUsage;
+        spec.currentStorageUsed = currentStorageUsed_;
+    }
+    return spec;
+}
+
+bool State::storageLimitAllows( SpeculativeExecution const& _spec ) const {
+    // limit was checked against baseStorageUsed + x, serial execution would check
+    // totalStorageUsed_ + x for the same x
+    s256 const peak = _spec.peakStorageUsed - _spec.baseStorageUsed + totalStorageUsed_;
+    return _spec.peakStorageUsed <= contractStorageLimit_ && peak <= contractStorageLimit_;
+}
+
+std::pair< ExecutionResult, TransactionReceipt > State::applySpeculativeExecution(
+    EnvInfo const& _envInfo, SealEngineFace const& _sealEngine, Transaction const& _t,
+    SpeculativeExecution const& _spec ) {
+    resetOverlayFS( RevertableFSPatch::isEnabled() );
+
+    for ( auto const& addressAccountPair : _spec.changedAccounts ) {
+        m_cache.erase( addressAccountPair.first );
+        m_cache.insert( addressAccountPair );
+        m_nonExistingAccountsCache.erase( addressAccountPair.first );
+    }
+    storageUsage = _spec.storageUsage;
+    currentStorageUsed_ = _spec.currentStorageUsed;
+    addBalance( _envInfo.author(), _spec.fees );
+
     TransactionReceipt receipt =
         _envInfo.number() >= _sealEngine.chainParams().byzantiumForkBlock ?
-            TransactionReceipt( statusCode, startGasUsed + e.gasUsed(), e.logs() ) :
-            TransactionReceipt( EmptyTrie, startGasUsed + e.gasUsed(), e.logs() );
-    receipt.setRevertReason( strRevertReason );
+            TransactionReceipt( _spec.statusCode, _envInfo.gasUsed() + _spec.gasUsed, _spec.logs ) :
+            TransactionReceipt( EmptyTrie, _envInfo.gasUsed() + _spec.gasUsed, _spec.logs );
+    receipt.setRevertReason( revertReason( _spec.result ) );
 
-    return make_pair( res, receipt );
+    commitTransaction( _envInfo, _sealEngine, _t, receipt );
+
+    return make_pair( _spec.result, receipt );
 }
 
 /// @returns true when normally halted; false when exceptionally halted; throws when internal VM
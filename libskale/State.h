@@ -25,8 +25,11 @@
 #pragma once
 
 #include <array>
+#include <deque>
 #include <queue>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <boost/optional.hpp>
 #include <boost/thread/mutex.hpp>
@@ -38,6 +41,7 @@
 #include <libethereum/TransactionReceipt.h>
 #include <libhistoric/HistoricState.h>
 
+#include "AccountCache.h"
 #include "BaseState.h"
 #include "OverlayDB.h"
 #include "OverlayFS.h"
@@ -145,6 +149,42 @@ struct Change {
 
 using ChangeLog = std::vector< Change >;
 
+/// Outcome of a transaction executed against the block-start state by
+/// State::executeSpeculatively(). It can be applied later with State::applySpeculativeExecution()
+/// if nothing it has read was changed in between.
+struct SpeculativeExecution {
+    /// false if execution threw or touched something that cannot be replayed (SKALE precompiles)
+    bool reusable = false;
+
+    dev::eth::ExecutionResult result;
+    bool statusCode = false;
+    dev::u256 gasUsed = 0;
+    dev::eth::LogEntries logs;
+    /// fees for the block author; not added to the author's balance during speculation
+    dev::u256 fees = 0;
+
+    /// every address looked up during execution
+    std::unordered_set< dev::Address > readSet;
+    /// accounts modified by the transaction
+    std::unordered_map< dev::Address, dev::eth::Account > changedAccounts;
+
+    std::map< dev::Address, dev::s256 > storageUsage;
+    dev::s256 currentStorageUsed = 0;
+    /// totalStorageUsed_ seen at start and the maximum value compared with the storage limit
+    dev::s256 baseStorageUsed = 0;
+    dev::s256 peakStorageUsed = 0;
+};
+
+/// Accounts and storage slots read by an execution or changed by commits,
+/// @see State::setReadLog() and State::setCommitLog()
+struct StateAccessLog {
+    /// accounts with balance, nonce, code or existence read or changed
+    std::unordered_set< dev::Address > accounts;
+    std::set< std::pair< dev::Address, dev::u256 > > storage;
+    /// execution read something that is not in the state, like block info or SKALE precompiles
+    bool external = false;
+};
+
 /**
  * Model of an Skale state.
  *
@@ -344,10 +384,27 @@ public:
 
     /// Commit all changes waiting in the address cache to the DB.
     /// @param _commitBehaviour whether or not to remove empty accounts during commit.
+    /// @note In block-scoped mode changes are only staged in the OverlayDB and reach the disk
+    /// on commitBlock().
 
     void commit( dev::eth::CommitBehaviour _commitBehaviour =
                      dev::eth::CommitBehaviour::RemoveEmptyAccounts );
 
+    /// Start accumulating committed transactions in memory instead of writing them
+    /// to the DB one by one. Must be finished by commitBlock().
+    void startBlockScopedCommit();
+
+    /// Write everything staged since startBlockScopedCommit() in one atomic batch.
+    /// Last executed transaction hash and partial receipts go in the same batch, so
+    /// after a crash the DB holds either the whole block or none of it.
+    void commitBlock();
+
+    /// Drop everything staged since startBlockScopedCommit() if commitBlock() was not reached,
+    /// e.g. because block execution threw. Does nothing otherwise.
+    void abortBlockScopedCommit();
+
+    bool isBlockScopedCommit() const { return m_blockScopedCommit; }
+
     /// Execute a given transaction.
     /// This will change the state accordingly.
     std::pair< dev::eth::ExecutionResult, dev::eth::TransactionReceipt > execute(
@@ -355,6 +412,46 @@ public:
         dev::eth::Transaction const& _t, Permanence _p = Permanence::Committed,
         dev::eth::OnOpFunc const& _onOp = dev::eth::OnOpFunc() );
 
+    /// Execute a transaction without committing it, recording everything needed to validate
+    /// and apply the result later. Meant for read-only copies taken at the block start.
+    /// Author fees are not paid and SKALE precompiles are not executed.
+    SpeculativeExecution executeSpeculatively( dev::eth::EnvInfo const& _envInfo,
+        dev::eth::SealEngineFace const& _sealEngine, dev::eth::Transaction const& _t );
+
+    /// @returns true if applying @a _spec gives the same storage limit checks as re-execution
+    bool storageLimitAllows( SpeculativeExecution const& _spec ) const;
+
+    /// Commit the result of executeSpeculatively() as if the transaction was executed
+    /// with Permanence::Committed. Caller must check that nothing from its read set has changed.
+    std::pair< dev::eth::ExecutionResult, dev::eth::TransactionReceipt > applySpeculativeExecution(
+        dev::eth::EnvInfo const& _envInfo, dev::eth::SealEngineFace const& _sealEngine,
+        dev::eth::Transaction const& _t, SpeculativeExecution const& _spec );
+
+    /// Collect addresses of accounts written by subsequent commits into @a _log
+    void setWriteLog( std::shared_ptr< std::unordered_set< dev::Address > > _log ) {
+        m_writeLog = _log;
+    }
+
+    /// Collect accounts and storage slots read by subsequent calls into @a _log
+    void setReadLog( std::shared_ptr< StateAccessLog > _log ) { m_readLog = _log; }
+
+    /// Collect accounts and storage slots changed by subsequent commits into @a _log. Accounts
+    /// are listed only if their balance, nonce, code or existence has changed.
+    void setCommitLog( std::shared_ptr< StateAccessLog > _log ) { m_commitLog = _log; }
+
+    /// Execution depends on something besides the state
+    void noteExternalRead() {
+        if ( m_readLog )
+            m_readLog->external = true;
+    }
+
+    /// true inside executeSpeculatively()
+    bool isSpeculative() const { return m_speculation != nullptr; }
+    /// Author fees collected by a speculative execution are applied on commit
+    void deferAuthorFees( dev::u256 const& _fees ) { m_speculation->fees += _fees; }
+    /// Speculative execution reached something that has to be executed serially
+    void abandonSpeculation() { m_speculation->reusable = false; }
+
     /// Get the account start nonce. May be required.
     dev::u256 const& accountStartNonce() const { return m_accountStartNonce; }
     dev::u256 const& requireAccountStartNonce() const;
@@ -408,6 +505,11 @@ public:
         return m_db_ptr->storageUsed();
     }
 
+    /// Counters and size of the account cache shared by this state and its copies
+    AccountCache::Stats accountCacheStats() const {
+        return m_accountCache ? m_accountCache->stats() : AccountCache::Stats{};
+    }
+
     void setStorageLimit( const dev::s256& _contractStorageLimit ) {
         contractStorageLimit_ = _contractStorageLimit;
     };  // only for tests
@@ -442,6 +544,21 @@ private:
     /// Purges non-modified entries in m_cache if it grows too large.
     void clearCacheIfTooLarge() const;
 
+    void noteRead( dev::Address const& _address ) const {
+        if ( m_readLog )
+            m_readLog->accounts.insert( _address );
+    }
+    void noteRead( dev::Address const& _address, dev::u256 const& _key ) const {
+        if ( m_readLog )
+            m_readLog->storage.emplace( _address, _key );
+    }
+
+    /// Adds @a _account to m_commitLog. Must be called before it is written to m_accountCache.
+    void noteCommitted( dev::Address const& _address, dev::eth::Account const& _account ) const;
+
+    /// Read committed storage value through m_accountCache. Must be called under x_db_ptr lock.
+    dev::u256 lookupStorage( dev::Address const& _contract, dev::u256 const& _key ) const;
+
     void createAccount( dev::Address const& _address, dev::eth::Account const&& _account );
 
     /// @returns true when normally halted; false when exceptionally halted; throws when internal VM
@@ -453,6 +570,11 @@ private:
 
     void updateStorageUsage();
 
+    /// Common tail of committed execution: storage usage, partial receipts, file storage and state
+    void commitTransaction( dev::eth::EnvInfo const& _envInfo,
+        dev::eth::SealEngineFace const& _sealEngine, dev::eth::Transaction const& _t,
+        dev::eth::TransactionReceipt const& _receipt );
+
     void resetOverlayFS( bool _enableCache ) {
         m_fs_ptr = std::make_shared< OverlayFS >( _enableCache );
     };
@@ -487,19 +609,28 @@ private:
                                             //    std::shared_ptr< dev::db::DBImpl > m_orig_db;
     std::shared_ptr< size_t > m_storedVersion;
     size_t m_currentVersion;
+    std::shared_ptr< AccountCache > m_accountCache;  ///< Committed accounts, shared by copies.
     mutable std::unordered_map< dev::Address, dev::eth::Account > m_cache;  ///< Our address cache.
                                                                             ///< This stores the
                                                                             ///< states of each
                                                                             ///< address that has
                                                                             ///< (or at least might
                                                                             ///< have) been changed.
-    mutable std::vector< dev::Address > m_unchangedCacheEntries;  ///< Tracks entries in m_cache
+    mutable std::deque< dev::Address > m_unchangedCacheEntries;  ///< Tracks entries in m_cache
                                                                   ///< that can potentially be
                                                                   ///< purged if it grows too large.
     mutable std::set< dev::Address > m_nonExistingAccountsCache;  ///< Tracks addresses that are
                                                                   ///< known to not exist.
     dev::u256 m_accountStartNonce;
 
+    bool m_blockScopedCommit = false;  ///< commit() only stages changes in m_db_ptr
+    bool m_hasStagedChanges = false;   ///< something was staged since startBlockScopedCommit()
+
+    SpeculativeExecution* m_speculation = nullptr;  ///< set by executeSpeculatively(), not copied
+    std::shared_ptr< std::unordered_set< dev::Address > > m_writeLog;  ///< @see setWriteLog()
+    std::shared_ptr< StateAccessLog > m_readLog;                       ///< @see setReadLog()
+    std::shared_ptr< StateAccessLog > m_commitLog;                     ///< @see setCommitLog()
+
     friend std::ostream& operator<<( std::ostream& _out, State const& _s );
     ChangeLog m_changeLog;
 
@@ -534,4 +665,11 @@ public:
 
 std::ostream& operator<<( std::ostream& _out, State const& _s );
 
+/// Node-local switch: write state once per block instead of once per transaction
+extern bool c_blockScopedStateCommit;
+
+/// Node-local setting: capacity of the shared account cache, separately for accounts
+/// and storage values; 0 disables it
+extern size_t c_stateCacheSize;
+
 }  // namespace skale
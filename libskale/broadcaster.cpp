@@ -24,6 +24,8 @@
 
 #include "broadcaster.h"
 
+#include <libdevcore/CommonJS.h>
+#include <libdevcore/RLP.h>
 #include <libethereum/Client.h>
 #include <libethereum/SkaleHost.h>
 #include <libskale/SkaleClient.h>
@@ -34,8 +36,28 @@
 
 #include <string>
 
+size_t c_broadcastBatchSize = 0;
+unsigned c_broadcastBatchTimeUs = 1000;
+
 Broadcaster::~Broadcaster() {}
 
+void Broadcaster::broadcastBatch( const std::vector< dev::bytes >& _rlps ) {
+    for ( const dev::bytes& rlp : _rlps )
+        broadcast( dev::toJS( rlp ) );
+}
+
+dev::bytes Broadcaster::encodeFrame( const std::vector< dev::bytes >& _rlps ) {
+    dev::RLPStream stream( _rlps.size() );
+    for ( const dev::bytes& rlp : _rlps )
+        stream.append( dev::bytesConstRef( &rlp ) );
+    return stream.out();
+}
+
+bool Broadcaster::isFrame( dev::bytesConstRef _message ) {
+    // hex strings start with "0x"
+    return !_message.empty() && _message[0] >= dev::c_rlpListStart;
+}
+
 HttpBroadcaster::HttpBroadcaster( dev::eth::Client& _client ) : m_client( _client ) {
     const dev::eth::ChainParams& ch = _client.chainParams();
     initClients( ch.sChain, ch.nodeInfo );
@@ -78,6 +100,8 @@ ZmqBroadcaster::ZmqBroadcaster( dev::eth::Client& _client, SkaleHost& _skaleHost
       m_zmq_client_socket( nullptr ),
       m_need_exit( false ) {
     m_zmq_context = zmq_ctx_new();
+    m_frameStats.event_queue_add( "sent", 0 );
+    m_frameStats.event_queue_add( "received", 0 );
 }
 
 std::string ZmqBroadcaster::getZmqUrl( const dev::eth::sChainNode& node ) const {
@@ -206,13 +230,23 @@ void ZmqBroadcaster::startService() {
                 size_t size = zmq_msg_size( &msg );
                 void* data = zmq_msg_data( &msg );
 
-                std::string str( static_cast< char* >( data ), size );
-
-                try {
-                    m_skaleHost.receiveTransaction( str );
-                } catch ( const std::exception& ex ) {
-                    clog( dev::VerbosityDebug, "skale-host" )
-                        << "Received bad transaction through broadcast: " << ex.what();
+                dev::bytesConstRef message( static_cast< dev::byte* >( data ), size );
+                if ( isFrame( message ) ) {
+                    try {
+                        noteFrame( false, m_skaleHost.receiveTransactions( message ) );
+                    } catch ( const std::exception& ex ) {
+                        clog( dev::VerbosityDebug, "skale-host" )
+                            << "Received bad transactions frame through broadcast: " << ex.what();
+                    }
+                } else {
+                    std::string str( static_cast< char* >( data ), size );
+
+                    try {
+                        m_skaleHost.receiveTransaction( str );
+                    } catch ( const std::exception& ex ) {
+                        clog( dev::VerbosityDebug, "skale-host" )
+                            << "Received bad transaction through broadcast: " << ex.what();
+                    }
                 }
 
             } catch ( const std::exception& ex ) {
@@ -252,8 +286,42 @@ void ZmqBroadcaster::broadcast( const std::string& _rlp ) {
         return;
     }
 
-    int res = zmq_send( server_socket(), const_cast< char* >( _rlp.c_str() ), _rlp.size(), 0 );
+    send( _rlp.c_str(), _rlp.size() );
+}
+
+void ZmqBroadcaster::broadcastBatch( const std::vector< dev::bytes >& _rlps ) {
+    if ( _rlps.empty() )
+        return;
+
+    dev::bytes frame = encodeFrame( _rlps );
+    send( frame.data(), frame.size() );
+    noteFrame( true, _rlps.size() );
+}
+
+void ZmqBroadcaster::send( const void* _data, size_t _size ) {
+    int res = zmq_send( server_socket(), _data, _size, 0 );
     if ( res <= 0 ) {
         throw std::runtime_error( "Zmq can't send data" );
     }
 }
+
+void ZmqBroadcaster::noteFrame( bool _sent, size_t _transactions ) {
+    std::lock_guard< std::mutex > lock( m_statsMutex );
+    if ( _sent ) {
+        ++m_stats.framesSent;
+        m_stats.transactionsSent += _transactions;
+    } else {
+        ++m_stats.framesReceived;
+        m_stats.transactionsReceived += _transactions;
+    }
+    m_frameStats.event_add( _sent ? "sent" : "received", 1 );
+}
+
+Broadcaster::Stats ZmqBroadcaster::stats() const {
+    std::lock_guard< std::mutex > lock( m_statsMutex );
+    Stats stats = m_stats;
+    skutils::stats::time_point tpNow = skutils::stats::clock::now();
+    stats.framesSentPerSecond = m_frameStats.compute_eps_smooth( "sent", tpNow );
+    stats.framesReceivedPerSecond = m_frameStats.compute_eps_smooth( "received", tpNow );
+    return stats;
+}
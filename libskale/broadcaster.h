@@ -28,7 +28,10 @@
 
 #include <libethereum/ChainParams.h>
 
+#include <skutils/stats.h>
+
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -42,6 +45,12 @@ class Client;
 class SkaleClient;
 class SkaleHost;
 
+/// Max number of transactions sent in one frame, 0 to send them one by one as hex strings.
+/// Nodes of older versions drop frames, so set it only when every node of the chain reads them
+extern size_t c_broadcastBatchSize;
+/// How long to wait for more transactions to fill a frame
+extern unsigned c_broadcastBatchTimeUs;
+
 class Broadcaster {
 public:
     class StartupException : public std::runtime_error {
@@ -49,10 +58,28 @@ public:
         StartupException( const std::string& what ) : std::runtime_error( what ) {}
     };
 
+    struct Stats {
+        uint64_t framesSent = 0;
+        uint64_t transactionsSent = 0;
+        uint64_t framesReceived = 0;
+        uint64_t transactionsReceived = 0;
+        double framesSentPerSecond = 0;
+        double framesReceivedPerSecond = 0;
+    };
+
     Broadcaster() {}
     virtual ~Broadcaster();
 
     virtual void broadcast( const std::string& _rlp ) = 0;
+    /// Sends binary RLPs of transactions, in one frame if supported
+    virtual void broadcastBatch( const std::vector< dev::bytes >& _rlps );
+
+    virtual Stats stats() const { return Stats(); }
+
+    /// Frame is an RLP list of transaction RLPs, each encoded as a byte string
+    static dev::bytes encodeFrame( const std::vector< dev::bytes >& _rlps );
+    /// Tells a frame from a hex string sent by broadcast()
+    static bool isFrame( dev::bytesConstRef _message );
 
     virtual void startService() = 0;
     virtual void stopService() = 0;
@@ -81,6 +108,9 @@ public:
     virtual ~ZmqBroadcaster();
 
     virtual void broadcast( const std::string& _rlp );
+    virtual void broadcastBatch( const std::vector< dev::bytes >& _rlps );
+
+    virtual Stats stats() const;
 
     virtual void startService();
     virtual void stopService();
@@ -89,6 +119,13 @@ private:
     dev::eth::Client& m_client;
     SkaleHost& m_skaleHost;
 
+    void send( const void* _data, size_t _size );
+    void noteFrame( bool _sent, size_t _transactions );
+
+    mutable std::mutex m_statsMutex;
+    Stats m_stats;
+    mutable skutils::stats::named_event_stats m_frameStats;
+
     void* m_zmq_context;
     mutable void* m_zmq_server_socket;
     mutable void* m_zmq_client_socket;
@@ -1169,6 +1169,11 @@ bool SkaleWsPeer::handleWebSocketSpecificRequest(
     if ( esm == e_server_mode_t::esm_informational && strMethod == "eth_getBalance" )
         isSkipProtocolSpecfic = true;
 
+    if ( ( !isSkipProtocolSpecfic ) &&
+         pso()->handleProtocolSpecificStreamingRequest(
+             getRemoteIp(), joRequestRapidjson, strResponse ) )
+        return true;
+
     if ( ( !isSkipProtocolSpecfic ) && pso()->handleProtocolSpecificRequest( getRemoteIp(),
                                            joRequestRapidjson, joResponseRapidjson ) ) {
         rapidjson::StringBuffer buffer;
@@ -3717,6 +3722,24 @@ const SkaleServerOverride::protocol_rpc_map_t SkaleServerOverride::g_protocol_rp
     { "eth_getCode", &SkaleServerOverride::eth_getCode }
 };
 
+bool SkaleServerOverride::handleProtocolSpecificStreamingRequest( const std::string& strOrigin,
+    const rapidjson::Document& joRequest, std::string& strResponse ) {
+    std::string strMethod = joRequest["method"].GetString();
+    protocol_stream_rpc_map_t::const_iterator itFind = g_protocol_stream_rpc_map.find( strMethod );
+    if ( itFind == g_protocol_stream_rpc_map.end() )
+        return false;
+    rapidjson::StringBuffer buffer;
+    ( ( *this ).*( itFind->second ) )( strOrigin, joRequest, buffer );
+    strResponse.assign( buffer.GetString(), buffer.GetSize() );
+    return true;
+}
+
+const SkaleServerOverride::protocol_stream_rpc_map_t
+    SkaleServerOverride::g_protocol_stream_rpc_map = {
+        { "eth_getLogs", &SkaleServerOverride::eth_getLogs },
+        { "skale_getLogs", &SkaleServerOverride::skale_getLogs }
+    };
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -3876,6 +3899,16 @@ void SkaleServerOverride::eth_getCode( const std::string& /*strOrigin*/,
     opts_.fn_eth_getCode_( joRequest, joResponse );
 }
 
+void SkaleServerOverride::eth_getLogs( const std::string& /*strOrigin*/,
+    const rapidjson::Document& joRequest, rapidjson::StringBuffer& bufferResponse ) {
+    opts_.fn_eth_getLogs_( joRequest, bufferResponse );
+}
+
+void SkaleServerOverride::skale_getLogs( const std::string& /*strOrigin*/,
+    const rapidjson::Document& joRequest, rapidjson::StringBuffer& bufferResponse ) {
+    opts_.fn_skale_getLogs_( joRequest, bufferResponse );
+}
+
 bool SkaleServerOverride::handleHttpSpecificRequest( const std::string& strOrigin,
     e_server_mode_t esm, const std::string& strRequest, std::string& strResponse ) {
     strResponse.clear();
@@ -3912,6 +3945,8 @@ bool SkaleServerOverride::handleHttpSpecificRequest( const std::string& strOrigi
         strResponse = joResponseObj.dump();
         return true;
     }
+    if ( handleProtocolSpecificStreamingRequest( strOrigin, joRequest, strResponse ) )
+        return true;
     if ( !handleProtocolSpecificRequest( strOrigin, joRequest, joResponse ) ) {
         return false;
     } else {
@@ -335,6 +335,10 @@ public:
     typedef std::function< void(
         const rapidjson::Document& joRequest, rapidjson::Document& joResponse ) >
         fn_jsonrpc_call_t;
+    // writes the whole response, for results too big to be built as a document first
+    typedef std::function< void(
+        const rapidjson::Document& joRequest, rapidjson::StringBuffer& bufferResponse ) >
+        fn_jsonrpc_stream_call_t;
 
     static const double g_lfDefaultExecutionDurationMaxForPerformanceWarning;  // in seconds,
                                                                                // default 1 second
@@ -423,6 +427,8 @@ public:
         fn_jsonrpc_call_t fn_eth_getStorageAt_;
         fn_jsonrpc_call_t fn_eth_getTransactionCount_;
         fn_jsonrpc_call_t fn_eth_getCode_;
+        fn_jsonrpc_stream_call_t fn_eth_getLogs_;
+        fn_jsonrpc_stream_call_t fn_skale_getLogs_;
         double lfExecutionDurationMaxForPerformanceWarning_ = 0;  // in seconds
         bool isTraceCalls_ = false;
         bool isTraceSpecialCalls_ = false;
@@ -440,6 +446,8 @@ public:
             fn_eth_getStorageAt_ = other.fn_eth_getStorageAt_;
             fn_eth_getTransactionCount_ = other.fn_eth_getTransactionCount_;
             fn_eth_getCode_ = other.fn_eth_getCode_;
+            fn_eth_getLogs_ = other.fn_eth_getLogs_;
+            fn_skale_getLogs_ = other.fn_skale_getLogs_;
             lfExecutionDurationMaxForPerformanceWarning_ =
                 other.lfExecutionDurationMaxForPerformanceWarning_;
             isTraceCalls_ = other.isTraceCalls_;
@@ -576,6 +584,8 @@ public:
 
     bool handleProtocolSpecificRequest( const std::string& strOrigin,
         const rapidjson::Document& joRequest, rapidjson::Document& joResponse );
+    bool handleProtocolSpecificStreamingRequest( const std::string& strOrigin,
+        const rapidjson::Document& joRequest, std::string& strResponse );
 
 protected:
     typedef void ( SkaleServerOverride::*rpc_method_t )( const std::string& strOrigin,
@@ -607,6 +617,17 @@ protected:
     void eth_getCode( const std::string& strOrigin, const rapidjson::Document& joRequest,
         rapidjson::Document& joResponse );
 
+    typedef void ( SkaleServerOverride::*rpc_stream_method_t )( const std::string& strOrigin,
+        const rapidjson::Document& joRequest, rapidjson::StringBuffer& bufferResponse );
+    typedef std::map< std::string, rpc_stream_method_t > protocol_stream_rpc_map_t;
+    static const protocol_stream_rpc_map_t g_protocol_stream_rpc_map;
+
+    void eth_getLogs( const std::string& strOrigin, const rapidjson::Document& joRequest,
+        rapidjson::StringBuffer& bufferResponse );
+
+    void skale_getLogs( const std::string& strOrigin, const rapidjson::Document& joRequest,
+        rapidjson::StringBuffer& bufferResponse );
+
     unsigned iwBlockStats_ = unsigned( -1 ), iwPendingTransactionStats_ = unsigned( -1 );
     mutex_type mtxStats_;
     skutils::stats::named_event_stats statsBlocks_, statsTransactions_, statsPendingTx_;
@@ -45,7 +45,6 @@ using namespace dev;
 using namespace eth;
 using namespace dev::rpc;
 
-const uint64_t MAX_CALL_CACHE_ENTRIES = 1024;
 const uint64_t MAX_RECEIPT_CACHE_ENTRIES = 1024;
 
 
@@ -53,7 +52,6 @@ Eth::Eth( const std::string& configPath, eth::Interface& _eth, eth::AccountHolde
     : skutils::json_config_file_accessor( configPath ),
       m_eth( _eth ),
       m_ethAccounts( _ethAccounts ),
-      m_callCache( MAX_CALL_CACHE_ENTRIES ),
       m_receiptsCache( MAX_RECEIPT_CACHE_ENTRIES ) {}
 
 bool Eth::isEnabledTransactionSending() const {
@@ -383,15 +381,6 @@ string Eth::eth_call( TransactionSkeleton& t, string const&
 
     auto bN = jsToBlockNumber( blockNumber );
 
-    // if an identical call has been made for the same block number
-    // and the result is in cache, return the result from cache
-    // note that lru_cache class is thread safe so there is no need to lock
-
-
-    // Step 1 Look into the cache for the same request at the same block number
-    // no need to lock since cache is synchronized internally
-    string key;
-
     if ( bN == LatestBlock || bN == PendingBlock ) {
         bN = client()->number();
     }
@@ -400,16 +389,7 @@ string Eth::eth_call( TransactionSkeleton& t, string const&
         throw std::logic_error( "Unknown block number:" + blockNumber );
     }
 
-
-    key = t.toString().append( to_string( bN ) );
-
-    auto result = m_callCache.getIfExists( key );
-    if ( result.has_value() ) {
-        // found an identical request in cache, return
-        return any_cast< string >( result );
-    }
-
-    // Step 2. We got a cache miss. Execute the call now.
+    // identical calls are cached and coalesced by the client
     setTransactionDefaults( t );
 
     ExecutionResult er = client()->call( t.from, t.value, t.to, t.data, t.gas, t.gasPrice,
@@ -436,9 +416,6 @@ string Eth::eth_call( TransactionSkeleton& t, string const&
 
     string callResult = toJS( er.output );
 
-    // put the result into cache so it can be used by future calls
-    m_callCache.put( key, callResult );
-
     return callResult;
 }
 
@@ -690,9 +667,39 @@ Json::Value Eth::eth_getFilterLogs( string const& _filterId ) {
 Json::Value Eth::eth_getLogs( Json::Value const& _json ) {
     try {
         return toJson( client()->logs( toLogFilter( _json ) ) );
+    } catch ( TooManyLogs const& ) {
+        BOOST_THROW_EXCEPTION( JsonRpcException( Errors::ERROR_RPC_INVALID_PARAMS,
+            "query returned more than " + to_string( c_maxLogsPerQuery ) + " results" ) );
+    } catch ( ... ) {
+        BOOST_THROW_EXCEPTION( JsonRpcException( Errors::ERROR_RPC_INVALID_PARAMS ) );
+    }
+}
+
+optional< LogCursor > Eth::writeLogs( Json::Value const& _filter, LogCursor const& _from,
+    size_t _limit, rapidjson::Writer< rapidjson::StringBuffer >& _writer ) {
+    LogFilter filter;
+    try {
+        filter = toLogFilter( _filter );
     } catch ( ... ) {
         BOOST_THROW_EXCEPTION( JsonRpcException( Errors::ERROR_RPC_INVALID_PARAMS ) );
     }
+
+    size_t count = 0;
+    _writer.StartArray();
+    optional< LogCursor > next =
+        client()->forEachLog( filter, _from, [&]( LocalisedLogEntry const& _e ) {
+            if ( _limit && count == _limit )
+                return false;
+            ++count;
+            // only one entry is kept in memory besides the output
+            rapidjson::Document entry;
+            entry.SetObject();
+            rapidjson::Document d = toRapidJson( _e, entry.GetAllocator() );
+            d.Accept( _writer );
+            return true;
+        } );
+    _writer.EndArray();
+    return next;
 }
 
 // Json::Value Eth::eth_getLogsEx( Json::Value const& _json ) {
@@ -30,8 +30,12 @@
 #include <jsonrpccpp/common/exception.h>
 #include <jsonrpccpp/server.h>
 #include <libdevcore/Common.h>
+#include <libethereum/LogFilter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #include <iosfwd>
 #include <memory>
+#include <optional>
 
 #include <libconsensus/thirdparty/lrucache.hpp>
 
@@ -126,6 +130,11 @@ public:
     //    virtual Json::Value eth_getFilterLogsEx( std::string const& _filterId ) override;
     virtual Json::Value eth_getLogs( Json::Value const& _json ) override;
     //    virtual Json::Value eth_getLogsEx( Json::Value const& _json ) override;
+    /// Writes logs matching _filter starting at _from to _writer as a JSON array, at most _limit
+    /// of them if _limit is not 0. @returns position to continue from if there are more logs.
+    std::optional< eth::LogCursor > writeLogs( Json::Value const& _filter,
+        eth::LogCursor const& _from, size_t _limit,
+        rapidjson::Writer< rapidjson::StringBuffer >& _writer );
     virtual Json::Value eth_getWork() override;
     virtual bool eth_submitWork(
         std::string const& _nonce, std::string const&, std::string const& _mixHash ) override;
@@ -151,10 +160,6 @@ protected:
     eth::Interface& m_eth;
     eth::AccountHolder& m_ethAccounts;
 
-    // a cache that maps the call request to the pair of response string and block number
-    // for which the request has been executed
-    cache::lru_cache< string, string > m_callCache;
-
     // a cache that maps a transaction receipt to the block number where
     // the transaction was not yet ready
     // for which the request has been executed
@@ -257,7 +257,6 @@ rapidjson::Document toRapidJson(
             ADD_FIELD_TO_RAPIDJSON(
                 res, "transactionIndex", toJS( _e.transactionIndex ), allocator );
         } else {
-            res["type"] = "pending";
             res.AddMember( "type", "pending", allocator );
             res.AddMember( "blockNumber", rapidjson::Value(), allocator );
             res.AddMember( "blockHash", rapidjson::Value(), allocator );
@@ -613,6 +612,27 @@ dev::eth::LogFilter toLogFilter( Json::Value const& _json )  // commented to avo
     return filter;
 }
 
+std::string toJS( LogCursor const& _cursor ) {
+    bytes token( 8 );
+    for ( unsigned i = 0; i < 4; ++i ) {
+        token[3 - i] = byte( _cursor.block >> ( 8 * i ) );
+        token[7 - i] = byte( _cursor.log >> ( 8 * i ) );
+    }
+    return dev::toJS( token );
+}
+
+LogCursor jsToLogCursor( std::string const& _token ) {
+    bytes token = jsToBytes( _token, OnFailed::Throw );
+    if ( token.size() != 8 )
+        throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+    LogCursor ret;
+    for ( unsigned i = 0; i < 4; ++i ) {
+        ret.block = ( ret.block << 8 ) | token[i];
+        ret.log = ( ret.log << 8 ) | token[4 + i];
+    }
+    return ret;
+}
+
 bool validateEIP1898Json( const rapidjson::Value& jo ) {
     if ( !jo.IsObject() )
         return false;
@@ -87,6 +87,9 @@ std::string getBlockFromEIP1898Json( const rapidjson::Value& jo );
 TransactionSkeleton toTransactionSkeleton( Json::Value const& _json );
 TransactionSkeleton rapidJsonToTransactionSkeleton( rapidjson::Value const& _json );
 LogFilter toLogFilter( Json::Value const& _json );
+/// Continuation token of a paginated log query
+std::string toJS( LogCursor const& _cursor );
+LogCursor jsToLogCursor( std::string const& _token );
 // LogFilter toLogFilter( Json::Value const& _json,
 //    Interface const& _client );  // commented to avoid warning. Uncomment once in use @ PoC-7.
 
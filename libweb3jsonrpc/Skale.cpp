@@ -57,11 +57,20 @@
 
 #include <cstdlib>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace dev::eth;
 
 namespace dev {
 namespace rpc {
 
+// how long a fragment request waits for a diff that is still being produced
+static const unsigned c_snapshotDataWaitSec = 10;
+// consecutive fragment requests that may bring no data before the download is abandoned
+static const size_t c_maxFragmentRetries = 30;
+
 std::string exceptionToErrorMessage();
 
 Skale::Skale( Client& _client, std::shared_ptr< SharedSpace > _sharedSpace )
@@ -162,13 +171,6 @@ nlohmann::json Skale::impl_skale_getSnapshot( const nlohmann::json& joRequest, C
         return joResponse;
     }
 
-    if ( currentSnapshotBlockNumber >= 0 ) {
-        fs::remove( currentSnapshotPath );
-        currentSnapshotBlockNumber = -1;
-        if ( m_shared_space )
-            m_shared_space->unlock();
-    }
-
     // exit if shared space unavailable
     if ( m_shared_space && !m_shared_space->try_lock() ) {
         joResponse["error"] = "snapshot serialization space is occupied, please try again later";
@@ -182,8 +184,26 @@ nlohmann::json Skale::impl_skale_getSnapshot( const nlohmann::json& joRequest, C
         snapshotDownloadFragmentMonitorThread->join();
     }
 
+    // streaming clients may read the diff while btrfs send is still producing it
+    bool isStreaming = joRequest.count( "streaming" ) > 0 && joRequest["streaming"].get< bool >();
+
     try {
-        currentSnapshotPath = client.createSnapshotFile( blockNumber );
+        SnapshotManager::DiffJob job;
+        if ( isStreaming ) {
+            job = client.createSnapshotFileAsync( blockNumber );
+        } else {
+            job.path = job.partPath = client.createSnapshotFile( blockNumber );
+            std::promise< void > ready;
+            ready.set_value();
+            job.done = ready.get_future().share();
+        }
+        currentSnapshotDone = job.done;
+        currentSnapshotFd = ::open( job.partPath.c_str(), O_RDONLY );
+        // the diff may have been completed and renamed meanwhile
+        if ( currentSnapshotFd < 0 && job.partPath != job.path )
+            currentSnapshotFd = ::open( job.path.c_str(), O_RDONLY );
+        if ( currentSnapshotFd < 0 )
+            throw std::runtime_error( "failed to open snapshot file" );
     } catch ( ... ) {
         if ( m_shared_space )
             m_shared_space->unlock();
@@ -207,15 +227,20 @@ nlohmann::json Skale::impl_skale_getSnapshot( const nlohmann::json& joRequest, C
             clog( VerbosityInfo, "skale_downloadSnapshotFragmentMonitorThread" )
                 << "Unlocking shared space as timeout was reached.\n";
 
-            std::lock_guard< std::mutex > lock( m_snapshot_mutex );
-            if ( currentSnapshotBlockNumber >= 0 ) {
+            int blockNumber;
+            {
+                std::lock_guard< std::mutex > lock( m_snapshot_mutex );
+                blockNumber = closeCurrentSnapshot();
+            }
+            // removal waits for the diff, so fragment requests must not be blocked meanwhile;
+            // the shared space stays locked until the file is gone
+            if ( blockNumber >= 0 ) {
                 try {
-                    fs::remove( currentSnapshotPath );
+                    m_client.removeSnapshotFile( blockNumber );
                     clog( VerbosityInfo, "skale_downloadSnapshotFragmentMonitorThread" )
                         << "Deleted snapshot file.\n";
                 } catch ( ... ) {
                 }
-                currentSnapshotBlockNumber = -1;
                 if ( m_shared_space )
                     m_shared_space->unlock();
             }
@@ -224,14 +249,66 @@ nlohmann::json Skale::impl_skale_getSnapshot( const nlohmann::json& joRequest, C
 
     //
     //
-    size_t sizeOfFile = fs::file_size( currentSnapshotPath );
+    struct stat st;
+    if ( ::fstat( currentSnapshotFd, &st ) != 0 )
+        throw std::runtime_error( "failed to stat snapshot file" );
+    size_t sizeOfFile = st.st_size;
     //
     //
-    joResponse["dataSize"] = sizeOfFile;
+    joResponse["dataSize"] = sizeOfFile;  // only the part written so far when streaming
     joResponse["maxAllowedChunkSize"] = g_nMaxChunckSize;
+    if ( isStreaming )
+        joResponse["streaming"] = true;
     return joResponse;
 }
 
+int Skale::openCurrentSnapshot( std::shared_future< void >& o_done ) {
+    std::lock_guard< std::mutex > lock( m_snapshot_mutex );
+
+    lastSnapshotDownloadFragmentTime = time( NULL );
+
+    if ( currentSnapshotBlockNumber < 0 )
+        return -1;
+
+    o_done = currentSnapshotDone;
+    int fd = ::dup( currentSnapshotFd );
+    if ( fd < 0 )
+        throw std::runtime_error( "failed to open snapshot file" );
+    return fd;
+}
+
+// under m_snapshot_mutex
+int Skale::closeCurrentSnapshot() {
+    if ( currentSnapshotFd >= 0 )
+        ::close( currentSnapshotFd );
+    currentSnapshotFd = -1;
+    currentSnapshotDone = std::shared_future< void >();
+    int blockNumber = currentSnapshotBlockNumber;
+    currentSnapshotBlockNumber = -1;
+    return blockNumber;
+}
+
+// returns size of data available; waits a bit if there is nothing after idxFrom yet
+size_t Skale::waitForSnapshotData(
+    int fd, const std::shared_future< void >& done, size_t idxFrom, bool& isComplete ) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds( c_snapshotDataWaitSec );
+    for ( ;; ) {
+        isComplete = done.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready;
+        if ( isComplete )
+            done.get();  // throws if btrfs send failed
+
+        struct stat st;
+        if ( ::fstat( fd, &st ) != 0 )
+            throw std::runtime_error( "failed to stat snapshot file" );
+        size_t sizeOfFile = st.st_size;
+
+        if ( isComplete || sizeOfFile > idxFrom || std::chrono::steady_clock::now() > deadline )
+            return sizeOfFile;
+        done.wait_for( std::chrono::milliseconds( 100 ) );
+    }
+}
+
 Json::Value Skale::skale_getSnapshot( const Json::Value& request ) {
     try {
         Json::FastWriter fastWriter;
@@ -254,35 +331,34 @@ Json::Value Skale::skale_getSnapshot( const Json::Value& request ) {
 // "from": 0, "size": 1024, "isBinary": true },"id":73}'
 //
 std::vector< uint8_t > Skale::ll_impl_skale_downloadSnapshotFragment(
-    const fs::path& fp, size_t idxFrom, size_t sizeOfChunk ) {
-    // size_t sizeOfFile = fs::file_size( fp );
-    //
-    //
-    std::ifstream f;
-    f.open( fp.native(), std::ios::in | std::ios::binary );
-    if ( !f.is_open() )
-        throw std::runtime_error( "failed to open snapshot file" );
+    int fd, size_t idxFrom, size_t sizeOfChunk ) {
+    // pread() doesn't move the shared file offset, so fragments can be read concurrently
     std::vector< uint8_t > buffer( sizeOfChunk );
-    f.seekg( idxFrom );
-    f.read( ( char* ) buffer.data(), sizeOfChunk );
-    f.close();
+    size_t sizeRead = 0;
+    while ( sizeRead < sizeOfChunk ) {
+        ssize_t n = ::pread( fd, buffer.data() + sizeRead, sizeOfChunk - sizeRead,
+            off_t( idxFrom + sizeRead ) );
+        if ( n < 0 && errno == EINTR )
+            continue;
+        if ( n <= 0 )
+            throw std::runtime_error( "failed to read snapshot file" );
+        sizeRead += n;
+    }
     return buffer;
 }
 std::vector< uint8_t > Skale::impl_skale_downloadSnapshotFragmentBinary(
     const nlohmann::json& joRequest ) {
-    std::lock_guard< std::mutex > lock( m_snapshot_mutex );
-
-    lastSnapshotDownloadFragmentTime = time( NULL );
-
-    if ( currentSnapshotBlockNumber < 0 ) {
+    std::shared_future< void > done;
+    int fd = openCurrentSnapshot( done );
+    if ( fd < 0 ) {
         return std::vector< uint8_t >();
     }
-
-    fs::path fp = currentSnapshotPath;
+    std::shared_ptr< void > fdCloser( nullptr, [fd]( void* ) { ::close( fd ); } );
     //
     size_t idxFrom = joRequest["from"].get< size_t >();
     size_t sizeOfChunk = joRequest["size"].get< size_t >();
-    size_t sizeOfFile = fs::file_size( fp );
+    bool isComplete;
+    size_t sizeOfFile = waitForSnapshotData( fd, done, idxFrom, isComplete );
     if ( idxFrom >= sizeOfFile )
         sizeOfChunk = 0;
     else if ( ( idxFrom + sizeOfChunk ) > sizeOfFile )
@@ -290,24 +366,24 @@ std::vector< uint8_t > Skale::impl_skale_downloadSnapshotFragmentBinary(
     if ( sizeOfChunk > g_nMaxChunckSize )
         sizeOfChunk = g_nMaxChunckSize;
     std::vector< uint8_t > buffer =
-        Skale::ll_impl_skale_downloadSnapshotFragment( fp, idxFrom, sizeOfChunk );
+        Skale::ll_impl_skale_downloadSnapshotFragment( fd, idxFrom, sizeOfChunk );
     return buffer;
 }
 nlohmann::json Skale::impl_skale_downloadSnapshotFragmentJSON( const nlohmann::json& joRequest ) {
-    std::lock_guard< std::mutex > lock( m_snapshot_mutex );
-
-    lastSnapshotDownloadFragmentTime = time( NULL );
     nlohmann::json joResponse = nlohmann::json::object();
 
-    if ( currentSnapshotBlockNumber < 0 )
+    std::shared_future< void > done;
+    int fd = openCurrentSnapshot( done );
+    if ( fd < 0 )
         return "there's no current snapshot, or snapshot expired; please call skale_getSnapshot() "
                "first";
+    std::shared_ptr< void > fdCloser( nullptr, [fd]( void* ) { ::close( fd ); } );
 
-    fs::path fp = currentSnapshotPath;
     //
     size_t idxFrom = joRequest["from"].get< size_t >();
     size_t sizeOfChunk = joRequest["size"].get< size_t >();
-    size_t sizeOfFile = fs::file_size( fp );
+    bool isComplete;
+    size_t sizeOfFile = waitForSnapshotData( fd, done, idxFrom, isComplete );
     if ( idxFrom >= sizeOfFile )
         sizeOfChunk = 0;
     else if ( ( idxFrom + sizeOfChunk ) > sizeOfFile )
@@ -315,16 +391,17 @@ nlohmann::json Skale::impl_skale_downloadSnapshotFragmentJSON( const nlohmann::j
     if ( sizeOfChunk > g_nMaxChunckSize )
         sizeOfChunk = g_nMaxChunckSize;
     std::vector< uint8_t > buffer =
-        Skale::ll_impl_skale_downloadSnapshotFragment( fp, idxFrom, sizeOfChunk );
+        Skale::ll_impl_skale_downloadSnapshotFragment( fd, idxFrom, sizeOfChunk );
     std::string strBase64 = skutils::tools::base64::encode( buffer.data(), sizeOfChunk );
 
-    if ( sizeOfChunk + idxFrom == sizeOfFile )
+    if ( isComplete && sizeOfChunk + idxFrom == sizeOfFile )
         clog( VerbosityInfo, "skale_downloadSnapshotFragment" )
-            << cc::success( "Sent all chunks for " ) << cc::p( currentSnapshotPath.string() )
-            << "\n";
+            << cc::success( "Sent all chunks of snapshot" ) << "\n";
 
     joResponse["size"] = sizeOfChunk;
     joResponse["data"] = strBase64;
+    // no more data will appear after this fragment
+    joResponse["isComplete"] = isComplete && sizeOfChunk + idxFrom == sizeOfFile;
     return joResponse;
 }
 
@@ -563,6 +640,47 @@ std::string Skale::oracle_checkResult( std::string& receipt ) {
 
 namespace snapshot {
 
+// fetches one fragment; returns false if it should be asked for again
+static bool downloadFragment( skutils::rest::client& cli, size_t idxFrom, size_t size,
+    bool isBinaryDownload, std::vector< uint8_t >& buffer, bool& isComplete,
+    std::string& strError ) {
+    isComplete = false;
+    buffer.clear();
+    nlohmann::json joIn = nlohmann::json::object();
+    joIn["jsonrpc"] = "2.0";
+    joIn["method"] = "skale_downloadSnapshotFragment";
+    nlohmann::json joParams = nlohmann::json::object();
+    joParams["from"] = idxFrom;
+    joParams["size"] = size;
+    joParams["isBinary"] = isBinaryDownload;
+    joIn["params"] = joParams;
+    skutils::rest::data_t d = cli.call( joIn, true,
+        isBinaryDownload ? skutils::rest::e_data_fetch_strategy::edfs_nearest_binary :
+                           skutils::rest::e_data_fetch_strategy::edfs_default );
+    if ( isBinaryDownload ) {
+        buffer.insert( buffer.end(), d.s_.begin(), d.s_.end() );
+        // binary answer can't tell the end of data from an error
+        if ( buffer.empty() )
+            return downloadFragment( cli, idxFrom, 0, false, buffer, isComplete, strError );
+        return true;
+    }
+    if ( d.empty() ) {
+        strError = "REST call failed(fragment downloader)";
+        return false;
+    }
+    nlohmann::json joAnswer = nlohmann::json::parse( d.s_ );
+    nlohmann::json joFragment = joAnswer["result"];
+    if ( !joFragment.is_object() || joFragment.count( "error" ) > 0 ) {
+        strError = "skale_downloadSnapshotFragment error: ";
+        strError += joFragment.is_object() ? joFragment["error"].dump() : joFragment.dump();
+        return false;
+    }
+    std::string strBase64orBinary = joFragment["data"];
+    buffer = skutils::tools::base64::decodeBin( strBase64orBinary );
+    isComplete = joFragment.count( "isComplete" ) > 0 && joFragment["isComplete"].get< bool >();
+    return true;
+}
+
 bool download( const std::string& strURLWeb3, unsigned& block_number, const fs::path& saveTo,
     fn_progress_t onProgress, bool isBinaryDownload, std::string* pStrErrorDescription ) {
     if ( pStrErrorDescription )
@@ -618,6 +736,7 @@ bool download( const std::string& strURLWeb3, unsigned& block_number, const fs::
         joIn["method"] = "skale_getSnapshot";
         nlohmann::json joParams = nlohmann::json::object();
         joParams["blockNumber"] = block_number;
+        joParams["streaming"] = true;
         joIn["params"] = joParams;
         skutils::rest::data_t d = cli.call( joIn );
         if ( !d.err_s_.empty() ) {
@@ -656,6 +775,9 @@ bool download( const std::string& strURLWeb3, unsigned& block_number, const fs::
         }
         size_t sizeOfFile = joSnapshotInfo["dataSize"].get< size_t >();
         size_t maxAllowedChunkSize = joSnapshotInfo["maxAllowedChunkSize"].get< size_t >();
+        // older servers ignore "streaming" and return the complete diff
+        bool isStreaming =
+            joSnapshotInfo.count( "streaming" ) > 0 && joSnapshotInfo["streaming"].get< bool >();
         size_t idxChunk, cntChunks = sizeOfFile / maxAllowedChunkSize +
                                      ( ( ( sizeOfFile % maxAllowedChunkSize ) > 0 ) ? 1 : 0 );
         //
@@ -670,6 +792,55 @@ bool download( const std::string& strURLWeb3, unsigned& block_number, const fs::
                 ( *pStrErrorDescription ) = s;
             throw std::runtime_error( s );
         }
+        if ( isStreaming ) {
+            // diff is being produced while downloaded: read until the server reports its end,
+            // a failed fragment is requested again from the same offset
+            size_t idxFrom = 0, cntFailures = 0;
+            for ( idxChunk = 0;; ) {
+                std::vector< uint8_t > buffer;
+                bool isComplete = false;
+                std::string strError;
+                bool bOK = downloadFragment( cli, idxFrom, maxAllowedChunkSize, isBinaryDownload,
+                    buffer, isComplete, strError );
+                if ( bOK && buffer.empty() && isComplete )
+                    break;
+                if ( !bOK || buffer.empty() ) {
+                    if ( ++cntFailures > c_maxFragmentRetries ) {
+                        if ( strError.empty() )
+                            strError = "snapshot data stopped arriving";
+                        if ( pStrErrorDescription )
+                            ( *pStrErrorDescription ) = strError;
+                        clog( VerbosityError, "download snapshot" )
+                            << cc::fatal( "FATAL:" ) << " " << cc::error( strError ) << "\n";
+                        f.close();
+                        boost::filesystem::remove( saveTo );
+                        return false;
+                    }
+                    if ( !bOK )
+                        sleep( 1 );
+                    continue;
+                }
+                cntFailures = 0;
+                f.write( ( char* ) buffer.data(), buffer.size() );
+                if ( !f )
+                    throw std::runtime_error( "failed to write snapshot file" );
+                idxFrom += buffer.size();
+                bool bContinue = true;
+                if ( onProgress )
+                    bContinue = onProgress( idxChunk++, 0 );  // count of chunks isn't known yet
+                if ( !bContinue ) {
+                    if ( pStrErrorDescription )
+                        ( *pStrErrorDescription ) = "fragment downloader stopped by callback";
+                    f.close();
+                    boost::filesystem::remove( saveTo );
+                    return false;
+                }
+                if ( isComplete )
+                    break;
+            }
+            f.close();
+            return true;
+        }
         for ( idxChunk = 0; idxChunk < cntChunks; ++idxChunk ) {
             nlohmann::json joIn = nlohmann::json::object();
             joIn["jsonrpc"] = "2.0";
@@ -715,6 +886,8 @@ bool download( const std::string& strURLWeb3, unsigned& block_number, const fs::
                 buffer = skutils::tools::base64::decodeBin( strBase64orBinary );
             }
             f.write( ( char* ) buffer.data(), buffer.size() );
+            if ( !f )
+                throw std::runtime_error( "failed to write snapshot file" );
             bool bContinue = true;
             if ( onProgress )
                 bContinue = onProgress( idxChunk, cntChunks );
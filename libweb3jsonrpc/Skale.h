@@ -33,6 +33,7 @@
 #include <libethereum/Client.h>
 #include <libweb3jsonrpc/SkaleFace.h>
 #include <functional>
+#include <future>
 #include <iosfwd>
 #include <libconsensus/thirdparty/json.hpp>
 #include <list>
@@ -87,12 +88,19 @@ public:
     nlohmann::json impl_skale_getSnapshot(
         const nlohmann::json& joRequest, dev::eth::Client& client );
     std::vector< uint8_t > ll_impl_skale_downloadSnapshotFragment(
-        const fs::path& fp, size_t idxFrom, size_t sizeOfChunk );
+        int fd, size_t idxFrom, size_t sizeOfChunk );
     std::vector< uint8_t > impl_skale_downloadSnapshotFragmentBinary(
         const nlohmann::json& joRequest );
     nlohmann::json impl_skale_downloadSnapshotFragmentJSON( const nlohmann::json& joRequest );
 
 private:
+    // fd of the current snapshot duplicated under m_snapshot_mutex, and the diff completion
+    int openCurrentSnapshot( std::shared_future< void >& o_done );
+    // returns the block of the closed snapshot, whose file is to be removed without the mutex
+    int closeCurrentSnapshot();
+    static size_t waitForSnapshotData(
+        int fd, const std::shared_future< void >& done, size_t idxFrom, bool& isComplete );
+
     static volatile bool g_bShutdownViaWeb3Enabled;
     static volatile bool g_bNodeInstanceShouldShutdown;
     typedef std::list< fn_on_shutdown_t > list_fn_on_shutdown_t;
@@ -101,7 +109,8 @@ private:
     dev::eth::Client& m_client;
     std::shared_ptr< SharedSpace > m_shared_space;
     int currentSnapshotBlockNumber = -1;
-    fs::path currentSnapshotPath;
+    int currentSnapshotFd = -1;  // stays valid when the diff is renamed after completion
+    std::shared_future< void > currentSnapshotDone;
     std::atomic< time_t > currentSnapshotTime = 0;
     std::atomic< time_t > lastSnapshotDownloadFragmentTime = 0;
     std::unique_ptr< std::thread > snapshotDownloadFragmentMonitorThread;
@@ -32,6 +32,8 @@
 #include <libdevcore/Common.h>
 #include <libdevcore/CommonJS.h>
 #include <libdevcore/FileSystem.h>
+#include <libdevcore/LevelDB.h>
+#include <libevm/LegacyVMCodeCache.h>
 
 #include <skutils/console_colors.h>
 #include <skutils/eth_utils.h>
@@ -1097,6 +1099,87 @@ Json::Value SkaleStats::skale_stats() {
 
             joStats["tracepoints"] = joTrace;
 
+            skale::AccountCache::Stats cacheStats = c->state().accountCacheStats();
+            nlohmann::json joCache = nlohmann::json::object();
+            joCache["accountHits"] = cacheStats.accountHits;
+            joCache["accountMisses"] = cacheStats.accountMisses;
+            joCache["accounts"] = cacheStats.accounts;
+            joCache["storageHits"] = cacheStats.storageHits;
+            joCache["storageMisses"] = cacheStats.storageMisses;
+            joCache["storageValues"] = cacheStats.storageValues;
+            joStats["stateCache"] = joCache;
+
+            dev::db::LevelDB::Stats dbStats = dev::db::LevelDB::stats();
+            nlohmann::json joDB = nlohmann::json::object();
+            joDB["openDatabases"] = dbStats.openDatabases;
+            joDB["lookups"] = dbStats.lookups;
+            joDB["missedLookups"] = dbStats.missedLookups;
+            joDB["blockCacheCharge"] = dbStats.blockCacheCharge;
+            joDB["memoryUsage"] = dbStats.memoryUsage;
+            joStats["leveldb"] = joDB;
+
+            Broadcaster::Stats bcStats = h->broadcastStats();
+            nlohmann::json joBroadcast = nlohmann::json::object();
+            joBroadcast["framesSent"] = bcStats.framesSent;
+            joBroadcast["framesReceived"] = bcStats.framesReceived;
+            joBroadcast["framesSentPerSecond"] = bcStats.framesSentPerSecond;
+            joBroadcast["framesReceivedPerSecond"] = bcStats.framesReceivedPerSecond;
+            joBroadcast["transactionsPerFrameSent"] =
+                bcStats.framesSent ? double( bcStats.transactionsSent ) / bcStats.framesSent : 0.0;
+            joBroadcast["transactionsPerFrameReceived"] =
+                bcStats.framesReceived ?
+                    double( bcStats.transactionsReceived ) / bcStats.framesReceived :
+                    0.0;
+            joStats["broadcast"] = joBroadcast;
+
+            dev::eth::TransactionCache::Stats txCacheStats = h->transactionCacheStats();
+            nlohmann::json joTxCache = nlohmann::json::object();
+            joTxCache["hits"] = txCacheStats.hits;
+            joTxCache["misses"] = txCacheStats.misses;
+            joTxCache["evictions"] = txCacheStats.evictions;
+            joTxCache["transactions"] = txCacheStats.size;
+            uint64_t lookups = txCacheStats.hits + txCacheStats.misses;
+            joTxCache["hitRate"] = lookups ? double( txCacheStats.hits ) / lookups : 0.0;
+            joStats["transactionCache"] = joTxCache;
+
+            dev::eth::CallCache::Stats callCacheStats = c->callCacheStats();
+            nlohmann::json joCallCache = nlohmann::json::object();
+            joCallCache["hits"] = callCacheStats.hits;
+            joCallCache["misses"] = callCacheStats.misses;
+            joCallCache["coalesced"] = callCacheStats.coalesced;
+            joCallCache["invalidations"] = callCacheStats.invalidations;
+            joCallCache["results"] = callCacheStats.size;
+            uint64_t calls = callCacheStats.hits + callCacheStats.misses + callCacheStats.coalesced;
+            joCallCache["hitRate"] =
+                calls ? double( callCacheStats.hits + callCacheStats.coalesced ) / calls : 0.0;
+            joStats["callCache"] = joCallCache;
+
+            dev::eth::LegacyVMCodeCache::Stats codeCacheStats =
+                dev::eth::LegacyVMCodeCache::instance().stats();
+            nlohmann::json joCodeCache = nlohmann::json::object();
+            joCodeCache["hits"] = codeCacheStats.hits;
+            joCodeCache["misses"] = codeCacheStats.misses;
+            joCodeCache["evictions"] = codeCacheStats.evictions;
+            joCodeCache["contracts"] = codeCacheStats.size;
+            uint64_t codeLookups = codeCacheStats.hits + codeCacheStats.misses;
+            joCodeCache["hitRate"] =
+                codeLookups ? double( codeCacheStats.hits ) / codeLookups : 0.0;
+            joStats["vmCodeCache"] = joCodeCache;
+
+#ifdef HISTORIC_STATE
+            dev::eth::HistoricTrieNodeCache::Stats trieCacheStats =
+                c->historicTrieNodeCacheStats();
+            nlohmann::json joTrieCache = nlohmann::json::object();
+            joTrieCache["hits"] = trieCacheStats.hits;
+            joTrieCache["misses"] = trieCacheStats.misses;
+            joTrieCache["evictions"] = trieCacheStats.evictions;
+            joTrieCache["nodes"] = trieCacheStats.size;
+            uint64_t trieLookups = trieCacheStats.hits + trieCacheStats.misses;
+            joTrieCache["hitRate"] =
+                trieLookups ? double( trieCacheStats.hits ) / trieLookups : 0.0;
+            joStats["historicTrieNodeCache"] = joTrieCache;
+#endif
+
         }  // if client
 
         std::string strStatsJson = joStats.dump();
@@ -1,7 +1,12 @@
 #include "rapidjson_handlers.h"
 
+#include <libethereum/ClientBase.h>
+
 #define ERROR_RPC_CUSTOM_ERROR ( -32004 )
 
+// page size of skale_getLogs if the request does not set it
+static const size_t c_defaultLogsPageSize = 1000;
+
 using namespace dev::eth;
 
 void wrapJsonRpcException( const rapidjson::Document& /*joRequest*/,
@@ -30,6 +35,45 @@ void wrapJsonRpcException( const rapidjson::Document& /*joRequest*/,
     joResponse.AddMember( "error", joError, joResponse.GetAllocator() );
 }
 
+void writeJsonRpcResponseStart(
+    const rapidjson::Document& joRequest, rapidjson::Writer< rapidjson::StringBuffer >& writer ) {
+    writer.StartObject();
+    writer.Key( "jsonrpc" );
+    writer.String( "2.0" );
+    if ( joRequest.HasMember( "id" ) ) {
+        writer.Key( "id" );
+        joRequest["id"].Accept( writer );
+    }
+}
+
+// replaces whatever was written to buffer with an error response
+void writeJsonRpcException( const rapidjson::Document& joRequest,
+    const jsonrpc::JsonRpcException& exception, rapidjson::StringBuffer& buffer ) {
+    rapidjson::Document joResponse;
+    joResponse.SetObject();
+    joResponse.AddMember( "jsonrpc", "2.0", joResponse.GetAllocator() );
+    if ( joRequest.HasMember( "id" ) ) {
+        rapidjson::Value id;
+        id.CopyFrom( joRequest["id"], joResponse.GetAllocator() );
+        joResponse.AddMember( "id", id, joResponse.GetAllocator() );
+    }
+    wrapJsonRpcException( joRequest, exception, joResponse );
+
+    buffer.Clear();
+    rapidjson::Writer< rapidjson::StringBuffer > writer( buffer );
+    joResponse.Accept( writer );
+}
+
+Json::Value rapidJsonToJson( const rapidjson::Value& jo ) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer< rapidjson::StringBuffer > writer( buffer );
+    jo.Accept( writer );
+    Json::Value ret;
+    if ( !Json::Reader().parse( buffer.GetString(), ret ) )
+        throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+    return ret;
+}
+
 void inject_rapidjson_handlers( SkaleServerOverride::opts_t& serverOpts, dev::rpc::Eth* pEthFace ) {
     SkaleServerOverride::fn_jsonrpc_call_t fn_eth_sendRawTransaction =
         [=]( const rapidjson::Document& joRequest, rapidjson::Document& joResponse ) -> void {
@@ -263,6 +307,125 @@ void inject_rapidjson_handlers( SkaleServerOverride::opts_t& serverOpts, dev::rp
         }
     };
 
+    // writes log entries to the response one by one instead of building all of them first
+    SkaleServerOverride::fn_jsonrpc_stream_call_t fn_eth_getLogs =
+        [=]( const rapidjson::Document& joRequest, rapidjson::StringBuffer& buffer ) -> void {
+        try {
+            if ( !joRequest.HasMember( "params" ) || !joRequest["params"].IsArray() ) {
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+            }
+
+            if ( joRequest["params"].GetArray().Size() != 1 ||
+                 !joRequest["params"].GetArray()[0].IsObject() ) {
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+            }
+
+            Json::Value joFilter = rapidJsonToJson( joRequest["params"].GetArray()[0] );
+
+            rapidjson::Writer< rapidjson::StringBuffer > writer( buffer );
+            writeJsonRpcResponseStart( joRequest, writer );
+            writer.Key( "result" );
+            if ( pEthFace->writeLogs( joFilter, LogCursor(), c_maxLogsPerQuery, writer ) )
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS,
+                    "query returned more than " + std::to_string( c_maxLogsPerQuery ) +
+                        " results" );
+            writer.EndObject();
+        } catch ( const jsonrpc::JsonRpcException& ex ) {
+            writeJsonRpcException( joRequest, ex, buffer );
+        } catch ( const dev::eth::TooManyLogs& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS,
+                    "query returned more than " + std::to_string( c_maxLogsPerQuery ) +
+                        " results" ),
+                buffer );
+        } catch ( const std::invalid_argument& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS ), buffer );
+        } catch ( const dev::Exception& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException(
+                    ERROR_RPC_CUSTOM_ERROR, dev::rpc::exceptionToErrorMessage() ),
+                buffer );
+        }
+    };
+
+    // params are the filter and optional { "limit", "cursor" }, result is
+    // { "logs": [ ... ], "cursor": token to pass for the next page or null }
+    SkaleServerOverride::fn_jsonrpc_stream_call_t fn_skale_getLogs =
+        [=]( const rapidjson::Document& joRequest, rapidjson::StringBuffer& buffer ) -> void {
+        try {
+            if ( !joRequest.HasMember( "params" ) || !joRequest["params"].IsArray() ) {
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+            }
+
+            auto paramsArray = joRequest["params"].GetArray();
+
+            if ( paramsArray.Size() < 1 || paramsArray.Size() > 2 || !paramsArray[0].IsObject() ) {
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+            }
+
+            size_t limit = c_defaultLogsPageSize;
+            LogCursor from;
+            if ( paramsArray.Size() == 2 ) {
+                if ( !paramsArray[1].IsObject() )
+                    throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+                const rapidjson::Value& joOptions = paramsArray[1];
+                if ( joOptions.HasMember( "limit" ) ) {
+                    if ( joOptions["limit"].IsUint64() )
+                        limit = joOptions["limit"].GetUint64();
+                    else if ( joOptions["limit"].IsString() )
+                        limit = dev::jsToInt( joOptions["limit"].GetString() );
+                    else
+                        throw jsonrpc::JsonRpcException(
+                            jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+                }
+                if ( joOptions.HasMember( "cursor" ) && !joOptions["cursor"].IsNull() ) {
+                    if ( !joOptions["cursor"].IsString() )
+                        throw jsonrpc::JsonRpcException(
+                            jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+                    from = jsToLogCursor( joOptions["cursor"].GetString() );
+                }
+            }
+            if ( limit == 0 )
+                throw jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS );
+            if ( c_maxLogsPerQuery )
+                limit = std::min( limit, c_maxLogsPerQuery );
+
+            Json::Value joFilter = rapidJsonToJson( paramsArray[0] );
+
+            rapidjson::Writer< rapidjson::StringBuffer > writer( buffer );
+            writeJsonRpcResponseStart( joRequest, writer );
+            writer.Key( "result" );
+            writer.StartObject();
+            writer.Key( "logs" );
+            std::optional< LogCursor > next = pEthFace->writeLogs( joFilter, from, limit, writer );
+            writer.Key( "cursor" );
+            if ( next ) {
+                std::string strCursor = toJS( *next );
+                writer.String( strCursor.c_str(), strCursor.size() );
+            } else
+                writer.Null();
+            writer.EndObject();
+            writer.EndObject();
+        } catch ( const jsonrpc::JsonRpcException& ex ) {
+            writeJsonRpcException( joRequest, ex, buffer );
+        } catch ( const dev::eth::TooManyLogs& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS,
+                    "query returned more than " + std::to_string( c_maxLogsPerQuery ) +
+                        " results" ),
+                buffer );
+        } catch ( const std::invalid_argument& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException( jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS ), buffer );
+        } catch ( const dev::Exception& ) {
+            writeJsonRpcException( joRequest,
+                jsonrpc::JsonRpcException(
+                    ERROR_RPC_CUSTOM_ERROR, dev::rpc::exceptionToErrorMessage() ),
+                buffer );
+        }
+    };
+
     serverOpts.fn_eth_sendRawTransaction_ = fn_eth_sendRawTransaction;
     serverOpts.fn_eth_getTransactionReceipt_ = fn_eth_getTransactionReceipt;
     serverOpts.fn_eth_call_ = fn_eth_call;
@@ -270,4 +433,6 @@ void inject_rapidjson_handlers( SkaleServerOverride::opts_t& serverOpts, dev::rp
     serverOpts.fn_eth_getStorageAt_ = fn_eth_getStorageAt;
     serverOpts.fn_eth_getTransactionCount_ = fn_eth_getTransactionCount;
     serverOpts.fn_eth_getCode_ = fn_eth_getCode;
+    serverOpts.fn_eth_getLogs_ = fn_eth_getLogs;
+    serverOpts.fn_skale_getLogs_ = fn_skale_getLogs;
 }
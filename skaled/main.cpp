@@ -43,6 +43,7 @@
 
 #include <json_spirit/JsonSpiritHeaders.h>
 
+#include <libdevcore/DBFactory.h>
 #include <libdevcore/FileSystem.h>
 #include <libdevcore/LevelDB.h>
 #include <libdevcore/LoggingProgramOptions.h>
@@ -54,10 +55,14 @@
 #include <libethereum/ClientTest.h>
 #include <libethereum/Defaults.h>
 #include <libethereum/SnapshotStorage.h>
+#include <libevm/LegacyVMCodeCache.h>
 #include <libevm/VMFactory.h>
+#include <libhistoric/HistoricStateView.h>
 
 #include <libskale/ConsensusGasPricer.h>
+#include <libskale/IncrementalSnapshotHashPatch.h>
 #include <libskale/UnsafeRegion.h>
+#include <libskale/broadcaster.h>
 
 #include <libdevcrypto/LibSnark.h>
 
@@ -116,6 +121,18 @@ namespace fs = boost::filesystem;
 namespace dev {
 namespace db {
 extern unsigned c_maxOpenLeveldbFiles;
+extern bool c_maintainIncrementalHash;
+}
+}  // namespace dev
+
+namespace skale {
+extern bool c_blockScopedStateCommit;
+extern size_t c_stateCacheSize;
+}
+
+namespace dev {
+namespace eth {
+extern unsigned c_parallelExecutionThreads;
 }
 }  // namespace dev
 
@@ -253,6 +270,8 @@ void downloadSnapshot( unsigned block_number, std::shared_ptr< SnapshotManager >
             << cc::normal( "Will download snapshot from " ) << cc::u( strURLWeb3 ) << std::endl;
         ;
 
+        // the diff is fetched with the streaming protocol while the server is still making it,
+        // fragments are read with pread() there until it reports isComplete
         try {
             bool isBinaryDownload = true;
             std::string strErrorDescription;
@@ -262,7 +281,8 @@ void downloadSnapshot( unsigned block_number, std::shared_ptr< SnapshotManager >
                 [&]( size_t idxChunck, size_t cntChunks ) -> bool {
                     clog( VerbosityInfo, "downloadSnapshot" )
                         << cc::normal( "... download progress ... " ) << cc::size10( idxChunck )
-                        << cc::normal( " of " ) << cc::size10( cntChunks ) << "\r";
+                        << cc::normal( " of " )
+                        << ( cntChunks ? cc::size10( cntChunks ) : cc::normal( "?" ) ) << "\r";
                     return true;  // continue download
                 },
                 isBinaryDownload, &strErrorDescription );
@@ -311,6 +331,16 @@ void downloadSnapshot( unsigned block_number, std::shared_ptr< SnapshotManager >
         }
         //// HACK END ////
 
+        // databases of another backend would be read as empty or corrupt after restore
+        fs::path const snapshotChainDir = getDataDir() / "snapshots" / to_string( block_number ) /
+                                          BlockChain::getChainDirName( chainParams );
+        std::string const snapshotKind = dev::db::writtenDatabaseKindName( snapshotChainDir );
+        if ( snapshotKind != dev::db::databaseKindName( dev::db::databaseKind() ) ) {
+            snapshotManager->cleanup();
+            throw std::runtime_error( "Downloaded snapshot was written by " + snapshotKind +
+                                      " database backend" );
+        }
+
         snapshotManager->restoreSnapshot( block_number );
         std::cout << cc::success( "Snapshot restore success for block " )
                   << cc::u( to_string( block_number ) ) << std::endl;
@@ -1395,6 +1425,160 @@ int main( int argc, char** argv ) try {
         } catch ( ... ) {
         }
 
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "leveldbBlockCacheSize" ) )
+                dev::db::c_leveldbBlockCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["leveldbBlockCacheSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "leveldbTuning" ) ) {
+                const nlohmann::json& joTuning =
+                    joConfig["skaleConfig"]["nodeInfo"]["leveldbTuning"];
+                const std::pair< const char*, dev::db::LevelDBKind > kinds[] = {
+                    { "state", dev::db::LevelDBKind::State },
+                    { "blocks", dev::db::LevelDBKind::Blocks },
+                    { "historic", dev::db::LevelDBKind::Historic } };
+                for ( const auto& kind : kinds ) {
+                    if ( !joTuning.count( kind.first ) )
+                        continue;
+                    const nlohmann::json& joKind = joTuning[kind.first];
+                    dev::db::LevelDBTuning& tuning = dev::db::c_leveldbTuning[kind.second];
+                    if ( joKind.count( "bloomBitsPerKey" ) )
+                        tuning.bloomBitsPerKey = joKind["bloomBitsPerKey"].get< int >();
+                    if ( joKind.count( "writeBufferSize" ) )
+                        tuning.writeBufferSize = joKind["writeBufferSize"].get< size_t >();
+                    if ( joKind.count( "compression" ) )
+                        tuning.compression = joKind["compression"].get< bool >();
+                }
+            }
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "broadcastBatchSize" ) )
+                c_broadcastBatchSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["broadcastBatchSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "broadcastBatchTimeUs" ) )
+                c_broadcastBatchTimeUs =
+                    joConfig["skaleConfig"]["nodeInfo"]["broadcastBatchTimeUs"].get< unsigned >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "transactionVerifierThreads" ) )
+                dev::eth::c_transactionVerifierThreads =
+                    joConfig["skaleConfig"]["nodeInfo"]["transactionVerifierThreads"]
+                        .get< unsigned >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "transactionQueueShards" ) )
+                dev::eth::c_transactionQueueShards =
+                    joConfig["skaleConfig"]["nodeInfo"]["transactionQueueShards"].get< unsigned >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "transactionCacheSize" ) )
+                dev::eth::c_transactionCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["transactionCacheSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        std::string strDbBackend;
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "dbBackend" ) )
+                strDbBackend =
+                    joConfig["skaleConfig"]["nodeInfo"]["dbBackend"].get< std::string >();
+        } catch ( ... ) {
+        }
+        // an unknown or not compiled in backend must not silently fall back to LevelDB
+        if ( !strDbBackend.empty() )
+            dev::db::setDatabaseKindByName( strDbBackend );
+
+        // kept up to date in advance, snapshots switch to it at the patch timestamp
+        dev::db::c_maintainIncrementalHash =
+            IncrementalSnapshotHashPatch::isScheduled( chainParams );
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "blockScopedStateCommit" ) )
+                skale::c_blockScopedStateCommit =
+                    joConfig["skaleConfig"]["nodeInfo"]["blockScopedStateCommit"].get< bool >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "pipelinedBlockImport" ) )
+                dev::eth::c_pipelinedBlockImport =
+                    joConfig["skaleConfig"]["nodeInfo"]["pipelinedBlockImport"].get< bool >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "asyncFilterNotifications" ) )
+                dev::eth::c_asyncFilterNotifications =
+                    joConfig["skaleConfig"]["nodeInfo"]["asyncFilterNotifications"].get< bool >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "logIndex" ) )
+                dev::eth::c_logIndex =
+                    joConfig["skaleConfig"]["nodeInfo"]["logIndex"].get< bool >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "maxLogsPerQuery" ) )
+                dev::eth::c_maxLogsPerQuery =
+                    joConfig["skaleConfig"]["nodeInfo"]["maxLogsPerQuery"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "callCacheSize" ) )
+                dev::eth::c_callCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["callCacheSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "vmCodeCacheSize" ) )
+                dev::eth::c_legacyVMCodeCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["vmCodeCacheSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "historicTrieNodeCacheSize" ) )
+                dev::eth::c_historicTrieNodeCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["historicTrieNodeCacheSize"]
+                        .get< size_t >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "parallelExecutionThreads" ) )
+                dev::eth::c_parallelExecutionThreads =
+                    joConfig["skaleConfig"]["nodeInfo"]["parallelExecutionThreads"]
+                        .get< unsigned >();
+        } catch ( ... ) {
+        }
+
+        try {
+            if ( joConfig["skaleConfig"]["nodeInfo"].count( "stateCacheSize" ) )
+                skale::c_stateCacheSize =
+                    joConfig["skaleConfig"]["nodeInfo"]["stateCacheSize"].get< size_t >();
+        } catch ( ... ) {
+        }
+
         if ( vm.count( "log-value-size-limit" ) ) {
             int n = vm["log-value-size-limit"].as< size_t >();
             cc::_max_value_size_ = ( n > 0 ) ? n : std::string::npos;
@@ -1525,6 +1709,19 @@ int main( int argc, char** argv ) try {
                 "blocks_" + chainParams.nodeInfo.id.str() + ".db"/*,
                 mostRecentBlocksDBPath.string()*/ },
             sharedSpace ? sharedSpace->getPath() : "" ) );
+
+        size_t snapshotHashingThreads = 0;
+        if ( chainConfigParsed ) {
+            try {
+                if ( joConfig["skaleConfig"]["nodeInfo"].count( "snapshotHashingThreads" ) )
+                    snapshotHashingThreads =
+                        joConfig["skaleConfig"]["nodeInfo"]["snapshotHashingThreads"]
+                            .get< size_t >();
+            } catch ( ... ) {
+            }
+        }
+        if ( snapshotHashingThreads > 0 )
+            snapshotManager->setHashingThreads( snapshotHashingThreads );
     }
 
     if ( chainParams.nodeInfo.syncNode && !chainParams.nodeInfo.syncFromCatchup ) {
@@ -1676,7 +1873,11 @@ int main( int argc, char** argv ) try {
                             blockNumber, snapshotManager, urlToDownloadSnapshot, chainParams );
 
                         try {
-                            snapshotManager->computeSnapshotHash( blockNumber, true );
+                            bool incrementalHash = IncrementalSnapshotHashPatch::isEnabledWhen(
+                                chainParams,
+                                snapshotManager->getBlockTimestamp( blockNumber, chainParams ) );
+                            snapshotManager->computeSnapshotHash(
+                                blockNumber, true, incrementalHash );
                         } catch ( const std::exception& ) {
                             std::throw_with_nested( std::runtime_error(
                                 cc::fatal( "FATAL:" ) + " " +
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -10,9 +11,14 @@ using namespace std;
 
 #include <libdevcore/Address.h>
 #include <libdevcore/FileSystem.h>
+#include <libdevcore/LevelDB.h>
+#include <libdevcore/TransientDirectory.h>
 
+#include <libskale/SnapshotManager.h>
 #include <libskale/State.h>
 
+#include <skutils/thread_pool.h>
+
 using namespace skale;
 using namespace dev;
 
@@ -181,9 +187,57 @@ void testState() {
          << " Mreads per second" << endl;
 }
 
-int main() {
+// hash 6 DBs (state and 5 blocks_and_extras pieces) like SnapshotManager::computeAllVolumesHash
+void testSnapshotHashing() {
+    const size_t volumes = 6;
+
+    for ( size_t entries : { 10000, 100000, 1000000 } ) {
+        TransientDirectory dir;
+        std::vector< fs::path > paths;
+        srand( 13 );
+        for ( size_t v = 0; v < volumes; ++v ) {
+            paths.push_back( fs::path( dir.path() ) / to_string( v ) );
+            dev::db::LevelDB db( paths.back() );
+            for ( size_t i = 0; i < entries; i += 1000 ) {
+                auto batch = db.createWriteBatch();
+                for ( size_t j = i; j < min( entries, i + 1000 ); ++j ) {
+                    string value( 64, ' ' );
+                    for ( auto& c : value )
+                        c = rand();
+                    batch->insert( dev::db::Slice( h256( j ).hex() ), dev::db::Slice( value ) );
+                }
+                db.commit( move( batch ) );
+            }
+        }
+
+        cout << "Snapshot hashing of " << volumes << " DBs x " << entries << " entries:" << endl;
+        for ( size_t threads : { 1, 2, 4, 8 } ) {
+            skutils::thread_pool pool( threads );
+
+            auto start = chrono::steady_clock::now();
+            vector< future< h256 > > hashes;
+            for ( auto const& path : paths )
+                hashes.push_back( pool.submit(
+                    [path]() { return SnapshotManager::computeDatabaseHash( path ); } ) );
+            h256 combined;
+            for ( auto& hash : hashes )
+                combined ^= hash.get();
+            auto finish = chrono::steady_clock::now();
+
+            cout << "  " << threads << " threads: "
+                 << chrono::duration_cast< chrono::milliseconds >( finish - start ).count()
+                 << " ms, hash " << combined.abridged() << endl;
+        }
+        cout << endl;
+    }
+}
+
+int main( int argc, char** argv ) {
     //    debug();
     testState();
+    // writes up to 6M entries, run only on request
+    if ( argc > 1 && string( argv[1] ) == "--snapshot-hashing" )
+        testSnapshotHashing();
     return 0;
 
     //    State state = State(0);
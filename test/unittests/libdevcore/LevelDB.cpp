@@ -1,9 +1,16 @@
+#include <libbatched-io/batched_db.h>
 #include <libdevcore/Common.h>
 #include <libdevcore/CommonIO.h>
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/LevelDB.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/ManuallyRotatingLevelDB.h>
+#if SKALED_ROCKSDB
+#include <libdevcore/RocksDB.h>
+#endif
 #include <libdevcore/SplitDB.h>
 #include <libdevcore/TransientDirectory.h>
+#include <libethcore/Exceptions.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
 
@@ -109,6 +116,293 @@ BOOST_AUTO_TEST_CASE( split_test ) {
     BOOST_REQUIRE( db2->hashBase() != h2 );
 }
 
+BOOST_AUTO_TEST_CASE( range_test ) {
+    TransientDirectory td;
+    auto p_leveldb = std::make_shared< db::LevelDB >( td.path() );
+    db::SplitDB splitdb( p_leveldb );
+    db::DatabaseFace* db1 = splitdb.newInterface();
+    db::DatabaseFace* db2 = splitdb.newInterface();
+
+    for ( db::DatabaseFace* db : { db1, db2 } ) {
+        db->insert( string( "a" ), string( "1" ) );
+        db->insert( string( "ab" ), string( "2" ) );
+        db->insert( string( "ab\xff" ), string( "3" ) );
+        db->insert( string( "ac" ), string( "4" ) );
+        db->insert( string( "b" ), string( "5" ) );
+    }
+
+    auto collect = []( db::DatabaseFace* _db, string const& _begin, string const& _end,
+                       size_t _limit = 100 ) {
+        string values;
+        _db->forEachInRange( _begin, _end, [&]( db::Slice, db::Slice _value ) -> bool {
+            values += _value.toString();
+            return values.size() < _limit;
+        } );
+        return values;
+    };
+
+    BOOST_REQUIRE_EQUAL( collect( db1, "ab", "b" ), "234" );
+    BOOST_REQUIRE_EQUAL( collect( db2, "", "" ), "12345" );
+    BOOST_REQUIRE_EQUAL( collect( db2, "ab", "" ), "2345" );
+    BOOST_REQUIRE_EQUAL( collect( db2, "", "ab", 1 ), "1" );
+    BOOST_REQUIRE_EQUAL( collect( db1, "c", "" ), "" );
+
+    string values;
+    db2->forEachWithPrefix( string( "ab" ), [&]( db::Slice _key, db::Slice _value ) -> bool {
+        BOOST_REQUIRE_EQUAL( _key.toString().substr( 0, 2 ), "ab" );
+        values += _value.toString();
+        return true;
+    } );
+    BOOST_REQUIRE_EQUAL( values, "23" );
+
+    BOOST_REQUIRE_EQUAL( db::prefixUpperBound( string( "a\xff\xff" ) ), "b" );
+    BOOST_REQUIRE( db::prefixUpperBound( string( "\xff" ) ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( async_commit_test ) {
+    TransientDirectory td;
+    auto p_leveldb = std::make_shared< db::LevelDB >( td.path() );
+    auto bdb = std::make_shared< batched_io::batched_db >();
+    bdb->open( p_leveldb, true );
+    batched_io::db_splitter splitter( bdb );
+    batched_io::db_operations_face* db1 = splitter.new_interface();
+
+    db1->insert( string( "a" ), string( "1" ) );
+    db1->insert( string( "b" ), string( "2" ) );
+    bdb->commit();
+
+    db1->insert( string( "a" ), string( "3" ) );
+    db1->kill( string( "b" ) );
+    db1->insert( string( "c" ), string() );
+    // not committed yet
+    BOOST_REQUIRE_EQUAL( db1->lookup( string( "a" ) ), "1" );
+
+    bdb->commit_async();
+    // visible while being written
+    BOOST_REQUIRE_EQUAL( db1->lookup( string( "a" ) ), "3" );
+    BOOST_REQUIRE( !db1->exists( string( "b" ) ) );
+    BOOST_REQUIRE( db1->exists( string( "c" ) ) );
+
+    bdb->wait_committed();
+    BOOST_REQUIRE_EQUAL( db1->lookup( string( "a" ) ), "3" );
+    BOOST_REQUIRE( !db1->exists( string( "b" ) ) );
+    BOOST_REQUIRE( db1->exists( string( "c" ) ) );
+
+    // iteration sees everything committed
+    db1->insert( string( "d" ), string( "4" ) );
+    bdb->commit_async();
+    string values;
+    db1->forEach( [&]( db::Slice, db::Slice _value ) -> bool {
+        values += _value.toString();
+        return true;
+    } );
+    BOOST_REQUIRE_EQUAL( values, "34" );
+}
+
+BOOST_AUTO_TEST_CASE( tuned_db_test ) {
+    TransientDirectory td;
+    db::LevelDB::Stats before = db::LevelDB::stats();
+    {
+        db::LevelDB db( td.path(), db::LevelDBKind::State );
+        for ( int i = 0; i < 1000; ++i )
+            db.insert( to_string( i ), to_string( i * i ) );
+
+        BOOST_REQUIRE_EQUAL( db.lookup( string( "12" ) ), string( "144" ) );
+        BOOST_REQUIRE( db.lookup( string( "absent" ) ).empty() );
+        BOOST_REQUIRE( !db.exists( string( "1000" ) ) );
+        BOOST_REQUIRE( !db.property( "leveldb.stats" ).empty() );
+
+        db::LevelDB::Stats after = db::LevelDB::stats();
+        BOOST_REQUIRE_EQUAL( after.openDatabases, before.openDatabases + 1 );
+        BOOST_REQUIRE_EQUAL( after.lookups, before.lookups + 3 );
+        BOOST_REQUIRE_EQUAL( after.missedLookups, before.missedLookups + 2 );
+    }
+    BOOST_REQUIRE_EQUAL( db::LevelDB::stats().openDatabases, before.openDatabases );
+
+    // tables written with bloom filters stay readable without them
+    db::LevelDBTuning const saved = db::c_leveldbTuning[db::LevelDBKind::Historic];
+    db::c_leveldbTuning[db::LevelDBKind::Historic].bloomBitsPerKey = 0;
+    db::LevelDB db( td.path(), db::LevelDBKind::Historic );
+    db::c_leveldbTuning[db::LevelDBKind::Historic] = saved;
+    BOOST_REQUIRE_EQUAL( db.lookup( string( "999" ) ), to_string( 999 * 999 ) );
+}
+
+BOOST_AUTO_TEST_CASE( database_kind_test ) {
+    TransientDirectory td;
+    boost::filesystem::path const fresh = boost::filesystem::path( td.path() ) / "fresh";
+    boost::filesystem::path const legacy = boost::filesystem::path( td.path() ) / "legacy";
+
+    BOOST_REQUIRE( db::writtenDatabaseKindName( fresh ).empty() );
+    db::checkDatabaseKind( fresh );
+    BOOST_REQUIRE_EQUAL( db::writtenDatabaseKindName( fresh ), "leveldb" );
+
+    // data written before the marker was introduced
+    boost::filesystem::create_directories( legacy / "blocks_and_extras" );
+    BOOST_REQUIRE_EQUAL( db::writtenDatabaseKindName( legacy ), "leveldb" );
+    db::checkDatabaseKind( legacy );
+    BOOST_REQUIRE( boost::filesystem::exists( legacy / db::c_databaseKindFileName ) );
+
+    writeFile( fresh / db::c_databaseKindFileName, asBytes( "rocksdb" ) );
+    BOOST_REQUIRE_THROW( db::checkDatabaseKind( fresh ), eth::InvalidDatabaseKind );
+}
+
+#if SKALED_ROCKSDB
+BOOST_AUTO_TEST_CASE( rocksdb_hash_test ) {
+    TransientDirectory tdl, tdr;
+    db::LevelDB ldb( tdl.path(), db::LevelDBKind::Blocks );
+    h256 hashWithPrefix[2];
+    {
+        db::RocksDB rdb( tdr.path(), db::LevelDBKind::Blocks, db::RocksDB::c_blocksPrefixFamilies );
+        for ( db::DatabaseFace* db : std::vector< db::DatabaseFace* >{ &ldb, &rdb } ) {
+            db->insert( string( "" ), string( "empty" ) );
+            db->insert( string( "plain" ), string( "v" ) );
+            for ( char prefix = 0; prefix < 3; ++prefix ) {
+                auto batch = db->createWriteBatch();
+                for ( int i = 0; i < 10; ++i )
+                    batch->insert( string( 1, prefix ) + to_string( i ), to_string( i * i ) );
+                db->commit( std::move( batch ) );
+            }
+            db->kill( string( 1, 0 ) + "5" );
+        }
+
+        BOOST_REQUIRE_EQUAL( rdb.lookup( string( 1, 1 ) + "3" ), string( "9" ) );
+        BOOST_REQUIRE( !rdb.exists( string( 1, 0 ) + "5" ) );
+        BOOST_REQUIRE_EQUAL( rdb.hashBase(), ldb.hashBase() );
+        for ( int prefix = 0; prefix < 2; ++prefix ) {
+            hashWithPrefix[prefix] = rdb.hashBaseWithPrefix( prefix );
+            BOOST_REQUIRE_EQUAL( hashWithPrefix[prefix], ldb.hashBaseWithPrefix( prefix ) );
+        }
+    }
+
+    // prefix families are found on disk when reopened
+    db::RocksDB rdb( tdr.path() );
+    BOOST_REQUIRE_EQUAL( rdb.hashBaseWithPrefix( 1 ), hashWithPrefix[1] );
+    BOOST_REQUIRE_EQUAL( rdb.hashBase(), ldb.hashBase() );
+}
+#endif
+
+BOOST_AUTO_TEST_CASE( incremental_hash_test ) {
+    struct IncrementalHashScope {
+        IncrementalHashScope() { db::c_maintainIncrementalHash = true; }
+        ~IncrementalHashScope() { db::c_maintainIncrementalHash = false; }
+    } scope;
+
+    TransientDirectory td1, td2, td3;
+    h256 hash1;
+    {
+        db::LevelDB db1( td1.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+        db1.insert( string( "a" ), string( "va" ) );
+        db1.insert( string( "b" ), string( "vb" ) );
+        db1.insert( string( "c" ), string( "vc" ) );
+        hash1 = db1.incrementalHash();
+
+        db1.insert( string( "b" ), string( "vb_new" ) );
+        BOOST_REQUIRE( db1.incrementalHash() != hash1 );
+        db1.insert( string( "b" ), string( "vb" ) );
+        BOOST_REQUIRE_EQUAL( db1.incrementalHash(), hash1 );
+
+        // persisted hash is hidden from iteration
+        int cnt = 0;
+        db1.forEach( [&cnt]( db::Slice, db::Slice ) -> bool {
+            ++cnt;
+            return true;
+        } );
+        BOOST_REQUIRE_EQUAL( cnt, 3 );
+    }
+
+    {
+        // same content written in other order and with overwrites
+        db::LevelDB db2( td2.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+        std::unique_ptr< db::WriteBatchFace > b = db2.createWriteBatch();
+        b->insert( db::Slice( "c" ), db::Slice( "vc" ) );
+        b->insert( db::Slice( "d" ), db::Slice( "vd" ) );
+        b->insert( db::Slice( "b" ), db::Slice( "vb_old" ) );
+        b->insert( db::Slice( "b" ), db::Slice( "vb" ) );
+        db2.commit( std::move( b ) );
+        db2.insert( string( "a" ), string( "va" ) );
+        db2.kill( string( "d" ) );
+        BOOST_REQUIRE_EQUAL( db2.incrementalHash(), hash1 );
+    }
+
+    // reopened DB loads the persisted hash
+    {
+        db::LevelDB reopened( td1.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+        BOOST_REQUIRE_EQUAL( reopened.incrementalHash(), hash1 );
+    }
+
+    // DB opened only to hash it, like a snapshot copy, reads the persisted hash
+    db::LevelDB reopened( td1.path() );
+    BOOST_REQUIRE_EQUAL( reopened.incrementalHash(), hash1 );
+
+    // without maintenance the same hash is computed by a full scan, and hashBase() ignores
+    // the persisted one
+    db::c_maintainIncrementalHash = false;
+    db::LevelDB legacy( td3.path() );
+    legacy.insert( string( "a" ), string( "va" ) );
+    legacy.insert( string( "b" ), string( "vb" ) );
+    legacy.insert( string( "c" ), string( "vc" ) );
+    BOOST_REQUIRE_EQUAL( legacy.incrementalHash(), hash1 );
+    BOOST_REQUIRE_EQUAL( legacy.hashBase(), reopened.hashBase() );
+}
+
+BOOST_AUTO_TEST_CASE( incremental_hash_not_owned_test ) {
+    TransientDirectory td;
+    h256 hash;
+    {
+        db::LevelDB db( td.path() );
+        db.insert( string( "a" ), string( "va" ) );
+        hash = db.incrementalHash();
+    }
+
+    {
+        struct IncrementalHashScope {
+            IncrementalHashScope() { db::c_maintainIncrementalHash = true; }
+            ~IncrementalHashScope() { db::c_maintainIncrementalHash = false; }
+        } scope;
+
+        {
+            // DBs skaled doesn't own are never written to, even when hashing is on
+            db::LevelDB db( td.path() );
+            BOOST_REQUIRE( db.lookup( string( db::LevelDB::c_incrementalHashKey ) ).empty() );
+            db.insert( string( "b" ), string( "vb" ) );
+            BOOST_REQUIRE( db.lookup( string( db::LevelDB::c_incrementalHashKey ) ).empty() );
+            BOOST_REQUIRE( db.incrementalHash() != hash );
+        }
+
+        db::LevelDB owned( td.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+        BOOST_REQUIRE( !owned.lookup( string( db::LevelDB::c_incrementalHashKey ) ).empty() );
+    }
+
+    // owner drops the hash when maintenance is off, so it can't go stale
+    db::LevelDB db( td.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+    BOOST_REQUIRE( db.lookup( string( db::LevelDB::c_incrementalHashKey ) ).empty() );
+}
+
+BOOST_AUTO_TEST_CASE( incremental_hash_verified_test ) {
+    struct IncrementalHashScope {
+        IncrementalHashScope() { db::c_maintainIncrementalHash = true; }
+        ~IncrementalHashScope() { db::c_maintainIncrementalHash = false; }
+    } scope;
+
+    TransientDirectory td;
+    h256 hash;
+    {
+        db::LevelDB owned( td.path(), db::LevelDBKind::Default, db::IncrementalHash::Owned );
+        owned.insert( string( "a" ), string( "va" ) );
+        owned.insert( string( "b" ), string( "vb" ) );
+        hash = owned.incrementalHash();
+    }
+
+    // DB from someone else, like a downloaded snapshot
+    db::LevelDB copy( td.path() );
+    BOOST_REQUIRE_EQUAL( copy.verifiedIncrementalHash(), hash );
+
+    // entries changed without updating the persisted hash
+    copy.insert( string( "b" ), string( "forged" ) );
+    BOOST_REQUIRE_EQUAL( copy.incrementalHash(), hash );
+    BOOST_REQUIRE_THROW( copy.verifiedIncrementalHash(), db::DatabaseError );
+}
+
 BOOST_AUTO_TEST_CASE( rotation_test ) {
     TransientDirectory td;
     const int nPieces = 5;
@@ -0,0 +1,168 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file CallCache.cpp
+ * @date 2026
+ */
+
+#include <libethereum/CallCache.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace {
+
+/// Pretends to be a call reading _accounts and _slots, counts executions
+CallCache::Execute reading( atomic< unsigned >& _executions, vector< Address > const& _accounts,
+    vector< pair< Address, u256 > > const& _slots = {}, bool _external = false ) {
+    return [&_executions, _accounts, _slots, _external](
+               shared_ptr< skale::StateAccessLog > const& _readLog ) {
+        ++_executions;
+        if ( _readLog ) {
+            _readLog->accounts.insert( _accounts.begin(), _accounts.end() );
+            _readLog->storage.insert( _slots.begin(), _slots.end() );
+            _readLog->external = _external;
+        }
+        ExecutionResult ret;
+        ret.output = bytes{ byte( _executions.load() ) };
+        return ret;
+    };
+}
+
+skale::StateAccessLog written(
+    vector< Address > const& _accounts, vector< pair< Address, u256 > > const& _slots = {} ) {
+    skale::StateAccessLog ret;
+    ret.accounts.insert( _accounts.begin(), _accounts.end() );
+    ret.storage.insert( _slots.begin(), _slots.end() );
+    return ret;
+}
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE( CallCacheSuite, TestOutputHelperFixture )
+
+BOOST_AUTO_TEST_CASE( invalidation ) {
+    Address a1( 1 ), a2( 2 ), contract( 3 );
+    h256 k1( 1 ), k2( 2 ), k3( 3 );
+    atomic< unsigned > executions{ 0 };
+
+    CallCache cache( 16 );
+    cache.get( k1, true, reading( executions, { a1 } ) );
+    cache.get( k2, true, reading( executions, { contract }, { { contract, 7 } } ) );
+    cache.get( k3, true, reading( executions, {}, {}, true ) );
+    BOOST_REQUIRE_EQUAL( executions, 3 );
+
+    // all are cached
+    cache.get( k1, true, reading( executions, { a1 } ) );
+    cache.get( k2, true, reading( executions, { contract }, { { contract, 7 } } ) );
+    cache.get( k3, true, reading( executions, {}, {}, true ) );
+    BOOST_REQUIRE_EQUAL( executions, 3 );
+    BOOST_REQUIRE_EQUAL( cache.stats().hits, 3 );
+
+    // other account and other slot - only the result reading block info is dropped
+    cache.noteCommitted( written( { a2 }, { { contract, 8 } } ) );
+    BOOST_REQUIRE_EQUAL( cache.stats().size, 2 );
+    cache.get( k1, true, reading( executions, { a1 } ) );
+    cache.get( k2, true, reading( executions, { contract }, { { contract, 7 } } ) );
+    BOOST_REQUIRE_EQUAL( executions, 3 );
+
+    cache.noteCommitted( written( {}, { { contract, 7 } } ) );
+    cache.get( k2, true, reading( executions, { contract }, { { contract, 7 } } ) );
+    BOOST_REQUIRE_EQUAL( executions, 4 );
+
+    cache.noteCommitted( written( { a1 } ) );
+    cache.get( k1, true, reading( executions, { a1 } ) );
+    BOOST_REQUIRE_EQUAL( executions, 5 );
+    BOOST_REQUIRE_EQUAL( cache.stats().invalidations, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( historic ) {
+    Address a1( 1 );
+    atomic< unsigned > executions{ 0 };
+
+    CallCache cache( 16 );
+    cache.get( h256( 1 ), false, reading( executions, { a1 }, {}, true ) );
+    cache.noteCommitted( written( { a1 } ) );
+    cache.get( h256( 1 ), false, reading( executions, { a1 }, {}, true ) );
+    BOOST_REQUIRE_EQUAL( executions, 1 );
+}
+
+BOOST_AUTO_TEST_CASE( eviction ) {
+    Address a1( 1 );
+    atomic< unsigned > executions{ 0 };
+
+    CallCache cache( 2 );
+    for ( unsigned i = 0; i < 3; ++i )
+        cache.get( h256( i ), true, reading( executions, { a1 } ) );
+    BOOST_REQUIRE_EQUAL( cache.stats().size, 2 );
+
+    // the oldest one is evicted and unindexed
+    cache.noteCommitted( written( { a1 } ) );
+    BOOST_REQUIRE_EQUAL( cache.stats().size, 0 );
+    BOOST_REQUIRE_EQUAL( cache.stats().invalidations, 2 );
+}
+
+BOOST_AUTO_TEST_CASE( coalescing ) {
+    atomic< unsigned > executions{ 0 };
+    atomic< bool > started{ false }, release{ false };
+    auto slow = [&]( shared_ptr< skale::StateAccessLog > const& ) {
+        ++executions;
+        started = true;
+        while ( !release )
+            this_thread::yield();
+        ExecutionResult ret;
+        ret.output = bytes{ 42 };
+        return ret;
+    };
+
+    CallCache cache( 16 );
+    ExecutionResult first, second;
+    thread t1( [&]() { first = cache.get( h256( 1 ), true, slow ); } );
+    while ( !started )
+        this_thread::yield();
+    thread t2( [&]() { second = cache.get( h256( 1 ), true, slow ); } );
+    while ( cache.stats().coalesced == 0 )
+        this_thread::yield();
+    release = true;
+    t1.join();
+    t2.join();
+
+    BOOST_REQUIRE_EQUAL( executions, 1 );
+    BOOST_REQUIRE( first.output == bytes{ 42 } );
+    BOOST_REQUIRE( second.output == bytes{ 42 } );
+}
+
+BOOST_AUTO_TEST_CASE( exceptions ) {
+    CallCache cache( 16 );
+    auto failing = []( shared_ptr< skale::StateAccessLog > const& ) -> ExecutionResult {
+        BOOST_THROW_EXCEPTION( std::runtime_error( "call failed" ) );
+    };
+    BOOST_REQUIRE_THROW( cache.get( h256( 1 ), true, failing ), std::runtime_error );
+    BOOST_REQUIRE_EQUAL( cache.stats().size, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
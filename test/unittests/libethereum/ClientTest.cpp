@@ -814,6 +814,125 @@ BOOST_AUTO_TEST_CASE( consumptionWithReverts ) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+// returns the block number
+static std::string const c_blockNumberCode = "0x4360005260206000f3";
+
+static std::string const c_genesisInfoCallCacheTest = [] {
+    std::string config = c_genesisInfoSkaleTest;
+    std::string const accounts = "\"accounts\": {";
+    config.insert( config.find( accounts ) + accounts.size(),
+        "\"0xD2001300000000000000000000000000000000D5\": { \"balance\": \"0\", \"code\": \"" +
+            c_blockNumberCode + "\" }," );
+    return config;
+}();
+
+static u256 callForWord( Client& _client, Address const& _to, bytes const& _data ) {
+    Address from( "0xca4409573a5129a72edf85d6c51e26760fc9c903" );
+    ExecutionResult result = _client.call( from, 0, _to, _data, 1000000, 0,
+#ifdef HISTORIC_STATE
+        LatestBlock,
+#endif
+        FudgeFactor::Lenient );
+    BOOST_REQUIRE_EQUAL( result.output.size(), 32 );
+    return fromBigEndian< u256 >( result.output );
+}
+
+BOOST_AUTO_TEST_SUITE( CallCacheSuite )
+
+BOOST_AUTO_TEST_CASE( recomputedWhenReadSlotChanges ) {
+    TestClientFixture fixture( c_genesisInfoCallCacheTest );
+    ClientTest* testClient = asClientTest( fixture.ethereum() );
+
+    dev::eth::simulateMining( *( fixture.ethereum() ), 10 );
+
+    //    pragma solidity ^0.6.6;
+    //    contract Storage {
+    //        uint256 number;
+    //        function store(uint256 num) public { number = num; }
+    //        function retreive() public view returns (uint256) { return number; }
+    //    }
+    Address contractAddress( "0xd40B3c51D0ECED279b1697DbdF45d4D19b872164" );
+    bytes retreive = jsToBytes( "0xb05784b8" );
+
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, retreive ), 0 );
+    CallCache::Stats before = testClient->callCacheStats();
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, retreive ), 0 );
+    BOOST_REQUIRE_EQUAL( testClient->callCacheStats().hits, before.hits + 1 );
+
+    // store(5) changes the slot the call has read
+    Json::Value storeTransaction;
+    storeTransaction["from"] = toJS( fixture.coinbase.address() );
+    storeTransaction["to"] = toJS( contractAddress );
+    storeTransaction["data"] =
+        "0x6057361d0000000000000000000000000000000000000000000000000000000000000005";
+    storeTransaction["gas"] = toJS( u256( 100000 ) );
+    BOOST_REQUIRE( fixture.getTransactionStatus( storeTransaction ) );
+
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, retreive ), 5 );
+    CallCache::Stats after = testClient->callCacheStats();
+    BOOST_REQUIRE_EQUAL( after.misses, before.misses + 1 );
+    BOOST_REQUIRE_GE( after.invalidations, before.invalidations + 1 );
+}
+
+BOOST_AUTO_TEST_CASE( keptWhenUnrelatedSlotChanges ) {
+    TestClientFixture fixture( c_genesisInfoCallCacheTest );
+    ClientTest* testClient = asClientTest( fixture.ethereum() );
+
+    dev::eth::simulateMining( *( fixture.ethereum() ), 10 );
+
+    //    pragma solidity 0.6.0;
+    //    contract Test {
+    //        mapping (uint => bool) public a;
+    //        uint public b;
+    //        function setA(uint x) public { a[x] = true; }
+    //        ...
+    //    }
+    Address contractAddress( "0xD40b89C063a23eb85d739f6fA9B14341838eeB2b" );
+    bytes getA2 =
+        jsToBytes( "0xf0fdf8340000000000000000000000000000000000000000000000000000000000000002" );
+
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, getA2 ), 0 );
+    CallCache::Stats before = testClient->callCacheStats();
+
+    // setA(4) changes another slot of the same contract
+    Json::Value setTransaction;
+    setTransaction["from"] = toJS( fixture.coinbase.address() );
+    setTransaction["to"] = toJS( contractAddress );
+    setTransaction["data"] =
+        "0xee919d500000000000000000000000000000000000000000000000000000000000000004";
+    setTransaction["gas"] = toJS( u256( 100000 ) );
+    BOOST_REQUIRE( fixture.getTransactionStatus( setTransaction ) );
+
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, getA2 ), 0 );
+    CallCache::Stats after = testClient->callCacheStats();
+    BOOST_REQUIRE_EQUAL( after.hits, before.hits + 1 );
+    BOOST_REQUIRE_EQUAL( after.misses, before.misses );
+
+    bytes getA4 =
+        jsToBytes( "0xf0fdf8340000000000000000000000000000000000000000000000000000000000000004" );
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, getA4 ), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( recomputedEveryBlockWhenReadingBlockInfo ) {
+    TestClientFixture fixture( c_genesisInfoCallCacheTest );
+    ClientTest* testClient = asClientTest( fixture.ethereum() );
+
+    dev::eth::simulateMining( *( fixture.ethereum() ), 10 );
+
+    Address contractAddress( "0xD2001300000000000000000000000000000000D5" );
+    u256 number = callForWord( *testClient, contractAddress, bytes() );
+    CallCache::Stats before = testClient->callCacheStats();
+    BOOST_REQUIRE_EQUAL( callForWord( *testClient, contractAddress, bytes() ), number );
+    BOOST_REQUIRE_EQUAL( testClient->callCacheStats().hits, before.hits + 1 );
+
+    // an empty block changes nothing in the state, but changes NUMBER
+    BOOST_REQUIRE( testClient->mineBlocks( 1 ) );
+    BOOST_REQUIRE_GT( callForWord( *testClient, contractAddress, bytes() ), number );
+    BOOST_REQUIRE_EQUAL( testClient->callCacheStats().misses, before.misses + 1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE( IMABLSPublicKey )
 
 static std::string const c_genesisInfoSkaleIMABLSPublicKeyTest = std::string() +
@@ -0,0 +1,74 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogFilterIndex.cpp
+ * @date 2026
+ */
+
+#include <libethereum/LogFilterIndex.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+BOOST_FIXTURE_TEST_SUITE( LogFilterIndexSuite, TestOutputHelperFixture )
+
+BOOST_AUTO_TEST_CASE( candidates ) {
+    Address a1( 1 ), a2( 2 );
+    h256 t1( 11 ), t2( 12 );
+
+    LogFilter byAddress = LogFilter().address( a1 );
+    LogFilter byTopic = LogFilter().topic( 1, t2 );
+    LogFilter byBoth = LogFilter().address( a2 ).topic( 0, t1 );
+    LogFilter everything;
+
+    LogFilterIndex index;
+    index.insert( byAddress.sha3(), byAddress );
+    index.insert( byTopic.sha3(), byTopic );
+    index.insert( byBoth.sha3(), byBoth );
+    index.insert( everything.sha3(), everything );
+    BOOST_REQUIRE_EQUAL( index.size(), 4 );
+
+    // no logs - nothing to match
+    BOOST_REQUIRE( index.candidates( TransactionReceipt( 1, 21000, LogEntries() ) ).empty() );
+
+    TransactionReceipt r1( 1, 21000, { LogEntry( a1, { t1 }, bytes() ) } );
+    BOOST_REQUIRE( index.candidates( r1 ) == h256Hash( { byAddress.sha3(), everything.sha3() } ) );
+
+    TransactionReceipt r2( 1, 21000, { LogEntry( a2, { t1, t2 }, bytes() ) } );
+    h256Hash c2 = index.candidates( r2 );
+    BOOST_REQUIRE( c2 == h256Hash( { byTopic.sha3(), byBoth.sha3(), everything.sha3() } ) );
+
+    // candidates are a superset of matching filters
+    for ( LogFilter const& f : { byAddress, byTopic, byBoth, everything } )
+        if ( !f.matches( r2 ).empty() )
+            BOOST_REQUIRE( c2.count( f.sha3() ) );
+
+    index.remove( byBoth.sha3() );
+    index.remove( everything.sha3() );
+    BOOST_REQUIRE( index.candidates( r2 ) == h256Hash( { byTopic.sha3() } ) );
+    BOOST_REQUIRE( index.candidates( r1 ) == h256Hash( { byAddress.sha3() } ) );
+    BOOST_REQUIRE_EQUAL( index.size(), 2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
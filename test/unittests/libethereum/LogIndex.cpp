@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file LogIndex.cpp
+ * @date 2026
+ */
+
+#include <libdevcore/TransientDirectory.h>
+#include <libethereum/LogIndex.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace {
+
+vector< LogPosition > matches( LogIndex const& _index, LogFilter const& _filter, unsigned _from,
+    unsigned _to, size_t _limit = 0 ) {
+    vector< LogPosition > ret;
+    _index.forEachMatch( _filter, _from, _to, [&]( LogPosition const& _p ) {
+        ret.push_back( _p );
+        return !_limit || ret.size() < _limit;
+    } );
+    return ret;
+}
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE( LogIndexSuite, TestOutputHelperFixture )
+
+BOOST_AUTO_TEST_CASE( postingIntersection ) {
+    TransientDirectory td;
+    Address a1( 1 ), a2( 2 );
+    h256 t1( 11 ), t2( 12 );
+
+    LogIndex index( td.path(), 4, false );
+    BOOST_REQUIRE( !index.blocks() );
+    index.startAfter( 9 );
+
+    // block 10: tx 0 logs (a1, t1), (a2, t2); tx 1 logs (a1, t2)
+    index.insertBlock( 10,
+        { TransactionReceipt( 1, 21000,
+              { LogEntry( a1, { t1 }, bytes() ), LogEntry( a2, { t2 }, bytes() ) } ),
+            TransactionReceipt( 1, 21000, { LogEntry( a1, { t2 }, bytes() ) } ) } );
+    // block 11: no logs; block 12: (a2, t1 t2)
+    index.insertBlock( 11, { TransactionReceipt( 1, 21000, LogEntries() ) } );
+    index.insertBlock(
+        12, { TransactionReceipt( 1, 21000, { LogEntry( a2, { t1, t2 }, bytes() ) } ) } );
+    BOOST_REQUIRE( index.blocks() == make_pair( 10u, 12u ) );
+
+    auto byA1 = matches( index, LogFilter().address( a1 ), 0, 100 );
+    BOOST_REQUIRE_EQUAL( byA1.size(), 2 );
+    BOOST_REQUIRE( byA1[0] == ( LogPosition{ 10, 0, 0 } ) );
+    BOOST_REQUIRE( byA1[1] == ( LogPosition{ 10, 1, 2 } ) );
+
+    // addresses are or-ed, positions are and-ed
+    auto filter = LogFilter().address( a1 ).address( a2 ).topic( 0, t2 );
+    auto both = matches( index, filter, 0, 100 );
+    BOOST_REQUIRE_EQUAL( both.size(), 2 );
+    BOOST_REQUIRE( both[0] == ( LogPosition{ 10, 0, 1 } ) );
+    BOOST_REQUIRE( both[1] == ( LogPosition{ 10, 1, 2 } ) );
+
+    auto secondTopic = matches( index, LogFilter().topic( 1, t2 ), 0, 100 );
+    BOOST_REQUIRE_EQUAL( secondTopic.size(), 1 );
+    BOOST_REQUIRE( secondTopic[0] == ( LogPosition{ 12, 0, 0 } ) );
+
+    // block range and early stop
+    BOOST_REQUIRE( matches( index, LogFilter().address( a2 ), 11, 12 ).size() == 1 );
+    BOOST_REQUIRE( matches( index, LogFilter().address( a2 ), 0, 100, 1 ).size() == 1 );
+
+    // a gap is not indexed
+    index.insertBlock( 14, { TransactionReceipt( 1, 21000, { LogEntry( a1, {}, bytes() ) } ) } );
+    BOOST_REQUIRE( index.blocks() == make_pair( 10u, 12u ) );
+
+    // postings survive rotation until their piece is dropped
+    index.rotate();
+    BOOST_REQUIRE( index.blocks() == make_pair( 10u, 12u ) );
+    BOOST_REQUIRE_EQUAL( matches( index, LogFilter().address( a1 ), 0, 100 ).size(), 2 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,7 +21,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
 #include <memory>
+#include <thread>
 
 using namespace dev;
 using namespace dev::eth;
@@ -748,6 +750,69 @@ BOOST_AUTO_TEST_CASE( gasLimitInBlockProposal ) {
     BOOST_REQUIRE( proposal[0] == stream1.out() );
 }
 
+BOOST_AUTO_TEST_CASE( receiveTransactionsFrame ) {
+    auto receiver = KeyPair::create();
+
+    Json::Value json;
+    json["from"] = toJS( coinbase.address() );
+    json["to"] = toJS( receiver.address() );
+    json["value"] = jsToDecimal( toJS( 10000 * dev::eth::szabo ) );
+    json["nonce"] = 0;
+    bytes tx1 = bytes_from_json( json );
+    json["nonce"] = 1;
+    bytes tx2 = bytes_from_json( json );
+
+    bytes frame = Broadcaster::encodeFrame( { tx1, bytes{ 1, 2, 3 }, tx2 } );
+    BOOST_REQUIRE( Broadcaster::isFrame( &frame ) );
+    BOOST_REQUIRE( !Broadcaster::isFrame( bytesConstRef( toJS( tx1 ) ) ) );
+
+    // bad transaction is skipped
+    BOOST_REQUIRE_EQUAL( skaleHost->receiveTransactions( &frame ), 3 );
+    BOOST_REQUIRE_EQUAL( tq->knownTransactions().size(), 2 );
+}
+
+// decoded transaction which is not in the queue is executed as consensus-born
+BOOST_AUTO_TEST_CASE( cachedTransactionNotInQueue ) {
+    auto senderAddress = coinbase.address();
+    auto receiver = KeyPair::create();
+
+    Json::Value json;
+    json["from"] = toJS( senderAddress );
+    json["to"] = toJS( receiver.address() );
+    json["value"] = jsToDecimal( toJS( 10000 * dev::eth::szabo ) );
+    json["nonce"] = 0;
+    Transaction tx1 = tx_from_json( json );
+    json["nonce"] = 1;
+    Transaction tx2 = tx_from_json( json );
+
+    // tx1 is imported, tx2 is only decoded
+    BOOST_REQUIRE( tq->import( tx1 ) == ImportResult::Success );
+    BOOST_REQUIRE( tq->decodedTransactions().insert( tx2 ) );
+    BOOST_REQUIRE_EQUAL( tq->knownTransactions().size(), 1 );
+
+    auto traceCount = [this]( const std::string& _name ) {
+        return std::stoi( skaleHost->getDebugHandler()( "trace count " + _name ) );
+    };
+    int const dropGood = traceCount( "drop_good" );
+    int const consensusBorn = traceCount( "import_consensus_born" );
+
+    CHECK_BLOCK_BEGIN;
+    CHECK_NONCE_BEGIN( senderAddress );
+
+    BOOST_REQUIRE_NO_THROW( stub->createBlock(
+        ConsensusExtFace::transactions_vector{ tx1.rlp(), tx2.rlp() }, utcTime(), 1U ) );
+
+    REQUIRE_BLOCK_INCREASE( 1 );
+    REQUIRE_BLOCK_SIZE( 1, 2 );
+    REQUIRE_NONCE_INCREASE( senderAddress, 2 );
+
+    BOOST_REQUIRE_EQUAL( traceCount( "drop_good" ), dropGood + 1 );
+    BOOST_REQUIRE_EQUAL( traceCount( "import_consensus_born" ), consensusBorn + 1 );
+    BOOST_REQUIRE( !tq->decodedTransactions().contains( tx1.sha3() ) );
+    BOOST_REQUIRE( !tq->decodedTransactions().contains( tx2.sha3() ) );
+    BOOST_REQUIRE_EQUAL( tq->knownTransactions().size(), 0 );
+}
+
 // positive test for 4 next ones
 BOOST_AUTO_TEST_CASE( transactionDropReceive
                       //, *boost::unit_test::precondition( dev::test::run_not_express )
@@ -1105,6 +1170,145 @@ BOOST_AUTO_TEST_CASE( getIMABLSPUblicKey ) {
     BOOST_REQUIRE( res.second == toBigEndian( dev::u256( imaBLSPublicKey[0] ) ) + toBigEndian( dev::u256( imaBLSPublicKey[1] ) ) + toBigEndian( dev::u256( imaBLSPublicKey[2] ) ) + toBigEndian( dev::u256( imaBLSPublicKey[3] ) ) );
 }
 
+namespace {
+
+// sets c_parallelExecutionThreads for the lifetime of the object
+struct ParallelExecutionScope {
+    explicit ParallelExecutionScope( unsigned _threads ) { c_parallelExecutionThreads = _threads; }
+    ~ParallelExecutionScope() { c_parallelExecutionThreads = 0; }
+};
+
+bytes rlpOf( Transaction const& _tx ) {
+    RLPStream stream;
+    _tx.streamRLP( stream );
+    return stream.out();
+}
+
+// contract whose every call increments storage slot 0
+bytes counterContractCode() {
+    // runtime: PUSH1 1 PUSH1 0 SLOAD ADD PUSH1 0 SSTORE STOP
+    bytes runtime = fromHex( "60016000540160005500" );
+    // init: PUSH10 <runtime> PUSH1 0 MSTORE PUSH1 10 PUSH1 22 RETURN
+    bytes init = fromHex( "69" );
+    init += runtime;
+    init += fromHex( "600052600a6016f3" );
+    return init;
+}
+
+}  // namespace
+
+// transactions of a block executed in parallel must give exactly the serial result
+BOOST_AUTO_TEST_CASE( parallelExecution ) {
+    ParallelExecutionScope parallel( 4 );
+
+    u256 const gasPrice = dev::eth::shannon;
+    u256 const fund = 1000 * dev::eth::szabo;
+    u256 const value = dev::eth::szabo;
+    u256 const transferCost = 21000 * gasPrice;
+
+    std::vector< KeyPair > senders, receivers;
+    ConsensusExtFace::transactions_vector funding;
+    for ( size_t i = 0; i < 4; ++i ) {
+        senders.push_back( KeyPair::create() );
+        receivers.push_back( KeyPair::create() );
+        funding.push_back( rlpOf( Transaction(
+            fund, gasPrice, 21000, senders[i].address(), bytes(), i, coinbase.secret() ) ) );
+    }
+
+    // same sender - only the first one can be taken from speculation
+    BOOST_REQUIRE_NO_THROW( stub->createBlock( funding, utcTime(), 1U ) );
+    REQUIRE_BLOCK_SIZE( 1, 4 );
+    for ( auto const& sender : senders )
+        BOOST_REQUIRE_EQUAL( client->balanceAt( sender.address() ), fund );
+
+    // 0..3 are independent, 4 and 5 read accounts written by 1 and 0
+    ConsensusExtFace::transactions_vector block;
+    for ( size_t i = 0; i < 4; ++i )
+        block.push_back( rlpOf( Transaction( value, gasPrice, 21000, receivers[i].address(),
+            bytes(), 0, senders[i].secret() ) ) );
+    block.push_back( rlpOf( Transaction(
+        value, gasPrice, 21000, receivers[1].address(), bytes(), 0, receivers[0].secret() ) ) );
+    block.push_back( rlpOf( Transaction(
+        value, gasPrice, 21000, receivers[2].address(), bytes(), 1, senders[0].secret() ) ) );
+
+    u256 authorBefore = client->balanceAt( client->author() );
+    BOOST_REQUIRE_NO_THROW( stub->createBlock( block, utcTime(), 2U ) );
+    REQUIRE_BLOCK_SIZE( 2, 6 );
+
+    // receivers[0] has no money for gas
+    BOOST_REQUIRE_EQUAL( client->balanceAt( receivers[0].address() ), value );
+    BOOST_REQUIRE_EQUAL( client->countAt( receivers[0].address() ), 0 );
+    BOOST_REQUIRE_EQUAL( client->balanceAt( receivers[1].address() ), value );
+    BOOST_REQUIRE_EQUAL( client->balanceAt( receivers[2].address() ), 2 * value );
+    BOOST_REQUIRE_EQUAL( client->balanceAt( receivers[3].address() ), value );
+    BOOST_REQUIRE_EQUAL(
+        client->balanceAt( senders[0].address() ), fund - 2 * ( value + transferCost ) );
+    BOOST_REQUIRE_EQUAL( client->countAt( senders[0].address() ), 2 );
+    BOOST_REQUIRE_EQUAL( client->balanceAt( senders[3].address() ), fund - value - transferCost );
+    BOOST_REQUIRE_EQUAL(
+        client->balanceAt( client->author() ) - authorBefore, 5 * transferCost );
+
+    TransactionReceipts receipts =
+        client->blockChain().receipts( client->hashFromNumber( 2 ) ).receipts;
+    BOOST_REQUIRE_EQUAL( receipts.size(), 6 );
+    BOOST_REQUIRE_EQUAL( receipts[3].cumulativeGasUsed(), 4 * 21000 );
+    BOOST_REQUIRE_EQUAL( receipts[5].cumulativeGasUsed(), 5 * 21000 );
+}
+
+// serial vs parallel block execution on independent transfers and on calls to a few hot contracts
+BOOST_AUTO_TEST_CASE( bench_parallelExecution,
+    *boost::unit_test::label( "bench" ) *
+        boost::unit_test::precondition( dev::test::run_not_express ) ) {
+    size_t const senderCount = 1000;
+    size_t const contractCount = 16;
+    unsigned const threads = std::max( 2u, std::thread::hardware_concurrency() );
+    u256 const gasPrice = dev::eth::shannon;
+
+    std::vector< KeyPair > senders;
+    ConsensusExtFace::transactions_vector funding;
+    u256 coinbaseNonce = client->countAt( coinbase.address() );
+    for ( size_t i = 0; i < senderCount; ++i ) {
+        senders.push_back( KeyPair::create() );
+        funding.push_back( rlpOf( Transaction( 1000 * dev::eth::szabo, gasPrice, 21000,
+            senders[i].address(), bytes(), coinbaseNonce++, coinbase.secret() ) ) );
+    }
+    std::vector< Address > contracts;
+    for ( size_t i = 0; i < contractCount; ++i ) {
+        contracts.push_back( right160( sha3( rlpList( coinbase.address(), coinbaseNonce ) ) ) );
+        funding.push_back( rlpOf( Transaction(
+            0, gasPrice, 100000, counterContractCode(), coinbaseNonce++, coinbase.secret() ) ) );
+    }
+    uint64_t blockId = client->number() + 1;
+    BOOST_REQUIRE_NO_THROW( stub->createBlock( funding, utcTime(), blockId++ ) );
+
+    std::vector< u256 > nonces( senderCount, 0 );
+    auto run = [&]( std::string const& _name, std::function< Transaction( size_t ) > _makeTx ) {
+        for ( unsigned t : { 0u, threads } ) {
+            ParallelExecutionScope parallel( t );
+            ConsensusExtFace::transactions_vector block;
+            for ( size_t i = 0; i < senderCount; ++i )
+                block.push_back( rlpOf( _makeTx( i ) ) );
+
+            auto start = std::chrono::steady_clock::now();
+            BOOST_REQUIRE_NO_THROW( stub->createBlock( block, utcTime(), blockId++ ) );
+            auto ms = std::chrono::duration_cast< std::chrono::milliseconds >(
+                std::chrono::steady_clock::now() - start )
+                          .count();
+            std::cout << boost::unit_test::framework::current_test_case().p_name << "/" << _name
+                      << "/" << t << " threads: " << ms << " ms\n";
+        }
+    };
+
+    run( "transfers", [&]( size_t i ) {
+        return Transaction( dev::eth::wei, gasPrice, 21000, KeyPair::create().address(), bytes(),
+            nonces[i]++, senders[i].secret() );
+    } );
+    run( "counters", [&]( size_t i ) {
+        return Transaction( 0, gasPrice, 100000, contracts[i % contractCount], bytes(),
+            nonces[i]++, senders[i].secret() );
+    } );
+}
+
 struct dummy{};
 
 // Test behavior of MTM if tx with big nonce was already mined as erroneous
@@ -56,6 +56,121 @@ BOOST_AUTO_TEST_CASE( LoadAccountCode ) {
         std::equal( std::begin( codeData ), std::end( codeData ), std::begin( loadedCode ) ) );
 }
 
+BOOST_AUTO_TEST_CASE( BlockScopedCommit ) {
+    TransientDirectory tempDir;
+    State state( 0, tempDir.path(), h256{}, BaseState::Empty );
+    Address addr1{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"};
+    Address addr2{"bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"};
+
+    State s = state.createStateModifyCopy();
+    s.startBlockScopedCommit();
+
+    s.addBalance( addr1, 100 );
+    s.setStorage( addr1, 1, 42 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+
+    s.addBalance( addr2, 200 );
+    s.kill( addr1 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+
+    // staged changes are visible through the state but not yet written
+    BOOST_CHECK_EQUAL( s.balance( addr2 ), 200 );
+    BOOST_CHECK( !s.addressInUse( addr1 ) );
+    BOOST_CHECK( s.db()->lookup( skale::slicing::toSlice( addr2 ) ).empty() );
+
+    s.commitBlock();
+    BOOST_CHECK( !s.isBlockScopedCommit() );
+    BOOST_CHECK( !s.db()->lookup( skale::slicing::toSlice( addr2 ) ).empty() );
+    BOOST_CHECK( s.db()->lookup( skale::slicing::toSlice( addr1 ) ).empty() );
+    s.releaseWriteLock();
+
+    State r = state.createStateReadOnlyCopy();
+    BOOST_CHECK_EQUAL( r.balance( addr2 ), 200 );
+    BOOST_CHECK( !r.addressInUse( addr1 ) );
+}
+
+BOOST_AUTO_TEST_CASE( BlockScopedCommitAbort ) {
+    TransientDirectory tempDir;
+    State state( 0, tempDir.path(), h256{}, BaseState::Empty );
+    Address addr1{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"};
+    Address addr2{"bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"};
+
+    State s = state.createStateModifyCopy();
+    s.startBlockScopedCommit();
+    s.addBalance( addr1, 100 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+
+    // block failed before commitBlock()
+    s.abortBlockScopedCommit();
+    BOOST_CHECK( !s.isBlockScopedCommit() );
+    BOOST_CHECK( !s.addressInUse( addr1 ) );
+
+    // next block commits only its own changes
+    s.addBalance( addr2, 200 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+    s.releaseWriteLock();
+
+    State r = state.createStateReadOnlyCopy();
+    BOOST_CHECK( !r.addressInUse( addr1 ) );
+    BOOST_CHECK_EQUAL( r.balance( addr2 ), 200 );
+}
+
+BOOST_AUTO_TEST_CASE( AccountCacheServesCommittedValues ) {
+    TransientDirectory tempDir;
+    State state( 0, tempDir.path(), h256{}, BaseState::Empty );
+    Address addr{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"};
+
+    State s = state.createStateModifyCopy();
+    s.addBalance( addr, 100 );
+    s.setStorage( addr, 1, 42 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+    s.releaseWriteLock();
+
+    auto before = state.accountCacheStats();
+    State r = state.createStateReadOnlyCopy();
+    BOOST_CHECK_EQUAL( r.balance( addr ), 100 );
+    BOOST_CHECK_EQUAL( r.storage( addr, 1 ), 42 );
+    auto after = state.accountCacheStats();
+    BOOST_CHECK_GT( after.accountHits, before.accountHits );
+    BOOST_CHECK_GT( after.storageHits, before.storageHits );
+
+    // a killed account must not be served from the cache
+    State k = state.createStateModifyCopy();
+    k.kill( addr );
+    k.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+    k.releaseWriteLock();
+    BOOST_CHECK( !state.createStateReadOnlyCopy().addressInUse( addr ) );
+}
+
+BOOST_AUTO_TEST_CASE( StorageOfOneContract ) {
+    TransientDirectory tempDir;
+    State state( 0, tempDir.path(), h256{}, BaseState::Empty );
+    Address addr1{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"};
+    Address addr2{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab"};
+
+    State s = state.createStateModifyCopy();
+    s.addBalance( addr1, 100 );
+    s.addBalance( addr2, 100 );
+    for ( unsigned i = 1; i <= 3; ++i ) {
+        s.setStorage( addr1, i, i * 10 );
+        s.setStorage( addr2, i, i * 20 );
+    }
+    s.setStorage( addr2, 4, 80 );
+    s.commit( dev::eth::CommitBehaviour::KeepEmptyAccounts );
+    s.releaseWriteLock();
+
+    State r = state.createStateReadOnlyCopy();
+    auto storage1 = r.storage( addr1 );
+    BOOST_REQUIRE_EQUAL( storage1.size(), 3 );
+    BOOST_CHECK( storage1[sha3( u256( 2 ) )] == std::make_pair( u256( 2 ), u256( 20 ) ) );
+    BOOST_CHECK_EQUAL( r.storage( addr2 ).size(), 4 );
+
+    // accounts are found past the storage of the previous one
+    auto addresses = r.addresses();
+    BOOST_CHECK_EQUAL( addresses.size(), 2 );
+    BOOST_CHECK_EQUAL( addresses[addr2], 100 );
+}
+
 class AddressRangeTestFixture : public TestOutputHelperFixture {
 public:
     AddressRangeTestFixture() {
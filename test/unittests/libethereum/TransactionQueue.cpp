@@ -526,18 +526,196 @@ BOOST_AUTO_TEST_CASE( tqEqueue ) {
     Transaction tRlpTransaction( payloadToDecode, CheckTransaction::Cheap );
     BOOST_REQUIRE( tRlpTransaction.data() == testTransaction.transaction().data() );
 
-    // SKALE as we don't have tx verifier threads - we won't check tx import
-    //    // try to import transactions
-    //    string hashStr =
-    //        "010203040506070809101112131415161718192021222324252627282930313201020304050607080910111213"
-    //        "14151617181920212223242526272829303132";
-    //    tq.enqueue( tRlp, h512( hashStr ) );
-    //    tq.enqueue( tRlp, h512( hashStr ) );
-    //    std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
-
-    //    // at least 1 transaction should be imported through RLP
-    //    Transactions topTr = tq.topTransactions( 10 );
-    //    BOOST_REQUIRE( topTr.size() == 1 );
+    // verifier threads are needed to import enqueued transactions
+    if ( c_transactionVerifierThreads == 0 )
+        return;
+
+    // try to import transactions
+    string hashStr =
+        "010203040506070809101112131415161718192021222324252627282930313201020304050607080910111213"
+        "14151617181920212223242526272829303132";
+    tq.enqueue( tRlp, h512( hashStr ) );
+    tq.enqueue( tRlp, h512( hashStr ) );
+    std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+
+    // at least 1 transaction should be imported through RLP
+    Transactions topTr = tq.topTransactions( 10 );
+    BOOST_REQUIRE( topTr.size() == 1 );
+}
+
+BOOST_AUTO_TEST_CASE( tqImportBatch ) {
+    TransactionQueue tq;
+    const u256 gasCost = 10 * szabo;
+    const u256 gas = 25000;
+    Address dest = Address( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+
+    Transactions txs;
+    for ( unsigned i = 0; i < 32; ++i )
+        txs.push_back( Transaction( 0, gasCost, gas, dest, bytes(), i % 8, Secret::random() ) );
+    txs.push_back( txs.front() );
+
+    RLPStream streamRLP;
+    streamRLP.appendList( 9 );
+    streamRLP << 0 << gasCost << gas << dest << 0 << bytes() << 0 << 0 << 0;
+    txs.push_back( Transaction( streamRLP.out(), CheckTransaction::None ) );
+
+    std::vector< ImportResult > results = tq.importBatch( txs );
+    BOOST_REQUIRE_EQUAL( results.size(), txs.size() );
+    for ( unsigned i = 0; i < 32; ++i )
+        BOOST_CHECK( results[i] == ImportResult::Success );
+    BOOST_CHECK( results[32] == ImportResult::AlreadyKnown );
+    BOOST_CHECK( results[33] == ImportResult::ZeroSignature );
+    BOOST_CHECK_EQUAL( tq.knownTransactions().size(), 32 );
+}
+
+BOOST_AUTO_TEST_CASE( tqConcurrentImport ) {
+    TransactionQueue tq( 4096, 1024 );
+    const u256 gasCost = 10 * szabo;
+    const u256 gas = 25000;
+    Address dest = Address( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+
+    // every thread sends its own nonce sequence
+    unsigned const threadCount = 8;
+    unsigned const perThread = 50;
+    std::vector< Transactions > txs( threadCount );
+    for ( auto& threadTxs : txs ) {
+        Secret sec = Secret::random();
+        for ( unsigned nonce = 0; nonce < perThread; ++nonce )
+            threadTxs.push_back( Transaction( 0, gasCost, gas, dest, bytes(), nonce, sec ) );
+    }
+
+    std::atomic< unsigned > succeeded{ 0 };
+    std::vector< std::thread > threads;
+    for ( auto const& threadTxs : txs )
+        threads.emplace_back( [&]() {
+            for ( auto const& t : threadTxs )
+                if ( tq.import( t ) == ImportResult::Success )
+                    ++succeeded;
+        } );
+    for ( auto& t : threads )
+        t.join();
+
+    BOOST_CHECK_EQUAL( succeeded.load(), threadCount * perThread );
+    BOOST_CHECK_EQUAL( tq.topTransactions( threadCount * perThread ).size(),
+        threadCount * perThread );
+    for ( auto const& threadTxs : txs )
+        BOOST_CHECK( tq.maxNonce( threadTxs.front().from() ) == perThread );
+}
+
+BOOST_AUTO_TEST_CASE( tqShardsKeepOrder ) {
+    TransactionQueue single( 1024, 1024, 1 );
+    TransactionQueue sharded( 1024, 1024, 16 );
+    Address dest = Address( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+
+    // senders with different gas prices and gaps, imported interleaved
+    std::vector< Secret > senders;
+    for ( unsigned i = 1; i <= 8; ++i )
+        senders.push_back( Secret( sha3( toString( i ) ) ) );
+    Transactions txs;
+    for ( unsigned nonce = 0; nonce < 6; ++nonce )
+        for ( unsigned i = 0; i < senders.size(); ++i )
+            if ( nonce != 3 || i % 3 != 0 )
+                txs.push_back( Transaction(
+                    0, ( 10 + i % 4 ) * szabo, 25000, dest, bytes(), nonce, senders[i] ) );
+
+    for ( auto const& t : txs ) {
+        BOOST_CHECK( single.import( t ) == ImportResult::Success );
+        BOOST_CHECK( sharded.import( t ) == ImportResult::Success );
+    }
+    BOOST_CHECK( single.topTransactions( 256 ) == sharded.topTransactions( 256 ) );
+    BOOST_CHECK( single.topTransactions( 10, 0, 1 ) == sharded.topTransactions( 10, 0, 1 ) );
+    BOOST_CHECK( single.topTransactions( 256 ) == sharded.topTransactions( 256 ) );
+
+    // the global lowest priority transaction is dropped when the limit is reached
+    TransactionQueue limited( txs.size() - 1, 1024, 16 );
+    for ( auto const& t : txs )
+        limited.import( t );
+    Transactions top = single.topTransactions( 256 );
+    top.pop_back();
+    BOOST_CHECK( limited.topTransactions( 256 ) == top );
+    BOOST_CHECK_EQUAL( limited.status().current, txs.size() - 1 );
+}
+
+BOOST_AUTO_TEST_CASE( tqPendingSnapshot ) {
+    TransactionQueue tq;
+    const u256 gasCost = 10 * szabo;
+    const u256 gas = 25000;
+    Address dest = Address( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+    Secret sec = Secret( "0x45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8" );
+    Transaction tx0( 0, gasCost, gas, dest, bytes(), 0, sec );
+    Transaction tx1( 0, gasCost, gas, dest, bytes(), 1, sec );
+
+    auto empty = tq.pendingSnapshot();
+    BOOST_CHECK( empty->transactions.empty() );
+    BOOST_CHECK( tq.pendingSnapshot() == empty );
+
+    tq.import( tx0 );
+    tq.import( tx1 );
+    auto snapshot = tq.pendingSnapshot();
+    BOOST_CHECK( snapshot != empty );
+    BOOST_CHECK( empty->transactions.empty() );
+    BOOST_REQUIRE_EQUAL( snapshot->transactions.size(), 2 );
+    BOOST_CHECK( snapshot->transactions[0].sha3() == tx0.sha3() );
+    BOOST_CHECK( snapshot->categories == std::vector< int >( 2, 0 ) );
+    BOOST_CHECK( tq.pendingSnapshot() == snapshot );
+
+    tq.topTransactions( 1, 0, 1 );
+    snapshot = tq.pendingSnapshot();
+    BOOST_CHECK_EQUAL( snapshot->categories[0], 1 );
+    BOOST_CHECK_EQUAL( snapshot->categories[1], 0 );
+
+    tq.setVerifiedOn( { tx0.sha3() }, 5 );
+    snapshot = tq.pendingSnapshot();
+    BOOST_CHECK_EQUAL( snapshot->transactions[0].verifiedOn, 5 );
+
+    tq.drop( h256Hash{ tx0.sha3(), tx1.sha3() } );
+    BOOST_CHECK( tq.pendingSnapshot()->transactions.empty() );
+    BOOST_CHECK( tq.knownTransactions().empty() );
+
+    // nothing changes, so waiting times out
+    uint64_t version = tq.pendingSnapshot()->version;
+    tq.waitForChange( version, std::chrono::milliseconds( 10 ) );
+    BOOST_CHECK_EQUAL( tq.pendingSnapshot()->version, version );
+}
+
+BOOST_AUTO_TEST_CASE( tqDecodedTransactions ) {
+    Address dest = Address( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+    Secret sec = Secret( "0x45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8" );
+    Transactions txs;
+    for ( unsigned nonce = 0; nonce < 3; ++nonce )
+        txs.push_back( Transaction( 0, 10 * szabo, 25000, dest, bytes(), nonce, sec ) );
+
+    TransactionCache cache( 2, 1 );
+    bytes rlp = txs[0].rlp();
+    Transaction decoded = cache.decode( &rlp );
+    BOOST_CHECK( decoded.sha3() == txs[0].sha3() );
+    BOOST_CHECK( decoded.sender() == txs[0].sender() );
+    BOOST_CHECK( cache.decode( &rlp ).sha3() == txs[0].sha3() );
+    TransactionCache::Stats stats = cache.stats();
+    BOOST_CHECK_EQUAL( stats.hits, 1 );
+    BOOST_CHECK_EQUAL( stats.misses, 1 );
+
+    // the least recently used one is evicted
+    BOOST_CHECK( cache.insert( txs[1] ) );
+    BOOST_CHECK( !cache.insert( txs[1] ) );
+    cache.find( txs[0].sha3() );
+    BOOST_CHECK( cache.insert( txs[2] ) );
+    BOOST_CHECK( cache.contains( txs[0].sha3() ) );
+    BOOST_CHECK( !cache.contains( txs[1].sha3() ) );
+    stats = cache.stats();
+    BOOST_CHECK_EQUAL( stats.evictions, 1 );
+    BOOST_CHECK_EQUAL( stats.size, 2 );
+
+    // unsigned transactions are not cached
+    BOOST_CHECK( !cache.insert( Transaction( 0, 10 * szabo, 25000, dest, bytes(), 3 ) ) );
+
+    // imported transactions can be found by hash
+    TransactionQueue tq;
+    BOOST_CHECK( tq.import( txs[1] ) == ImportResult::Success );
+    std::optional< Transaction > cached = tq.decodedTransactions().find( txs[1].sha3() );
+    BOOST_REQUIRE( cached );
+    BOOST_CHECK( cached->sender() == txs[1].sender() );
+    BOOST_CHECK( !tq.decodedTransactions().find( txs[2].sha3() ) );
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file Uint256.cpp
+ * @date 2026
+ * Checks the native 256-bit kernel against boost::multiprecision
+ */
+
+#include <libevm/Uint256.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace {
+
+/// Random numbers of random width, so that single limb fast paths and carries are hit
+class RandomNumbers {
+public:
+    u256 operator()() {
+        unsigned const bits = 1 + m_random() % 256;
+        u256 ret;
+        for ( unsigned i = 0; i < bits; i += 64 )
+            ret = ( ret << 64 ) | m_random();
+        ret &= bits == 256 ? ~u256( 0 ) : ( u256( 1 ) << bits ) - 1;
+        // values next to the limits of a limb
+        if ( m_random() % 8 == 0 )
+            ret = ~ret;
+        return ret;
+    }
+
+private:
+    mt19937_64 m_random{ 256 };
+};
+
+u256 const c_min = u256( 1 ) << 255;
+u256 const c_minusOne = ~u256( 0 );
+
+u256 refDiv( u256 const& _a, u256 const& _b ) {
+    return _b ? u256( s512( _a ) / s512( _b ) ) : 0;
+}
+
+u256 refMod( u256 const& _a, u256 const& _b ) {
+    return _b ? u256( s512( _a ) % s512( _b ) ) : 0;
+}
+
+u256 refSdiv( u256 const& _a, u256 const& _b ) {
+    return _b ? s2u( s256( s512( u2s( _a ) ) / s512( u2s( _b ) ) ) ) : 0;
+}
+
+u256 refSmod( u256 const& _a, u256 const& _b ) {
+    return _b ? s2u( s256( s512( u2s( _a ) ) % s512( u2s( _b ) ) ) ) : 0;
+}
+
+u256 refExp( u256 _base, u256 _exponent ) {
+    u256 ret = 1;
+    for ( ; _exponent; _exponent >>= 1, _base *= _base )
+        if ( _exponent & 1 )
+            ret *= _base;
+    return ret;
+}
+
+u256 refSar( u256 const& _v, u256 const& _shift ) {
+    bool const negative = boost::multiprecision::bit_test( _v, 255 );
+    if ( _shift >= 256 )
+        return negative ? c_minusOne : 0;
+    unsigned const shift = unsigned( _shift );
+    u256 ret = _v >> shift;
+    if ( negative && shift )
+        ret |= c_minusOne << ( 256 - shift );
+    return ret;
+}
+
+u256 refSignextend( u256 const& _byte, u256 _v ) {
+    if ( _byte >= 31 )
+        return _v;
+    unsigned const testBit = unsigned( _byte ) * 8 + 7;
+    u256 const mask = ( u256( 1 ) << testBit ) - 1;
+    return boost::multiprecision::bit_test( _v, testBit ) ? _v | ~mask : _v & mask;
+}
+
+void checkAll( u256 const& _a, u256 const& _b, u256 const& _m ) {
+    BOOST_REQUIRE_EQUAL( native::add( _a, _b ), _a + _b );
+    BOOST_REQUIRE_EQUAL( native::sub( _a, _b ), _a - _b );
+    BOOST_REQUIRE_EQUAL( native::mul( _a, _b ), _a * _b );
+    BOOST_REQUIRE_EQUAL( native::div( _a, _b ), refDiv( _a, _b ) );
+    BOOST_REQUIRE_EQUAL( native::mod( _a, _b ), refMod( _a, _b ) );
+    BOOST_REQUIRE_EQUAL( native::sdiv( _a, _b ), refSdiv( _a, _b ) );
+    BOOST_REQUIRE_EQUAL( native::smod( _a, _b ), refSmod( _a, _b ) );
+    BOOST_REQUIRE_EQUAL(
+        native::addmod( _a, _b, _m ), _m ? u256( ( u512( _a ) + u512( _b ) ) % _m ) : 0 );
+    BOOST_REQUIRE_EQUAL(
+        native::mulmod( _a, _b, _m ), _m ? u256( ( u512( _a ) * u512( _b ) ) % _m ) : 0 );
+
+    u256 const shift = _b % 300;
+    BOOST_REQUIRE_EQUAL( native::shl( _a, shift ), shift < 256 ? _a << unsigned( shift ) : 0 );
+    BOOST_REQUIRE_EQUAL( native::shr( _a, shift ), shift < 256 ? _a >> unsigned( shift ) : 0 );
+    BOOST_REQUIRE_EQUAL( native::sar( _a, shift ), refSar( _a, shift ) );
+    BOOST_REQUIRE_EQUAL( native::signextend( _b % 40, _a ), refSignextend( _b % 40, _a ) );
+}
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE( Uint256Suite, TestOutputHelperFixture )
+
+BOOST_AUTO_TEST_CASE( Uint256Random ) {
+    RandomNumbers random;
+    for ( unsigned i = 0; i < 100000; ++i )
+        checkAll( random(), random(), random() );
+}
+
+BOOST_AUTO_TEST_CASE( Uint256Limits ) {
+    vector< u256 > const values{ 0, 1, 2, 3, c_minusOne, c_minusOne - 1, c_min, c_min - 1,
+        c_min + 1, u256( 1 ) << 64, ( u256( 1 ) << 64 ) - 1, u256( 1 ) << 128,
+        ( u256( 1 ) << 128 ) - 1, u256( 1 ) << 192, 255, 256, 257 };
+    for ( u256 const& a : values )
+        for ( u256 const& b : values )
+            for ( u256 const& m : values )
+                checkAll( a, b, m );
+
+    // -2^255 / -1 overflows back to -2^255
+    BOOST_CHECK_EQUAL( native::sdiv( c_min, c_minusOne ), c_min );
+    BOOST_CHECK_EQUAL( native::smod( c_min, c_minusOne ), 0 );
+    BOOST_CHECK_EQUAL( native::sar( c_min, 255 ), c_minusOne );
+    BOOST_CHECK_EQUAL( native::sar( c_min, c_minusOne ), c_minusOne );
+    BOOST_CHECK_EQUAL( native::shl( 1, c_min ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( Uint256Exp ) {
+    RandomNumbers random;
+    for ( unsigned i = 0; i < 2000; ++i ) {
+        u256 const base = random();
+        u256 const exponent = random();
+        BOOST_REQUIRE_EQUAL( native::exp( base, exponent ), refExp( base, exponent ) );
+    }
+    BOOST_CHECK_EQUAL( native::exp( 0, 0 ), 1 );
+    BOOST_CHECK_EQUAL( native::exp( 2, 255 ), c_min );
+    BOOST_CHECK_EQUAL( native::exp( 2, 256 ), 0 );
+    BOOST_CHECK_EQUAL( native::exp( c_minusOne, c_minusOne ), c_minusOne );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,10 +19,13 @@
 
 #include <libethereum/LastBlockHashesFace.h>
 #include <libevm/EVMC.h>
+#include <libevm/FramePool.h>
 #include <libevm/LegacyVM.h>
+#include <libevm/VMFactory.h>
 #include <libskale-interpreter/interpreter.h>
 #include <test/tools/jsontests/vm.h>
 #include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/Options.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 #include <boost/test/unit_test.hpp>
 
@@ -657,6 +660,110 @@ class SkaleInterpreterBalanceFixture : public BalanceFixture {
 public:
     SkaleInterpreterBalanceFixture() : BalanceFixture{new EVMC{evmc_create_interpreter()}} {}
 };
+
+class CallsFixture : public TestOutputHelperFixture {
+public:
+    CallsFixture() {
+        state.addBalance( address, 1 * ether );
+
+        // return(0, 0) followed by never executed code up to ~20KB, unique for every fixture
+        calleeCode = fromHex( "60006000f373" + calleeAddress.hex() );
+        while ( calleeCode.size() < 20000 ) {
+            calleeCode.push_back( _byte_( Instruction::PUSH32 ) );
+            calleeCode.resize( calleeCode.size() + 32, _byte_( Instruction::JUMPDEST ) );
+            calleeCode.push_back( _byte_( Instruction::JUMPDEST ) );
+        }
+        state.setCode( calleeAddress, bytes{ calleeCode }, version );
+    }
+
+    ~CallsFixture() { state.releaseWriteLock(); }
+
+    /// Code calling the callee _calls times in a loop
+    bytes callerCode( uint16_t _calls ) const {
+        // counter
+        // loop: call(gas(), callee, 0, 0, 0, 0, 0)
+        // counter := sub(counter, 1)
+        // jumpi(loop, counter)
+        bytes counter{ _byte_( _calls >> 8 ), _byte_( _calls ) };
+        return fromHex( "61" + toHex( counter ) + "5b" + "6000600060006000600073" +
+                        calleeAddress.hex() + "5af1506001900380600357" + "00" );
+    }
+
+    owning_bytes_ref execute( bytes const& _code ) { return execute( vm, _code ); }
+
+    owning_bytes_ref execute( VMFace& _vm, bytes const& _code ) {
+        ExtVM extVm( state, envInfo, *se, address, address, address, value, gasPrice, {},
+            ref( _code ), sha3( _code ), version, depth, isCreate, staticCall );
+        u256 io_gas = gas;
+        return _vm.exec( io_gas, extVm, OnOpFunc{} );
+    }
+
+    BlockHeader blockHeader{ initBlockHeader() };
+    LastBlockHashes lastBlockHashes;
+    Address address{ KeyPair::create().address() };
+    Address calleeAddress{ KeyPair::create().address() };
+    State state{ 0 };
+    std::unique_ptr< SealEngineFace > se{
+        ChainParams( genesisInfo( Network::IstanbulTest ) ).createSealEngine() };
+    EnvInfo envInfo{ blockHeader, lastBlockHashes, 0, se->chainParams().chainID };
+
+    u256 value = 0;
+    u256 gasPrice = 1;
+    u256 version = IstanbulSchedule.accountVersion;
+    int depth = 0;
+    bool isCreate = false;
+    bool staticCall = false;
+    u256 gas = 1000000000;
+
+    bytes calleeCode;
+
+    LegacyVM vm;
+};
+
+class GasMeteringFixture : public TestOutputHelperFixture {
+public:
+    GasMeteringFixture() { state.addBalance( address, 1 * ether ); }
+
+    ~GasMeteringFixture() { state.releaseWriteLock(); }
+
+    /// Output and gas left after running _code, or the exception it stopped with
+    std::string execute( VMFace& _vm, bytes const& _code, u256 _gas ) {
+        ExtVM extVm( state, envInfo, *se, address, address, address, value, gasPrice, {},
+            ref( _code ), sha3( _code ), version, depth, isCreate, staticCall );
+        try {
+            owning_bytes_ref ret = _vm.exec( _gas, extVm, OnOpFunc{} );
+            return toHex( ret.toBytes() ) + " " + _gas.str();
+        } catch ( VMException const& _e ) {
+            return _e.what();
+        }
+    }
+
+    /// Runs _code with every _step of gas up to _maxGas, so that it runs out of gas everywhere
+    void testSameAsLegacyVM( std::string const& _code, unsigned _maxGas, unsigned _step = 1 ) {
+        bytes const code = fromHex( _code );
+        for ( unsigned gas = 0; gas <= _maxGas; gas += _step )
+            BOOST_REQUIRE_EQUAL(
+                execute( legacyVM, code, gas ), execute( interpreter, code, gas ) );
+    }
+
+    BlockHeader blockHeader{ initBlockHeader() };
+    LastBlockHashes lastBlockHashes;
+    Address address{ KeyPair::create().address() };
+    State state{ 0 };
+    std::unique_ptr< SealEngineFace > se{
+        ChainParams( genesisInfo( Network::IstanbulTest ) ).createSealEngine() };
+    EnvInfo envInfo{ blockHeader, lastBlockHashes, 0, se->chainParams().chainID };
+
+    u256 value = 0;
+    u256 gasPrice = 1;
+    u256 version = IstanbulSchedule.accountVersion;
+    int depth = 0;
+    bool isCreate = false;
+    bool staticCall = false;
+
+    LegacyVM legacyVM;
+    EVMC interpreter{ evmc_create_interpreter() };
+};
 }  // namespace
 
 BOOST_FIXTURE_TEST_SUITE( LegacyVMSuite, TestOutputHelperFixture )
@@ -857,6 +964,73 @@ BOOST_AUTO_TEST_CASE( LegacyVMSelfBalanceisInvalidBeforeIstanbul,
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_FIXTURE_TEST_SUITE( LegacyVMCallsSuite, CallsFixture )
+
+BOOST_AUTO_TEST_CASE( LegacyVMCodeIsAnalyzedOnce ) {
+    LegacyVMCodeCache::Stats before = LegacyVMCodeCache::instance().stats();
+    execute( callerCode( 10 ) );
+    LegacyVMCodeCache::Stats after = LegacyVMCodeCache::instance().stats();
+
+    // caller and the first call of the callee
+    BOOST_REQUIRE_EQUAL( after.misses - before.misses, 2 );
+    BOOST_REQUIRE_EQUAL( after.hits - before.hits, 9 );
+}
+
+BOOST_AUTO_TEST_CASE( LegacyVMCodeJumpDests ) {
+    // jump(4) is valid, jump(1) would land in PUSH1 data
+    bytes code = fromHex( "6004565b5b00" );
+    LegacyVMCode analyzed( &code );
+    BOOST_REQUIRE( !analyzed.isJumpDest( 1 ) );
+    BOOST_REQUIRE( analyzed.isJumpDest( 3 ) );
+    BOOST_REQUIRE( analyzed.isJumpDest( 4 ) );
+    BOOST_REQUIRE( !analyzed.isJumpDest( 5 ) );
+    BOOST_REQUIRE( !analyzed.isJumpDest( 1000 ) );
+    BOOST_REQUIRE_EQUAL( analyzed.code.size(), code.size() + 33 );
+}
+
+BOOST_AUTO_TEST_CASE( LegacyVMFramesAreRecycled ) {
+    // the callees run in VMs kept by this thread
+    execute( callerCode( 10 ) );
+    BOOST_REQUIRE_GE( FramePool< LegacyVM >::size(), 1 );
+
+    VMFace* recycled = nullptr;
+    {
+        VMPtr first = VMFactory::create( VMKind::Legacy );
+        recycled = first.get();
+        // 1 stays on the stack, mstore(0, 0xff)
+        execute( *first, fromHex( "6001" "60ff600052" "00" ) );
+    }
+
+    VMPtr second = VMFactory::create( VMKind::Legacy );
+    BOOST_REQUIRE_EQUAL( second.get(), recycled );
+    // mstore(0, msize()), return(0, 32) starts with empty memory
+    owning_bytes_ref ret = execute( *second, fromHex( "5960005260206000f3" ) );
+    BOOST_REQUIRE_EQUAL( fromBigEndian< int >( ret ), 0 );
+    // and an empty stack
+    BOOST_REQUIRE_THROW( execute( *second, fromHex( "01" ) ), StackUnderflow );
+}
+
+BOOST_AUTO_TEST_CASE( bench_LegacyVMCalls,
+    *boost::unit_test::label( "bench" ) *
+        boost::unit_test::precondition( dev::test::run_not_express ) ) {
+    if ( !Options::get().all ) {
+        std::cout << "Skipping benchmark test because --all option is not specified.\n";
+        return;
+    }
+
+    uint16_t const calls = 10000;
+    bytes code = callerCode( calls );
+    execute( code );
+
+    Timer timer;
+    execute( code );
+    double seconds = std::chrono::duration< double >( timer.duration() ).count();
+    std::cout << boost::unit_test::framework::current_test_case().p_name << ": "
+              << calls / seconds << " calls/s into " << calleeCode.size() << " bytes of code\n";
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE( SkaleInterpreterSuite, TestOutputHelperFixture )
@@ -1045,4 +1219,41 @@ BOOST_AUTO_TEST_CASE( SkaleInterpreterSelfBalanceisInvalidBeforeIstanbul,
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_FIXTURE_TEST_SUITE( SkaleInterpreterGasMeteringSuite, GasMeteringFixture )
+
+BOOST_AUTO_TEST_CASE( SkaleInterpreterBlockGasSameAsLegacyVM ) {
+    // acc := 0
+    // for { let i := 3 } i { i := sub(i, 1) } { acc := add(acc, 7)  mstore(mul(i, 32), gas()) }
+    // mstore(0, acc)
+    // return(0, 128)
+    testSameAsLegacyVM( "6000"
+                        "6003"
+                        "5b"
+                        "81"
+                        "600701"
+                        "8092"
+                        "5050"
+                        "5a"
+                        "81"
+                        "602002"
+                        "52"
+                        "60019003"
+                        "80"
+                        "600457"
+                        "50"
+                        "600052"
+                        "60806000f3",
+        300 );
+}
+
+BOOST_AUTO_TEST_CASE( SkaleInterpreterBlockErrorsSameAsLegacyVM ) {
+    // add(1, ?) with a single item on the stack
+    testSameAsLegacyVM( "600101", 10 );
+    // jump(3) into PUSH1 data
+    testSameAsLegacyVM( "6001600356", 20 );
+    // push forever
+    testSameAsLegacyVM( "5b6000600056", 20000, 7 );
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file HistoricStateView.cpp
+ * @date 2026
+ * Checks point queries of HistoricStateView against the accounts written into every block
+ */
+
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libethereum/BlockChain.h>
+#include <libhistoric/HistoricStateView.h>
+#include <libhistoric/SecureTrieDB.h>
+#include <test/tools/libtesteth/TestOutputHelper.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace {
+
+u256 const c_startNonce = 7;
+uint64_t const c_blocks = 10;
+
+struct TestAccount {
+    u256 nonce;
+    u256 balance;
+    map< u256, u256 > storage;
+    bytes code;
+};
+
+/// Writes random accounts into the state tries, saving a root for every block like HistoricState
+class HistoricStateViewFixture : public TestOutputHelperFixture {
+public:
+    HistoricStateViewFixture() {
+        SecureTrieDB< Address, OverlayDB > state( &m_db );
+        state.init();
+        for ( unsigned i = 0; i < 100; ++i )
+            m_addresses.push_back( Address( m_random() ) );
+
+        map< Address, TestAccount > accounts;
+        for ( uint64_t block = 0; block < c_blocks; ++block ) {
+            for ( unsigned i = 0; i < 20; ++i ) {
+                Address const& address = m_addresses[m_random() % m_addresses.size()];
+                TestAccount& account = accounts[address];
+                account.nonce += 1;
+                account.balance = m_random();
+                account.storage[m_random() % 8] = m_random() % 3;
+                if ( m_random() % 4 == 0 )
+                    account.code = bytes( 1 + m_random() % 64, uint8_t( block ) );
+
+                SecureTrieDB< h256, OverlayDB > storage( &m_db );
+                storage.init();
+                for ( auto const& value : account.storage )
+                    if ( value.second )
+                        storage.insert( h256( value.first ), rlp( value.second ) );
+                h256 codeHash = EmptySHA3;
+                if ( !account.code.empty() ) {
+                    codeHash = sha3( account.code );
+                    m_db.insert( codeHash, &account.code );
+                }
+                RLPStream s( 4 );
+                s << account.nonce << account.balance << storage.root() << codeHash;
+                state.insert( address, &s.out() );
+            }
+            m_blockToStateRootDB.insert( h256( block ), state.root().ref() );
+            m_history.push_back( accounts );
+        }
+    }
+
+    /// @returns number of random queries which do not match the accounts written into the blocks.
+    /// Does not use Boost.Test, so that it can run on several threads.
+    unsigned mismatches( HistoricStateView const& _view, unsigned _seed, unsigned _queries ) const {
+        mt19937_64 random( _seed );
+        unsigned ret = 0;
+        for ( unsigned i = 0; i < _queries; ++i ) {
+            uint64_t const block = random() % c_blocks;
+            Address const& address = m_addresses[random() % m_addresses.size()];
+            u256 const key = random() % 8;
+
+            auto const it = m_history[block].find( address );
+            if ( it == m_history[block].end() ) {
+                ret += _view.balance( address, block ) != 0 ||
+                       _view.getNonce( address, block ) != c_startNonce ||
+                       _view.storage( address, key, block ) != 0 ||
+                       _view.storageRoot( address, block ) != EmptyTrie ||
+                       !_view.code( address, block ).empty();
+                continue;
+            }
+            TestAccount const& account = it->second;
+            auto const value = account.storage.find( key );
+            ret += _view.balance( address, block ) != account.balance ||
+                   _view.getNonce( address, block ) != account.nonce ||
+                   _view.storage( address, key, block ) !=
+                       ( value == account.storage.end() ? 0 : value->second ) ||
+                   _view.code( address, block ) != account.code;
+        }
+        return ret;
+    }
+
+    OverlayDB m_db;
+    OverlayDB m_blockToStateRootDB;
+    vector< Address > m_addresses;
+    vector< map< Address, TestAccount > > m_history;
+    mt19937_64 m_random{ 25 };
+};
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE( HistoricStateViewSuite, HistoricStateViewFixture )
+
+BOOST_AUTO_TEST_CASE( HistoricStateViewReadsEveryBlock ) {
+    HistoricStateView const view( c_startNonce, m_db, m_blockToStateRootDB );
+    BOOST_CHECK_EQUAL( mismatches( view, 1, 5000 ), 0 );
+    BOOST_CHECK( view.trieNodeCacheStats().hits > 0 );
+    BOOST_CHECK_THROW( view.balance( m_addresses[0], c_blocks ), UnknownBlockNumberInRootDB );
+}
+
+BOOST_AUTO_TEST_CASE( HistoricStateViewEvictsTrieNodes ) {
+    auto const cacheSize = c_historicTrieNodeCacheSize;
+    c_historicTrieNodeCacheSize = 16;
+    HistoricStateView const view( c_startNonce, m_db, m_blockToStateRootDB );
+    c_historicTrieNodeCacheSize = cacheSize;
+
+    BOOST_CHECK_EQUAL( mismatches( view, 2, 2000 ), 0 );
+    BOOST_CHECK_LE( view.trieNodeCacheStats().size, 16 );
+}
+
+BOOST_AUTO_TEST_CASE( HistoricStateViewConcurrentQueries ) {
+    HistoricStateView const view( c_startNonce, m_db, m_blockToStateRootDB );
+    vector< unsigned > results( 4, 0 );
+    vector< thread > threads;
+    for ( unsigned i = 0; i < results.size(); ++i )
+        threads.emplace_back( [&, i]() { results[i] = mismatches( view, 10 + i, 2000 ); } );
+    for ( auto& t : threads )
+        t.join();
+    for ( unsigned result : results )
+        BOOST_CHECK_EQUAL( result, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
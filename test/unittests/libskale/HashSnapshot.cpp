@@ -583,6 +583,37 @@ BOOST_FIXTURE_TEST_CASE( SnapshotHashingFileStorageTest, SnapshotHashingFixture,
     BOOST_REQUIRE( hash4_dbl == hash4 );
 }
 
+BOOST_FIXTURE_TEST_CASE( SnapshotHashDoesntDependOnThreads, SnapshotHashingFixture,
+    *boost::unit_test::precondition( dev::test::run_not_express ) ) {
+    mgr->doSnapshot( 5 );
+
+    mgr->setHashingThreads( 1 );
+    mgr->computeSnapshotHash( 5 );
+    dev::h256 hash5 = mgr->getSnapshotHash( 5 );
+
+    boost::filesystem::remove( mgr->snapshots_dir / "5" / SnapshotManager::snapshot_hash_file_name );
+    BOOST_REQUIRE( !mgr->isSnapshotHashPresent( 5 ) );
+
+    mgr->setHashingThreads( 8 );
+    mgr->computeSnapshotHash( 5 );
+    BOOST_REQUIRE( mgr->getSnapshotHash( 5 ) == hash5 );
+}
+
+BOOST_AUTO_TEST_CASE( FileContentHashIsStreamed ) {
+    TransientDirectory td;
+    boost::filesystem::path path = td.path() + "/file";
+
+    // not a multiple of the buffer size
+    std::string content( 3 * SnapshotManager::c_fileHashBufferSize + 17, 'a' );
+    for ( size_t i = 0; i < content.size(); i += 4096 )
+        content[i] = char( i / 4096 );
+    std::ofstream( path.string(), std::ios::binary ) << content;
+
+    BOOST_REQUIRE_EQUAL( SnapshotManager::hashFileContent( path ), dev::sha256( content ) );
+    BOOST_REQUIRE_THROW(
+        SnapshotManager::hashFileContent( td.path() + "/absent" ), SnapshotManager::CannotRead );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE( SnapshotPerformanceSuite, *boost::unit_test::disabled() )
@@ -6,6 +6,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -359,6 +360,55 @@ BOOST_FIXTURE_TEST_CASE( DiffTest, BtrfsFixture,
         tmp = mgr.makeOrGetDiff( 4 ), SnapshotManager::CannotPerformBtrfsOperation );
 }
 
+BOOST_FIXTURE_TEST_CASE( AsyncDiffTest, BtrfsFixture,
+    *boost::unit_test::precondition( dev::test::run_not_express ) ) {
+    SnapshotManager mgr( fs::path( BTRFS_DIR_PATH ), {"vol1", "vol2"} );
+    mgr.doSnapshot( 2 );
+    fs::create_directory( fs::path( BTRFS_DIR_PATH ) / "vol1" / "dir" );
+    mgr.doSnapshot( 4 );
+
+    BOOST_REQUIRE_THROW( mgr.makeOrGetDiffAsync( 3 ), SnapshotManager::SnapshotAbsent );
+
+    SnapshotManager::DiffJob job = mgr.makeOrGetDiffAsync( 4 );
+    BOOST_REQUIRE( job.partPath != job.path );
+    // diff in flight is not restarted
+    SnapshotManager::DiffJob same = mgr.makeOrGetDiffAsync( 4 );
+    BOOST_REQUIRE( same.partPath == job.partPath || same.partPath == same.path );
+    BOOST_REQUIRE_NO_THROW( job.done.get() );
+    BOOST_REQUIRE( fs::exists( job.path ) );
+    BOOST_REQUIRE( !fs::exists( job.partPath ) );
+    BOOST_REQUIRE_GT( fs::file_size( job.path ), 0 );
+
+    // diffs being written are not counted as complete ones
+    fs::path part = job.path.string() + ".abcd-ef01.part";
+    std::ofstream( part.string() ).close();
+    mgr.leaveNLastDiffs( 1 );
+    BOOST_REQUIRE( fs::exists( job.path ) );
+    BOOST_REQUIRE( fs::exists( part ) );
+    fs::remove( part );
+
+    // complete diff is returned as is
+    SnapshotManager::DiffJob again = mgr.makeOrGetDiffAsync( 4 );
+    BOOST_REQUIRE( again.partPath == again.path );
+    BOOST_REQUIRE( again.done.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    mgr.removeDiff( 4 );
+    BOOST_REQUIRE( !fs::exists( again.path ) );
+
+    // removal waits for the send in flight
+    job = mgr.makeOrGetDiffAsync( 4 );
+    mgr.removeDiff( 4 );
+    BOOST_REQUIRE( job.done.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    BOOST_REQUIRE( !fs::exists( job.partPath ) );
+    BOOST_REQUIRE( !fs::exists( job.path ) );
+
+    btrfs.subvolume._delete( ( fs::path( BTRFS_DIR_PATH ) / "snapshots" / "4" / "vol1" ).c_str() );
+
+    job = mgr.makeOrGetDiffAsync( 4 );
+    BOOST_REQUIRE_THROW( job.done.get(), SnapshotManager::CannotPerformBtrfsOperation );
+    BOOST_REQUIRE( !fs::exists( job.partPath ) );
+    BOOST_REQUIRE( !fs::exists( job.path ) );
+}
+
 // TODO Tests to check no files left in /tmp?!
 
 BOOST_FIXTURE_TEST_CASE( ImportTest, BtrfsFixture,
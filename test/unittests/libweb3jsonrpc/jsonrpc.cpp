@@ -964,6 +964,74 @@ contract Logger{
     BOOST_REQUIRE_EQUAL(res["to"], contractAddress);
 }
 
+BOOST_AUTO_TEST_CASE( logs_pages ) {
+    JsonRpcFixture fixture;
+    dev::eth::simulateMining( *( fixture.client ), 1 );
+
+    // same Logger contract as in logs_range
+    string bytecode =
+        "6080604052348015600f57600080fd5b50607d80601d6000396000f3fe60806040527f64696d616c69740000000000000000000000000000000000000000000000000043600102600143016001026040518082815260200191505060405180910390a200fea2646970667358221220ecafb98cd573366a37976cb7a4489abe5389d1b5989cd7b7136c8eb0c5ba0b5664736f6c63430006000033";
+
+    Json::Value create;
+    create["code"] = bytecode;
+    create["gas"] = "180000";
+
+    string deployHash = fixture.rpcClient->eth_sendTransaction( create );
+    dev::eth::mineTransaction( *( fixture.client ), 1 );
+
+    Json::Value deployReceipt = fixture.rpcClient->eth_getTransactionReceipt( deployHash );
+    string contractAddress = deployReceipt["contractAddress"].asString();
+
+    for(int i=0; i<10; ++i){
+        Json::Value t;
+        t["from"] = toJS( fixture.coinbase.address() );
+        t["value"] = jsToDecimal( "0" );
+        t["to"] = contractAddress;
+        t["gas"] = "99000";
+
+        std::string txHash = fixture.rpcClient->eth_sendTransaction( t );
+        BOOST_REQUIRE( !txHash.empty() );
+
+        dev::eth::mineTransaction( *( fixture.client ), 1 );
+    }
+
+    Json::Value filter;
+    filter["fromBlock"] = "0x0";
+    filter["toBlock"] = "latest";
+    filter["address"] = contractAddress;
+    Json::Value logs = fixture.rpcClient->eth_getLogs(filter);
+    BOOST_REQUIRE(logs.isArray());
+    BOOST_REQUIRE_EQUAL(logs.size(), 10);
+    // logs come in chain order, pages rely on it
+    for(int i=1; i<10; ++i)
+        BOOST_REQUIRE_LT(jsToInt(logs[i-1]["blockNumber"].asString()), jsToInt(logs[i]["blockNumber"].asString()));
+
+    // read the same logs 3 at a time
+    Json::Value options;
+    options["limit"] = 3;
+    options["cursor"] = Json::Value( Json::nullValue );
+    size_t count = 0;
+    do {
+        Json::Value p;
+        p.append( filter );
+        p.append( options );
+        Json::Value page = fixture.rpcClient->CallMethod( "skale_getLogs", p );
+        BOOST_REQUIRE(page["logs"].isArray());
+        BOOST_REQUIRE(page["logs"].size() <= 3);
+        for(auto const& log : page["logs"])
+            BOOST_REQUIRE_EQUAL(log["transactionHash"], logs[(int)count++]["transactionHash"]);
+        options["cursor"] = page["cursor"];
+    } while ( !options["cursor"].isNull() );
+    BOOST_REQUIRE_EQUAL(count, 10);
+
+    Json::Value p;
+    p.append( filter );
+    options["cursor"] = "0x12";
+    p.append( options );
+    BOOST_REQUIRE_THROW( fixture.rpcClient->CallMethod( "skale_getLogs", p ),
+        jsonrpc::JsonRpcException );
+}
+
 BOOST_AUTO_TEST_CASE( deploy_contract_from_owner ) {
     JsonRpcFixture fixture( c_genesisConfigString );
     Address senderAddress = fixture.coinbase.address();
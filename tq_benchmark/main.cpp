@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file main.cpp
+ * @date 2026
+ * Measures TransactionQueue import throughput by number of importing threads and shards.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#include <libethereum/TransactionQueue.h>
+
+using namespace dev;
+using namespace dev::eth;
+
+namespace {
+
+const size_t c_senders = 256;
+const size_t c_transactionsPerSender = 64;
+
+/// Every sender has its own nonce sequence, so all transactions are accepted
+vector< Transactions > createTransactions() {
+    Address dest( "0x095e7baea6a6c7c4c2dfeb977efac326af552d87" );
+    vector< Transactions > ret( c_senders );
+    for ( auto& senderTransactions : ret ) {
+        Secret secret = Secret::random();
+        for ( size_t nonce = 0; nonce < c_transactionsPerSender; ++nonce ) {
+            senderTransactions.push_back(
+                Transaction( 0, 10 * szabo, 25000, dest, bytes(), nonce, secret ) );
+            // recover here to measure the queue only
+            senderTransactions.back().sender();
+        }
+    }
+    return ret;
+}
+
+/// @returns imported transactions per second
+double measureImport(
+    vector< Transactions > const& _transactions, unsigned _threads, unsigned _shards ) {
+    size_t total = c_senders * c_transactionsPerSender;
+    TransactionQueue tq( total, 1024, _shards );
+
+    atomic< size_t > nextSender{ 0 };
+    atomic< size_t > failed{ 0 };
+    auto start = chrono::steady_clock::now();
+    vector< thread > threads;
+    for ( unsigned i = 0; i < _threads; ++i )
+        threads.emplace_back( [&]() {
+            for ( size_t s = nextSender++; s < _transactions.size(); s = nextSender++ )
+                for ( auto const& t : _transactions[s] )
+                    if ( tq.import( t ) != ImportResult::Success )
+                        ++failed;
+        } );
+    for ( auto& t : threads )
+        t.join();
+    double seconds =
+        chrono::duration< double >( chrono::steady_clock::now() - start ).count();
+
+    if ( failed > 0 )
+        cerr << failed << " transactions were not imported" << endl;
+    return total / seconds;
+}
+
+}  // namespace
+
+int main() {
+    c_transactionVerifierThreads = 0;
+    cout << "Signing " << c_senders * c_transactionsPerSender << " transactions..." << endl;
+    vector< Transactions > transactions = createTransactions();
+
+    unsigned maxThreads = max( thread::hardware_concurrency(), 1U );
+    cout << setw( 8 ) << "threads" << setw( 16 ) << "1 shard tx/s" << setw( 16 )
+         << to_string( c_transactionQueueShards ) + " shards tx/s" << endl;
+    for ( unsigned threads = 1; threads <= maxThreads; threads *= 2 ) {
+        cout << setw( 8 ) << threads << setw( 16 ) << fixed << setprecision( 0 )
+             << measureImport( transactions, threads, 1 ) << setw( 16 )
+             << measureImport( transactions, threads, c_transactionQueueShards ) << endl;
+    }
+    return 0;
+}
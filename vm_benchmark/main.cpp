@@ -0,0 +1,414 @@
+/*
+    Copyright (C) 2018-present, SKALE Labs
+
+    This file is part of skaled.
+
+    skaled is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skaled is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with skaled.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * @file main.cpp
+ * @date 2026
+ * Measures 256-bit arithmetic of the EVM interpreters. Compares the native kernel of Uint256.h
+ * with the boost::multiprecision code it replaces, then runs the opcode loops of
+ * test/unittests/performance/*.asm in LegacyVM and in skale-interpreter. Last counts heap
+ * allocations of nested call frames.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include <libethereum/LastBlockHashesFace.h>
+#include <libevm/EVMC.h>
+#include <libevm/LegacyVM.h>
+#include <libevm/Uint256.h>
+#include <libevm/VMFactory.h>
+#include <libskale-interpreter/interpreter.h>
+
+using namespace dev;
+using namespace dev::eth;
+
+namespace {
+uint64_t g_allocations = 0;
+}  // namespace
+
+// count every heap allocation of the program
+void* operator new( size_t _size ) {
+    ++g_allocations;
+    if ( void* p = malloc( _size ? _size : 1 ) )
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete( void* _p ) noexcept {
+    free( _p );
+}
+
+void operator delete( void* _p, size_t ) noexcept {
+    free( _p );
+}
+
+namespace {
+
+mt19937_64 g_random( 2026 );
+volatile uint64_t g_sink = 0;
+
+u256 randomNumber( unsigned _bits ) {
+    u256 ret;
+    for ( unsigned i = 0; i < _bits; i += 64 )
+        ret = ( ret << 64 ) | g_random();
+    return _bits < 256 ? ret & ( ( u256( 1 ) << _bits ) - 1 ) : ret;
+}
+
+//
+// kernel
+//
+
+struct Operands {
+    u256 a;
+    u256 b;  ///< about half of the width of a, never 0
+    u256 m;  ///< modulus, never 0
+};
+
+vector< Operands > createOperands( unsigned _bits ) {
+    vector< Operands > ret( 4096 );
+    for ( auto& o : ret ) {
+        o.a = randomNumber( _bits );
+        o.b = randomNumber( max( _bits / 2, 64U ) ) | 1;
+        o.m = randomNumber( _bits ) | 1;
+    }
+    return ret;
+}
+
+/// @returns nanoseconds per call of _op
+template < class Op >
+double measureKernel( vector< Operands > const& _operands, unsigned _rounds, Op _op ) {
+    u256 sink = 0;
+    auto start = chrono::steady_clock::now();
+    for ( unsigned r = 0; r < _rounds; ++r )
+        for ( auto const& o : _operands )
+            sink ^= _op( o );
+    double ns = chrono::duration< double, nano >( chrono::steady_clock::now() - start ).count();
+    g_sink = g_sink ^ static_cast< uint64_t >( sink );
+    return ns / ( double( _rounds ) * _operands.size() );
+}
+
+template < class BoostOp, class NativeOp >
+void compareKernel(
+    string const& _name, unsigned _bits, unsigned _rounds, BoostOp _boost, NativeOp _native ) {
+    vector< Operands > operands = createOperands( _bits );
+    for ( auto const& o : operands )
+        if ( _boost( o ) != _native( o ) ) {
+            cerr << _name << " results differ for " << o.a << ", " << o.b << ", " << o.m << endl;
+            exit( 1 );
+        }
+
+    double boostNs = measureKernel( operands, _rounds, _boost );
+    double nativeNs = measureKernel( operands, _rounds, _native );
+    cout << setw( 14 ) << _name << setw( 12 ) << fixed << setprecision( 1 ) << boostNs
+         << setw( 12 ) << nativeNs << setw( 10 ) << setprecision( 2 ) << boostNs / nativeNs
+         << endl;
+}
+
+/// exp256 of the interpreters before the native kernel
+u256 boostExp( u256 _base, u256 _exponent ) {
+    using boost::multiprecision::limb_type;
+    u256 result = 1;
+    while ( _exponent ) {
+        if ( static_cast< limb_type >( _exponent ) & 1 )
+            result *= _base;
+        _base *= _base;
+        _exponent >>= 1;
+    }
+    return result;
+}
+
+void benchmarkKernel() {
+    cout << setw( 14 ) << "ns/op" << setw( 12 ) << "boost" << setw( 12 ) << "native" << setw( 10 )
+         << "speedup" << endl;
+
+    for ( unsigned bits : { 64U, 128U, 256U } ) {
+        string suffix = to_string( bits );
+        compareKernel(
+            "add" + suffix, bits, 2000, []( Operands const& o ) -> u256 { return o.a + o.m; },
+            []( Operands const& o ) { return native::add( o.a, o.m ); } );
+        compareKernel(
+            "sub" + suffix, bits, 2000, []( Operands const& o ) -> u256 { return o.a - o.m; },
+            []( Operands const& o ) { return native::sub( o.a, o.m ); } );
+        compareKernel(
+            "mul" + suffix, bits, 2000, []( Operands const& o ) -> u256 { return o.a * o.m; },
+            []( Operands const& o ) { return native::mul( o.a, o.m ); } );
+        compareKernel(
+            "div" + suffix, bits, 500,
+            []( Operands const& o ) { return u256( s512( o.a ) / s512( o.b ) ); },
+            []( Operands const& o ) { return native::div( o.a, o.b ); } );
+    }
+
+    compareKernel(
+        "mod256", 256, 500, []( Operands const& o ) { return u256( s512( o.a ) % s512( o.b ) ); },
+        []( Operands const& o ) { return native::mod( o.a, o.b ); } );
+    compareKernel(
+        "sdiv256", 256, 500,
+        []( Operands const& o ) { return s2u( s256( s512( u2s( o.a ) ) / s512( u2s( o.b ) ) ) ); },
+        []( Operands const& o ) { return native::sdiv( o.a, o.b ); } );
+    compareKernel(
+        "addmod256", 256, 500,
+        []( Operands const& o ) { return u256( ( u512( o.a ) + u512( o.b ) ) % o.m ); },
+        []( Operands const& o ) { return native::addmod( o.a, o.b, o.m ); } );
+    compareKernel(
+        "mulmod256", 256, 500,
+        []( Operands const& o ) { return u256( ( u512( o.a ) * u512( o.b ) ) % o.m ); },
+        []( Operands const& o ) { return native::mulmod( o.a, o.b, o.m ); } );
+    compareKernel(
+        "exp256", 256, 10, []( Operands const& o ) { return boostExp( o.a, o.m ); },
+        []( Operands const& o ) { return native::exp( o.a, o.m ); } );
+    compareKernel(
+        "shl256", 256, 2000,
+        []( Operands const& o ) -> u256 { return o.a << unsigned( o.b & 0xff ); },
+        []( Operands const& o ) { return native::shl( o.a, o.b & 0xff ); } );
+    compareKernel(
+        "signextend256", 256, 2000,
+        []( Operands const& o ) {
+            u256 number = o.a;
+            unsigned testBit = unsigned( o.b % 31 ) * 8 + 7;
+            u256 mask = ( ( u256( 1 ) << testBit ) - 1 );
+            if ( boost::multiprecision::bit_test( number, testBit ) )
+                number |= ~mask;
+            else
+                number &= mask;
+            return number;
+        },
+        []( Operands const& o ) { return native::signextend( o.b % 31, o.a ); } );
+}
+
+//
+// interpreters
+//
+
+class NoBlockHashes : public LastBlockHashesFace {
+public:
+    h256s precedingHashes( h256 const& ) const override { return h256s( 256, h256() ); }
+    void clear() override {}
+};
+
+/// Runs code without any state
+class BenchmarkExtVM : public ExtVMFace {
+public:
+    BenchmarkExtVM( EnvInfo const& _envInfo, bytes const& _code )
+        : ExtVMFace( _envInfo, Address(), Address(), Address(), 0, 1, bytesConstRef(), _code,
+              sha3( _code ), 0, 0, false, false ) {}
+
+    CreateResult create(
+        u256, u256&, bytesConstRef, Instruction, u256, OnOpFunc const& ) override {
+        return { EVMC_FAILURE, {}, Address() };
+    }
+    CallResult call( CallParameters& ) override { return { EVMC_FAILURE, {} }; }
+    h256 blockHash( u256 ) override { return h256(); }
+    EVMSchedule const& evmSchedule() const override { return IstanbulSchedule; }
+};
+
+unsigned const c_opsPerIteration = 16;
+
+/// Same loop as the .asm tests: _operands stay on the stack, every iteration copies them and
+/// applies _op 16 times. Instruction::POP instead of _op gives the overhead of the loop.
+bytes createProgram( Instruction _op, vector< u256 > const& _operands, uint32_t _iterations ) {
+    bytes code;
+    for ( u256 const& operand : _operands ) {
+        code.push_back( _byte_( Instruction::PUSH32 ) );
+        bytes b = h256( operand ).asBytes();
+        code.insert( code.end(), b.begin(), b.end() );
+    }
+    code.push_back( _byte_( Instruction::PUSH4 ) );
+    for ( int shift = 24; shift >= 0; shift -= 8 )
+        code.push_back( _byte_( _iterations >> shift ) );
+
+    size_t const loop = code.size();
+    code.push_back( _byte_( Instruction::JUMPDEST ) );
+    for ( unsigned i = 0; i < c_opsPerIteration; ++i ) {
+        // the counter is on top, operands are below it
+        for ( size_t j = 0; j < _operands.size(); ++j )
+            code.push_back( _byte_( Instruction::DUP1 ) + _operands.size() );
+        if ( _op == Instruction::POP )
+            code.insert( code.end(), _operands.size(), _byte_( Instruction::POP ) );
+        else {
+            code.push_back( _byte_( _op ) );
+            code.push_back( _byte_( Instruction::POP ) );
+        }
+    }
+    // counter := sub(counter, 1), jumpi(loop, counter)
+    for ( _byte_ b : { _byte_( Instruction::PUSH1 ), _byte_( 1 ), _byte_( Instruction::SWAP1 ),
+              _byte_( Instruction::SUB ), _byte_( Instruction::DUP1 ),
+              _byte_( Instruction::PUSH2 ), _byte_( loop >> 8 ), _byte_( loop ),
+              _byte_( Instruction::JUMPI ), _byte_( Instruction::STOP ) } )
+        code.push_back( b );
+    return code;
+}
+
+/// @returns seconds
+double runProgram( VMFace& _vm, bytes const& _code ) {
+    BlockHeader header;
+    NoBlockHashes hashes;
+    EnvInfo envInfo( header, hashes, 0, 1 );
+    BenchmarkExtVM ext( envInfo, _code );
+    u256 gas = 0x7FFFFFFFFFFFFFFF;
+
+    auto start = chrono::steady_clock::now();
+    _vm.exec( gas, ext, OnOpFunc() );
+    return chrono::duration< double >( chrono::steady_clock::now() - start ).count();
+}
+
+struct Program {
+    string name;
+    Instruction op;
+    /// pushed in this order, so the last one is the first argument of op
+    vector< u256 > operands;
+    uint32_t iterations;
+};
+
+vector< Program > createPrograms() {
+    vector< Program > ret;
+    for ( unsigned bits : { 64U, 128U, 256U } ) {
+        string suffix = to_string( bits );
+        vector< u256 > operands{ randomNumber( max( bits / 2, 64U ) ) | 1, randomNumber( bits ) };
+        ret.push_back( { "add" + suffix, Instruction::ADD, operands, 1 << 16 } );
+        ret.push_back( { "sub" + suffix, Instruction::SUB, operands, 1 << 16 } );
+        ret.push_back( { "mul" + suffix, Instruction::MUL, operands, 1 << 16 } );
+        ret.push_back( { "div" + suffix, Instruction::DIV, operands, 1 << 16 } );
+    }
+    vector< u256 > wide{ randomNumber( 128 ) | 1, randomNumber( 256 ) };
+    vector< u256 > modular{ randomNumber( 256 ) | 1, randomNumber( 256 ), randomNumber( 256 ) };
+    vector< u256 > shift{ randomNumber( 256 ), 97 };
+    ret.push_back( { "mod256", Instruction::MOD, wide, 1 << 16 } );
+    ret.push_back( { "sdiv256", Instruction::SDIV, wide, 1 << 16 } );
+    ret.push_back( { "addmod256", Instruction::ADDMOD, modular, 1 << 16 } );
+    ret.push_back( { "mulmod256", Instruction::MULMOD, modular, 1 << 16 } );
+    vector< u256 > power{ randomNumber( 256 ), randomNumber( 256 ) };
+    ret.push_back( { "exp", Instruction::EXP, power, 1 << 12 } );
+    ret.push_back( { "shl", Instruction::SHL, shift, 1 << 16 } );
+    ret.push_back( { "sar", Instruction::SAR, shift, 1 << 16 } );
+    vector< u256 > extend{ randomNumber( 256 ), 15 };
+    ret.push_back( { "signextend", Instruction::SIGNEXTEND, extend, 1 << 16 } );
+    return ret;
+}
+
+void benchmarkInterpreters() {
+    LegacyVM legacy;
+    EVMC interpreter{ evmc_create_interpreter() };
+    VMFace* const vms[] = { &legacy, &interpreter };
+
+    cout << setw( 14 ) << "ns/op" << setw( 12 ) << "legacy" << setw( 14 ) << "interpreter"
+         << endl;
+    for ( Program const& p : createPrograms() ) {
+        bytes code = createProgram( p.op, p.operands, p.iterations );
+        bytes loop = createProgram( Instruction::POP, p.operands, p.iterations );
+        double ops = double( p.iterations ) * c_opsPerIteration;
+        cout << setw( 14 ) << p.name << fixed << setprecision( 1 );
+        for ( VMFace* vm : vms ) {
+            double seconds = runProgram( *vm, code ) - runProgram( *vm, loop );
+            cout << setw( vm == vms[0] ? 12 : 14 ) << seconds * 1e9 / ops;
+        }
+        cout << endl;
+    }
+}
+
+//
+// call frames
+//
+
+unsigned const c_callDepth = 256;
+
+/// Runs every CALL as a nested frame of the same code in a VM of VMFactory, as Executive does,
+/// until c_callDepth
+class CallingExtVM : public BenchmarkExtVM {
+public:
+    CallingExtVM( EnvInfo const& _envInfo, bytes const& _code, VMKind _kind, unsigned _depth )
+        : BenchmarkExtVM( _envInfo, _code ), m_kind( _kind ) {
+        depth = _depth;
+    }
+
+    CallResult call( CallParameters& _p ) override {
+        if ( depth + 1 >= c_callDepth )
+            return { EVMC_SUCCESS, {} };
+        // copies the code as ExtVM does
+        CallingExtVM ext( envInfo(), code, m_kind, depth + 1 );
+        owning_bytes_ref output = VMFactory::create( m_kind )->exec( _p.gas, ext, OnOpFunc() );
+        return { EVMC_SUCCESS, move( output ) };
+    }
+
+private:
+    VMKind m_kind;
+};
+
+/// call(gas(), address(), 0, 0, 0, 0, 32), mstore(0x40, 1), return(0, 32)
+bytes const c_callerCode = fromHex( "60206000600060006000305af150" "6001604052" "60206000f3" );
+
+/// Allocations and nanoseconds per frame of a call tree of c_callDepth frames
+pair< double, double > runCallTree( VMKind _kind ) {
+    BlockHeader header;
+    NoBlockHashes hashes;
+    EnvInfo envInfo( header, hashes, 0, 1 );
+    CallingExtVM ext( envInfo, c_callerCode, _kind, 0 );
+    u256 gas = 0x7FFFFFFFFFFFFFFF;
+
+    uint64_t const allocations = g_allocations;
+    auto start = chrono::steady_clock::now();
+    VMFactory::create( _kind )->exec( gas, ext, OnOpFunc() );
+    chrono::duration< double, nano > const time = chrono::steady_clock::now() - start;
+    return { double( g_allocations - allocations ) / c_callDepth, time.count() / c_callDepth };
+}
+
+void benchmarkCallFrames() {
+    cout << setw( 14 ) << "per frame" << setw( 12 ) << "allocs" << setw( 12 ) << "ns" << endl;
+    for ( VMKind kind : { VMKind::Legacy, VMKind::Interpreter } ) {
+        string const name = kind == VMKind::Legacy ? "legacy" : "interpreter";
+        auto const first = runCallTree( kind );
+        unsigned const rounds = 100;
+        pair< double, double > warm;
+        for ( unsigned i = 0; i < rounds; ++i ) {
+            auto const r = runCallTree( kind );
+            warm.first += r.first / rounds;
+            warm.second += r.second / rounds;
+        }
+        cout << fixed << setprecision( 1 );
+        cout << setw( 14 ) << name + " 1st" << setw( 12 ) << first.first << setw( 12 )
+             << first.second << endl;
+        cout << setw( 14 ) << name << setw( 12 ) << warm.first << setw( 12 ) << warm.second
+             << endl;
+    }
+}
+
+}  // namespace
+
+int main() {
+    cout << "Native kernel against boost::multiprecision" << endl;
+    benchmarkKernel();
+
+    cout << endl
+         << "VMs with " << ( EVM_NATIVE_UINT256 ? "native" : "boost::multiprecision" )
+         << " arithmetic, less the loop overhead (build with -DEVM_NATIVE_UINT256=OFF to compare)"
+         << endl;
+    benchmarkInterpreters();
+
+    cout << endl
+         << "Call frames of a call tree " << c_callDepth
+         << " deep, first run and after warm-up. The code of every frame is copied." << endl;
+    benchmarkCallFrames();
+    return 0;
+}